@@ -50,11 +50,12 @@
 
 // internal functions and macros
 WORD word2xchar(WORD pSmple, XCHAR *xcharArray, WORD cnt); 
-void GetCirclePoint(SHORT radius, SHORT angle, SHORT *x, SHORT *y);
 void DrawSector(SHORT cx, SHORT cy, SHORT radius, SHORT angleFrom, SHORT angleTo, WORD outLineColor);
 WORD GetColorShade(WORD color, BYTE shade); 
 WORD ChParseShowData(DATASERIES *pData);
 DATASERIES *ChGetNextShowData(DATASERIES *pData);
+DWORD ChGetBarHeight(CHART *pCh, WORD value, WORD valDelta);
+WORD ChDrawStream(CHART *pCh);
 SHORT ChSetDataSeries(CHART *pCh, WORD seriesNum, BYTE status);
 
 // array used to define the default colors used to draw the bars or sectors of the chart
@@ -118,6 +119,10 @@ CHART  *ChCreate( WORD ID, SHORT left, SHORT top, SHORT right, SHORT bottom,
 
 	pCh->pChData	    = pData;		// assign the chart data 
 
+	// no layout is saved for the streaming mode yet
+	pCh->stream.splDelta = 0;
+	pCh->stream.count	 = 0;
+
 	// check if how variables have SHOW_DATA flag set
 	pCh->prm.seriesCount = ChParseShowData(pData);
 
@@ -220,6 +225,115 @@ WORD GetLongestNameLength(CHART *pCh) {
    	return temp;
 }   		
 
+/*********************************************************************
+* Function: DWORD ChGetBarHeight(CHART *pCh, WORD value, WORD valDelta)
+*
+*
+* Notes: Returns the height of the bar in pixels for the sample value 
+*		 scaled to the value range of the chart. valDelta is the space 
+*		 between the value grids.
+*
+********************************************************************/
+DWORD ChGetBarHeight(CHART *pCh, WORD value, WORD valDelta)
+{
+	DWORD dHeight;
+
+	// this should be adjusted to the min and max set values 
+	if (ChGetValueMax(pCh) <= value) {
+		dHeight = ChGetValueRange(pCh);
+	} else {
+		if (value < ChGetValueMin(pCh))
+			dHeight = 0;
+		else 
+			dHeight = value - ChGetValueMin(pCh);	
+	}
+	return ((DWORD)(dHeight)*(valDelta*(CH_YGRIDCOUNT-1))/ChGetValueRange(pCh));
+}
+
+/*********************************************************************
+* Function: WORD ChDrawStream(CHART *pCh)
+*
+*
+* Notes: Draws the bars of the samples set by ChStreamSample() using 
+*		 the layout saved when the chart was last drawn. The area above 
+*		 each bar is cleared and the value grids in this area are 
+*		 restored. Returns 0 if the layout cannot be used and the chart 
+*		 must be drawn completely, 1 otherwise.
+*
+********************************************************************/
+WORD ChDrawStream(CHART *pCh)
+{
+	CHARTSTREAM *pStream = &pCh->stream;
+	DATASERIES 	*pVar;
+	WORD		sample, barWidth, i;
+	SHORT		varCtr, x, left, right, top, yTop, yGrid;
+
+	// check if the chart still has the saved layout
+	if ((pStream->splDelta == 0) ||
+		(GetState(pCh, CH_BAR_HOR|CH_3D_ENABLE|CH_VALUE|CH_PERCENT) != CH_BAR) ||
+		(pStream->smplStart != ChGetSampleStart(pCh)) || (pStream->smplEnd != ChGetSampleEnd(pCh)) ||
+		(pStream->valMin != ChGetValueMin(pCh)) || (pStream->valMax != ChGetValueMax(pCh)) ||
+		(pStream->seriesCount != (SHORT)ChParseShowData(pCh->pChData)))
+		return 0;
+
+	barWidth = pStream->splDelta/(2+pStream->seriesCount);
+	// top of the highest bar
+	yTop = pStream->yStart-1-((CH_YGRIDCOUNT-1)*pStream->valDelta);
+
+	sample = pStream->first;
+	while (pStream->count) {
+
+		x = pStream->xStart+((sample-pStream->smplStart)*pStream->splDelta)+barWidth;
+
+		// the data series are selected the same way as in ChDraw()
+		varCtr = 0;
+		pVar = ChGetNextShowData(pCh->pChData);
+		while (pVar != NULL) {
+			left  = x+1+(barWidth*varCtr);
+			right = x+(barWidth*(varCtr+1));
+			top   = (pStream->yStart-1)-ChGetBarHeight(pCh, *(&(*pVar->pData) + (sample-1)), pStream->valDelta);
+
+			// clear the area above the bar and restore the value grids in it
+			if (top > yTop) {
+				SetColor(pCh->hdr.pGolScheme->CommonBkColor);
+				Bar(left, yTop, right, top-1);
+
+				SetColor(pCh->hdr.pGolScheme->Color0);
+				for (i = 1; i < CH_YGRIDCOUNT; i++) {
+					yGrid = pStream->yStart-(i*pStream->valDelta);
+					if (yGrid < top)
+						Bar(left, yGrid, right, yGrid);
+				}
+			}
+
+			// draw the bar
+#ifdef USE_MULTI_COLOR			
+			if (pStream->seriesCount > 1) {
+				SetColor(*(&(*pCh->prm.pColor)+varCtr));
+			} else	{
+				SetColor(*(&(*pCh->prm.pColor)+(sample-pStream->smplStart)));
+			}	
+#else
+			SetColor(*(&(*pCh->prm.pColor)+varCtr));
+#endif			
+        	Bar(left, top, right, pStream->yStart-1);
+
+			// find the next data series that will be shown
+			if ((pVar = ChGetNextShowData(pVar)) == NULL)
+				break;
+			if (++varCtr >= pStream->seriesCount)
+				break;
+			pVar = pVar->pNextData;
+		}
+
+		// go to the next sample, the sample range is used as a ring buffer
+		if (++sample > pStream->smplEnd)
+			sample = pStream->smplStart;
+		pStream->count--;
+	}
+	return 1;
+}
+
 WORD word2xchar(WORD pSmple, XCHAR *xcharArray, WORD cnt) {
 	
 	WORD j, z;
@@ -350,6 +464,7 @@ typedef enum {
 	PIE_DRAW_SECTOR_LOOP_CONTINUE,
 	PIE_DRAW_SECTOR_LOOP_CREATE_STRINGS,
 	PIE_DRAW_SECTOR_LOOP_STRINGS_RUN,
+	PIE_DRAW_OUTLINE2,
 } CH_DRAW_STATES;
 
 static XCHAR tempXchar[2] = {'B',0};
@@ -387,6 +502,13 @@ static SHORT varCtr, pieX, pieY;
    			SetLineThickness(NORMAL_LINE);
 			SetLineType(SOLID_LINE);			
 			  			 
+			// check if we only need to draw the new samples (streaming mode)
+			if (GetState(pCh, CH_DRAW_STREAM) && !GetState(pCh, CH_DRAW|CH_DRAW_DATA)) {
+				// if the saved layout cannot be used the chart is drawn completely
+				if (ChDrawStream(pCh))
+					return 1;
+			}
+
 			// check if we only need to refresh the data on the chart
 			if (GetState(pCh, CH_DRAW_DATA)) {
 				// this is only performed when refreshing data in the chart
@@ -1097,6 +1219,23 @@ chrt_data_draw_init:
 			*/			
 			ctr = 0;
 			temp = splDelta/(2+ChGetShowSeriesCount(pCh));			// <---- note this! this can be used to calculate the minimum size limit of the chart
+
+			// save the layout for the streaming mode 
+			if (GetState(pCh, CH_BAR_HOR|CH_3D_ENABLE|CH_VALUE|CH_PERCENT) == CH_BAR) {
+				pCh->stream.xStart		= xStart;
+				pCh->stream.yStart		= yStart;
+				pCh->stream.splDelta	= splDelta;
+				pCh->stream.valDelta	= valDelta;
+				pCh->stream.smplStart	= ChGetSampleStart(pCh);
+				pCh->stream.smplEnd		= ChGetSampleEnd(pCh);
+				pCh->stream.valMax		= ChGetValueMax(pCh);
+				pCh->stream.valMin		= ChGetValueMin(pCh);
+				pCh->stream.seriesCount = ChGetShowSeriesCount(pCh);
+			} else {
+				pCh->stream.splDelta	= 0;
+			}
+			// all new samples are drawn now
+			pCh->stream.count = 0;
 			 
 			state = DATA_DRAW_SET;
 
@@ -1154,16 +1293,7 @@ chrt_data_draw:
 			} else {
 
 				// get the height of the current bar to draw
-				// this should be adjusted to the min and max set values 
-				if (ChGetValueMax(pCh) <= (*pSmple)) {
-					dTemp = ChGetValueRange(pCh);
-				} else {
-					if ((*pSmple) < ChGetValueMin(pCh))
-						dTemp = 0;
-					else 
-						dTemp = (*pSmple) - ChGetValueMin(pCh);	
-				}
-				dTemp = ((DWORD)(dTemp)*(valDelta*(CH_YGRIDCOUNT-1))/ChGetValueRange(pCh));
+				dTemp = ChGetBarHeight(pCh, *pSmple, valDelta);
 			}		
 
 			// draw the front side of the bar
@@ -1651,13 +1781,8 @@ chrt_pie_draw_sector_loop:
 				state = PIE_DRAW_SECTOR_LOOP_CREATE_STRINGS;
 
 			} else {
-				if(GetState(pCh, CH_DONUT) == CH_DONUT) {
-					state = PIE_DONUT_HOLE_DRAW;
-					goto chrt_pie_donut_hole_draw;
-				} else {
-	        		state = REMOVE;	
-		          	return 1;	        	
-		        }
+				state = PIE_DRAW_OUTLINE2;
+				goto chrt_pie_draw_outline2;
 			}
 
         case PIE_DRAW_SECTOR_LOOP_CREATE_STRINGS:
@@ -1748,13 +1873,8 @@ chrt_pie_draw_sector_loop_continue:
 			j += dTemp;
 			varCtr--;
 			if (varCtr == 0) {
-				if (GetState(pCh, CH_DONUT) == CH_DONUT) {
-					state = PIE_DONUT_HOLE_DRAW;
-					goto chrt_pie_donut_hole_draw;
-				} else {
-        			state = REMOVE;	
-            		return 1;	        	
-            	}
+				state = PIE_DRAW_OUTLINE2;
+				goto chrt_pie_draw_outline2;
 			}
 
 			// check if more than one data series to be shown
@@ -1768,6 +1888,20 @@ chrt_pie_draw_sector_loop_continue:
             state = PIE_DRAW_SECTOR_LOOP;
             goto chrt_pie_draw_sector_loop;
 
+chrt_pie_draw_outline2:
+        case PIE_DRAW_OUTLINE2:
+
+			// the sectors are filled up to the outline, draw it again 
+   			SetColor(LIGHTGRAY);
+    		Circle(ctr,ctry, z);    
+			if (GetState(pCh, CH_DONUT) == CH_DONUT) {
+				state = PIE_DONUT_HOLE_DRAW;
+				goto chrt_pie_donut_hole_draw;
+			} else {
+				state = REMOVE;	
+				return 1;	        	
+			}
+
 chrt_pie_donut_hole_draw:
 		case PIE_DONUT_HOLE_DRAW:
 			SetColor(LIGHTGRAY);
@@ -1931,6 +2065,38 @@ void ChSetSampleRange(CHART *pCh, WORD start, WORD end)
 		pCh->prm.smplEnd = end;
 }	
 
+/*********************************************************************
+* Function: ChStreamSample(CHART *pCh, WORD sample) 
+*
+*
+* Notes: Marks the sample as new. The samples waiting to be drawn are 
+*		 kept as a range in the ring buffer order of the sample range,
+*		 starting at the first sample marked after the last drawing.
+*
+********************************************************************/
+void ChStreamSample(CHART *pCh, WORD sample) 
+{
+	WORD pos;
+
+	if ((sample < ChGetSampleStart(pCh)) || (sample > ChGetSampleEnd(pCh)))
+		return;
+
+	if (pCh->stream.count == 0) {
+		pCh->stream.first = sample;
+		pCh->stream.count = 1;
+		return;
+	}
+
+	// get the position of the sample from the first sample waiting 
+	if (sample < pCh->stream.first)
+		pos = sample+ChGetSampleRange(pCh)+1-pCh->stream.first;
+	else	
+		pos = sample-pCh->stream.first;
+		
+	if (pos >= pCh->stream.count)
+		pCh->stream.count = pos+1;
+}	
+
 /*********************************************************************
 * Function: ChSetValueRange(CHART *pCh, WORD min, WORD max) 
 *
@@ -1967,197 +2133,38 @@ void ChSetPercentRange(CHART *pCh, WORD min, WORD max)
 		pCh->prm.perMax = max;
 }	 
 
-///////////////////// SIN and COS Tables from 0 to 45 deg /////////////////////
-
-const WORD sinTable[] __attribute__  ((aligned(2))) = {
-       0, 1143,  2287, 3429, 4571,
-    5711, 6850,  7986, 9120,10251,
-    11380,12504,13625,14742,15854,
-    16961,18063,19160,20251,21336,
-    22414,23485,24549,25606,26655,
-    27696,28728,29752,30766,31771,
-    32767,33753,34728,35692,36646,
-    37589,38520,39439,40347,41242,
-    42125,42994,43851,44694,45524,
-    46340
-};
-
-const WORD cosTable[] __attribute__  ((aligned(2))) = {
-    65535,65525,65495,65445,65375,
-    65285,65175,65046,64897,64728,
-    64539,64330,64102,63855,63588,
-    63301,62996,62671,62327,61964,
-    61582,61182,60762,60325,59869,
-    59394,58902,58392,57863,57318,
-    56754,56174,55576,54962,54330,
-    53683,53018,52338,51642,50930,
-    50202,49459,48701,47929,47141,
-    46340
-};
-
-
-void    FillSector(SHORT x, SHORT y, WORD outLineColor)
-{
-WORD    pixel;
-SHORT   left, right;
-SHORT   top, bottom;
-SHORT   xc, yc;
-
-    // scan down
-    top = bottom = yc = y;
-    left = right = xc = x;
-    while(1){
-        pixel = GetPixel(xc,yc);
-        if(pixel == outLineColor){
-
-            for(xc = left+1; xc<right; xc++){
-                pixel = GetPixel(xc,yc);
-                if(pixel != outLineColor){
-                    break;
-                }
-            }
-
-            if(xc == right)
-                break;
-            
-        }
-        // left scan
-        left  = xc;
-        do{
-            PutPixel(left--,yc);
-            pixel = GetPixel(left,yc);
-        }while(pixel != outLineColor);
-
-        // right scan
-        right = xc;
-        pixel = GetPixel(right,yc);
-        do{
-            PutPixel(right++,yc);
-            pixel = GetPixel(right,yc);
-        }while(pixel != outLineColor);
-        
-        xc = (left+right)>>1;
-        yc++;
-    }
-
-    // scan up
-    yc = y;
-    xc = x;
-    while(1){
-        pixel = GetPixel(xc,yc);
-        if(pixel == outLineColor){
-
-            for(xc = left+1; xc<right; xc++){
-                pixel = GetPixel(xc,yc);
-                if(pixel != outLineColor){
-                    break;
-                }
-            }
-
-            if(xc == right)
-                break;
-        }
-        // left scan
-        left  = xc;
-        do{
-            PutPixel(left--,yc);
-            pixel = GetPixel(left,yc);
-        }while(pixel != outLineColor);
-
-        // right scan
-        right = xc;
-        pixel = GetPixel(right,yc);
-        do{
-            PutPixel(right++,yc);
-            pixel = GetPixel(right,yc);
-        }while(pixel != outLineColor);
-        
-        xc = (left+right)>>1;
-        yc--;
-    }
-}
-
-void  GetCirclePoint(SHORT radius, SHORT angle, SHORT* x, SHORT* y){
-DWORD rad;
-SHORT ang;
-SHORT temp;
-    
-    ang = angle%45;
-    if((angle/45)&0x01)
-        ang = 45 - ang;
-
-    rad = radius;
-    rad *= cosTable[ang];
-    *x = ((DWORD_VAL)rad).w[1];
-    rad = radius;
-    rad *= sinTable[ang];
-    *y = ((DWORD_VAL)rad).w[1];
-
-    if( ((angle >  45) && (angle < 135)) ||
-        ((angle > 225) && (angle < 315)) ){
-        temp = *x; *x = *y; *y = temp;
-    }
-
-    if( (angle > 90) && (angle < 270) ){
-        *x = -*x;
-    }
-
-    if( (angle > 180) && (angle < 360) ){
-        *y = -*y;
-    }
-}
-
+/*********************************************************************
+* Function: void DrawSector(SHORT cx, SHORT cy, SHORT outRadius, 
+*							SHORT angleFrom, SHORT angleTo, WORD outLineColor)
+*
+*
+* Notes: Draws a sector of the pie chart with the current color. The 
+*		 sector is filled up to the pie outline with FillSector() and 
+*		 the edges are drawn with the outline color. The outline 
+*		 circle is drawn again after the last sector.
+*
+********************************************************************/
 void DrawSector(SHORT cx, SHORT cy, SHORT outRadius,
                  SHORT angleFrom, SHORT angleTo, WORD outLineColor)
 {
-SHORT x1, y1, x2, y2, x3, y3;
-LONG  temp;
+SHORT x1, y1;
 WORD  tempColor;
-SHORT angleMid;
 
-    angleMid =(angleTo+angleFrom)>>1;
-    GetCirclePoint(outRadius, angleFrom, &x1, &y1);
-    GetCirclePoint(outRadius, angleTo, &x2, &y2);
-    x1 += cx; y1 += cy; x2 += cx; y2 += cy;
+	FillSector(cx, cy, outRadius, angleFrom, angleTo);
 
-    tempColor = GetColor();
-    
     // special case for single data shown on pie chart 
     // we remove the line drawn at angle 0
     if (!((angleFrom == 0) && (angleTo == 360))) {
-    
-	    // special case for small angles
-		GetCirclePoint(outRadius-1, angleFrom+1, &x3, &y3);
-	    x3 += cx; y3 += cy;
-	    Line(x3, y3, cx, cy);
-	
-	    GetCirclePoint(outRadius-1, angleTo-1, &x3, &y3);
-	    x3 += cx; y3 += cy;
-	    Line(x3, y3, cx, cy);
-	
-	    GetCirclePoint(outRadius-1, angleMid, &x3, &y3);
-	    x3 += cx; y3 += cy;
-		Line(x3, y3, cx, cy);
-
+	    tempColor = GetColor();
 	    SetColor(outLineColor);
-    	Line(x1, y1, cx, cy);
-
-	    Line(x2, y2, cx, cy);
-	}
 
-    SetColor(tempColor);
+	    GetCirclePoint(outRadius, angleFrom, &x1, &y1);
+    	Line(cx+x1, cy+y1, cx, cy);
+	    GetCirclePoint(outRadius, angleTo, &x1, &y1);
+	    Line(cx+x1, cy+y1, cx, cy);
 
-    temp = ((x1-x2)*(x1-x2));
-    temp += ((y1-y2)*(y1-y2));
-    
-    if( ((DWORD)temp <= (DWORD)16) &&
-        ((angleTo-angleFrom)<90) ) 
-        return;
-    GetCirclePoint(outRadius-2, angleMid, &x3, &y3);
-    x3 += cx; y3 += cy;
-    FillSector(x3, y3, outLineColor);
-    
+	    SetColor(tempColor);
+	}
 }
 
-
 #endif // USE_CHART
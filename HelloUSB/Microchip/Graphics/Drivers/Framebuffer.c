@@ -0,0 +1,793 @@
+/*****************************************************************************
+ *  Module for Microchip Graphics Library
+ *  In-memory RGB565 frame buffer display driver
+ *****************************************************************************
+ * FileName:        Framebuffer.c
+ * Dependencies:    Graphics.h
+ * Processor:       PIC32, host PC
+ * Compiler:       	MPLAB C32, GCC
+ * Linker:          MPLAB LINK32, GNU ld
+ * Company:         Microchip Technology Incorporated
+ *
+ * Software License Agreement
+ *
+ * Copyright  2008 Microchip Technology Inc.  All rights reserved.
+ * Microchip licenses to you the right to use, modify, copy and distribute
+ * Software only when embedded on a Microchip microcontroller or digital
+ * signal controller, which is integrated into your product or third party
+ * product (pursuant to the sublicense terms in the accompanying license
+ * agreement).  
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED AS IS WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+ *****************************************************************************/
+#include "Graphics\Graphics.h"
+#include <string.h>
+#ifdef USE_FRAMEBUFFER_DUMP
+#include <stdio.h>
+#endif
+
+// Color
+WORD  _color;
+// Clipping region control
+SHORT _clipRgn;
+// Clipping region borders
+SHORT _clipLeft;
+SHORT _clipTop;
+SHORT _clipRight;
+SHORT _clipBottom;
+
+// Frame buffer memory
+WORD  _frameBuffer[SCREEN_VER_SIZE][SCREEN_HOR_SIZE];
+
+#ifdef USE_DOUBLE_BUFFERING
+// Back buffer memory, all drawing goes here
+WORD  _backBuffer[SCREEN_VER_SIZE][SCREEN_HOR_SIZE];
+#define DRAW_BUFFER             _backBuffer
+
+// Areas of the back buffer to be copied to the frame buffer
+typedef struct {
+    SHORT left;
+    SHORT top;
+    SHORT right;
+    SHORT bottom;
+} INVALID_REC;
+
+INVALID_REC _invalidRec[FRAMEBUFFER_INVALID_RECS];
+BYTE        _invalidCount;
+// Set if the whole screen must be copied
+BYTE        _invalidAll;
+#else
+#define DRAW_BUFFER             _frameBuffer
+#endif
+
+#ifdef USE_FRAMEBUFFER_STATISTICS
+// Driver call and pixel counters
+FRAMEBUFFER_STATS _fbStats;
+#define FB_COUNT(counter)       _fbStats.counter++
+#define FB_COUNT_PIXELS(count)  _fbStats.pixels += (count)
+#define FB_COUNT_UPDATED(count) _fbStats.updated += (count)
+#else
+#define FB_COUNT(counter)
+#define FB_COUNT_PIXELS(count)
+#define FB_COUNT_UPDATED(count)
+#endif
+
+/////////////////////// LOCAL FUNCTIONS PROTOTYPES ////////////////////////////
+BOOL ClipRow(SHORT y, SHORT* pLeft, SHORT* pRight);
+#ifdef USE_DRV_PUTIMAGE
+void PutImageRow(SHORT left, SHORT y, const BYTE* pData, WORD* pallete, BYTE colorDepth, WORD sizeX, BYTE stretch);
+
+void PutImageFlash(SHORT left, SHORT top, FLASH_BYTE* bitmap, BYTE stretch);
+void PutImageExt(SHORT left, SHORT top, void* bitmap, BYTE stretch);
+#endif
+
+/*********************************************************************
+* Function: BOOL ClipRow(SHORT y, SHORT* pLeft, SHORT* pRight)
+*
+* PreCondition: none
+*
+* Input: y - row coordinate,
+*        pLeft, pRight - pointers to the first and last column
+*
+* Output: FALSE if nothing of the row is visible
+*
+* Side Effects: none
+*
+* Overview: limits a horizontal run of pixels to the screen and,
+*           if clipping is enabled, to the clipping region
+*
+* Note: none
+*
+********************************************************************/
+BOOL ClipRow(SHORT y, SHORT* pLeft, SHORT* pRight){
+
+    if((y<0) || (y>GetMaxY()))
+        return FALSE;
+    if(*pLeft<0)
+        *pLeft = 0;
+    if(*pRight>GetMaxX())
+        *pRight = GetMaxX();
+
+    if(_clipRgn){
+        if(y<_clipTop)
+            return FALSE;
+        if(y>_clipBottom)
+            return FALSE;
+        if(*pLeft<_clipLeft)
+            *pLeft = _clipLeft;
+        if(*pRight>_clipRight)
+            *pRight = _clipRight;
+    }
+
+    return (*pLeft <= *pRight);
+}
+
+/*********************************************************************
+* Function:  void ResetDevice()
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: clears the frame buffer to black
+*
+* Note: none
+*
+********************************************************************/
+void ResetDevice(void){
+    memset(_frameBuffer, 0, sizeof(_frameBuffer));
+#ifdef USE_DOUBLE_BUFFERING
+    memset(_backBuffer, 0, sizeof(_backBuffer));
+    _invalidCount = 0;
+    _invalidAll = 0;
+#endif
+}
+
+/*********************************************************************
+* Function: void PutPixel(SHORT x, SHORT y)
+*
+* PreCondition: none
+*
+* Input: x,y - pixel coordinates
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: puts pixel
+*
+* Note: none
+*
+********************************************************************/
+void PutPixel(SHORT x, SHORT y){
+SHORT right;
+
+    FB_COUNT(putPixel);
+    right = x;
+    if(!ClipRow(y, &x, &right))
+        return;
+    FB_COUNT_PIXELS(1);
+    DRAW_BUFFER[y][x] = _color;
+}
+
+/*********************************************************************
+* Function: WORD GetPixel(SHORT x, SHORT y)
+*
+* PreCondition: none
+*
+* Input: x,y - pixel coordinates
+*
+* Output: pixel color
+*
+* Side Effects: none
+*
+* Overview: returns pixel color at x,y position
+*
+* Note: none
+*
+********************************************************************/
+WORD GetPixel(SHORT x, SHORT y){
+
+    FB_COUNT(getPixel);
+    if((x<0) || (x>GetMaxX()) || (y<0) || (y>GetMaxY()))
+        return 0;
+    return DRAW_BUFFER[y][x];
+}
+
+#ifdef USE_DRV_PUTPIXELROW
+/*********************************************************************
+* Function: void PutPixelRow(SHORT x, SHORT y, WORD* pixels, WORD count)
+*
+* PreCondition: none
+*
+* Input: x,y - coordinates of the first pixel,
+*        pixels - pointer to the pixel colors,
+*        count - number of pixels
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: puts a horizontal row of pixels with individual colors
+*
+* Note: none
+*
+********************************************************************/
+void PutPixelRow(SHORT x, SHORT y, WORD* pixels, WORD count){
+SHORT left, right;
+
+    FB_COUNT(putPixelRow);
+    if(count == 0)
+        return;
+
+    left  = x;
+    right = x + count - 1;
+    if(!ClipRow(y, &left, &right))
+        return;
+
+    FB_COUNT_PIXELS(right-left+1);
+    memcpy(&DRAW_BUFFER[y][left], pixels + (left-x), (right-left+1)*sizeof(WORD));
+}
+#endif
+
+#ifdef USE_DRV_BAR
+/*********************************************************************
+* Function: void Bar(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* PreCondition: none
+*
+* Input: left,top - top left corner coordinates,
+*        right,bottom - bottom right corner coordinates
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: draws rectangle filled with current color
+*
+* Note: none
+*
+********************************************************************/
+void Bar(SHORT left, SHORT top, SHORT right, SHORT bottom){
+WORD* pPixel;
+SHORT x, y;
+
+    FB_COUNT(bar);
+
+    if(top<0)
+        top = 0;
+    if(bottom>GetMaxY())
+        bottom = GetMaxY();
+    if(_clipRgn){
+        if(top<_clipTop)
+           top = _clipTop;
+        if(bottom>_clipBottom)
+           bottom = _clipBottom;
+    }
+
+    if(!ClipRow(top, &left, &right))
+        return;
+
+    for(y=top; y<bottom+1; y++){
+        FB_COUNT_PIXELS(right-left+1);
+        pPixel = &DRAW_BUFFER[y][left];
+        for(x=left; x<right+1; x++)
+            *pPixel++ = _color;
+    }
+}
+#endif
+
+#ifdef USE_DRV_HLINE
+/*********************************************************************
+* Function: void HLine(SHORT x1, SHORT x2, SHORT y)
+*
+* PreCondition: none
+*
+* Input: x1,x2 - span ends, y - span row
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: draws horizontal span with current color
+*
+* Note: none
+*
+********************************************************************/
+void HLine(SHORT x1, SHORT x2, SHORT y){
+WORD* pPixel;
+SHORT x;
+
+    FB_COUNT(hLine);
+    if(x1>x2){
+        x = x1; x1 = x2; x2 = x;
+    }
+    if(!ClipRow(y, &x1, &x2))
+        return;
+
+    FB_COUNT_PIXELS(x2-x1+1);
+    pPixel = &DRAW_BUFFER[y][x1];
+    for(x=x1; x<x2+1; x++)
+        *pPixel++ = _color;
+}
+#endif
+
+#ifdef USE_DRV_CLEARDEVICE
+/*********************************************************************
+* Function: void ClearDevice(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: clears screen with current color
+*
+* Note: none
+*
+********************************************************************/
+void ClearDevice(void){
+WORD* pPixel;
+DWORD counter;
+
+    FB_COUNT(clearDevice);
+    FB_COUNT_PIXELS((DWORD)SCREEN_HOR_SIZE*SCREEN_VER_SIZE);
+
+    pPixel = &DRAW_BUFFER[0][0];
+    for(counter=0; counter<(DWORD)SCREEN_HOR_SIZE*SCREEN_VER_SIZE; counter++)
+        *pPixel++ = _color;
+}
+#endif
+
+#ifdef USE_DRV_PUTIMAGE
+/*********************************************************************
+* Function: void PutImage(SHORT left, SHORT top, void* bitmap, BYTE stretch)
+*
+* PreCondition: none
+*
+* Input: left,top - left top image corner,
+*        bitmap - image pointer,
+*        stretch - image stretch factor
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: outputs image starting from left,top coordinates
+*
+* Note: none
+*
+********************************************************************/
+void PutImage(SHORT left, SHORT top, void* bitmap, BYTE stretch){
+
+    FB_COUNT(putImage);
+
+#ifdef USE_COMP_RLE
+    if(GetImageCompression(bitmap) == COMP_RLE){
+        PutImageRLE(left, top, bitmap, stretch);
+        return;
+    }
+#endif
+
+    switch(*((SHORT*)bitmap))
+    {
+#ifdef USE_BITMAP_FLASH
+        case FLASH:
+            PutImageFlash(left, top, ((BITMAP_FLASH*)bitmap)->address, stretch);
+            break;
+#endif
+#ifdef USE_BITMAP_EXTERNAL
+        case EXTERNAL:
+            PutImageExt(left, top, bitmap, stretch);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+/*********************************************************************
+* Function: void PutImageRow(SHORT left, SHORT y, const BYTE* pData, WORD* pallete,
+*                            BYTE colorDepth, WORD sizeX, BYTE stretch)
+*
+* PreCondition: none
+*
+* Input: left - image left border, y - row coordinate,
+*        pData - pointer to the image line data,
+*        pallete - image pallete (not used for 16BPP images),
+*        colorDepth - 1, 4, 8 or 16 bits per pixel,
+*        sizeX - image width, stretch - image stretch factor
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: writes one screen row of an image, only the visible
+*           pixels of the line are converted
+*
+* Note: none
+*
+********************************************************************/
+void PutImageRow(SHORT left, SHORT y, const BYTE* pData, WORD* pallete, BYTE colorDepth, WORD sizeX, BYTE stretch){
+WORD* pPixel;
+SHORT xStart, xEnd, x;
+WORD  index;
+BYTE  stretchX;
+BYTE  temp;
+
+    xStart = left;
+    xEnd   = left + (SHORT)(sizeX*stretch) - 1;
+    if(!ClipRow(y, &xStart, &xEnd))
+        return;
+
+    FB_COUNT_PIXELS(xEnd-xStart+1);
+
+    // Image pixel and stretch phase of the first visible screen pixel
+    index    = (xStart-left)/stretch;
+    stretchX = (xStart-left)%stretch;
+
+    pPixel = &DRAW_BUFFER[y][xStart];
+    for(x=xStart; x<xEnd+1; x++){
+        switch(colorDepth){
+            case 1:
+                temp = (pData[index>>3]>>(7-(index&0x07)))&0x01;
+                *pPixel++ = pallete[temp];
+                break;
+            case 4:
+                temp = pData[index>>1];
+                if(index&0x0001)
+                    temp >>= 4;
+                *pPixel++ = pallete[temp&0x0f];
+                break;
+            case 8:
+                *pPixel++ = pallete[pData[index]];
+                break;
+            default:
+                *pPixel++ = ((const WORD*)pData)[index];
+                break;
+        }
+        if(++stretchX == stretch){
+            stretchX = 0;
+            index++;
+        }
+    }
+}
+
+#ifdef USE_BITMAP_FLASH
+/*********************************************************************
+* Function: void PutImageFlash(SHORT left, SHORT top, FLASH_BYTE* bitmap, BYTE stretch)
+*
+* PreCondition: none
+*
+* Input: left,top - left top image corner,
+*        bitmap - image pointer,
+*        stretch - image stretch factor
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: outputs 1, 4, 8 or 16BPP image starting from left,top coordinates
+*
+* Note: image must be located in flash
+*
+********************************************************************/
+void PutImageFlash(SHORT left, SHORT top, FLASH_BYTE* bitmap, BYTE stretch){
+FLASH_BYTE* flashAddress;
+WORD        pallete[256];
+WORD        byteWidth;
+WORD        sizeX, sizeY;
+WORD        counter;
+BYTE        colorDepth;
+WORD        y;
+BYTE        stretchY;
+
+    // Read color depth
+    colorDepth = *(bitmap+1);
+    if((colorDepth != 1) && (colorDepth != 4) && (colorDepth != 8) && (colorDepth != 16))
+        return;
+
+    // Move pointer to size information
+    flashAddress = bitmap + 2;
+
+    // Read image size
+    sizeY = *((FLASH_WORD*)flashAddress);
+    flashAddress += 2;
+    sizeX = *((FLASH_WORD*)flashAddress);
+    flashAddress += 2;
+
+    // Read pallete
+    if(colorDepth < 16){
+        for(counter=0; counter<(1<<colorDepth); counter++){
+            pallete[counter] = *((FLASH_WORD*)flashAddress);
+            flashAddress += 2;
+        }
+    }
+
+    // Line width in bytes
+    byteWidth = ((DWORD)sizeX*colorDepth+7)>>3;
+
+    for(y=0; y<sizeY; y++){
+        for(stretchY = 0; stretchY<stretch; stretchY++){
+            PutImageRow(left, top++, (const BYTE*)flashAddress, pallete, colorDepth, sizeX, stretch);
+        }
+        flashAddress += byteWidth;
+    }
+}
+#endif
+
+#ifdef USE_BITMAP_EXTERNAL
+/*********************************************************************
+* Function: void PutImageExt(SHORT left, SHORT top, void* bitmap, BYTE stretch)
+*
+* PreCondition: none
+*
+* Input: left,top - left top image corner, bitmap - image pointer,
+*        stretch - image stretch factor
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: outputs 1, 4, 8 or 16BPP image starting from left,top coordinates
+*
+* Note: image must be located in external memory
+*
+********************************************************************/
+void PutImageExt(SHORT left, SHORT top, void* bitmap, BYTE stretch){
+DWORD               memOffset;
+BITMAP_HEADER       bmp;
+WORD                pallete[256];
+WORD                lineBuffer[SCREEN_HOR_SIZE];
+WORD                byteWidth;
+WORD                palleteSize;
+WORD                y;
+BYTE                stretchY;
+
+    // Get bitmap header
+    ExternalMemoryCallback(bitmap, 0, sizeof(BITMAP_HEADER), &bmp);
+    if((bmp.colorDepth != 1) && (bmp.colorDepth != 4) && (bmp.colorDepth != 8) && (bmp.colorDepth != 16))
+        return;
+
+    // Get pallete
+    palleteSize = 0;
+    if(bmp.colorDepth < 16){
+        palleteSize = (1<<bmp.colorDepth)*sizeof(WORD);
+        ExternalMemoryCallback(bitmap, sizeof(BITMAP_HEADER), palleteSize, pallete);
+    }
+
+    // Set offset to the image data
+    memOffset = sizeof(BITMAP_HEADER) + palleteSize;
+
+    // Line width in bytes
+    byteWidth = ((DWORD)bmp.width*bmp.colorDepth+7)>>3;
+    if(byteWidth > sizeof(lineBuffer))
+        return;
+
+    for(y=0; y<bmp.height; y++){
+        // Get line
+        ExternalMemoryCallback(bitmap, memOffset, byteWidth, lineBuffer);
+        memOffset += byteWidth;
+
+        for(stretchY = 0; stretchY<stretch; stretchY++){
+            PutImageRow(left, top++, (const BYTE*)lineBuffer, pallete, bmp.colorDepth, bmp.width, stretch);
+        }
+    }
+}
+#endif
+#endif // USE_DRV_PUTIMAGE
+
+#ifdef USE_DOUBLE_BUFFERING
+/*********************************************************************
+* Function: void InvalidateRectangle(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* PreCondition: none
+*
+* Input: left,top,right,bottom - borders of the area
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: marks the back buffer area to be copied to the frame buffer
+*           by the next UpdateDisplayNow() call
+*
+* Note: none
+*
+********************************************************************/
+void InvalidateRectangle(SHORT left, SHORT top, SHORT right, SHORT bottom){
+INVALID_REC* pRec;
+BYTE counter;
+
+    if(_invalidAll)
+        return;
+
+    if(left < 0)
+        left = 0;
+    if(top < 0)
+        top = 0;
+    if(right > GetMaxX())
+        right = GetMaxX();
+    if(bottom > GetMaxY())
+        bottom = GetMaxY();
+
+    if((left > right) || (top > bottom))
+        return;
+
+    // skip the area if it is already invalid
+    pRec = _invalidRec;
+    for(counter=0; counter<_invalidCount; counter++){
+        if((pRec->left <= left) && (pRec->top <= top) &&
+           (pRec->right >= right) && (pRec->bottom >= bottom))
+            return;
+        pRec++;
+    }
+
+    if(_invalidCount == FRAMEBUFFER_INVALID_RECS){
+        // no room, the whole screen will be copied
+        _invalidAll = 1;
+        return;
+    }
+
+    pRec->left = left;
+    pRec->top = top;
+    pRec->right = right;
+    pRec->bottom = bottom;
+    _invalidCount++;
+}
+
+/*********************************************************************
+* Function: void UpdateDisplayNow(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: copies the invalidated back buffer areas to the frame buffer
+*
+* Note: none
+*
+********************************************************************/
+void UpdateDisplayNow(void){
+INVALID_REC* pRec;
+BYTE  counter;
+SHORT y;
+WORD  width;
+
+    FB_COUNT(update);
+
+    if(_invalidAll){
+        FB_COUNT_UPDATED((DWORD)SCREEN_HOR_SIZE*SCREEN_VER_SIZE);
+        memcpy(_frameBuffer, _backBuffer, sizeof(_frameBuffer));
+    }else{
+        // overlapping areas are copied twice, the result is the same
+        pRec = _invalidRec;
+        for(counter=0; counter<_invalidCount; counter++){
+            width = pRec->right - pRec->left + 1;
+            FB_COUNT_UPDATED((DWORD)width*(pRec->bottom - pRec->top + 1));
+            for(y=pRec->top; y<=pRec->bottom; y++)
+                memcpy(&_frameBuffer[y][pRec->left], &_backBuffer[y][pRec->left], width*sizeof(WORD));
+            pRec++;
+        }
+    }
+
+    _invalidCount = 0;
+    _invalidAll = 0;
+}
+#endif
+
+#ifdef USE_FRAMEBUFFER_STATISTICS
+/*********************************************************************
+* Function: void FramebufferGetStats(FRAMEBUFFER_STATS* pStats)
+*
+* PreCondition: none
+*
+* Input: pStats - pointer to the structure receiving the counters
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: copies the driver call and pixel counters
+*
+* Note: none
+*
+********************************************************************/
+void FramebufferGetStats(FRAMEBUFFER_STATS* pStats){
+    *pStats = _fbStats;
+}
+
+/*********************************************************************
+* Function: void FramebufferResetStats(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: clears the driver call and pixel counters
+*
+* Note: none
+*
+********************************************************************/
+void FramebufferResetStats(void){
+    memset(&_fbStats, 0, sizeof(_fbStats));
+}
+#endif
+
+#ifdef USE_FRAMEBUFFER_DUMP
+/*********************************************************************
+* Function: BOOL FramebufferDumpPPM(const char* fileName)
+*
+* PreCondition: none
+*
+* Input: fileName - name of the file to create
+*
+* Output: TRUE if the file was written, FALSE otherwise
+*
+* Side Effects: none
+*
+* Overview: writes the frame buffer to a binary PPM (P6) file
+*
+* Note: 5 and 6 bit color components are expanded to 8 bits by
+*       replicating their high bits
+*
+********************************************************************/
+BOOL FramebufferDumpPPM(const char* fileName){
+FILE* pFile;
+BYTE  lineBuffer[SCREEN_HOR_SIZE*3];
+BYTE* pData;
+WORD  color;
+SHORT x, y;
+BOOL  result;
+
+    pFile = fopen(fileName, "wb");
+    if(pFile == NULL)
+        return FALSE;
+
+    result = (fprintf(pFile, "P6\n%d %d\n255\n", SCREEN_HOR_SIZE, SCREEN_VER_SIZE) > 0);
+
+    for(y=0; (y<SCREEN_VER_SIZE) && result; y++){
+        pData = lineBuffer;
+        for(x=0; x<SCREEN_HOR_SIZE; x++){
+            color = _frameBuffer[y][x];
+            *pData++ = ((color>>8)&0xf8) | (color>>13);
+            *pData++ = ((color>>3)&0xfc) | ((color>>9)&0x03);
+            *pData++ = ((color<<3)&0xf8) | ((color>>2)&0x07);
+        }
+        result = (fwrite(lineBuffer, 1, sizeof(lineBuffer), pFile) == sizeof(lineBuffer));
+    }
+
+    if(fclose(pFile) != 0)
+        result = FALSE;
+
+    return result;
+}
+#endif
@@ -313,6 +313,13 @@ FLASH_BYTE* flashAddress;
 BYTE colorDepth;
 WORD colorTemp;
 
+#ifdef USE_COMP_RLE
+    if(GetImageCompression(bitmap) == COMP_RLE){
+        PutImageRLE(left, top, bitmap, stretch);
+        return;
+    }
+#endif
+
     // Save current color
     colorTemp = _color.Val;
 
@@ -506,6 +506,70 @@ DWORD_VAL address;
     CS_LAT_BIT = 1;
 }
 
+/*********************************************************************
+* Function: void PutPixelRow(SHORT x, SHORT y, WORD* pixels, WORD count)
+*
+* PreCondition: none
+*
+* Input: x,y - coordinates of the first pixel,
+*        pixels - pointer to the pixel colors,
+*        count - number of pixels
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: puts a horizontal row of pixels with individual colors,
+*           the address is set only once for the whole row
+*
+* Note: none
+*
+********************************************************************/
+void PutPixelRow(SHORT x, SHORT y, WORD* pixels, WORD count){
+DWORD_VAL address;
+WORD_VAL  color;
+SHORT     right;
+
+    if(count == 0)
+        return;
+
+    right = x + count - 1;
+
+    if(_clipRgn){
+        if(y<_clipTop)
+            return;
+        if(y>_clipBottom)
+            return;
+        if(x<_clipLeft){
+            pixels += _clipLeft - x;
+            x = _clipLeft;
+        }
+        if(right>_clipRight)
+            right = _clipRight;
+        if(x>right)
+            return;
+    }
+
+#ifdef	USE_PORTRAIT
+
+    address.Val = (DWORD)LINE_MEM_PITCH*y + x;
+
+#else
+
+    y = GetMaxY() - y;
+    address.Val = (DWORD)LINE_MEM_PITCH*x + y;
+
+#endif
+
+    CS_LAT_BIT = 0;
+    SetAddress(address.v[2],address.v[1],address.v[0]);
+    for(; x<right+1; x++){
+        color.Val = *pixels++;
+        WriteData(color.v[1],color.v[0]);
+    }
+    CS_LAT_BIT = 1;
+}
+
 /*********************************************************************
 * Function: WORD GetPixel(SHORT x, SHORT y)
 *
@@ -652,6 +716,63 @@ register SHORT  x,y;
 
 }
 
+/*********************************************************************
+* Function: void HLine(SHORT x1, SHORT x2, SHORT y)
+*
+* PreCondition: none
+*
+* Input: x1,x2 - span ends, y - span row
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: draws horizontal span with current color,
+*           the address is set only once for the whole span
+*
+* Note: none
+*
+********************************************************************/
+void HLine(SHORT x1, SHORT x2, SHORT y){
+DWORD_VAL address;
+SHORT     x;
+
+    if(x1>x2){
+        x = x1; x1 = x2; x2 = x;
+    }
+
+    if(_clipRgn){
+        if(y<_clipTop)
+            return;
+        if(y>_clipBottom)
+            return;
+        if(x1<_clipLeft)
+            x1 = _clipLeft;
+        if(x2>_clipRight)
+            x2 = _clipRight;
+        if(x1>x2)
+            return;
+    }
+
+#ifdef	USE_PORTRAIT
+
+    address.Val = (DWORD)LINE_MEM_PITCH*y + x1;
+
+#else
+
+    y = GetMaxY() - y;
+    address.Val = (DWORD)LINE_MEM_PITCH*x1 + y;
+
+#endif
+
+    CS_LAT_BIT = 0;
+    SetAddress(address.v[2],address.v[1],address.v[0]);
+    for(x=x1; x<x2+1; x++){
+        WriteData(_color.v[1],_color.v[0]);
+    }
+    CS_LAT_BIT = 1;
+}
+
 /*********************************************************************
 * Function: void ClearDevice(void)
 *
@@ -704,6 +825,13 @@ FLASH_BYTE* flashAddress;
 BYTE colorDepth;
 WORD colorTemp;
 
+#ifdef USE_COMP_RLE
+    if(GetImageCompression(bitmap) == COMP_RLE){
+        PutImageRLE(left, top, bitmap, stretch);
+        return;
+    }
+#endif
+
 #ifndef USE_PORTRAIT
 	top = GetMaxY() - top; 
 #endif
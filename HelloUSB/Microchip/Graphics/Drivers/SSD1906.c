@@ -590,6 +590,53 @@ register SHORT  x,y;
     CS_LAT_BIT = 1;
 }
 
+/*********************************************************************
+* Function: void HLine(SHORT x1, SHORT x2, SHORT y)
+*
+* PreCondition: none
+*
+* Input: x1,x2 - span ends, y - span row
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: draws horizontal span with current color,
+*           the address is set only once for the whole span
+*
+* Note: none
+*
+********************************************************************/
+void HLine(SHORT x1, SHORT x2, SHORT y){
+DWORD address;
+SHORT x;
+
+    if(x1>x2){
+        x = x1; x1 = x2; x2 = x;
+    }
+
+    if(_clipRgn){
+        if(y<_clipTop)
+            return;
+        if(y>_clipBottom)
+            return;
+        if(x1<_clipLeft)
+            x1 = _clipLeft;
+        if(x2>_clipRight)
+            x2 = _clipRight;
+        if(x1>x2)
+            return;
+    }
+
+    address = (DWORD)(GetMaxX( ) +1)*y + x1;
+    SetAddress(address);
+    CS_LAT_BIT = 0;
+    for(x=x1; x<x2+1; x++){
+        WriteData(_color);
+    }
+    CS_LAT_BIT = 1;
+}
+
 /*********************************************************************
 * Function: void ClearDevice(void)
 *
@@ -640,6 +687,13 @@ FLASH_BYTE* flashAddress;
 BYTE colorDepth;
 WORD colorTemp;
 
+#ifdef USE_COMP_RLE
+    if(GetImageCompression(bitmap) == COMP_RLE){
+        PutImageRLE(left, top, bitmap, stretch);
+        return;
+    }
+#endif
+
     // Save current color
     colorTemp = _color;
 
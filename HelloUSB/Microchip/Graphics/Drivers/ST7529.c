@@ -494,6 +494,13 @@ FLASH_BYTE* flashAddress;
 BYTE colorDepth;
 BYTE colorTemp;
 
+#ifdef USE_COMP_RLE
+    if(GetImageCompression(bitmap) == COMP_RLE){
+        PutImageRLE(left, top, bitmap, stretch);
+        return;
+    }
+#endif
+
     // Save current color
     colorTemp = _color;
 
@@ -295,12 +295,10 @@ SHORT width;
 
     }
 
-            SetClip(CLIP_ENABLE);
-
-            SetClipRgn(pEb->hdr.left+GOL_EMBOSS_SIZE+EB_INDENT,
-                       pEb->hdr.top+GOL_EMBOSS_SIZE+EB_INDENT,
-                       pEb->hdr.right-GOL_EMBOSS_SIZE-EB_INDENT,
-                       pEb->hdr.bottom-GOL_EMBOSS_SIZE-EB_INDENT);
+            GOLSetClipRgn(pEb->hdr.left+GOL_EMBOSS_SIZE+EB_INDENT,
+                          pEb->hdr.top+GOL_EMBOSS_SIZE+EB_INDENT,
+                          pEb->hdr.right-GOL_EMBOSS_SIZE-EB_INDENT,
+                          pEb->hdr.bottom-GOL_EMBOSS_SIZE-EB_INDENT);
 
 	        SetFont(pEb->hdr.pGolScheme->pFont);
 
@@ -353,7 +351,7 @@ SHORT width;
                 }
                 Bar(GetX(),GetY(),GetX()+EB_CARET_WIDTH,GetY()+pEb->textHeight);
             }
-            SetClip(CLIP_DISABLE);
+            GOLResetClip();
 			state = EB_STATE_START;
 			return 1;
     }
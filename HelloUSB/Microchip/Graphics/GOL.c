@@ -52,6 +52,34 @@ GOL_SCHEME  *_pDefaultGolScheme  = NULL;
 // Pointer to the object receiving keyboard input
 OBJ_HEADER  *_pObjectFocused     = NULL;
 
+#if defined(USE_DIRTY_RECTS) || defined(USE_DOUBLE_BUFFERING)
+
+// Rectangle used by the damage region manager
+typedef struct {
+    SHORT left;
+    SHORT top;
+    SHORT right;
+    SHORT bottom;
+} DIRTY_REC;
+
+#endif
+
+#ifdef USE_DIRTY_RECTS
+
+// Damage region collected for the next drawing pass
+static DIRTY_REC _dirtyRec[GOL_DIRTY_RECS];
+static BYTE      _dirtyCount     = 0;
+
+// Damage region of the drawing pass in progress
+static DIRTY_REC _drawRec[GOL_DIRTY_RECS];
+static BYTE      _drawCount      = 0;
+
+// Damaged part of the object being redrawn, valid if _damageClip is set
+static DIRTY_REC _damageRec;
+static BYTE      _damageClip     = 0;
+
+#endif
+
 #ifdef USE_FOCUS
 
 /*********************************************************************
@@ -408,6 +436,332 @@ OBJ_HEADER * pNextObj;
     }
     object->pNxtObj = NULL;
 }
+#if defined(USE_DIRTY_RECTS) || defined(USE_DOUBLE_BUFFERING)
+
+/*********************************************************************
+* Function: static void GOLGetObjRec(OBJ_HEADER *pObj, DIRTY_REC *pRec)
+*
+* PreCondition: none
+*
+* Input: pObj - pointer to the object
+*        pRec - pointer to the rectangle receiving the object borders
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: gets the rectangle covered by the object
+*
+* Note: none
+*
+********************************************************************/
+static void GOLGetObjRec(OBJ_HEADER *pObj, DIRTY_REC *pRec){
+
+    #ifdef USE_ROUNDDIAL
+    // dial has no object borders in the header
+    if(pObj->type == OBJ_ROUNDDIAL){
+        pRec->left   = ((ROUNDDIAL*)pObj)->xCenter - ((ROUNDDIAL*)pObj)->radius;
+        pRec->top    = ((ROUNDDIAL*)pObj)->yCenter - ((ROUNDDIAL*)pObj)->radius;
+        pRec->right  = ((ROUNDDIAL*)pObj)->xCenter + ((ROUNDDIAL*)pObj)->radius;
+        pRec->bottom = ((ROUNDDIAL*)pObj)->yCenter + ((ROUNDDIAL*)pObj)->radius;
+        return;
+    }
+    #endif
+
+    pRec->left   = pObj->left;
+    pRec->top    = pObj->top;
+    pRec->right  = pObj->right;
+    pRec->bottom = pObj->bottom;
+}
+
+#endif
+
+#ifdef USE_DIRTY_RECTS
+
+/*********************************************************************
+* Function: static DWORD GOLRecArea(DIRTY_REC *pRec)
+*
+* PreCondition: none
+*
+* Input: pRec - pointer to the rectangle
+*
+* Output: number of pixels in the rectangle
+*
+* Side Effects: none
+*
+* Overview: calculates the rectangle area
+*
+* Note: none
+*
+********************************************************************/
+static DWORD GOLRecArea(DIRTY_REC *pRec){
+    return (DWORD)(pRec->right-pRec->left+1)*(DWORD)(pRec->bottom-pRec->top+1);
+}
+
+/*********************************************************************
+* Function: static void GOLRecUnion(DIRTY_REC *pDest, DIRTY_REC *pRec)
+*
+* PreCondition: none
+*
+* Input: pDest - pointer to the rectangle to be enlarged
+*        pRec - pointer to the rectangle to be added
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: enlarges the destination rectangle to the bounding box
+*           of both rectangles
+*
+* Note: none
+*
+********************************************************************/
+static void GOLRecUnion(DIRTY_REC *pDest, DIRTY_REC *pRec){
+    if(pRec->left < pDest->left)
+        pDest->left = pRec->left;
+    if(pRec->top < pDest->top)
+        pDest->top = pRec->top;
+    if(pRec->right > pDest->right)
+        pDest->right = pRec->right;
+    if(pRec->bottom > pDest->bottom)
+        pDest->bottom = pRec->bottom;
+}
+
+/*********************************************************************
+* Function: static void GOLMergeRec(DIRTY_REC *pList, BYTE *pCount, DIRTY_REC *pRec)
+*
+* PreCondition: none
+*
+* Input: pList - pointer to the rectangles list
+*        pCount - pointer to the number of rectangles in the list
+*        pRec - pointer to the rectangle to be added
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: adds the rectangle to the list merging it with the
+*           overlapping or touching rectangles, if the list is full
+*           the rectangle is merged with the entry growing the least
+*
+* Note: none
+*
+********************************************************************/
+static void GOLMergeRec(DIRTY_REC *pList, BYTE *pCount, DIRTY_REC *pRec){
+DIRTY_REC rec;
+DIRTY_REC merged;
+DWORD     growth;
+DWORD     minGrowth;
+BYTE      counter;
+BYTE      best;
+
+    rec = *pRec;
+
+    counter = 0;
+    while(counter < *pCount){
+
+        if( (pList[counter].left   <= rec.right+1)  &&
+            (pList[counter].right  >= rec.left-1)   &&
+            (pList[counter].top    <= rec.bottom+1) &&
+            (pList[counter].bottom >= rec.top-1) ){
+
+            // merge and remove the entry, the union can touch
+            // entries checked already so start over
+            GOLRecUnion(&rec, &pList[counter]);
+            pList[counter] = pList[--(*pCount)];
+            counter = 0;
+            continue;
+        }
+
+        counter++;
+
+        if((counter == *pCount) && (*pCount == GOL_DIRTY_RECS)){
+
+            // list is full, merge with the entry growing the least
+            best = 0;
+            minGrowth = 0xffffffff;
+            for(counter = 0; counter < *pCount; counter++){
+                merged = pList[counter];
+                GOLRecUnion(&merged, &rec);
+                growth = GOLRecArea(&merged) - GOLRecArea(&pList[counter]);
+                if(growth < minGrowth){
+                    minGrowth = growth;
+                    best = counter;
+                }
+            }
+            GOLRecUnion(&rec, &pList[best]);
+            pList[best] = pList[--(*pCount)];
+            counter = 0;
+        }
+    }
+
+    pList[(*pCount)++] = rec;
+}
+
+/*********************************************************************
+* Function: void GOLAddDirtyRec(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* PreCondition: none
+*
+* Input: left,top,right,bottom - rectangle borders
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: adds the rectangle to the damage region
+*
+* Note: none
+*
+********************************************************************/
+void GOLAddDirtyRec(SHORT left, SHORT top, SHORT right, SHORT bottom){
+DIRTY_REC rec;
+
+    if(left < 0)
+        left = 0;
+    if(top < 0)
+        top = 0;
+    if(right > GetMaxX())
+        right = GetMaxX();
+    if(bottom > GetMaxY())
+        bottom = GetMaxY();
+
+    if((left > right) || (top > bottom))
+        return;
+
+    rec.left   = left;
+    rec.top    = top;
+    rec.right  = right;
+    rec.bottom = bottom;
+
+    GOLMergeRec(_dirtyRec, &_dirtyCount, &rec);
+}
+
+/*********************************************************************
+* Function: static BYTE GOLGetDamage(OBJ_HEADER *pObj)
+*
+* PreCondition: none
+*
+* Input: pObj - pointer to the object
+*
+* Output: non-zero if the object intersects the damage region
+*
+* Side Effects: none
+*
+* Overview: calculates the bounding box of the damaged part
+*           of the object, the object will repaint the whole box
+*           so the box is added to the damage region of the pass
+*           and the objects above are redrawn there too
+*
+* Note: none
+*
+********************************************************************/
+static BYTE GOLGetDamage(OBJ_HEADER *pObj){
+DIRTY_REC rec;
+DIRTY_REC objRec;
+BYTE      counter;
+BYTE      found;
+
+    GOLGetObjRec(pObj, &objRec);
+
+    found = 0;
+    for(counter = 0; counter < _drawCount; counter++){
+
+        rec = _drawRec[counter];
+        if(rec.left < objRec.left)
+            rec.left = objRec.left;
+        if(rec.top < objRec.top)
+            rec.top = objRec.top;
+        if(rec.right > objRec.right)
+            rec.right = objRec.right;
+        if(rec.bottom > objRec.bottom)
+            rec.bottom = objRec.bottom;
+
+        if((rec.left > rec.right) || (rec.top > rec.bottom))
+            continue;
+
+        if(found){
+            GOLRecUnion(&_damageRec, &rec);
+        }else{
+            _damageRec = rec;
+            found = 1;
+        }
+    }
+
+    if(found)
+        GOLMergeRec(_drawRec, &_drawCount, &_damageRec);
+
+    return found;
+}
+
+#endif
+
+/*********************************************************************
+* Function: void GOLSetClipRgn(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* PreCondition: none
+*
+* Input: left,top,right,bottom - clipping region borders
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: enables clipping to the rectangle limited to the damaged
+*           part of the object being redrawn
+*
+* Note: none
+*
+********************************************************************/
+void GOLSetClipRgn(SHORT left, SHORT top, SHORT right, SHORT bottom){
+
+    #ifdef USE_DIRTY_RECTS
+    if(_damageClip){
+        if(left < _damageRec.left)
+            left = _damageRec.left;
+        if(top < _damageRec.top)
+            top = _damageRec.top;
+        if(right > _damageRec.right)
+            right = _damageRec.right;
+        if(bottom > _damageRec.bottom)
+            bottom = _damageRec.bottom;
+    }
+    #endif
+
+    SetClip(CLIP_ENABLE);
+    SetClipRgn(left, top, right, bottom);
+}
+
+/*********************************************************************
+* Function: void GOLResetClip(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: disables clipping or sets it back to the damaged part
+*           of the object being redrawn
+*
+* Note: none
+*
+********************************************************************/
+void GOLResetClip(void){
+
+    #ifdef USE_DIRTY_RECTS
+    if(_damageClip){
+        SetClip(CLIP_ENABLE);
+        SetClipRgn(_damageRec.left, _damageRec.top, _damageRec.right, _damageRec.bottom);
+        return;
+    }
+    #endif
+
+    SetClip(CLIP_DISABLE);
+}
+
 /*********************************************************************
 * Function: WORD GOLDraw()
 *
@@ -427,11 +781,27 @@ OBJ_HEADER * pNextObj;
 WORD GOLDraw(){
 static OBJ_HEADER *pCurrentObj = NULL;
 SHORT done;
+#if defined(USE_DIRTY_RECTS) || defined(USE_DOUBLE_BUFFERING)
+DIRTY_REC   rec;
+#endif
+#ifdef USE_DIRTY_RECTS
+OBJ_HEADER *pResumedObj;
+
+    // drawing of this object is in progress
+    pResumedObj = pCurrentObj;
+#endif
 
     if(pCurrentObj == NULL){
         if(GOLDrawCallback()){
             // It's last object jump to head
             pCurrentObj = _pGolObjects;
+
+            #ifdef USE_DIRTY_RECTS
+            // rectangles added while this pass is drawn go to the next one
+            for(_drawCount = 0; _drawCount < _dirtyCount; _drawCount++)
+                _drawRec[_drawCount] = _dirtyRec[_drawCount];
+            _dirtyCount = 0;
+            #endif
         }else{
             return 0;  // drawing is not done
         }
@@ -439,7 +809,25 @@ SHORT done;
 
     done = 0;
     while(pCurrentObj != NULL){
-        
+
+        #ifdef USE_DIRTY_RECTS
+        if(_drawCount && (pCurrentObj != pResumedObj) && !(pCurrentObj->state & HIDE)){
+            if(GOLGetDamage(pCurrentObj)){
+                if(IsObjUpdated(pCurrentObj)){
+                    // marked by the application, the object is drawn whole
+                    // and a partial update must become a full one
+                    GOLGetObjRec(pCurrentObj, &rec);
+                    GOLMergeRec(_drawRec, &_drawCount, &rec);
+                }else{
+                    // redraw the damaged part only
+                    _damageClip = 1;
+                    GOLResetClip();
+                }
+                GOLRedraw(pCurrentObj);
+            }
+        }
+        #endif
+
         if(IsObjUpdated(pCurrentObj)){
 
             switch(pCurrentObj->type){
@@ -528,12 +916,39 @@ SHORT done;
             }
             if(done){
                 GOLDrawComplete(pCurrentObj);
+
+                #ifdef USE_DOUBLE_BUFFERING
+                // show the object with the next display update
+                GOLGetObjRec(pCurrentObj, &rec);
+                #ifdef USE_DIRTY_RECTS
+                if(_damageClip)
+                    rec = _damageRec;
+                #endif
+                InvalidateRectangle(rec.left, rec.top, rec.right, rec.bottom);
+                #endif
+
+                #ifdef USE_DIRTY_RECTS
+                if(_damageClip){
+                    _damageClip = 0;
+                    SetClip(CLIP_DISABLE);
+                }
+                #endif
             }else{
                 return 0; // drawing is not done
             }
         }
         pCurrentObj = pCurrentObj->pNxtObj;
     }
+
+    #ifdef USE_DIRTY_RECTS
+    _drawCount = 0;
+    #endif
+
+    #ifdef USE_DOUBLE_BUFFERING
+    // all objects are drawn, show them at once
+    UpdateDisplayNow();
+    #endif
+
     return 1;   // drawing is completed
 }
 
@@ -563,19 +978,7 @@ OBJ_HEADER *pCurrentObj;
         if( !( (pCurrentObj->left > right) ||
              (pCurrentObj->right < left) ||       
              (pCurrentObj->top > bottom) ||
-             (pCurrentObj->bottom < top) ) )
-
-		if( ( (pCurrentObj->left >= left)&&
-              (pCurrentObj->left <= right) ) ||
-
-            ( (pCurrentObj->right >= left)&&
-              (pCurrentObj->right <= right) ) ||
-
-            ( (pCurrentObj->top >= top)&&
-              (pCurrentObj->top <= bottom) )||
-
-            ( (pCurrentObj->bottom >= top)&&
-              (pCurrentObj->bottom <= bottom) ) ){
+             (pCurrentObj->bottom < top) ) ){
 
                 GOLRedraw(pCurrentObj);
 
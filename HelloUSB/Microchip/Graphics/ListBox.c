@@ -541,12 +541,10 @@ if(GetState(pLb, LB_DRAW)){
 // DRAW ITEMS
 /////////////////////////////////////////////////////////////////////
 L_LB_DRAW:
-            SetClip(CLIP_ENABLE);
-
-            SetClipRgn(pLb->hdr.left+GOL_EMBOSS_SIZE+LB_INDENT,
-                       pLb->hdr.top+GOL_EMBOSS_SIZE+LB_INDENT,
-                       pLb->hdr.right-GOL_EMBOSS_SIZE-LB_INDENT,
-                       pLb->hdr.bottom-GOL_EMBOSS_SIZE-LB_INDENT);
+            GOLSetClipRgn(pLb->hdr.left+GOL_EMBOSS_SIZE+LB_INDENT,
+                          pLb->hdr.top+GOL_EMBOSS_SIZE+LB_INDENT,
+                          pLb->hdr.right-GOL_EMBOSS_SIZE-LB_INDENT,
+                          pLb->hdr.bottom-GOL_EMBOSS_SIZE-LB_INDENT);
 
 	        SetFont(pLb->hdr.pGolScheme->pFont);
 
@@ -562,7 +560,7 @@ L_LB_DRAW:
 L_LB_DRAWITEM:
             if( pCurItem == NULL ) {
                 state = LB_STATE_START;
-                SetClip(CLIP_DISABLE);
+                GOLResetClip();
                 return 1;
             }
 
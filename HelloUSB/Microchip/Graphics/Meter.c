@@ -40,27 +40,10 @@
  *****************************************************************************/
 
 #include "Graphics\Graphics.h"
-#include <math.h>
 #include <stdio.h>
 
 #ifdef USE_METER
 
-/*********************************************************************
-* This is the sine lookup table used to draw the meter and update
-* the position of the needle. 
-*********************************************************************/
-const char _sineTable[] __attribute__  ((aligned(2))) = {
-	0x00,0x03,0x06,0x09,0x0c,0x10,0x13,0x16, 
-	0x19,0x1c,0x1f,0x22,0x25,0x28,0x2b,0x2e,
-	0x31,0x33,0x36,0x39,0x3c,0x3f,0x41,0x44,
-	0x47,0x49,0x4c,0x4e,0x51,0x53,0x55,0x58,
-	0x5a,0x5c,0x5e,0x60,0x62,0x64,0x66,0x68,
-	0x6a,0x6b,0x6d,0x6f,0x70,0x71,0x73,0x74,
-	0x75,0x76,0x78,0x79,0x7a,0x7a,0x7b,0x7c,
-	0x7d,0x7d,0x7e,0x7e,0x7e,0x7f,0x7f,0x7f,
-	0x7f
-};
-
 /*********************************************************************
 * Function: METER  *MtrCreate(WORD ID, SHORT left, SHORT top, SHORT right, 
 *							  SHORT bottom, WORD state, SHORT value, 
@@ -261,7 +244,6 @@ typedef enum {
 	static SHORT temp, j, i, angle;
 	static XCHAR strVal[SCALECHARCOUNT+1];
 	static XCHAR tempXchar[4] = {'8','8','8',0};
-	static float radian;
 	static DWORD_VAL dTemp, dRes;
 		
     if(IsDeviceBusy())
@@ -399,8 +381,6 @@ mtr_scale_compute:
 
 			if (i >= DEGREE_START) {
 				
-				radian = i*.0175;
-	
 				if (!GetState(pMtr, MTR_RING)) {
 					if (i < danger) {
 						SetColor(pMtr->dangerColor);
@@ -418,10 +398,10 @@ mtr_scale_compute:
 				
 				// compute the starting x1 and y1 position of the scales
 				// x2 here is the distance from the center to the x1, y1
-				// position. Sin and cos is used here since computation speed in initial
-				// drawing is not yet critical.
-				x1 = x2*cos(radian);
-				y1 = (-1)*(x2*sin(radian));
+				// position. The meter angles go counter clockwise on the screen.
+				// The scales are placed at whole degrees, the same angles the
+				// needle uses for the values they mark.
+				GetCirclePoint(x2, -i, &x1, &y1);
 				
 				// using ratio and proportion we get the x2,y2 position
 				dTemp.Val = 0;
@@ -449,12 +429,11 @@ mtr_scale_compute:
 			if ((i%45) == 0) {
 
 				// draw the scale labels
-				// reusing radian, x2 and y2
+				// reusing x2 and y2
 	
-				// compute for the actual angle of needle to be shown in screen				
-				radian = (DEGREE_END - DEGREE_START) - (i-(DEGREE_START));
 				// compute the values of the label to be shown per 45 degree
-				temp = pMtr->range*(radian/(DEGREE_END - DEGREE_START));
+				// from the actual angle of needle to be shown in screen
+				temp = ((LONG)pMtr->range*(DEGREE_END-i))/(DEGREE_END - DEGREE_START);
 				
 				// this implements sprintf(strVal, "%d", temp); faster
 				// note that this is just for values >= 0, while sprintf covers negative values.
@@ -528,64 +507,12 @@ mtr_needle_draw_st:
 			dTemp.Val  *= (DEGREE_END - DEGREE_START);
 			
 			angle = DEGREE_END-(dTemp.w[1]);
-			temp  = angle;
 	
-			/* The method uses a lookup table of pre-calculated sine values. The table
-			   is derived from calculating sine values from 0 degrees to 90 degrees.
-			   To save space, the entries are just a byte size. So 360/255 = 1.40625 degrees
-			   increments is used for each entry. (i.e entry 0 is zero, entry i is 1.40625,
-			   entry 2 is 2*1.40625,... entry n is n*1.40625. 
-			   Get the sine of the entries yields a float value. Since we only use a 
-			   byte for storage we can shift the values by 127 without overflowing the 
-			   storage. Thus we need to shift the computed values by 7 bits. Shifting now 
-			   permits us to work with integers which greatly reduces the execution time.
-			   With this in mind, the input angles must be translated to 0-90 range with the
-			   quadrant of the original angle stored to translate back the value from the 
-			   table to the correct quadrant. Also the quadrant number will determine if 
-			   the calculated x and y positions are to be swapped. 
-			   In summary:
-			   	Swap x and y when calculating points in quadrant 2 and 4
-			   	Negate x when in quadrant 2 and 3
-			   	Negate y when in quadrant 1 and 2
-			*/
-
-			// translate the angle to 0-90 range
-			while (temp < 0)								// this is needed for negative
-				temp += 90;									// for negative values
-			while(temp > 90)		
-				temp -= 90;
-
-			// determine which quadrant the angle is located
-			// i determines if x and y are swapped (0 no swapping, 1 swapping needed)
-			// y2 and x2 are the multiplier to negate or not the x and y values
-			if ((180 < angle ) && (angle <= 270)) {			// quadrant 3
-				i  =  0;
-				y2 =  1;
-				x2 = -1;
-			} else if ((90 < angle) && (angle <= 180)) {	// quadrant 2
-				i  =  1;
-				y2 = -1;
-				x2 = -1;
-			} else if ((0 <= angle) && (angle <= 90)) {		// quadrant 1
-				i  =  0;								
-				y2 = -1;
-				x2 =  1;
-			} else if ((-90 < angle) && (angle < 0)) {		// quadrant 4
-				i  =  1;
-				y2 =  1;
-				x2 =  1;
-			} 
-			
-			// Find Sine value from look up table 
-			temp *= .71111;									// value is derived from 
-															// 360/256 = 1.40625. To avoid
-															// division, the inverse is used
-			x1 = _sineTable[64-temp] * pMtr->radius;
-			y1 = _sineTable[temp] 	 * pMtr->radius;
-			
-			// calculate new positions, check if we need to reverse x and y values
-			pMtr->xPos = ((x2)*(((i==0) ? x1:y1) >> 7)) + pMtr->xCenter;
-			pMtr->yPos = ((y2)*(((i==0) ? y1:x1) >> 7)) + pMtr->yCenter;
+			// get the needle end from the shared sine table, the meter 
+			// angles go counter clockwise on the screen
+			GetCirclePoint(pMtr->radius, -angle, &x1, &y1);
+			pMtr->xPos = x1 + pMtr->xCenter;
+			pMtr->yPos = y1 + pMtr->yCenter;
 		
 			// now draw the needle with the new position	
 			SetColor(pMtr->dangerColor);
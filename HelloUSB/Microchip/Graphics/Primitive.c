@@ -43,6 +43,9 @@
 #define USE_PRIMITIVE_BEVEL
 
 /////////////////////// LOCAL FUNCTIONS PROTOTYPES ////////////////////////////
+void LineSpan(SHORT x1, SHORT x2, SHORT y);
+void OutCharRun(SHORT row, SHORT x, SHORT length);
+
 void PutImage1BPP(SHORT left, SHORT top, FLASH_BYTE* bitmap, BYTE stretch);
 void PutImage4BPP(SHORT left, SHORT top, FLASH_BYTE* bitmap, BYTE stretch);
 void PutImage8BPP(SHORT left, SHORT top, FLASH_BYTE* bitmap, BYTE stretch);
@@ -53,6 +56,43 @@ void PutImage4BPPExt(SHORT left, SHORT top, void* bitmap, BYTE stretch);
 void PutImage8BPPExt(SHORT left, SHORT top, void* bitmap, BYTE stretch);
 void PutImage16BPPExt(SHORT left, SHORT top, void* bitmap, BYTE stretch);
 
+void PutImageLine(SHORT left, SHORT top, WORD* pLine, WORD count, BYTE stretch);
+
+// Edges of the sector filled by FillSector()
+typedef struct {
+	LONG	cosFrom;	// Direction of the start edge.
+	LONG	sinFrom;
+	LONG	cosTo;		// Direction of the end edge.
+	LONG	sinTo;
+	BYTE	large;		// Set if the sector is larger than 180 degrees.
+} SECTOR_EDGES;
+
+void SectorEdgeSpan(LONG s, LONG t, SHORT* pLeft, SHORT* pRight);
+void SectorRows(SHORT cx, SHORT cy, SHORT dyFrom, SHORT dyTo, SHORT halfWidth, SECTOR_EDGES* pEdges);
+
+#ifdef USE_COMP_RLE
+// Number of bytes read at once from a compressed external image
+#define RLE_BUFFER_SIZE    32
+
+// Compressed image data reader
+typedef struct {
+    void*       bitmap;                 // Image
+    BYTE        end;                    // Set after the end of bitmap escape
+#ifdef USE_BITMAP_FLASH
+    FLASH_BYTE* flashAddress;           // Next data byte of a flash image
+#endif
+#ifdef USE_BITMAP_EXTERNAL
+    DWORD       memOffset;              // Offset of the next external memory read
+    BYTE        index;                  // Next byte in the buffer
+    BYTE        count;                  // Number of bytes in the buffer
+    BYTE        buffer[RLE_BUFFER_SIZE];
+#endif
+} RLE_READER;
+
+BYTE RLEGetByte(RLE_READER* pReader);
+WORD RLEDecodeLine(RLE_READER* pReader, BYTE colorDepth, WORD* pallete, WORD sizeX, SHORT left, BYTE stretch, WORD* pLine);
+#endif
+
 // Current line type
 SHORT _lineType;
 
@@ -75,6 +115,62 @@ WORD   _fontLastChar;					// Last character in the font table.
 // Installed font height
 SHORT  _fontHeight;
 
+#ifdef USE_GLYPH_CACHE
+// Horizontal run of set pixels in a glyph
+typedef struct {
+    BYTE row;                           // Glyph row
+    BYTE x;                             // First pixel in the row
+    BYTE length;                        // Number of pixels
+} GLYPH_RUN;
+
+// Glyph cache entry
+typedef struct {
+    void*     font;                     // Font of the glyph, NULL if the entry is free
+    XCHAR     ch;                       // Character code
+    BYTE      width;                    // Glyph width
+    BYTE      runCount;                 // Number of runs
+    WORD      used;                     // Time of the last use
+    GLYPH_RUN run[GLYPH_CACHE_RUNS];
+} GLYPH_CACHE_ENTRY;
+
+GLYPH_CACHE_ENTRY _glyphCache[GLYPH_CACHE_SIZE];
+// Incremented on each cached glyph use
+WORD              _glyphCacheTime;
+
+GLYPH_CACHE_ENTRY* GetCachedGlyph(XCHAR ch);
+GLYPH_CACHE_ENTRY* CacheGlyph(XCHAR ch, BYTE width, BYTE* pImage);
+#endif
+
+#ifdef USE_FONT_WIDTH_TABLE
+// Number of glyph entries read at once from an external font
+#define FONT_WIDTH_READ_SIZE    16
+
+// Font of the width table, NULL if the table is not loaded
+void*  _fontWidthFont;
+// First character and number of characters in the width table
+WORD   _fontWidthFirst;
+WORD   _fontWidthCount;
+// Character widths
+BYTE   _fontWidth[FONT_WIDTH_TABLE_SIZE];
+
+void LoadFontWidthTable(void* font, FONT_HEADER* pHeader);
+#endif
+
+#ifdef USE_TEXT_WIDTH_CACHE
+// Text width cache entry
+typedef struct {
+    void*     font;                     // Font of the string, NULL if the entry is free
+    XCHAR*    text;                     // String pointer
+    WORD      length;                   // Number of characters
+    WORD      checksum;                 // Checksum of the characters
+    SHORT     width;                    // String width
+} TEXT_WIDTH_ENTRY;
+
+TEXT_WIDTH_ENTRY _textWidthCache[TEXT_WIDTH_CACHE_SIZE];
+// Next entry to be replaced
+BYTE             _textWidthNext;
+#endif
+
 /*********************************************************************
 * Function:  void InitGraph(void)
 *
@@ -159,30 +255,20 @@ WORD Arc(SHORT xL, SHORT yT, SHORT xR, SHORT yB, SHORT r1, SHORT r2, BYTE octant
 
 #ifndef USE_NONBLOCKING_CONFIG
 
-	SHORT y1Limit, y2Limit;
+	CIRCLE_WALK walk1, walk2;
 	SHORT x1, x2, y1, y2;
-	SHORT err1, err2;
 	SHORT x1Cur, y1Cur, y1New;
 	SHORT x2Cur, y2Cur, y2New;
-	DWORD_VAL  temp;	
-
-	temp.Val = SIN45*r1;
-	y1Limit  = temp.w[1];
-	temp.Val = SIN45*r2;
-	y2Limit  = temp.w[1];
 
-	temp.Val = (DWORD)(ONEP25 -((LONG)r1<<16));
-	err1  = (SHORT)(temp.w[1]); 
-
-	temp.Val = (DWORD)(ONEP25 -((LONG)r2<<16));
-	err2  = (SHORT)(temp.w[1]); 
+	CircleWalkInit(&walk1, r1);
+	CircleWalkInit(&walk2, r2);
 
 	x1 = r1; x2 = r2; y1 = 0; y2 = 0;
 
 	x1Cur = x1; y1Cur = y1; y1New = y1;
 	x2Cur = x2; y2Cur = y2; y2New = y2;
 
-	while(y2<=y2Limit) {			// just watch for y2 limit since outer circle
+	while(y2<=walk2.yLimit) {		// just watch for y2 limit since outer circle
 									// will have greater value.
 		// Drawing of the rounded panel is done only when there is a change in the
 		// x direction. Bars are drawn to be efficient.
@@ -196,31 +282,17 @@ WORD Arc(SHORT xL, SHORT yT, SHORT xR, SHORT yB, SHORT r1, SHORT r2, BYTE octant
 		// draw the correct bars (non-overlapping).
 		y1New = y1;	y2New = y2;		
 
-		if (y1 <= y1Limit) {
-	 		if(err1 > 0) {
-    			x1--;
-    			err1 += 5;
-    			err1 += (y1-x1)<<1;
-   			} else {
-    			err1 += 3;
-    			err1 += y1<<1;
-    		}
-    		y1++;
+		if (y1 <= walk1.yLimit) {
+			CircleWalkStep(&walk1);
+			x1 = walk1.x; y1 = walk1.y;
 		} else {
 			y1++;
 			if (x1 < y1)	
 				x1 = y1;
 		}
 	
-	 	if(err2 > 0) {
-    		x2--;
-    		err2 += 5;
-    		err2 += (y2-x2)<<1;
-   		} else {
-    		err2 += 3;
-    		err2 += y2<<1;
-    	}
-		y2++;	
+		CircleWalkStep(&walk2);
+		x2 = walk2.x; y2 = walk2.y;
 
 
 		if ((x1Cur != x1) || (x2Cur != x2)) {
@@ -308,11 +380,9 @@ QUAD42, BARBOTTOM2,
 CHECK,  
 } OCTANTARC_STATES;
 
-	DWORD_VAL  temp;	
 //	LONG temp1;
-	static SHORT y1Limit, y2Limit;
+	static CIRCLE_WALK walk1, walk2;
 	static SHORT x1, x2, y1, y2;
-	static SHORT err1, err2;
 	static SHORT x1Cur, y1Cur, y1New;
 	static SHORT x2Cur, y2Cur, y2New;
 	static OCTANTARC_STATES state = BEGIN;
@@ -323,17 +393,8 @@ CHECK,
 	    switch(state){
 	        case BEGIN:     
 	        
-
-				temp.Val = SIN45*r1;
-				y1Limit  = temp.w[1];
-				temp.Val = SIN45*r2;
-				y2Limit  = temp.w[1];
-
-				temp.Val = (DWORD)(ONEP25 -((LONG)r1<<16));
-				err1  = (SHORT)(temp.w[1]); 
-			
-				temp.Val = (DWORD)(ONEP25 -((LONG)r2<<16));
-				err2  = (SHORT)(temp.w[1]); 
+				CircleWalkInit(&walk1, r1);
+				CircleWalkInit(&walk2, r2);
    
 				x1 = r1; x2 = r2; y1 = 0; y2 = 0;
 			
@@ -343,38 +404,24 @@ CHECK,
 	
 	        case CHECK:
 arc_check_state:	        
-				if (y2 > y2Limit) {
+				if (y2 > walk2.yLimit) {
 	                state = BARRIGHT1;
 	                goto arc_draw_width_height_state;
 	            }
 				// y1New & y2New records the last y positions
 				y1New = y1;	y2New = y2;		
 		
-				if (y1 <= y1Limit) {
-			 		if(err1 > 0) {
-		    			x1--;
-		    			err1 += 5;
-		    			err1 += (y1-x1)<<1;
-		   			} else {
-		    			err1 += 3;
-		    			err1 += y1<<1;
-		    		}
-		    		y1++;
+				if (y1 <= walk1.yLimit) {
+					CircleWalkStep(&walk1);
+					x1 = walk1.x; y1 = walk1.y;
 				} else {
 					y1++;
 					if (x1 < y1)	
 						x1 = y1;
 				}
 			
-			 	if(err2 > 0) {
-		    		x2--;
-		    		err2 += 5;
-		    		err2 += (y2-x2)<<1;
-		   		} else {
-		    		err2 += 3;
-		    		err2 += y2<<1;
-		    	}
-				y2++;	
+				CircleWalkStep(&walk2);
+				x2 = walk2.x; y2 = walk2.y;
 	        
 				state = QUAD11;
 				break;
@@ -569,11 +616,10 @@ SHORT style, type;
                 style = 0;
             }
             if(type){
-                PutPixel(x1,temp);
-                if(_lineThickness){
-                    PutPixel (x1+1,temp);
-                    PutPixel (x1-1,temp);
-                }
+                if(_lineThickness)
+                    HLine(x1-1,x1+1,temp);
+                else
+                    PutPixel(x1,temp);
             }
 
        }
@@ -584,6 +630,10 @@ SHORT style, type;
         if(x1>x2){
             temp = x1; x1 = x2; x2 = temp;
         }
+        if(_lineType == SOLID_LINE){
+            LineSpan(x1,x2,y1);
+            return;
+        }
         style = 0; type =1;
         for(temp=x1; temp<x2+1; temp++){
             if((++style)==_lineType){
@@ -637,6 +687,25 @@ SHORT style, type;
     // Error for the first pixel
     error= stepErrorLT-deltaX;
 
+    if((_lineType == SOLID_LINE) && !steep){
+        // Pixels with the same y form horizontal runs, draw each run as
+        // a span. The first pixel is already drawn.
+        temp = x1+stepX;
+        while(--deltaX >= 0){
+            if(error >= 0){
+                if(temp != x1+stepX)
+                    LineSpan(temp,x1,y1);
+                y1+= stepY;
+                error-= stepErrorGE;
+                temp = x1+stepX;
+            }
+            x1+= stepX;
+            error+= stepErrorLT;
+        }
+        LineSpan(temp,x1,y1);
+        return;
+    }
+
     style = 0; type =1;
 
     while(--deltaX >= 0){
@@ -653,11 +722,10 @@ SHORT style, type;
         }
         if(type){
             if(steep){
-                PutPixel (y1,x1);
-                if(_lineThickness){
-                    PutPixel (y1+1,x1);
-                    PutPixel (y1-1,x1);
-                }
+                if(_lineThickness)
+                    HLine(y1-1,y1+1,x1);
+                else
+                    PutPixel (y1,x1);
             }else{
                 PutPixel (x1,y1);
                 if(_lineThickness){
@@ -668,6 +736,31 @@ SHORT style, type;
         }
    }// end of while
 }
+
+/*********************************************************************
+* Function: void LineSpan(SHORT x1, SHORT x2, SHORT y)
+*
+* PreCondition: none
+*
+* Input: x1,x2 - span ends, y - span row
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: draws a horizontal piece of a solid line with the
+*           current line thickness
+*
+* Note: none
+*
+********************************************************************/
+void LineSpan(SHORT x1, SHORT x2, SHORT y){
+    HLine(x1,x2,y);
+    if(_lineThickness){
+        HLine(x1,x2,y+1);
+        HLine(x1,x2,y-1);
+    }
+}
 #endif
 
 /*********************************************************************
@@ -692,19 +785,18 @@ SHORT style, type;
 ********************************************************************/
 void Bevel(SHORT x1, SHORT y1, SHORT x2, SHORT y2, SHORT rad)
 {
-	SHORT  style, type, xLimit, xPos, yPos, error;
-	DWORD_VAL  temp;	
+	SHORT  style, type, xPos, yPos;
+	CIRCLE_WALK walk;
 
-	temp.Val = SIN45*rad;
-	xLimit   = temp.w[1]+1;
-	temp.Val = (DWORD)(ONEP25 -((LONG)rad<<16));
-	error    = (SHORT)(temp.w[1]); 
-	yPos     = rad;
+	// the walk runs one pixel past the 45 degree point here
+	CircleWalkInit(&walk, rad);
 
     style = 0; type =1;
 
 	if (rad) {
-	  	for (xPos=0; xPos <=xLimit; xPos++) {
+	  	while (walk.y <= walk.yLimit+1) {
+		  	xPos = walk.y;
+		  	yPos = walk.x;
 		  	
 		  	if((++style)==_lineType){
 	            type ^=1;
@@ -740,12 +832,7 @@ void Bevel(SHORT x1, SHORT y1, SHORT x2, SHORT y2, SHORT rad)
 			   		PutPixel(x1-xPos,   y1-yPos-1);
                 }
 		   	}
-		 	if(error > 0) {
-	    		yPos--;
-	    		error += 5+((xPos-yPos)<<1);
-	   		}
-	   		else
-	    		error += 3+(xPos<<1);
+		   	CircleWalkStep(&walk);
 	    }
 	} 
 
@@ -787,26 +874,23 @@ WORD FillBevel(SHORT x1, SHORT y1, SHORT x2, SHORT y2, SHORT rad)
 
 #ifndef USE_NONBLOCKING_CONFIG
 
-	SHORT yLimit, xPos, yPos, err;
+	CIRCLE_WALK walk;
+	SHORT xPos, yPos;
 	SHORT xCur, yCur, yNew;
-	DWORD_VAL  temp;	
 
 	// note that octants here is defined as:
 	// from yPos=-radius, xPos=0 in the clockwise direction octant 1 to 8 are labeled
 	// assumes an origin at 0,0. Quadrants are defined in the same manner
 
 	if (rad) {
-		temp.Val = SIN45*rad;
-		yLimit   = temp.w[1];
-		temp.Val = (DWORD)(ONEP25 -((LONG)rad<<16));
-		err      = (SHORT)(temp.w[1]); 
+		CircleWalkInit(&walk, rad);
 		xPos     = rad;
 		yPos     = 0;
 
 		xCur = xPos; yCur = yPos; yNew = yPos;
 
 		
-		while(yPos<=yLimit) {
+		while(yPos<=walk.yLimit) {
 	
 			// Drawing of the rounded panel is done only when there is a change in the
 			// x direction. Bars are drawn to be efficient.
@@ -818,12 +902,8 @@ WORD FillBevel(SHORT x1, SHORT y1, SHORT x2, SHORT y2, SHORT rad)
 			// y1New records the last y position
 			yNew = yPos;			
 
-		 	if(err > 0) {
-	    		xPos--;
-	    		err += 5+((yPos-xPos)<<1);
-	   		} else
-	    		err += 3+(yPos<<1);
-			yPos++;	
+			CircleWalkStep(&walk);
+			xPos = walk.x; yPos = walk.y;
 
 			if (xCur != xPos) {
 				// 6th octant to 3rd octant
@@ -859,9 +939,8 @@ FACE
 } FILLCIRCLE_STATES;
 
 
-	DWORD_VAL  temp;	
-	static LONG err;
-	static SHORT yLimit, xPos, yPos;
+	static CIRCLE_WALK walk;
+	static SHORT xPos, yPos;
 	static SHORT xCur, yCur, yNew;
 
 	FILLCIRCLE_STATES state = BEGIN;
@@ -876,17 +955,14 @@ while(1){
 	        	break;
 	        }
 	        // compute variables
-			temp.Val = SIN45*rad;
-			yLimit   = temp.w[1];
-			temp.Val = (DWORD)(ONEP25 -((LONG)rad<<16));
-			err      = (SHORT)(temp.w[1]); 
+			CircleWalkInit(&walk, rad);
 			xPos 	 = rad; yPos = 0;
 			xCur     = xPos; yCur = yPos; yNew = yPos;
             state    = CHECK;
 
         case CHECK:
 bevel_fill_check:
-            if (yPos>yLimit) {
+            if (yPos>walk.yLimit) {
                 state = FACE;
                 break;
             }
@@ -894,12 +970,8 @@ bevel_fill_check:
 			yNew = yPos;			
 
 			// calculate the next value of x and y
-		 	if(err > 0) {
-	    		xPos--;
-	    		err += 5+((yPos-xPos)<<1);
-	   		} else
-	    		err += 3+(yPos<<1);
-			yPos++;	
+			CircleWalkStep(&walk);
+			xPos = walk.x; yPos = walk.y;
 			state = Q6TOQ3;
 
         case Q6TOQ3:
@@ -952,6 +1024,327 @@ bevel_fill_check:
 #endif // end of USE_NONBLOCKING_CONFIG
 }
 
+/*********************************************************************
+* Overview: Sine values of the first quadrant (0 to 90 degrees with 
+*			1 degree steps) scaled by 2^16. sin(90) is limited to 
+*			0xFFFF. Shared by the circle and sector primitives and 
+*			the widgets drawing round objects.
+*
+*********************************************************************/
+const WORD _sineTable[91] __attribute__  ((aligned(2))) = {
+        0, 1143, 2287, 3429, 4571, 5711, 6850, 7986, 9120,10251,
+    11380,12504,13625,14742,15854,16961,18063,19160,20251,21336,
+    22414,23485,24549,25606,26655,27696,28728,29752,30766,31771,
+    32767,33753,34728,35692,36646,37589,38520,39439,40347,41242,
+    42125,42994,43851,44694,45524,46340,47141,47929,48701,49459,
+    50202,50930,51642,52338,53018,53683,54330,54962,55576,56174,
+    56754,57318,57863,58392,58902,59394,59869,60325,60762,61182,
+    61582,61964,62327,62671,62996,63301,63588,63855,64102,64330,
+    64539,64728,64897,65046,65175,65285,65375,65445,65495,65525,
+    65535
+};
+
+/*********************************************************************
+* Function: void CircleWalkInit(CIRCLE_WALK* pWalk, SHORT rad)
+*
+* PreCondition: none
+*
+* Input: pWalk - pointer to the circle walk state, rad - radius
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: starts the midpoint circle walk at x = rad, y = 0
+*
+* Note: none
+*
+********************************************************************/
+void CircleWalkInit(CIRCLE_WALK* pWalk, SHORT rad)
+{
+	DWORD_VAL  temp;	
+
+	temp.Val = SIN45*rad;
+	pWalk->yLimit = temp.w[1];
+	temp.Val = (DWORD)(ONEP25 -((LONG)rad<<16));
+	pWalk->err    = (SHORT)(temp.w[1]); 
+	pWalk->x      = rad;
+	pWalk->y      = 0;
+}
+
+/*********************************************************************
+* Function: void CircleWalkStep(CIRCLE_WALK* pWalk)
+*
+* PreCondition: CircleWalkInit() must be called before
+*
+* Input: pWalk - pointer to the circle walk state
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: moves the midpoint circle walk to the next y position
+*
+* Note: none
+*
+********************************************************************/
+void CircleWalkStep(CIRCLE_WALK* pWalk)
+{
+ 	if(pWalk->err > 0) {
+		pWalk->x--;
+		pWalk->err += 5+2*(pWalk->y-pWalk->x);
+	} else
+		pWalk->err += 3+(pWalk->y<<1);
+	pWalk->y++;	
+}
+
+/*********************************************************************
+* Function: SHORT GetSine(SHORT angle)
+*
+* PreCondition: none
+*
+* Input: angle - angle in degrees
+*
+* Output: sine of the angle scaled by SINE_SCALE
+*
+* Side Effects: none
+*
+* Overview: reads the sine of the angle from the first quadrant table
+*
+* Note: none
+*
+********************************************************************/
+SHORT GetSine(SHORT angle)
+{
+	angle %= 360;
+	if (angle < 0)
+		angle += 360;
+
+	if (angle <= 90)
+		return (_sineTable[angle]>>1);
+	if (angle <= 180)
+		return (_sineTable[180-angle]>>1);
+	if (angle <= 270)
+		return -(SHORT)(_sineTable[angle-180]>>1);
+	return -(SHORT)(_sineTable[360-angle]>>1);
+}
+
+/*********************************************************************
+* Function: void GetCirclePoint(SHORT radius, SHORT angle, SHORT* x, SHORT* y)
+*
+* PreCondition: none
+*
+* Input: radius - circle radius, angle - angle in degrees, 
+*		 x, y - pointers to the results
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: calculates the point on the circle relative to the center,
+*			the angle goes clockwise on the screen from the x axis
+*
+* Note: none
+*
+********************************************************************/
+void GetCirclePoint(SHORT radius, SHORT angle, SHORT* x, SHORT* y)
+{
+	DWORD_VAL rad;
+	WORD  xSine, ySine;
+
+	angle %= 360;
+	if (angle < 0)
+		angle += 360;
+
+	// get the cosine and sine of the angle translated to the first quadrant
+	if (angle <= 90) {
+		xSine = _sineTable[90-angle];
+		ySine = _sineTable[angle];
+	} else if (angle <= 180) {
+		xSine = _sineTable[angle-90];
+		ySine = _sineTable[180-angle];
+	} else if (angle <= 270) {
+		xSine = _sineTable[270-angle];
+		ySine = _sineTable[angle-180];
+	} else {
+		xSine = _sineTable[angle-270];
+		ySine = _sineTable[360-angle];
+	}
+
+	rad.Val = (DWORD)radius*xSine;
+	*x = rad.w[1];
+	rad.Val = (DWORD)radius*ySine;
+	*y = rad.w[1];
+
+	// negate x in the 2nd and 3rd quadrant, y in the 3rd and 4th quadrant
+	if ((angle > 90) && (angle < 270))
+		*x = -*x;
+	if (angle > 180)
+		*y = -*y;
+}
+
+/*********************************************************************
+* Function: void SectorEdgeSpan(LONG s, LONG t, SHORT* pLeft, SHORT* pRight)
+*
+* PreCondition: none
+*
+* Input: s, t - edge condition s*x <= t, pLeft, pRight - span ends
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: limits the span to the x positions on the inner side 
+*			of a sector edge, the span is empty if pLeft > pRight
+*
+* Note: none
+*
+********************************************************************/
+void SectorEdgeSpan(LONG s, LONG t, SHORT* pLeft, SHORT* pRight)
+{
+	LONG limit;
+
+	if (s > 0) {
+		// x <= floor(t/s)
+		limit = (t >= 0) ? (t/s) : -((s-1-t)/s);
+		if (limit < *pRight)
+			*pRight = (SHORT)limit;
+	} else if (s < 0) {
+		// x >= ceil(t/s)
+		s = -s; t = -t;
+		limit = (t >= 0) ? ((t+s-1)/s) : -((-t)/s);
+		if (limit > *pLeft)
+			*pLeft = (SHORT)limit;
+	} else if (t < 0) {
+		// the row is outside of the edge
+		*pLeft = *pRight+1;
+	}
+}
+
+/*********************************************************************
+* Function: void SectorRows(SHORT cx, SHORT cy, SHORT dyFrom, SHORT dyTo, 
+*							SHORT halfWidth, SECTOR_EDGES* pEdges)
+*
+* PreCondition: none
+*
+* Input: cx, cy - center, dyFrom, dyTo - rows relative to the center,
+*		 halfWidth - half width of the circle in the rows,
+*		 pEdges - pointer to the sector edges
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: fills the rows of a sector with horizontal spans
+*
+* Note: none
+*
+********************************************************************/
+void SectorRows(SHORT cx, SHORT cy, SHORT dyFrom, SHORT dyTo, SHORT halfWidth, SECTOR_EDGES* pEdges)
+{
+	SHORT dy, left1, right1, left2, right2;
+
+	for (dy = dyFrom; dy <= dyTo; dy++) {
+
+		// points clockwise from the start edge
+		left1 = -halfWidth; right1 = halfWidth;
+		SectorEdgeSpan(pEdges->sinFrom, pEdges->cosFrom*dy, &left1, &right1);
+		// points counter clockwise from the end edge
+		left2 = -halfWidth; right2 = halfWidth;
+		SectorEdgeSpan(-pEdges->sinTo, -pEdges->cosTo*dy, &left2, &right2);
+
+		if (!pEdges->large) {
+			// sector up to 180 degrees: points inside of both edges
+			if (left2 > left1)
+				left1 = left2;
+			if (right2 < right1)
+				right1 = right2;
+		} else {
+			// larger sector: points inside of any edge 
+			if (left1 > right1) {
+				left1 = left2; right1 = right2;
+			} else if (left2 <= right2) {
+				if ((left2 > right1+1) || (left1 > right2+1)) {
+					// two separate spans
+					HLine(cx+left2, cx+right2, cy+dy);
+				} else {
+					if (left2 < left1)
+						left1 = left2;
+					if (right2 > right1)
+						right1 = right2;
+				}
+			}
+		}
+
+		if (left1 <= right1)
+			HLine(cx+left1, cx+right1, cy+dy);
+	}
+}
+
+/*********************************************************************
+* Function: void FillSector(SHORT cx, SHORT cy, SHORT radius, 
+*							SHORT angleFrom, SHORT angleTo)
+*
+* PreCondition: none
+*
+* Input: cx, cy - center, radius - radius, 
+*		 angleFrom, angleTo - sector angles in degrees
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: draws a filled sector of the circle with horizontal spans
+*
+* Note: The rows are scanned in the same way as in FillBevel().
+*
+********************************************************************/
+void FillSector(SHORT cx, SHORT cy, SHORT radius, SHORT angleFrom, SHORT angleTo)
+{
+	CIRCLE_WALK walk;
+	SHORT xCur, yCur, yNew;
+	SECTOR_EDGES edges;
+
+	if ((angleTo < angleFrom) || (radius <= 0))
+		return;
+
+	if ((angleTo-angleFrom) >= 360) {
+		FillBevel(cx, cy, cx, cy, radius);
+		return;
+	}
+
+	// directions of the sector edges
+	edges.cosFrom = GetCosine(angleFrom);
+	edges.sinFrom = GetSine(angleFrom);
+	edges.cosTo   = GetCosine(angleTo);
+	edges.sinTo   = GetSine(angleTo);
+	edges.large   = ((angleTo-angleFrom) > 180);
+
+	CircleWalkInit(&walk, radius);
+	xCur = walk.x; yCur = walk.y; yNew = walk.y;
+
+	while (walk.y <= walk.yLimit) {
+
+		// yNew records the last y position
+		yNew = walk.y;
+		CircleWalkStep(&walk);
+
+		if (xCur != walk.x) {
+			// 6th octant to 3rd octant
+			SectorRows(cx, cy, yCur, yNew, xCur, &edges);
+			// 5th octant to 4th octant
+			SectorRows(cx, cy, walk.x, xCur, yNew, &edges);
+			// 8th octant to 1st octant
+			SectorRows(cx, cy, -xCur, -walk.x, yNew, &edges);
+			// 7th octant to 2nd octant
+			SectorRows(cx, cy, -yNew, -yCur, xCur, &edges);
+
+			// update current values
+			xCur = walk.x; yCur = walk.y;
+		}
+	}
+}
+
 /*********************************************************************
 * Function: void DrawPoly(SHORT numPoints, SHORT* polyPoints)
 *
@@ -1000,13 +1393,71 @@ SHORT sx,sy,ex,ey;
 ********************************************************************/
 #ifndef USE_DRV_BAR
 void Bar(SHORT left, SHORT top, SHORT right, SHORT bottom){
-SHORT x,y;
+SHORT y;
+    if(left>right)
+        return;
     for(y=top; y<bottom+1; y++)
-    for(x=left; x<right+1; x++)
+        HLine(left,right,y);
+}
+#endif
+
+/*********************************************************************
+* Function: void HLine(SHORT x1, SHORT x2, SHORT y)
+*
+* PreCondition: none
+*
+* Input: x1,x2 - span ends, y - span row
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: draws horizontal span with current color
+*
+* Note: none
+*
+********************************************************************/
+#ifndef USE_DRV_HLINE
+void HLine(SHORT x1, SHORT x2, SHORT y){
+SHORT x;
+    if(x1>x2){
+        x = x1; x1 = x2; x2 = x;
+    }
+    for(x=x1; x<x2+1; x++)
         PutPixel(x,y);
 }
 #endif
 
+/*********************************************************************
+* Function: void PutPixelRow(SHORT x, SHORT y, WORD* pixels, WORD count)
+*
+* PreCondition: none
+*
+* Input: x,y - coordinates of the first pixel,
+*        pixels - pointer to the pixel colors,
+*        count - number of pixels
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: puts a horizontal row of pixels with individual colors
+*
+* Note: the current color is restored on exit
+*
+********************************************************************/
+#ifndef USE_DRV_PUTPIXELROW
+void PutPixelRow(SHORT x, SHORT y, WORD* pixels, WORD count){
+WORD color;
+    color = GetColor();
+    while(count--){
+        SetColor(*pixels++);
+        PutPixel(x++,y);
+    }
+    SetColor(color);
+}
+#endif
+
 /*********************************************************************
 * Function: void ClearDevice(void)
 *
@@ -1025,10 +1476,9 @@ SHORT x,y;
 ********************************************************************/
 #ifndef USE_DRV_CLEARDEVICE
 void ClearDevice(void){
-SHORT x,y;
+SHORT y;
     for(y=0; y<GetMaxY()+1; y++)
-    for(x=0; x<GetMaxX()+1; x++)
-        PutPixel(x,y);
+        HLine(0,GetMaxX(),y);
     MoveTo(0,0);
 }
 #endif
@@ -1077,32 +1527,137 @@ FONT_HEADER  header;
     _fontFirstChar = pHeader->firstChar;
     _fontLastChar =  pHeader->lastChar;
     _fontHeight =    pHeader->height;
+#ifdef USE_FONT_WIDTH_TABLE
+    if(font != _fontWidthFont)
+        LoadFontWidthTable(font, pHeader);
+#endif
 }
 #endif
 
+#ifdef USE_FONT_WIDTH_TABLE
 /*********************************************************************
-* Function: WORD OutText(XCHAR* textString)
+* Function: void LoadFontWidthTable(void* font, FONT_HEADER* pHeader)
 *
 * PreCondition: none
 *
-* Input: textString - pointer to text string
+* Input: font - pointer to the font image,
+*        pHeader - pointer to the font header
 *
-* Output: non-zero if drawing done (used for NON-BLOCKING configuration)
+* Output: none
 *
 * Side Effects: none
 *
-* Overview: outputs text from current position
+* Overview: copies the character widths of the font to the width table
 *
-* Note: none
+* Note: the table is not loaded if the font has more than 
+*       FONT_WIDTH_TABLE_SIZE characters
 *
 ********************************************************************/
-WORD OutText(XCHAR* textString){
-#ifndef USE_NONBLOCKING_CONFIG
-
-XCHAR ch;
-    while((unsigned XCHAR)15 < (unsigned XCHAR)(ch = *textString++))
-        OutChar(ch);
-    return 1;
+void LoadFontWidthTable(void* font, FONT_HEADER* pHeader){
+#ifdef USE_FONT_FLASH
+GLYPH_ENTRY* pChTable;
+#endif
+#ifdef USE_FONT_EXTERNAL
+GLYPH_ENTRY  chTable[FONT_WIDTH_READ_SIZE];
+WORD         block;
+WORD         index;
+#endif
+WORD         count;
+WORD         counter;
+
+    _fontWidthFont = NULL;
+    if(pHeader->lastChar < pHeader->firstChar)
+        return;
+    count = pHeader->lastChar - pHeader->firstChar + 1;
+    if(count > FONT_WIDTH_TABLE_SIZE)
+        return;
+
+    switch(*((SHORT*)font)){
+#ifdef USE_FONT_FLASH
+        case FLASH:
+            pChTable = (GLYPH_ENTRY*)(pHeader + 1);
+            for(counter=0; counter<count; counter++)
+                _fontWidth[counter] = pChTable[counter].width;
+            break;
+#endif
+#ifdef USE_FONT_EXTERNAL
+        case EXTERNAL:
+            for(counter=0; counter<count; counter+=block){
+                block = count - counter;
+                if(block > FONT_WIDTH_READ_SIZE)
+                    block = FONT_WIDTH_READ_SIZE;
+                ExternalMemoryCallback(font,
+                                       sizeof(FONT_HEADER)+sizeof(GLYPH_ENTRY)*counter,
+                                       sizeof(GLYPH_ENTRY)*block,
+                                       chTable);
+                for(index=0; index<block; index++)
+                    _fontWidth[counter+index] = chTable[index].width;
+            }
+            break;
+#endif
+        default:
+            return;
+    }
+
+    _fontWidthFirst = pHeader->firstChar;
+    _fontWidthCount = count;
+    _fontWidthFont = font;
+}
+#endif
+
+#if defined(USE_FONT_WIDTH_TABLE) || defined(USE_TEXT_WIDTH_CACHE)
+/*********************************************************************
+* Function: void ClearTextWidthCache(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: discards the font width table and the cached string widths
+*
+* Note: none
+*
+********************************************************************/
+void ClearTextWidthCache(void){
+#ifdef USE_TEXT_WIDTH_CACHE
+BYTE counter;
+
+    for(counter=0; counter<TEXT_WIDTH_CACHE_SIZE; counter++)
+        _textWidthCache[counter].font = NULL;
+#endif
+#ifdef USE_FONT_WIDTH_TABLE
+    _fontWidthFont = NULL;
+#endif
+}
+#endif
+
+/*********************************************************************
+* Function: WORD OutText(XCHAR* textString)
+*
+* PreCondition: none
+*
+* Input: textString - pointer to text string
+*
+* Output: non-zero if drawing done (used for NON-BLOCKING configuration)
+*
+* Side Effects: none
+*
+* Overview: outputs text from current position
+*
+* Note: none
+*
+********************************************************************/
+WORD OutText(XCHAR* textString){
+#ifndef USE_NONBLOCKING_CONFIG
+
+XCHAR ch;
+    while((unsigned XCHAR)15 < (unsigned XCHAR)(ch = *textString++))
+        OutChar(ch);
+    return 1;
 
 #else
 
@@ -1164,6 +1719,163 @@ static BYTE start = 1;
 #endif
 }
 
+#ifndef USE_DRV_FONT
+
+/*********************************************************************
+* Function: void OutCharRun(SHORT row, SHORT x, SHORT length)
+*
+* PreCondition: none
+*
+* Input: row - glyph row, x - first pixel in the row,
+*        length - number of pixels
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: draws a horizontal run of glyph pixels at the current
+*           cursor position for the current font orientation
+*
+* Note: none
+*
+********************************************************************/
+void OutCharRun(SHORT row, SHORT x, SHORT length){
+    if(_fontOrientation == ORIENT_HOR)
+        HLine(GetX()+x, GetX()+x+length-1, GetY()+row);
+    else
+        Bar(GetX()+row, GetY()-x-length+1, GetX()+row, GetY()-x);
+}
+
+#ifdef USE_GLYPH_CACHE
+/*********************************************************************
+* Function: void ClearGlyphCache(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: removes all glyphs from the cache
+*
+* Note: none
+*
+********************************************************************/
+void ClearGlyphCache(void){
+BYTE counter;
+
+    for(counter=0; counter<GLYPH_CACHE_SIZE; counter++)
+        _glyphCache[counter].font = NULL;
+}
+
+/*********************************************************************
+* Function: GLYPH_CACHE_ENTRY* GetCachedGlyph(XCHAR ch)
+*
+* PreCondition: none
+*
+* Input: ch - character code
+*
+* Output: pointer to the cache entry of the current font glyph,
+*         NULL if the glyph is not cached
+*
+* Side Effects: none
+*
+* Overview: looks for the glyph in the cache
+*
+* Note: none
+*
+********************************************************************/
+GLYPH_CACHE_ENTRY* GetCachedGlyph(XCHAR ch){
+GLYPH_CACHE_ENTRY* pEntry;
+BYTE counter;
+
+    pEntry = _glyphCache;
+    for(counter=0; counter<GLYPH_CACHE_SIZE; counter++){
+        if((pEntry->font == _font) && (pEntry->ch == ch)){
+            pEntry->used = ++_glyphCacheTime;
+            return pEntry;
+        }
+        pEntry++;
+    }
+    return NULL;
+}
+
+/*********************************************************************
+* Function: GLYPH_CACHE_ENTRY* CacheGlyph(XCHAR ch, BYTE width, BYTE* pImage)
+*
+* PreCondition: none
+*
+* Input: ch - character code, width - glyph width,
+*        pImage - pointer to the glyph image
+*
+* Output: pointer to the cache entry, NULL if the glyph has
+*         too many runs to be cached
+*
+* Side Effects: none
+*
+* Overview: converts the glyph image into runs and stores them
+*           in the least recently used cache entry
+*
+* Note: none
+*
+********************************************************************/
+GLYPH_CACHE_ENTRY* CacheGlyph(XCHAR ch, BYTE width, BYTE* pImage){
+GLYPH_CACHE_ENTRY* pEntry;
+GLYPH_RUN*   pRun;
+BYTE         counter;
+SHORT        xCnt, yCnt, start;
+BYTE         temp, mask;
+
+    // find free or least recently used entry
+    pEntry = _glyphCache;
+    for(counter=0; counter<GLYPH_CACHE_SIZE; counter++){
+        if(_glyphCache[counter].font == NULL){
+            pEntry = &_glyphCache[counter];
+            break;
+        }
+        if((WORD)(_glyphCacheTime - _glyphCache[counter].used) > (WORD)(_glyphCacheTime - pEntry->used))
+            pEntry = &_glyphCache[counter];
+    }
+
+    pEntry->font = NULL;
+    pRun = pEntry->run;
+    counter = 0;
+    for(yCnt=0; yCnt<_fontHeight; yCnt++){
+        mask = 0;
+        start = -1;
+        for(xCnt=0; xCnt<=width; xCnt++){
+            if(mask == 0){
+                temp = (xCnt<width) ? *pImage++ : 0;
+                mask = 0x80;
+            }
+            if((xCnt<width) && (temp&mask)){
+                if(start < 0)
+                    start = xCnt;
+            }else if(start >= 0){
+                if(counter == GLYPH_CACHE_RUNS)
+                    return NULL;
+                pRun->row = yCnt;
+                pRun->x = start;
+                pRun->length = xCnt-start;
+                pRun++;
+                counter++;
+                start = -1;
+            }
+            mask >>= 1;
+        }
+    }
+
+    pEntry->font = _font;
+    pEntry->ch = ch;
+    pEntry->width = width;
+    pEntry->runCount = counter;
+    pEntry->used = ++_glyphCacheTime;
+    return pEntry;
+}
+#endif
+
 /*********************************************************************
 * Function: void OutChar(XCHAR ch)
 *
@@ -1180,7 +1892,6 @@ static BYTE start = 1;
 * Note: none
 *
 ********************************************************************/
-#ifndef USE_DRV_FONT
 void OutChar(XCHAR ch){
 
 GLYPH_ENTRY* pChTable;
@@ -1193,8 +1904,14 @@ WORD         imageSize;
 DWORD_VAL    glyphOffset;
 #endif
 
+#ifdef USE_GLYPH_CACHE
+GLYPH_CACHE_ENTRY* pEntry;
+GLYPH_RUN*   pRun;
+BYTE         counter;
+#endif
+
 SHORT        chWidth;
-SHORT        xCnt, yCnt, x, y;
+SHORT        xCnt, yCnt, start;
 BYTE         temp, mask;
 
 
@@ -1203,6 +1920,11 @@ BYTE         temp, mask;
     if((unsigned XCHAR)ch>(unsigned XCHAR)_fontLastChar)
         return;
 
+#ifdef USE_GLYPH_CACHE
+    pEntry = GetCachedGlyph(ch);
+    if(pEntry == NULL){
+#endif
+
     switch(*((SHORT*)_font)){
 #ifdef USE_FONT_FLASH
         case FLASH:
@@ -1249,47 +1971,50 @@ BYTE         temp, mask;
         default:
             break;
     }
-    if(_fontOrientation == ORIENT_HOR){
-        y = GetY(); 
-        for(yCnt=0; yCnt<_fontHeight; yCnt++){        
-            x = GetX(); 
-            mask = 0;
-            for(xCnt=0; xCnt<chWidth; xCnt++){
-                if(mask == 0){
-                    temp = *pChImage++;
-                    mask = 0x80;
-                }
-                if(temp&mask){
-                    PutPixel(x,y);
-                }
-                x++;
-                mask >>= 1;
-            }
-            y++;
+
+#ifdef USE_GLYPH_CACHE
+        pEntry = CacheGlyph(ch, chWidth, pChImage);
+    }
+
+    if(pEntry != NULL){
+        // draw runs from the cache
+        chWidth = pEntry->width;
+        pRun = pEntry->run;
+        for(counter=0; counter<pEntry->runCount; counter++){
+            OutCharRun(pRun->row, pRun->x, pRun->length);
+            pRun++;
         }
-        // move cursor
-        _cursorX = x;
-    }else{
-        y = GetX(); 
-        for(yCnt=0; yCnt<_fontHeight; yCnt++){        
-            x = GetY(); 
+    }else
+#endif
+    {
+        // draw runs of set pixels in each glyph row
+        for(yCnt=0; yCnt<_fontHeight; yCnt++){
             mask = 0;
+            start = -1;
             for(xCnt=0; xCnt<chWidth; xCnt++){
                 if(mask == 0){
                     temp = *pChImage++;
                     mask = 0x80;
                 }
                 if(temp&mask){
-                    PutPixel(y,x);
+                    if(start < 0)
+                        start = xCnt;
+                }else if(start >= 0){
+                    OutCharRun(yCnt, start, xCnt-start);
+                    start = -1;
                 }
-                x--;
                 mask >>= 1;
             }
-            y++;
+            if(start >= 0)
+                OutCharRun(yCnt, start, chWidth-start);
         }
-        // move cursor
-        _cursorY = x;
     }
+
+    // move cursor
+    if(_fontOrientation == ORIENT_HOR)
+        _cursorX += chWidth;
+    else
+        _cursorY -= chWidth;
 }
 #endif
 
@@ -1318,12 +2043,51 @@ FONT_HEADER* pHeader;
 GLYPH_ENTRY  chTable;
 FONT_HEADER  header;
 #endif
+#ifdef USE_FONT_WIDTH_TABLE
+WORD         index;
+#endif
+#ifdef USE_TEXT_WIDTH_CACHE
+TEXT_WIDTH_ENTRY* pEntry;
+XCHAR*       pText;
+WORD         length;
+WORD         checksum;
+BYTE         counter;
+#endif
 SHORT        textWidth;
 //SHORT        temp;
 XCHAR        ch;
 XCHAR        fontFirstChar;
 XCHAR        fontLastChar;
 
+#ifdef USE_FONT_WIDTH_TABLE
+    if(font == _fontWidthFont){
+        textWidth = 0;
+        while((unsigned XCHAR)15<(unsigned XCHAR)(ch = *textString++)){
+            index = (WORD)((unsigned XCHAR)ch - _fontWidthFirst);
+            if(index < _fontWidthCount)
+                textWidth += _fontWidth[index];
+        }
+        return textWidth;
+    }
+#endif
+
+#ifdef USE_TEXT_WIDTH_CACHE
+    length = 0;
+    checksum = 0;
+    for(pText = textString; (unsigned XCHAR)15<(unsigned XCHAR)(ch = *pText); pText++){
+        checksum = (checksum<<5) - checksum + (unsigned XCHAR)ch;
+        length++;
+    }
+    pEntry = _textWidthCache;
+    for(counter=0; counter<TEXT_WIDTH_CACHE_SIZE; counter++, pEntry++){
+        if((pEntry->font == font) && (pEntry->text == textString) &&
+           (pEntry->length == length) && (pEntry->checksum == checksum))
+            return pEntry->width;
+    }
+    pText = textString;
+#endif
+
+    textWidth = 0;
     switch(*((SHORT*)font)){
 #ifdef USE_FONT_FLASH
         case FLASH:
@@ -1331,7 +2095,6 @@ XCHAR        fontLastChar;
             fontFirstChar = pHeader->firstChar;
             fontLastChar  = pHeader->lastChar;
             pChTable = (GLYPH_ENTRY*)(pHeader + 1);
-            textWidth = 0;
             while((unsigned XCHAR)15<(unsigned XCHAR)(ch = *textString++)){
                 if((unsigned XCHAR)ch<(unsigned XCHAR)fontFirstChar)
                     continue;
@@ -1339,14 +2102,13 @@ XCHAR        fontLastChar;
                     continue;
                 textWidth += (pChTable+((unsigned XCHAR)ch-(unsigned XCHAR)fontFirstChar))->width;
             }
-            return textWidth;
+            break;
 #endif
 #ifdef USE_FONT_EXTERNAL
         case EXTERNAL:
             ExternalMemoryCallback(font,0,sizeof(FONT_HEADER),&header);
             fontFirstChar = header.firstChar;
             fontLastChar =  header.lastChar;
-            textWidth = 0;
             while((unsigned XCHAR)15<(unsigned XCHAR)(ch = *textString++)){
                 if((unsigned XCHAR)ch<(unsigned XCHAR)fontFirstChar)
                     continue;
@@ -1358,11 +2120,24 @@ XCHAR        fontLastChar;
                                        &chTable);
                 textWidth += chTable.width;
             }
-            return textWidth;
+            break;
 #endif
         default:
             return 0;
     }
+
+#ifdef USE_TEXT_WIDTH_CACHE
+    pEntry = &_textWidthCache[_textWidthNext];
+    pEntry->font = font;
+    pEntry->text = pText;
+    pEntry->length = length;
+    pEntry->checksum = checksum;
+    pEntry->width = textWidth;
+    if(++_textWidthNext >= TEXT_WIDTH_CACHE_SIZE)
+        _textWidthNext = 0;
+#endif
+
+    return textWidth;
 }
 #endif
 
@@ -1442,6 +2217,43 @@ SHORT width;
     }
 }
 
+/*********************************************************************
+* Function: BYTE GetImageCompression(void* bitmap)
+*
+* PreCondition: none
+*
+* Input: bitmap - image pointer
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: returns image compression setting
+*
+* Note: none
+*
+********************************************************************/
+BYTE GetImageCompression(void* bitmap){
+#ifdef USE_BITMAP_EXTERNAL
+BYTE compression;
+#endif
+
+    switch(*((SHORT*)bitmap))
+    {
+#ifdef USE_BITMAP_FLASH
+        case FLASH:
+            return *(((BITMAP_FLASH*)bitmap)->address);
+#endif
+#ifdef USE_BITMAP_EXTERNAL
+        case EXTERNAL:
+            ExternalMemoryCallback(bitmap, 0, 1, &compression);
+            return compression;
+#endif
+        default:
+            return COMP_NONE;
+    }
+}
+
 /*********************************************************************
 * Function: SHORT GetImageHeight(void* bitmap)
 *
@@ -1479,6 +2291,40 @@ SHORT height;
     }
 }
 
+#if !defined(USE_DRV_PUTIMAGE) || defined(USE_COMP_RLE)
+/*********************************************************************
+* Function: void PutImageLine(SHORT left, SHORT top, WORD* pLine, WORD count, BYTE stretch)
+*
+* PreCondition: none
+*
+* Input: left,top - left top corner of the line,
+*        pLine - pointer to the line colors,
+*        count - number of pixels in the line,
+*        stretch - image stretch factor
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: writes an expanded image line stretch times, each copy
+*           one row below the previous one
+*
+* Note: the line holds only the pixels inside the screen, it starts
+*       at the left screen border if left is negative
+*
+********************************************************************/
+void PutImageLine(SHORT left, SHORT top, WORD* pLine, WORD count, BYTE stretch){
+BYTE stretchY;
+
+    if(count == 0)
+        return;
+    if(left < 0)
+        left = 0;
+    for(stretchY=0; stretchY<stretch; stretchY++)
+        PutPixelRow(left, top++, pLine, count);
+}
+#endif
+
 #ifndef USE_DRV_PUTIMAGE
 /*********************************************************************
 * Function: void PutImage(SHORT left, SHORT top, void* bitmap, BYTE stretch)
@@ -1503,6 +2349,13 @@ FLASH_BYTE* flashAddress;
 BYTE colorDepth;
 WORD colorTemp;
 
+#ifdef USE_COMP_RLE
+    if(GetImageCompression(bitmap) == COMP_RLE){
+        PutImageRLE(left, top, bitmap, stretch);
+        return;
+    }
+#endif
+
     // Save current color
     colorTemp = GetColor();
 
@@ -1548,17 +2401,17 @@ WORD colorTemp;
                 case 1:
                     PutImage1BPPExt(left, top, bitmap, stretch);
                     break;
-#ifdef	(COLOR_DEPTH >= 4)
+#if	(COLOR_DEPTH >= 4)
                 case 4:
                     PutImage4BPPExt(left, top, bitmap, stretch);
                     break;
 #endif
-#ifdef	(COLOR_DEPTH >= 8)
+#if	(COLOR_DEPTH >= 8)
                 case 8:
                     PutImage8BPPExt(left, top, bitmap, stretch);
                     break;
 #endif
-#ifdef	(COLOR_DEPTH == 16)
+#if	(COLOR_DEPTH == 16)
                 case 16:
                     PutImage16BPPExt(left, top, bitmap, stretch);
                     break;
@@ -1601,9 +2454,12 @@ register FLASH_BYTE* tempFlashAddress;
 BYTE temp;
 WORD sizeX, sizeY;
 WORD x,y;
-WORD xc,yc;
-BYTE stretchX,stretchY;
+SHORT xc,yc;
+BYTE stretchX;
 WORD pallete[2];
+WORD lineColor[SCREEN_HOR_SIZE];
+WORD count;
+WORD byteWidth;
 BYTE mask;
 
     // Move pointer to size information
@@ -1619,38 +2475,45 @@ BYTE mask;
     pallete[1] = *((FLASH_WORD*)flashAddress);
     flashAddress += 2;
 
+    // Line width in bytes
+    byteWidth = sizeX>>3;
+    if(sizeX&0x0007)
+        byteWidth++;
+
     yc = top;
     for(y=0; y<sizeY; y++){
-        tempFlashAddress = flashAddress;
-        for(stretchY = 0; stretchY<stretch; stretchY++){
-            flashAddress = tempFlashAddress;
+        if(yc > GetMaxY())
+            break;
+        if(yc+stretch > 0){
+            tempFlashAddress = flashAddress;
             mask = 0;
+            count = 0;
             xc = left;
             for(x=0; x<sizeX; x++){
 
                 // Read 8 pixels from flash
                 if(mask == 0){
-                    temp = *flashAddress;
-                    flashAddress++;
+                    temp = *tempFlashAddress;
+                    tempFlashAddress++;
                     mask = 0x80;
                 }
-                
-                // Set color
-                if(mask&temp){
-                    SetColor(pallete[1]);
-                }else{
-                    SetColor(pallete[0]);
-                }
 
-                // Write pixel to screen
+                // Expand pixel to the line
                 for(stretchX=0; stretchX<stretch; stretchX++){
-                    PutPixel(xc++, yc);
+                    if((WORD)xc < (WORD)(GetMaxX()+1))
+                        lineColor[count++] = pallete[(mask&temp)?1:0];
+                    xc++;
                 }
+                if(xc > GetMaxX())
+                    break;
+
                 // Shift to the next pixel
                 mask >>= 1;
-           }
-           yc++;
+            }
+            PutImageLine(left, yc, lineColor, count, stretch);
         }
+        flashAddress += byteWidth;
+        yc += stretch;
     }
 }
 
@@ -1678,10 +2541,14 @@ register FLASH_BYTE* flashAddress;
 register FLASH_BYTE* tempFlashAddress;
 WORD sizeX, sizeY;
 register WORD x,y;
-WORD xc,yc;
+SHORT xc,yc;
 BYTE temp;
-register BYTE stretchX,stretchY;
+WORD color;
+register BYTE stretchX;
 WORD pallete[16];
+WORD lineColor[SCREEN_HOR_SIZE];
+WORD count;
+WORD byteWidth;
 WORD counter;
 
     // Move pointer to size information
@@ -1699,31 +2566,44 @@ WORD counter;
         flashAddress += 2;
     }
 
+    // Line width in bytes
+    byteWidth = sizeX>>1;
+    if(sizeX&0x0001)
+        byteWidth++;
+
     yc = top;
     for(y=0; y<sizeY; y++){
-        tempFlashAddress = flashAddress;
-        for(stretchY = 0; stretchY<stretch; stretchY++){
-            flashAddress = tempFlashAddress;
+        if(yc > GetMaxY())
+            break;
+        if(yc+stretch > 0){
+            tempFlashAddress = flashAddress;
+            count = 0;
             xc = left;
             for(x=0; x<sizeX; x++){
                 // Read 2 pixels from flash
                 if(x&0x0001){
                     // second pixel in byte
-                    SetColor(pallete[temp>>4]);
+                    color = pallete[temp>>4];
                 }else{
-                    temp = *flashAddress;
-                    flashAddress++;
+                    temp = *tempFlashAddress;
+                    tempFlashAddress++;
                     // first pixel in byte
-                    SetColor(pallete[temp&0x0f]);
+                    color = pallete[temp&0x0f];
                 }
 
-                // Write pixel to screen       
+                // Expand pixel to the line
                 for(stretchX=0; stretchX<stretch; stretchX++){
-					PutPixel(xc++, yc);
+                    if((WORD)xc < (WORD)(GetMaxX()+1))
+                        lineColor[count++] = color;
+                    xc++;
                 }
+                if(xc > GetMaxX())
+                    break;
             }
-            yc++;
+            PutImageLine(left, yc, lineColor, count, stretch);
         }
+        flashAddress += byteWidth;
+        yc += stretch;
     }
 }
 
@@ -1748,15 +2628,17 @@ WORD counter;
 ********************************************************************/
 #if	(COLOR_DEPTH >= 8)
 void PutImage8BPP(SHORT left, SHORT top, FLASH_BYTE* bitmap, BYTE stretch){
-register DWORD_VAL address;
 register FLASH_BYTE* flashAddress;
 register FLASH_BYTE* tempFlashAddress;
 WORD sizeX, sizeY;
 WORD x,y;
-WORD xc,yc;
+SHORT xc,yc;
 BYTE temp;
-BYTE stretchX, stretchY;
+WORD color;
+BYTE stretchX;
 WORD pallete[256];
+WORD lineColor[SCREEN_HOR_SIZE];
+WORD count;
 WORD counter;
 
     // Move pointer to size information
@@ -1776,25 +2658,31 @@ WORD counter;
 
     yc = top;
     for(y=0; y<sizeY; y++){
-        tempFlashAddress = flashAddress;
-        for(stretchY = 0; stretchY<stretch; stretchY++){
-            flashAddress = tempFlashAddress;
+        if(yc > GetMaxY())
+            break;
+        if(yc+stretch > 0){
+            tempFlashAddress = flashAddress;
+            count = 0;
             xc = left;
             for(x=0; x<sizeX; x++){
                 // Read pixels from flash
-                temp = *flashAddress;
-                flashAddress++;
-
-                // Set color
-                SetColor(pallete[temp]);
+                temp = *tempFlashAddress;
+                tempFlashAddress++;
+                color = pallete[temp];
 
-                // Write pixel to screen       
+                // Expand pixel to the line
                 for(stretchX=0; stretchX<stretch; stretchX++){
-					PutPixel(xc++, yc);
+                    if((WORD)xc < (WORD)(GetMaxX()+1))
+                        lineColor[count++] = color;
+                    xc++;
                 }
+                if(xc > GetMaxX())
+                    break;
             }
-            yc++;
+            PutImageLine(left, yc, lineColor, count, stretch);
         }
+        flashAddress += sizeX;
+        yc += stretch;
     }
 }
 
@@ -1822,9 +2710,11 @@ register FLASH_WORD* flashAddress;
 register FLASH_WORD* tempFlashAddress;
 WORD sizeX, sizeY;
 register WORD x,y;
-WORD xc,yc;
-WORD temp;
-register BYTE stretchX,stretchY;
+SHORT xc,yc;
+WORD color;
+register BYTE stretchX;
+WORD lineColor[SCREEN_HOR_SIZE];
+WORD count;
 
     // Move pointer to size information
     flashAddress = (FLASH_WORD*)bitmap + 1;
@@ -1837,25 +2727,30 @@ register BYTE stretchX,stretchY;
 
     yc = top;
     for(y=0; y<sizeY; y++){
-        tempFlashAddress = flashAddress;
-        for(stretchY = 0; stretchY<stretch; stretchY++){
-            flashAddress = tempFlashAddress;
+        if(yc > GetMaxY())
+            break;
+        if(yc+stretch > 0){
+            tempFlashAddress = flashAddress;
+            count = 0;
             xc = left;
             for(x=0; x<sizeX; x++){
                 // Read pixels from flash
-                temp = *flashAddress;
-                flashAddress++;
-
-                // Set color
-                SetColor(temp);
+                color = *tempFlashAddress;
+                tempFlashAddress++;
 
-                // Write pixel to screen       
+                // Expand pixel to the line
                 for(stretchX=0; stretchX<stretch; stretchX++){
-					PutPixel(xc++, yc);
+                    if((WORD)xc < (WORD)(GetMaxX()+1))
+                        lineColor[count++] = color;
+                    xc++;
                 }
+                if(xc > GetMaxX())
+                    break;
             }
-            yc++;
+            PutImageLine(left, yc, lineColor, count, stretch);
         }
+        flashAddress += sizeX;
+        yc += stretch;
     }
 }
 
@@ -1886,6 +2781,7 @@ register DWORD      memOffset;
 BITMAP_HEADER       bmp;
 WORD                pallete[2];
 BYTE                lineBuffer[(SCREEN_HOR_SIZE/8)+1];
+WORD                lineColor[SCREEN_HOR_SIZE];
 BYTE*               pData; 
 SHORT               byteWidth;
 
@@ -1893,8 +2789,9 @@ BYTE                temp;
 BYTE                mask;
 WORD                sizeX, sizeY;
 WORD                x,y;
-WORD xc,yc;
-BYTE                stretchX, stretchY;
+SHORT               xc,yc;
+WORD                count;
+BYTE                stretchX;
 
     // Get bitmap header
     ExternalMemoryCallback(bitmap, 0, sizeof(BITMAP_HEADER), &bmp);
@@ -1916,13 +2813,16 @@ BYTE                stretchX, stretchY;
 
     yc = top;
     for(y=0; y<sizeY; y++){
+        if(yc > GetMaxY())
+            break;
+        if(yc+stretch > 0){
+
+            // Get line
+            ExternalMemoryCallback(bitmap, memOffset, byteWidth, lineBuffer);
 
-        // Get line
-        ExternalMemoryCallback(bitmap, memOffset, byteWidth, lineBuffer);
-        memOffset += byteWidth;
-        for(stretchY = 0; stretchY<stretch; stretchY++){
             pData = lineBuffer;
             mask = 0;
+            count = 0;
             xc = left;
             for(x=0; x<sizeX; x++){
 
@@ -1931,24 +2831,23 @@ BYTE                stretchX, stretchY;
                     temp = *pData++;
                     mask = 0x80;
                 }
-                
-                // Set color
-                if(mask&temp){
-                    SetColor(pallete[1]);
-                }else{
-                    SetColor(pallete[0]);
-                }
 
-                // Write pixel to screen
+                // Expand pixel to the line
                 for(stretchX=0; stretchX<stretch; stretchX++){
-					PutPixel(xc++, yc);
+                    if((WORD)xc < (WORD)(GetMaxX()+1))
+                        lineColor[count++] = pallete[(mask&temp)?1:0];
+                    xc++;
                 }
+                if(xc > GetMaxX())
+                    break;
 
                 // Shift to the next pixel
                 mask >>= 1;
-           }
-           yc++;
+            }
+            PutImageLine(left, yc, lineColor, count, stretch);
         }
+        memOffset += byteWidth;
+        yc += stretch;
     }
 }
 
@@ -1969,20 +2868,23 @@ BYTE                stretchX, stretchY;
 * Note: image must be located in external memory
 *
 ********************************************************************/
-#ifdef	(COLOR_DEPTH >= 4)
+#if	(COLOR_DEPTH >= 4)
 void PutImage4BPPExt(SHORT left, SHORT top, void* bitmap, BYTE stretch){
 register DWORD      memOffset;
 BITMAP_HEADER       bmp;
 WORD                pallete[16];
 BYTE                lineBuffer[(SCREEN_HOR_SIZE/2)+1];
+WORD                lineColor[SCREEN_HOR_SIZE];
 BYTE*               pData; 
 SHORT               byteWidth;
 
 BYTE                temp;
+WORD                color;
 WORD                sizeX, sizeY;
 WORD                x,y;
-WORD xc,yc;
-BYTE                stretchX, stretchY;
+SHORT               xc,yc;
+WORD                count;
+BYTE                stretchX;
 
     // Get bitmap header
     ExternalMemoryCallback(bitmap, 0, sizeof(BITMAP_HEADER), &bmp);
@@ -2004,33 +2906,41 @@ BYTE                stretchX, stretchY;
 
     yc = top;
     for(y=0; y<sizeY; y++){
+        if(yc > GetMaxY())
+            break;
+        if(yc+stretch > 0){
 
-        // Get line
-        ExternalMemoryCallback(bitmap, memOffset, byteWidth, lineBuffer);
-        memOffset += byteWidth;
-        for(stretchY = 0; stretchY<stretch; stretchY++){
+            // Get line
+            ExternalMemoryCallback(bitmap, memOffset, byteWidth, lineBuffer);
 
             pData = lineBuffer;
+            count = 0;
             xc = left;
             for(x=0; x<sizeX; x++){
 
                 // Read 2 pixels from flash
                 if(x&0x0001){
                     // second pixel in byte
-                    SetColor(pallete[temp>>4]);
+                    color = pallete[temp>>4];
                 }else{
                     temp = *pData++;
                     // first pixel in byte
-                    SetColor(pallete[temp&0x0f]);
+                    color = pallete[temp&0x0f];
                 }
 
-                // Write pixel to screen       
+                // Expand pixel to the line
                 for(stretchX=0; stretchX<stretch; stretchX++){
-					PutPixel(xc++, yc);
-				}
-           }
-           yc++;
+                    if((WORD)xc < (WORD)(GetMaxX()+1))
+                        lineColor[count++] = color;
+                    xc++;
+                }
+                if(xc > GetMaxX())
+                    break;
+            }
+            PutImageLine(left, yc, lineColor, count, stretch);
         }
+        memOffset += byteWidth;
+        yc += stretch;
     }
 }
 #endif
@@ -2051,19 +2961,21 @@ BYTE                stretchX, stretchY;
 * Note: image must be located in external memory
 *
 ********************************************************************/
-#ifdef	(COLOR_DEPTH >= 8)
+#if	(COLOR_DEPTH >= 8)
 void PutImage8BPPExt(SHORT left, SHORT top, void* bitmap, BYTE stretch){
 register DWORD      memOffset;
 BITMAP_HEADER       bmp;
 WORD                pallete[256];
 BYTE                lineBuffer[SCREEN_HOR_SIZE];
+WORD                lineColor[SCREEN_HOR_SIZE];
 BYTE*               pData; 
 
-BYTE                temp;
+WORD                color;
 WORD                sizeX, sizeY;
 WORD                x,y;
-WORD xc,yc;
-BYTE                stretchX, stretchY;
+SHORT               xc,yc;
+WORD                count;
+BYTE                stretchX;
 
     // Get bitmap header
     ExternalMemoryCallback(bitmap, 0, sizeof(BITMAP_HEADER), &bmp);
@@ -2080,26 +2992,33 @@ BYTE                stretchX, stretchY;
 
     yc = top;
     for(y=0; y<sizeY; y++){
+        if(yc > GetMaxY())
+            break;
+        if(yc+stretch > 0){
 
-        // Get line
-        ExternalMemoryCallback(bitmap, memOffset, sizeX, lineBuffer);
-        memOffset += sizeX;
-        for(stretchY = 0; stretchY<stretch; stretchY++){
+            // Get line
+            ExternalMemoryCallback(bitmap, memOffset, sizeX, lineBuffer);
 
             pData = lineBuffer;
+            count = 0;
             xc = left;
             for(x=0; x<sizeX; x++){
 
-                temp = *pData++;
-                SetColor(pallete[temp]);                    
+                color = pallete[*pData++];
 
-                // Write pixel to screen       
+                // Expand pixel to the line
                 for(stretchX=0; stretchX<stretch; stretchX++){
-					PutPixel(xc++, yc);
-				}
-           }
-           yc++;
+                    if((WORD)xc < (WORD)(GetMaxX()+1))
+                        lineColor[count++] = color;
+                    xc++;
+                }
+                if(xc > GetMaxX())
+                    break;
+            }
+            PutImageLine(left, yc, lineColor, count, stretch);
         }
+        memOffset += sizeX;
+        yc += stretch;
     }
 }
 #endif
@@ -2117,22 +3036,26 @@ BYTE                stretchX, stretchY;
 *
 * Overview: outputs monochrome image starting from left,top coordinates
 *
-* Note: image must be located in external memory
+* Note: image must be located in external memory,
+*       lines of images without stretch are written from the
+*       external memory buffer directly
 *
 ********************************************************************/
-#ifdef	(COLOR_DEPTH == 16)
+#if	(COLOR_DEPTH == 16)
 void PutImage16BPPExt(SHORT left, SHORT top, void* bitmap, BYTE stretch){
 register DWORD      memOffset;
 BITMAP_HEADER       bmp;
 WORD                lineBuffer[SCREEN_HOR_SIZE];
+WORD                lineColor[SCREEN_HOR_SIZE];
 WORD*               pData; 
 WORD                byteWidth;
 
-WORD                temp;
+WORD                color;
 WORD                sizeX, sizeY;
 WORD                x,y;
-WORD xc,yc;
-BYTE                stretchX, stretchY;
+SHORT               xc,yc;
+WORD                count;
+BYTE                stretchX;
 
     // Get bitmap header
     ExternalMemoryCallback(bitmap, 0, sizeof(BITMAP_HEADER), &bmp);
@@ -2148,31 +3071,317 @@ BYTE                stretchX, stretchY;
 
     yc = top; 
     for(y=0; y<sizeY; y++){
+        if(yc > GetMaxY())
+            break;
+        if(yc+stretch > 0){
 
-        // Get line
-        ExternalMemoryCallback(bitmap, memOffset, byteWidth, lineBuffer);
-        memOffset += byteWidth;
-        for(stretchY = 0; stretchY<stretch; stretchY++){
+            // Get line
+            ExternalMemoryCallback(bitmap, memOffset, byteWidth, lineBuffer);
 
             pData = lineBuffer;
+            if(stretch == 1){
+                // Skip the pixels outside of the screen
+                xc = (left < 0)? 0 : left;
+                count = 0;
+                if((xc < GetMaxX()+1) && (xc-left < (SHORT)sizeX)){
+                    pData += xc-left;
+                    count = sizeX-(xc-left);
+                    if(count > (WORD)(GetMaxX()+1-xc))
+                        count = GetMaxX()+1-xc;
+                }
+                PutImageLine(left, yc, pData, count, stretch);
+            }else{
+                count = 0;
+                xc = left;
+                for(x=0; x<sizeX; x++){
+
+                    color = *pData++;
+
+                    // Expand pixel to the line
+                    for(stretchX=0; stretchX<stretch; stretchX++){
+                        if((WORD)xc < (WORD)(GetMaxX()+1))
+                            lineColor[count++] = color;
+                        xc++;
+                    }
+                    if(xc > GetMaxX())
+                        break;
+                }
+                PutImageLine(left, yc, lineColor, count, stretch);
+            }
+        }
+        memOffset += byteWidth;
+        yc += stretch;
+    }
+}
+#endif
 
-            xc = left;
-            for(x=0; x<sizeX; x++){
+#endif
 
-                temp = *pData++;
-                SetColor(temp);                    
+#endif // USE_DRV_PUTIMAGE
 
-                // Write pixel to screen       
+#ifdef USE_COMP_RLE
+/*********************************************************************
+* Function: BYTE RLEGetByte(RLE_READER* pReader)
+*
+* PreCondition: none
+*
+* Input: pReader - pointer to the image data reader
+*
+* Output: next byte of the compressed image data
+*
+* Side Effects: none
+*
+* Overview: reads the compressed image data byte by byte, external
+*           memory is read in blocks of RLE_BUFFER_SIZE bytes
+*
+* Note: none
+*
+********************************************************************/
+BYTE RLEGetByte(RLE_READER* pReader){
+#ifdef USE_BITMAP_FLASH
+BYTE temp;
+#endif
+
+    switch(*((SHORT*)pReader->bitmap))
+    {
+#ifdef USE_BITMAP_FLASH
+        case FLASH:
+            temp = *pReader->flashAddress;
+            pReader->flashAddress++;
+            return temp;
+#endif
+#ifdef USE_BITMAP_EXTERNAL
+        case EXTERNAL:
+            if(pReader->index == pReader->count){
+                ExternalMemoryCallback(pReader->bitmap, pReader->memOffset, RLE_BUFFER_SIZE, pReader->buffer);
+                pReader->memOffset += RLE_BUFFER_SIZE;
+                pReader->count = RLE_BUFFER_SIZE;
+                pReader->index = 0;
+            }
+            return pReader->buffer[pReader->index++];
+#endif
+        default:
+            return 0;
+    }
+}
+
+/*********************************************************************
+* Function: WORD RLEDecodeLine(RLE_READER* pReader, BYTE colorDepth, WORD* pallete, 
+*                              WORD sizeX, SHORT left, BYTE stretch, WORD* pLine)
+*
+* PreCondition: none
+*
+* Input: pReader - pointer to the image data reader,
+*        colorDepth - 4 or 8 bits per pixel,
+*        pallete - image pallete,
+*        sizeX - image width,
+*        left - image left border,
+*        stretch - image stretch factor,
+*        pLine - pointer to the line buffer (SCREEN_HOR_SIZE pixels)
+*
+* Output: number of pixels in the line buffer
+*
+* Side Effects: none
+*
+* Overview: decodes one image line up to the end of line escape and
+*           puts the colors of the pixels inside the screen to the
+*           line buffer
+*
+* Note: the line buffer starts at the left screen border if left is
+*       negative
+*
+********************************************************************/
+WORD RLEDecodeLine(RLE_READER* pReader, BYTE colorDepth, WORD* pallete, WORD sizeX, SHORT left, BYTE stretch, WORD* pLine){
+WORD  x;
+SHORT xc;
+WORD  count;
+WORD  color;
+BYTE  length;
+BYTE  value;
+BYTE  absolute;
+BYTE  counter;
+BYTE  stretchX;
+
+    x = 0;
+    xc = left;
+    count = 0;
+
+    while(!pReader->end){
+        length = RLEGetByte(pReader);
+        value = RLEGetByte(pReader);
+        absolute = 0;
+        if(length == 0){
+            // End of line
+            if(value == 0)
+                break;
+            // End of bitmap
+            if(value == 1){
+                pReader->end = 1;
+                break;
+            }
+            // Delta is not supported, skip it
+            if(value == 2){
+                RLEGetByte(pReader);
+                RLEGetByte(pReader);
+                continue;
+            }
+            // Absolute mode, value is the number of pixels
+            length = value;
+            absolute = 1;
+        }
+
+        for(counter=0; counter<length; counter++){
+            if(colorDepth == 8){
+                if(absolute)
+                    value = RLEGetByte(pReader);
+                color = pallete[value];
+            }else{
+                if(counter&0x01){
+                    // second pixel in byte
+                    color = pallete[value&0x0f];
+                }else{
+                    if(absolute)
+                        value = RLEGetByte(pReader);
+                    // first pixel in byte
+                    color = pallete[value>>4];
+                }
+            }
+
+            if(x < sizeX){
+                // Expand pixel to the line
                 for(stretchX=0; stretchX<stretch; stretchX++){
-					PutPixel(xc++, yc);
-				}
-           }
-           yc++;
+                    if((WORD)xc < (WORD)(GetMaxX()+1))
+                        pLine[count++] = color;
+                    xc++;
+                }
+                x++;
+            }
+        }
+
+        // Absolute mode data is padded to a word boundary
+        if(absolute){
+            if(colorDepth == 4)
+                length = (length+1)>>1;
+            if(length&0x01)
+                RLEGetByte(pReader);
+        }
+    }
+
+    // Missing pixels
+    color = pallete[0];
+    for(; x<sizeX; x++){
+        if(xc > GetMaxX())
+            break;
+        for(stretchX=0; stretchX<stretch; stretchX++){
+            if((WORD)xc < (WORD)(GetMaxX()+1))
+                pLine[count++] = color;
+            xc++;
         }
     }
+
+    return count;
 }
+
+/*********************************************************************
+* Function: void PutImageRLE(SHORT left, SHORT top, void* bitmap, BYTE stretch)
+*
+* PreCondition: none
+*
+* Input: left,top - left top image corner, bitmap - image pointer,
+*        stretch - image stretch factor
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: outputs RLE compressed 16 or 256 color image starting 
+*           from left,top coordinates
+*
+* Note: none
+*
+********************************************************************/
+void PutImageRLE(SHORT left, SHORT top, void* bitmap, BYTE stretch){
+RLE_READER          reader;
+#ifdef USE_BITMAP_FLASH
+FLASH_BYTE*         flashAddress;
 #endif
+#ifdef USE_BITMAP_EXTERNAL
+BITMAP_HEADER       bmp;
+#endif
+WORD                pallete[256];
+WORD                lineColor[SCREEN_HOR_SIZE];
+BYTE                colorDepth;
+WORD                sizeX, sizeY;
+WORD                counter;
+WORD                count;
+WORD                y;
+SHORT               yc;
 
+    reader.bitmap = bitmap;
+    reader.end = 0;
+
+    switch(*((SHORT*)bitmap))
+    {
+#ifdef USE_BITMAP_FLASH
+        case FLASH:
+            // Image address
+            flashAddress = ((BITMAP_FLASH*)bitmap)->address;
+            // Read color depth
+            colorDepth = *(flashAddress+1);
+            if((colorDepth != 4) && (colorDepth != 8))
+                return;
+            flashAddress += 2;
+
+            // Read image size
+            sizeY = *((FLASH_WORD*)flashAddress);
+            flashAddress += 2;
+            sizeX = *((FLASH_WORD*)flashAddress);
+            flashAddress += 2;
+
+            // Read pallete
+            for(counter=0; counter<(1<<colorDepth); counter++){
+                pallete[counter] = *((FLASH_WORD*)flashAddress);
+                flashAddress += 2;
+            }
+            reader.flashAddress = flashAddress;
+            break;
+#endif
+#ifdef USE_BITMAP_EXTERNAL
+        case EXTERNAL:
+            // Get bitmap header
+            ExternalMemoryCallback(bitmap, 0, sizeof(BITMAP_HEADER), &bmp);
+            colorDepth = bmp.colorDepth;
+            if((colorDepth != 4) && (colorDepth != 8))
+                return;
+            sizeX = bmp.width;
+            sizeY = bmp.height;
+
+            // Get pallete
+            ExternalMemoryCallback(bitmap, sizeof(BITMAP_HEADER), (1<<colorDepth)*sizeof(WORD), pallete);
+
+            // Set offset to the image data
+            reader.memOffset = sizeof(BITMAP_HEADER) + (1<<colorDepth)*sizeof(WORD);
+            reader.index = 0;
+            reader.count = 0;
+            break;
 #endif
+        default:
+            return;
+    }
 
-#endif // USE_DRV_PUTIMAGE
+#if defined(COLOR_DEPTH) && (COLOR_DEPTH < 8)
+    if(colorDepth > COLOR_DEPTH)
+        return;
+#endif
+
+    yc = top;
+    for(y=0; y<sizeY; y++){
+        if(yc > GetMaxY())
+            break;
+        count = RLEDecodeLine(&reader, colorDepth, pallete, sizeX, left, stretch, lineColor);
+        if(yc+stretch > 0)
+            PutImageLine(left, yc, lineColor, count, stretch);
+        yc += stretch;
+    }
+}
+#endif
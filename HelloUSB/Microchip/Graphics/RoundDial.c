@@ -115,76 +115,41 @@ void RdiaMsgDefault(WORD translatedMsg, ROUNDDIAL *pDia, GOL_MSG* pMsg)
 
 }
 
+#ifdef USE_KEYBOARD
+// Angle between two dial positions
+#define RDIA_POSITION_ANGLE     (90/RDIA_QUADRANT_POSITIONS)
+
 /*********************************************************************
 * Function: SHORT RdiaCosine( SHORT v )
 *
 *
-* Notes: Returns the cosine of the dial position.
+* Notes: Returns the cosine of the dial position scaled by 100.
+*        The positions in the 2nd and 4th quadrant are shifted by 
+*        one step to keep the original dimple positions.
 *
 ********************************************************************/
-
-#ifdef USE_KEYBOARD
-    // Dimple position table for 15 degree increments
-//    #define QUADRANT_POSITIONS     6
-//    SHORT   _cosine[QUADRANT_POSITIONS] = { 100, 97, 87, 71, 50, 26 };
-    SHORT   _cosine[RDIA_QUADRANT_POSITIONS] = { 100, 97, 87, 71, 50, 26 };
-#endif        
-
 SHORT RdiaCosine( SHORT v )
 {
-    if (v >= RDIA_QUADRANT_POSITIONS*3)
-    {
-        v -= RDIA_QUADRANT_POSITIONS*3;
-        return _cosine[RDIA_QUADRANT_POSITIONS-1 - v];
-    }
-    else if (v >= RDIA_QUADRANT_POSITIONS*2)    
-    {
-        v -= RDIA_QUADRANT_POSITIONS*2;
-        return -(_cosine[v]);
-    }
-    else if (v >= RDIA_QUADRANT_POSITIONS)
-    {
-        v -= RDIA_QUADRANT_POSITIONS;
-        return -(_cosine[RDIA_QUADRANT_POSITIONS-1 - v]);
-    }
-    else
-    {
-        return _cosine[v];
-    }    
+    if ((v/RDIA_QUADRANT_POSITIONS) & 1)
+        v++;
+    return (SHORT)(((LONG)GetCosine(v*RDIA_POSITION_ANGLE)*100 + (SINE_SCALE>>1)) >> SINE_SCALE_SHIFT);
 }            
     
 /*********************************************************************
 * Function: SHORT RdiaSine( SHORT v )
 *
 *
-* Notes: Returns the sine of the dial position.
+* Notes: Returns the sine of the dial position scaled by 100.
 *
 ********************************************************************/
-
 SHORT RdiaSine( SHORT v )
 {
-    if (v >= RDIA_QUADRANT_POSITIONS*3)
-    {
-        v -= RDIA_QUADRANT_POSITIONS*3;
-        return -(_cosine[v]);
-    }
-    else if (v >= RDIA_QUADRANT_POSITIONS*2)    
-    {
-        v -= RDIA_QUADRANT_POSITIONS*2;
-        return -(_cosine[RDIA_QUADRANT_POSITIONS-1 - v]);
-    }
-    else if (v >= RDIA_QUADRANT_POSITIONS)
-    {
-        v -= RDIA_QUADRANT_POSITIONS;
-        return _cosine[v];
-    }
-    else
-    {
-        return _cosine[RDIA_QUADRANT_POSITIONS-1 - v];
-    }
+    if (!((v/RDIA_QUADRANT_POSITIONS) & 1))
+        v++;
+    return (SHORT)(((LONG)GetSine(v*RDIA_POSITION_ANGLE)*100 + (SINE_SCALE>>1)) >> SINE_SCALE_SHIFT);
 }            
+#endif // USE_KEYBOARD
     
-        
 /*********************************************************************
 * Function: WORD RdiaTranslateMsg(ROUNDDIAL *pDia, GOL_MSG *pMsg)
 *
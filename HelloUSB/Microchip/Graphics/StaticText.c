@@ -158,7 +158,7 @@ XCHAR   ch = 0;
 
         case ST_STATE_IDLE:
         
-            SetClip(CLIP_DISABLE);
+            GOLResetClip();
 
            	if (GetState(pSt, ST_HIDE)) {
    	   	        SetColor(pSt->hdr.pGolScheme->CommonBkColor);
@@ -170,7 +170,8 @@ XCHAR   ch = 0;
 	       	if (GetState(pSt, ST_FRAME)) {
 		       	// show frame if specified to be shown
    	   	        SetLineType(SOLID_LINE);
-   	   	        SetLineThickness(NORMAL_LINE);	            if(!GetState(pSt,ST_DISABLED)){
+   	   	        SetLineThickness(NORMAL_LINE);
+	            if(!GetState(pSt,ST_DISABLED)){
 		            // show enabled color
     	   	        SetColor(pSt->hdr.pGolScheme->Color1);
 	    	        Rectangle(pSt->hdr.left,pSt->hdr.top,pSt->hdr.right,pSt->hdr.bottom);
@@ -183,9 +184,8 @@ XCHAR   ch = 0;
     	        }
     	    }
     	    // set clipping area, text will only appear inside the static text area.    
-            SetClip(CLIP_ENABLE);
-            SetClipRgn(pSt->hdr.left+ST_INDENT, pSt->hdr.top,   		\
-                       pSt->hdr.right-ST_INDENT, pSt->hdr.bottom);    
+            GOLSetClipRgn(pSt->hdr.left+ST_INDENT, pSt->hdr.top,   		\
+                          pSt->hdr.right-ST_INDENT, pSt->hdr.bottom);    
             state = ST_STATE_CLEANAREA;
 
         case ST_STATE_CLEANAREA:
@@ -204,14 +204,14 @@ XCHAR   ch = 0;
                 return 0;
 
 			// set the text color
-	        if(!GetState(pSt,ST_DISABLED)){
-	   	        SetColor(pSt->hdr.pGolScheme->TextColor0);
-	        }    
-	        else {
-	   	        SetColor(pSt->hdr.pGolScheme->TextColorDisabled);
-	        }    
-	        // use the font specified in the object
-	        SetFont(pSt->hdr.pGolScheme->pFont);
+            if(!GetState(pSt,ST_DISABLED)){
+                SetColor(pSt->hdr.pGolScheme->TextColor0);
+            }
+            else {
+                SetColor(pSt->hdr.pGolScheme->TextColorDisabled);
+            }
+            // use the font specified in the object
+            SetFont(pSt->hdr.pGolScheme->pFont);
 			pCurLine = pSt->pText;						// get first line of text
 			state = ST_STATE_SETALIGN;					// go to drawing of text
 
@@ -266,7 +266,7 @@ st_state_alignment:
 				pCurLine = NULL;							// reset static variables
 				lineCtr = 0;
 				charCtr = 0;
-	            SetClip(CLIP_DISABLE);						// remove clipping
+	            GOLResetClip();								// remove clipping
 				state = ST_STATE_IDLE;						// go back to IDLE state
 				return 1;
 			}	
@@ -56,9 +56,18 @@ typedef struct _BMPDECODER
         BYTE blCompressionType : 3;
         BYTE bNumOfPlanes : 3;
         BYTE b16bit565flag : 1;
-        BYTE aPalette[256][3]; /* Each palette entry has RGB */
+        WORD awPalette[256]; /* Each palette entry is in RGB565 format */
+      #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+        BYTE abPalette[256][3]; /* The same entries as R, G, B for the pixel output */
+      #endif
 } BMPDECODER;
 
+/**************************/
+/**** GLOBAL VARIABLES ****/
+/**************************/
+static BYTE BDEC_abRow[IMG_BMP_ROW_BUFFER_SIZE];   /* Raw pixel data read from the file */
+static WORD BDEC_awSpan[IMG_SPAN_BUFFER_SIZE];     /* Converted RGB565 pixels */
+
 /**************************/
 /******* FUNCTIONS  *******/
 /**************************/
@@ -178,220 +187,285 @@ BYTE BDEC_bReadHeader(BMPDECODER *pBmpDec)
                   if(pBmpDec->wPaletteEntries <= 256)
                   {
                           WORD wCounter;
+                          BYTE abEntry[4];
                           for(wCounter = 0; wCounter < pBmpDec->wPaletteEntries; wCounter++)
                           {
-                                     IMG_FREAD(&pBmpDec->aPalette[wCounter][2], sizeof(BYTE), 1, pBmpDec->pImageFile); /* R */
-                                     IMG_FREAD(&pBmpDec->aPalette[wCounter][1], sizeof(BYTE), 1, pBmpDec->pImageFile); /* G */
-                                     IMG_FREAD(&pBmpDec->aPalette[wCounter][0], sizeof(BYTE), 1, pBmpDec->pImageFile); /* B */
-                                     IMG_FREAD(&wWord, sizeof(BYTE), 1, pBmpDec->pImageFile); /* Dummy */
+                                     IMG_FREAD(abEntry, sizeof(abEntry), 1, pBmpDec->pImageFile); /* B, G, R, Dummy */
+                                     pBmpDec->awPalette[wCounter] = RGB565CONVERT(abEntry[2], abEntry[1], abEntry[0]);
+                                   #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+                                     pBmpDec->abPalette[wCounter][0] = abEntry[2];
+                                     pBmpDec->abPalette[wCounter][1] = abEntry[1];
+                                     pBmpDec->abPalette[wCounter][2] = abEntry[0];
+                                   #endif
                           }
                   }
         }
         return(0);
 }
 
+/* Appends one pixel to BDEC_awSpan and outputs the span when the buffer is full */
+#define BDEC_vAddPixel(color)                                    \
+        {                                                        \
+                BDEC_awSpan[wCount++] = (color);                 \
+                if(wCount == IMG_SPAN_BUFFER_SIZE)               \
+                {                                                \
+                        IMG_vPutSpan(wX, wY, wCount, BDEC_awSpan); \
+                        wX += wCount;                            \
+                        wCount = 0;                              \
+                }                                                \
+        }
+
 /*******************************************************************************
-Function:       BYTE BMP_bDecode(IMG_FILE *pFile)
+Function:       void BDEC_vPutPixels(BMPDECODER *pBmpDec, BYTE *pbData, WORD wBytes, WORD *pwX, WORD wY)
 
-Precondition:   None
+Precondition:   pbData holds whole pixels of one image row
 
-Overview:       This function decodes and displays a Bitmap image
+Overview:       This function converts a part of an image row to RGB565 and
+                outputs it as spans. Data beyond the image width (the row
+                padding) is ignored.
 
-Input:          Image file
+Input:          Bitmap decoder's data structure, raw row data, number of
+                bytes of row data, the column of the first pixel (updated to
+                the column following the last pixel), the image row
 
-Output:         Error code - '0' means no error
+Output:         None
 *******************************************************************************/
-BYTE BMP_bDecode(IMG_FILE *pFile)
+static void BDEC_vPutPixels(BMPDECODER *pBmpDec, BYTE *pbData, WORD wBytes, WORD *pwX, WORD wY)
 {
-        BMPDECODER BmpDec;
-        WORD wX, wY;
-        BYTE bPadding;
-
-        BDEC_vResetData(&BmpDec);
-        BmpDec.pImageFile = pFile;
-        BDEC_bReadHeader(&BmpDec);
-        if(BmpDec.blBmMarkerFlag == 0 || BmpDec.bHeaderType < 40 || (BmpDec.blCompressionType != 0 && BmpDec.blCompressionType != 3))
+        WORD wX = *pwX;                                /* Column of BDEC_awSpan[0] */
+        WORD wLeft = (WORD)pBmpDec->lWidth - wX;       /* Pixels of the row still to be output */
+        WORD wCount = 0;                               /* Pixels in BDEC_awSpan */
+        WORD *pwPalette = pBmpDec->awPalette;
+        WORD wColor;
+        BYTE bValue, bBits;
+
+        switch(pBmpDec->bBitsPerPixel)
         {
-            return 100;
-        }    
-        IMG_wImageWidth = (WORD)BmpDec.lWidth;
-        IMG_wImageHeight = (WORD)BmpDec.lHeight;
-        IMG_vSetboundaries();
+                case 24:
+                         for(; wBytes >= 3 && wLeft > 0; wBytes -= 3, wLeft--)
+                         {
+                                   BDEC_vAddPixel(RGB565CONVERT(pbData[2], pbData[1], pbData[0]));
+                                   pbData += 3;
+                         }
+                         break;
 
-        IMG_FSEEK(pFile, BmpDec.lImageOffset, 0);
-        if(BmpDec.wPaletteEntries == 0 && BmpDec.bBitsPerPixel == 8) /* Grayscale Image */
-        {
-                bPadding = (4 - (BmpDec.lWidth % 4))%4;
-                for(wY = 0; wY < BmpDec.lHeight; wY++)
-                {
-                         IMG_vLoopCallback();
-                         IMG_vCheckAndAbort();
-                         for(wX = 0; wX < BmpDec.lWidth; wX++)
+                case 16:
+                         for(; wBytes >= 2 && wLeft > 0; wBytes -= 2, wLeft--)
                          {
-                                   BYTE bY;
-                                   IMG_FREAD(&bY, sizeof(bY), 1, BmpDec.pImageFile); /* Y */
-                                   IMG_vSetColor(bY, bY, bY);
-                                   IMG_vPutPixel(wX, BmpDec.lHeight - wY - 1);
+                                   wColor = pbData[0] | ((WORD)pbData[1] << 8);
+                                   if(pBmpDec->b16bit565flag == 0)
+                                   {
+                                              wColor = ((wColor & 0x7FE0) << 1) | (wColor & 0x001F); /* RGB555 to RGB565 */
+                                   }
+                                   BDEC_vAddPixel(wColor);
+                                   pbData += 2;
                          }
-                         for(wX = 0; wX < bPadding; wX++)
+                         break;
+
+                case 8:
+                         for(; wBytes > 0 && wLeft > 0; wBytes--, wLeft--)
                          {
-                                   BYTE bValue;
-                                   IMG_FREAD(&bValue, sizeof(bValue), 1, BmpDec.pImageFile);
+                                   BDEC_vAddPixel(pwPalette[*pbData++]);
                          }
-                }
-        }
-        else if(BmpDec.bBitsPerPixel == 16) /* 16-bit Color Image */
-        {
-                bPadding = (4 - ((BmpDec.lWidth*2) % 4))%4;
-                for(wY = 0; wY < BmpDec.lHeight; wY++)
-                {
-                         IMG_vLoopCallback();
-                         IMG_vCheckAndAbort();
-                         for(wX = 0; wX < BmpDec.lWidth; wX++)
+                         break;
+
+                case 4:
+                         for(; wBytes > 0 && wLeft > 0; wBytes--)
                          {
-                                   WORD wColor;
-                                   BYTE bR, bG, bB;
-                                   IMG_FREAD(&wColor, sizeof(wColor), 1, BmpDec.pImageFile); /* RGB */
-                                   if(BmpDec.b16bit565flag == 1)
+                                   bValue = *pbData++;
+                                   BDEC_vAddPixel(pwPalette[bValue >> 4]);
+                                   if(--wLeft == 0)
                                    {
-                                              bR = (wColor >> 11) << 3;
-                                              bG = ((wColor & 0x07E0) >> 5) << 2;
-                                              bB = (wColor & 0x001F) << 3;
+                                              break;
                                    }
-                                   else
-                                   {
-                                              bR = ((wColor & 0x7FFF) >> 10) << 3;
-                                              bG = ((wColor & 0x03E0) >> 5) << 3;
-                                              bB = (wColor & 0x001F) << 3;
-                                   }
-                                   IMG_vSetColor(bR, bG, bB);
-                                   IMG_vPutPixel(wX, BmpDec.lHeight - wY - 1);
+                                   BDEC_vAddPixel(pwPalette[bValue & 0x0F]);
+                                   wLeft--;
                          }
-                         for(wX = 0; wX < bPadding; wX++)
+                         break;
+
+                case 1:
+                         for(; wBytes > 0 && wLeft > 0; wBytes--)
                          {
-                                   BYTE bValue;
-                                   IMG_FREAD(&bValue, sizeof(bValue), 1, BmpDec.pImageFile);
+                                   bValue = *pbData++;
+                                   for(bBits = 0; bBits < 8 && wLeft > 0; bBits++, wLeft--)
+                                   {
+                                              BDEC_vAddPixel(pwPalette[(bValue & 0x80)? 1: 0]);
+                                              bValue <<= 1;
+                                   }
                          }
-                }
+                         break;
         }
-        else if(BmpDec.bBitsPerPixel == 24) /* True color Image */
+
+        if(wCount > 0)
         {
-                bPadding = (4 - ((BmpDec.lWidth*3) % 4))%4;
-                for(wY = 0; wY < BmpDec.lHeight; wY++)
-                {
-                         IMG_vLoopCallback();
-                         IMG_vCheckAndAbort();
-                         for(wX = 0; wX < BmpDec.lWidth; wX++)
-                         {
-                                   BYTE bR, bG, bB;
-                                   IMG_FREAD(&bB, sizeof(bB), 1, BmpDec.pImageFile); /* B */
-                                   IMG_FREAD(&bG, sizeof(bG), 1, BmpDec.pImageFile); /* G */
-                                   IMG_FREAD(&bR, sizeof(bR), 1, BmpDec.pImageFile); /* R */
-                                   IMG_vSetColor(bR, bG, bB);
-                                   IMG_vPutPixel(wX, BmpDec.lHeight - wY - 1);
-                         }
-                         for(wX = 0; wX < bPadding; wX++)
-                         {
-                                   BYTE bValue;
-                                   IMG_FREAD(&bValue, sizeof(bValue), 1, BmpDec.pImageFile);
-                         }
-                }
+                IMG_vPutSpan(wX, wY, wCount, BDEC_awSpan);
+                wX += wCount;
         }
-        else if(BmpDec.wPaletteEntries != 0 && BmpDec.bBitsPerPixel == 1) /* B/W Image */
+        *pwX = wX;
+}
+
+#ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+/*******************************************************************************
+Function:       void BDEC_vPutPixelsRGB(BMPDECODER *pBmpDec, BYTE *pbData, WORD wBytes, WORD *pwX, WORD wY)
+
+Precondition:   pbData holds whole pixels of one image row
+
+Overview:       This function is BDEC_vPutPixels() for the pixel output. The
+                pixels keep their 8-bit color components.
+
+Input:          Bitmap decoder's data structure, raw row data, number of
+                bytes of row data, the column of the first pixel (updated to
+                the column following the last pixel), the image row
+
+Output:         None
+*******************************************************************************/
+static void BDEC_vPutPixelsRGB(BMPDECODER *pBmpDec, BYTE *pbData, WORD wBytes, WORD *pwX, WORD wY)
+{
+        BYTE abSpan[IMG_SPAN_BUFFER_SIZE * 3];         /* R, G, B of each pixel */
+        BYTE bBits = pBmpDec->bBitsPerPixel;
+        WORD wX = *pwX;                                /* Column of abSpan[0] */
+        WORD wPixels = (WORD)(((DWORD)wBytes * 8) / bBits);
+        WORD wCount = 0;                               /* Pixels in abSpan */
+        WORD wPixel, wColor;
+        BYTE bIndex, *pbPixel;
+
+        if(wPixels > (WORD)pBmpDec->lWidth - wX)
         {
-                WORD wBytesPerRow = BmpDec.lWidth/8;
-                BYTE bAdditionalBitsPerRow = BmpDec.lWidth % 8;
-                bPadding = (4 - ((wBytesPerRow + (bAdditionalBitsPerRow?1:0)) % 4))%4;
-                for(wY = 0; wY < BmpDec.lHeight; wY++)
+                wPixels = (WORD)pBmpDec->lWidth - wX;  /* Row padding */
+        }
+
+        for(wPixel = 0; wPixel < wPixels; wPixel++)
+        {
+                pbPixel = &abSpan[wCount * 3];
+                if(bBits == 24)
                 {
-                         BYTE bBits, bValue;
-                         IMG_vLoopCallback();
-                         IMG_vCheckAndAbort();
-                         for(wX = 0; wX < wBytesPerRow; wX++)
-                         {
-                                   IMG_FREAD(&bValue, sizeof(bValue), 1, BmpDec.pImageFile);
-                                   
-                                   for(bBits = 0; bBits < 8; bBits++)
-                                   {
-                                             BYTE bIndex = (bValue & (0x80 >> bBits))?1:0;
-                                             IMG_vSetColor(BmpDec.aPalette[bIndex][0], BmpDec.aPalette[bIndex][1], BmpDec.aPalette[bIndex][2]);
-                                             IMG_vPutPixel(wX*8+bBits, BmpDec.lHeight - wY - 1);
-                                   }
-                         }
-                         if(bAdditionalBitsPerRow > 0)
+                         pbPixel[0] = pbData[wPixel * 3 + 2];
+                         pbPixel[1] = pbData[wPixel * 3 + 1];
+                         pbPixel[2] = pbData[wPixel * 3];
+                }
+                else if(bBits == 16)
+                {
+                         wColor = pbData[wPixel * 2] | ((WORD)pbData[wPixel * 2 + 1] << 8);
+                         if(pBmpDec->b16bit565flag == 1)
                          {
-                                   IMG_FREAD(&bValue, sizeof(bValue), 1, BmpDec.pImageFile);
-                                   
-                                   for(bBits = 0; bBits < bAdditionalBitsPerRow; bBits++)
-                                   {
-                                             BYTE bIndex = (bValue & (0x80 >> bBits))?1:0;
-                                             IMG_vSetColor(BmpDec.aPalette[bIndex][0], BmpDec.aPalette[bIndex][1], BmpDec.aPalette[bIndex][2]);
-                                             IMG_vPutPixel(wX*8+bBits, BmpDec.lHeight - wY - 1);
-                                   }
+                                   pbPixel[0] = (wColor >> 11) << 3;
+                                   pbPixel[1] = ((wColor & 0x07E0) >> 5) << 2;
                          }
-                         for(wX = 0; wX < bPadding; wX++)
+                         else
                          {
-                                   BYTE bValue;
-                                   IMG_FREAD(&bValue, sizeof(bValue), 1, BmpDec.pImageFile);
+                                   pbPixel[0] = ((wColor & 0x7FFF) >> 10) << 3;
+                                   pbPixel[1] = ((wColor & 0x03E0) >> 5) << 3;
                          }
+                         pbPixel[2] = (wColor & 0x001F) << 3;
                 }
-        }
-        else if(BmpDec.wPaletteEntries != 0 && BmpDec.bBitsPerPixel == 4) /* 16 colors Image */
-        {
-                WORD wBytesPerRow = BmpDec.lWidth/2;
-                BYTE bAdditionalNibblePerRow = BmpDec.lWidth % 2;
-                bPadding = (4 - ((wBytesPerRow + bAdditionalNibblePerRow) % 4))%4;
-                for(wY = 0; wY < BmpDec.lHeight; wY++)
+                else
                 {
-                         IMG_vLoopCallback();
-                         IMG_vCheckAndAbort();
-                         for(wX = 0; wX < wBytesPerRow; wX++)
+                         if(bBits == 8)
                          {
-                                   BYTE bIndex, bValue;
-                                   IMG_FREAD(&bValue, sizeof(bValue), 1, BmpDec.pImageFile);
-                                   bIndex = bValue >> 4;
-                                   IMG_vSetColor(BmpDec.aPalette[bIndex][0], BmpDec.aPalette[bIndex][1], BmpDec.aPalette[bIndex][2]);
-                                   IMG_vPutPixel(wX*2, BmpDec.lHeight - wY - 1);
-                                   bIndex = bValue & 0x0F;
-                                   IMG_vSetColor(BmpDec.aPalette[bIndex][0], BmpDec.aPalette[bIndex][1], BmpDec.aPalette[bIndex][2]);
-                                   IMG_vPutPixel(wX*2+1, BmpDec.lHeight - wY - 1);
+                                   bIndex = pbData[wPixel];
                          }
-                         if(bAdditionalNibblePerRow)
+                         else if(bBits == 4)
                          {
-                                   BYTE bIndex, bValue;
-                                   IMG_FREAD(&bValue, sizeof(bValue), 1, BmpDec.pImageFile); /* Bits8 */
-                                   bIndex = bValue >> 4;
-                                   IMG_vSetColor(BmpDec.aPalette[bIndex][0], BmpDec.aPalette[bIndex][1], BmpDec.aPalette[bIndex][2]);
-                                   IMG_vPutPixel(wX*2, BmpDec.lHeight - wY - 1);
+                                   bIndex = (pbData[wPixel >> 1] >> ((wPixel & 1)? 0: 4)) & 0x0F;
                          }
-                         for(wX = 0; wX < bPadding; wX++)
+                         else
                          {
-                                   BYTE bValue;
-                                   IMG_FREAD(&bValue, sizeof(bValue), 1, BmpDec.pImageFile);
+                                   bIndex = (pbData[wPixel >> 3] >> (7 - (wPixel & 7))) & 0x01;
                          }
+                         pbPixel[0] = pBmpDec->abPalette[bIndex][0];
+                         pbPixel[1] = pBmpDec->abPalette[bIndex][1];
+                         pbPixel[2] = pBmpDec->abPalette[bIndex][2];
+                }
+
+                if(++wCount == IMG_SPAN_BUFFER_SIZE)
+                {
+                         IMG_vPutSpanRGB(wX, wY, wCount, abSpan);
+                         wX += wCount;
+                         wCount = 0;
                 }
         }
-        else if(BmpDec.wPaletteEntries != 0 && BmpDec.bBitsPerPixel == 8) /* 256 colors Image */
+
+        if(wCount > 0)
         {
-                bPadding = (4 - (BmpDec.lWidth % 4))%4;
-                for(wY = 0; wY < BmpDec.lHeight; wY++)
+                IMG_vPutSpanRGB(wX, wY, wCount, abSpan);
+                wX += wCount;
+        }
+        *pwX = wX;
+}
+#endif
+
+/*******************************************************************************
+Function:       BYTE BMP_bDecode(IMG_FILE *pFile)
+
+Precondition:   None
+
+Overview:       This function decodes and displays a Bitmap image. Each
+                padded row is read with as few IMG_FREAD calls as
+                IMG_BMP_ROW_BUFFER_SIZE allows and is output as spans.
+
+Input:          Image file
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+BYTE BMP_bDecode(IMG_FILE *pFile)
+{
+        BMPDECODER BmpDec;
+        WORD wX, wY;
+        WORD wRowBytes, wBytes, wCount;
+
+        BDEC_vResetData(&BmpDec);
+        BmpDec.pImageFile = pFile;
+        BDEC_bReadHeader(&BmpDec);
+        if(BmpDec.blBmMarkerFlag == 0 || BmpDec.bHeaderType < 40 || (BmpDec.blCompressionType != 0 && BmpDec.blCompressionType != 3))
+        {
+            return 100;
+        }    
+        IMG_wImageWidth = (WORD)BmpDec.lWidth;
+        IMG_wImageHeight = (WORD)BmpDec.lHeight;
+        IMG_vSetboundaries();
+
+        if(BmpDec.wPaletteEntries == 0 && BmpDec.bBitsPerPixel == 8) /* Grayscale Image */
+        {
+                for(wX = 0; wX < 256; wX++)
                 {
-                         IMG_vLoopCallback();
-                         IMG_vCheckAndAbort();
-                         for(wX = 0; wX < BmpDec.lWidth; wX++)
-                         {
-                                   BYTE bIndex;
-                                   IMG_FREAD(&bIndex, sizeof(bIndex), 1, BmpDec.pImageFile);
-                                   IMG_vSetColor(BmpDec.aPalette[bIndex][0], BmpDec.aPalette[bIndex][1], BmpDec.aPalette[bIndex][2]);
-                                   IMG_vPutPixel(wX, BmpDec.lHeight - wY - 1);
-                         }
-                         for(wX = 0; wX < bPadding; wX++)
-                         {
-                                   BYTE bValue;
-                                   IMG_FREAD(&bValue, sizeof(bValue), 1, BmpDec.pImageFile);
-                         }
+                         BmpDec.awPalette[wX] = RGB565CONVERT(wX, wX, wX);
+                       #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+                         BmpDec.abPalette[wX][0] = BmpDec.abPalette[wX][1] = BmpDec.abPalette[wX][2] = (BYTE)wX;
+                       #endif
                 }
         }
+        else if(BmpDec.bBitsPerPixel != 16 && BmpDec.bBitsPerPixel != 24 &&
+                (BmpDec.wPaletteEntries == 0 || (BmpDec.bBitsPerPixel != 1 && BmpDec.bBitsPerPixel != 4 && BmpDec.bBitsPerPixel != 8)))
+        {
+                return 0; /* Unsupported format, nothing is displayed */
+        }
+
+        /* Rows are padded to a multiple of 4 bytes */
+        wRowBytes = (WORD)(((BmpDec.lWidth * BmpDec.bBitsPerPixel + 31) / 32) * 4);
+
+        IMG_FSEEK(pFile, BmpDec.lImageOffset, 0);
+        for(wY = 0; wY < BmpDec.lHeight; wY++)
+        {
+                 IMG_vLoopCallback();
+                 IMG_vCheckAndAbort();
+                 wX = 0;
+                 for(wBytes = wRowBytes; wBytes > 0; wBytes -= wCount)
+                 {
+                           wCount = (wBytes > IMG_BMP_ROW_BUFFER_SIZE)? IMG_BMP_ROW_BUFFER_SIZE: wBytes;
+                           if(IMG_FREAD(BDEC_abRow, sizeof(BYTE), wCount, BmpDec.pImageFile) != wCount)
+                           {
+                                      return 0; /* Truncated file */
+                           }
+                         #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+                           if(IMG_bUseRGBOutput())
+                           {
+                                      BDEC_vPutPixelsRGB(&BmpDec, BDEC_abRow, wCount, &wX, BmpDec.lHeight - wY - 1);
+                                      continue;
+                           }
+                         #endif
+                           BDEC_vPutPixels(&BmpDec, BDEC_abRow, wCount, &wX, BmpDec.lHeight - wY - 1);
+                 }
+        }
 
         return 0;
 }
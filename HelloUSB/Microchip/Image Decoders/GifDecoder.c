@@ -62,6 +62,10 @@ typedef struct _GIFDECODER
         BYTE blInterlacedFlag : 1;
         BYTE blFirstcodeFlag : 1;
         BYTE bInterlacePass : 3;
+        BYTE blTransparentFlag : 1;
+        BYTE bDisposalMethod : 3;
+        BYTE bTransparentIndex;
+        WORD wDelayTime;                            /* In 1/100 seconds */
         #if GIF_USE_16_BITS_PER_PIXEL == 0
         BYTE aPalette[256][3]; /* Each palette entry has RGB */
         #else
@@ -76,6 +80,10 @@ typedef struct _GIFDECODER
         WORD awPrevSymbolPtr[(4096 * 3)/4];
         #endif
 
+        #if GIF_USE_STRING_TABLE == 1
+        WORD awStringLength[4096]; /* Number of pixels of each code's string */
+        #endif
+
         WORD wInitialSymbols;
         WORD wMaxSymbol;
         BYTE bInitialSymbolBits;
@@ -87,6 +95,10 @@ typedef struct _GIFDECODER
         BYTE bRemainingBits;
         WORD wCurrentX;
         WORD wCurrentY;
+        /* Palette indexes of the pixels of the current row waiting to be output */
+        BYTE abSpan[IMG_SPAN_BUFFER_SIZE];
+        WORD wSpanX;
+        WORD wSpanCount;
 } GIFDECODER;
 
 
@@ -129,6 +141,10 @@ static void GIF_vResetData(GIFDECODER *pGifDec)
     pGifDec->blInterlacedFlag = 0;
     pGifDec->blFirstcodeFlag = 1;
     pGifDec->bInterlacePass = 0;
+    pGifDec->blTransparentFlag = 0;
+    pGifDec->bDisposalMethod = 0;
+    pGifDec->bTransparentIndex = 0;
+    pGifDec->wDelayTime = 0;
     pGifDec->wMaxSymbol = 0;
     pGifDec->bMaxSymbolBits = 0;
     pGifDec->wInitialSymbols = 0;
@@ -138,6 +154,8 @@ static void GIF_vResetData(GIFDECODER *pGifDec)
     pGifDec->bRemainingBits = 0;
     pGifDec->wCurrentX = 0;
     pGifDec->wCurrentY = 0;
+    pGifDec->wSpanX = 0;
+    pGifDec->wSpanCount = 0;
     pGifDec->lGlobalColorTablePos = 0;
 }
 
@@ -245,6 +263,9 @@ static void GIF_vInitializeTable(GIFDECODER *pGifDec)
         {
                  pGifDec->abSymbol[wCounter] = wCounter;
                  GIF_vPutPrevCode(pGifDec, wCounter, pGifDec->wInitialSymbols);
+                 #if GIF_USE_STRING_TABLE == 1
+                 pGifDec->awStringLength[wCounter] = 1;
+                 #endif
         }
 }
 
@@ -340,11 +361,14 @@ Output:         Error code - '0' means no error
 *******************************************************************************/
 static BYTE GIF_bReadNextImageDescriptor(GIFDECODER *pGifDec)
 {
-       BYTE bSection, bSectionDetails, bBlockSize, bTemp;
+       BYTE bSection, bSectionDetails, bBlockSize;
        BYTE bFlags;
-       BYTE bCounter;
+       pGifDec->blTransparentFlag = 0; /* The graphics extension applies to one image only */
+       pGifDec->bDisposalMethod = 0;
+       pGifDec->wDelayTime = 0;
        do
        {
+            bSection = 0;
             IMG_FREAD(&bSection, sizeof(BYTE), 1, pGifDec->pImageFile);
             if(bSection == 0x21) /* Extension block */
             {
@@ -352,25 +376,32 @@ static BYTE GIF_bReadNextImageDescriptor(GIFDECODER *pGifDec)
                         switch(bSectionDetails)
                         {
 /* GRAPHICS EXTENSION */           case 0xF9: IMG_FREAD(&bBlockSize, sizeof(BYTE), 1, pGifDec->pImageFile);
+                                              if(bBlockSize >= 4)
+                                              {
+                                                    IMG_FREAD(&bFlags, sizeof(BYTE), 1, pGifDec->pImageFile);
+                                                    IMG_FREAD(&pGifDec->wDelayTime, sizeof(WORD), 1, pGifDec->pImageFile);
+                                                    IMG_FREAD(&pGifDec->bTransparentIndex, sizeof(BYTE), 1, pGifDec->pImageFile);
+                                                    pGifDec->blTransparentFlag = bFlags & 0x01;
+                                                    pGifDec->bDisposalMethod = (bFlags >> 2) & 0x07;
+                                                    bBlockSize -= 4;
+                                              }
                                               IMG_FSEEK(pGifDec->pImageFile, bBlockSize, 1);
                                               break;
 /* PLAIN TEXT EXTENSION */         case 0x01:
 /* APPLICATION EXTENSION */        case 0xFF: IMG_FREAD(&bBlockSize, sizeof(BYTE), 1, pGifDec->pImageFile);
                                               IMG_FSEEK(pGifDec->pImageFile, bBlockSize, 1);
-/* COMMENT EXTENSION */            case 0xFE: IMG_FREAD(&bBlockSize, sizeof(BYTE), 1, pGifDec->pImageFile);
-                                              for(bCounter = 0; bCounter < bBlockSize; bCounter++)
-                                              {
-                                                    IMG_FREAD(&bTemp, sizeof(BYTE), 1, pGifDec->pImageFile);
-                                              }
                                               break;
+/* COMMENT EXTENSION */            case 0xFE: break;
 
                                    default:   return(100);
                         }
-/* BLOCK TERMINATOR */  IMG_FREAD(&bTemp, sizeof(BYTE), 1, pGifDec->pImageFile);
-                        if(bTemp != 0)
+/* DATA SUB-BLOCKS */   do
                         {
-                                   return(100);
+                                   bBlockSize = 0;
+                                   IMG_FREAD(&bBlockSize, sizeof(BYTE), 1, pGifDec->pImageFile);
+                                   IMG_FSEEK(pGifDec->pImageFile, bBlockSize, 1);
                         }
+/* BLOCK TERMINATOR */  while(bBlockSize != 0 && !IMG_FEOF(pGifDec->pImageFile));
             }
             else if(bSection != 0x2C)
             {
@@ -389,14 +420,8 @@ static BYTE GIF_bReadNextImageDescriptor(GIFDECODER *pGifDec)
        IMG_FREAD(&pGifDec->wImageWidth, sizeof(WORD), 1, pGifDec->pImageFile);
        IMG_FREAD(&pGifDec->wImageHeight, sizeof(WORD), 1, pGifDec->pImageFile);
        IMG_FREAD(&bFlags, sizeof(BYTE), 1, pGifDec->pImageFile);  /* Packed fields */
-       if(bFlags & 0x40)
-       {
-            pGifDec->blInterlacedFlag = 1;
-       }
-       if(bFlags & 0x80)
-       {
-            pGifDec->blLocalColorTableFlag = 1;
-       }
+       pGifDec->blInterlacedFlag = (bFlags & 0x40)? 1: 0;
+       pGifDec->blLocalColorTableFlag = (bFlags & 0x80)? 1: 0;
        pGifDec->wLocalPaletteEntries = 0x01 << ((bFlags & 0x07) + 1);
        if(pGifDec->blLocalColorTableFlag == 1)
        {
@@ -490,107 +515,280 @@ static WORD GIF_wGetNextSymbol(GIFDECODER *pGifDec)
        return wDataBits;
 }
 
+#if GIF_USE_16_BITS_PER_PIXEL == 0 && !defined(IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT)
+/*******************************************************************************
+Function:       void GIF_vFlushSpanRGB(GIFDECODER *pGifDec)
+
+Precondition:   None
+
+Overview:       This function is GIF_vFlushSpan() for the pixel output. The
+                pixels keep the 8-bit color components of the palette.
+
+Input:          GIF decoder's data structure
+
+Output:         None
+*******************************************************************************/
+static void GIF_vFlushSpanRGB(GIFDECODER *pGifDec)
+{
+       BYTE abRGB[IMG_SPAN_BUFFER_SIZE * 3];
+       WORD wCounter, wStart = 0;
+       BYTE bIndex;
+
+       for(wCounter = 0; wCounter < pGifDec->wSpanCount; wCounter++)
+       {
+                bIndex = pGifDec->abSpan[wCounter];
+                if(pGifDec->blTransparentFlag == 1 && bIndex == pGifDec->bTransparentIndex)
+                {
+                         if(wCounter > wStart)
+                         {
+                                  IMG_vPutSpanRGB(pGifDec->wSpanX + wStart, pGifDec->wCurrentY, wCounter - wStart, &abRGB[wStart * 3]);
+                         }
+                         wStart = wCounter + 1;
+                         continue;
+                }
+                abRGB[wCounter * 3] = pGifDec->aPalette[bIndex][0];
+                abRGB[wCounter * 3 + 1] = pGifDec->aPalette[bIndex][1];
+                abRGB[wCounter * 3 + 2] = pGifDec->aPalette[bIndex][2];
+       }
+       if(wCounter > wStart)
+       {
+                IMG_vPutSpanRGB(pGifDec->wSpanX + wStart, pGifDec->wCurrentY, wCounter - wStart, &abRGB[wStart * 3]);
+       }
+       pGifDec->wSpanCount = 0;
+}
+#endif
+
+/*******************************************************************************
+Function:       void GIF_vFlushSpan(GIFDECODER *pGifDec)
+
+Precondition:   None
+
+Overview:       This function outputs the pixels collected so far in the
+                current row. Transparent pixels are left out, which splits
+                the span.
+
+Input:          GIF decoder's data structure
+
+Output:         None
+*******************************************************************************/
+static void GIF_vFlushSpan(GIFDECODER *pGifDec)
+{
+       WORD awColor[IMG_SPAN_BUFFER_SIZE];
+       WORD wCounter, wStart = 0;
+       BYTE bIndex;
+
+     #if GIF_USE_16_BITS_PER_PIXEL == 0 && !defined(IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT)
+       if(IMG_bUseRGBOutput())
+       {
+                GIF_vFlushSpanRGB(pGifDec);
+                return;
+       }
+     #endif
+
+       for(wCounter = 0; wCounter < pGifDec->wSpanCount; wCounter++)
+       {
+                bIndex = pGifDec->abSpan[wCounter];
+                if(pGifDec->blTransparentFlag == 1 && bIndex == pGifDec->bTransparentIndex)
+                {
+                         if(wCounter > wStart)
+                         {
+                                  IMG_vPutSpan(pGifDec->wSpanX + wStart, pGifDec->wCurrentY, wCounter - wStart, &awColor[wStart]);
+                         }
+                         wStart = wCounter + 1;
+                         continue;
+                }
+            #if GIF_USE_16_BITS_PER_PIXEL == 0
+                awColor[wCounter] = RGB565CONVERT(pGifDec->aPalette[bIndex][0], pGifDec->aPalette[bIndex][1], pGifDec->aPalette[bIndex][2]);
+            #else
+                awColor[wCounter] = pGifDec->awPalette[bIndex];
+            #endif
+       }
+       if(wCounter > wStart)
+       {
+                IMG_vPutSpan(pGifDec->wSpanX + wStart, pGifDec->wCurrentY, wCounter - wStart, &awColor[wStart]);
+       }
+       pGifDec->wSpanCount = 0;
+}
+
 /*******************************************************************************
-Function:       void GIF_vPaintData(GIFDECODER *pGifDec, BYTE bData)
+Function:       void GIF_vNextRow(GIFDECODER *pGifDec)
 
 Precondition:   pGifDec->blInterlacedFlag must be properly set
 
-Overview:       This function puts the actual pixel on the display. It also
-                takes care of the interlaced pixel arrangement.
+Overview:       This function outputs the rest of the current row and moves
+                to the next one. It also takes care of the interlaced row
+                arrangement.
 
-Input:          GIF decoder's data structure, palette index
+Input:          GIF decoder's data structure
 
 Output:         None
 *******************************************************************************/
-static void GIF_vPaintData(GIFDECODER *pGifDec, BYTE bData)
+static void GIF_vNextRow(GIFDECODER *pGifDec)
 {
-    #if GIF_USE_16_BITS_PER_PIXEL == 0
-        IMG_vSetColor(pGifDec->aPalette[bData][0], pGifDec->aPalette[bData][1], pGifDec->aPalette[bData][2]);
-    #else
-        IMG_vSetColor565(pGifDec->awPalette[bData]);
-    #endif
-       IMG_vPutPixel(pGifDec->wCurrentX, pGifDec->wCurrentY);
-       pGifDec->wCurrentX++;
-       if(pGifDec->wCurrentX >= pGifDec->wImageWidth)
+       GIF_vFlushSpan(pGifDec);
+       IMG_vLoopCallback();
+       pGifDec->wCurrentX = pGifDec->wImageX;
+       if(pGifDec->blInterlacedFlag == 0)
+       {
+                pGifDec->wCurrentY++;
+       }
+       else
        {
-                IMG_vLoopCallback();
-                pGifDec->wCurrentX = pGifDec->wImageX;
-                if(pGifDec->blInterlacedFlag == 0)
+                switch(pGifDec->bInterlacePass)
                 {
-                             pGifDec->wCurrentY++;
+                  case 0: pGifDec->wCurrentY += 8;
+                          break;
+                  case 1: pGifDec->wCurrentY += 8;
+                          break;
+                  case 2: pGifDec->wCurrentY += 4;
+                          break;
+                  case 3: pGifDec->wCurrentY += 2;
+                          break;
                 }
-                else
+                if(pGifDec->wCurrentY - pGifDec->wImageY >= pGifDec->wImageHeight)
                 {
-                             switch(pGifDec->bInterlacePass)
-                             {
-                               case 0: pGifDec->wCurrentY += 8;
-                                       break;
-                               case 1: pGifDec->wCurrentY += 8;
-                                       break;
-                               case 2: pGifDec->wCurrentY += 4;
-                                       break;
-                               case 3: pGifDec->wCurrentY += 2;
-                                       break;
-                             }
-                             if(pGifDec->wCurrentY - pGifDec->wImageY >= pGifDec->wImageHeight)
-                             {
-                                       switch(pGifDec->bInterlacePass)
-                                       {
-                                         case 0: pGifDec->wCurrentY = pGifDec->wImageY + 4;
-                                                 break;
-                                         case 1: pGifDec->wCurrentY = pGifDec->wImageY + 2;
-                                                 break;
-                                         case 2: pGifDec->wCurrentY = pGifDec->wImageY + 1;
-                                                 break;
-                                         case 3: pGifDec->wCurrentY = pGifDec->wImageY + 0;
-                                                 break;
-                                       }
-                                       pGifDec->bInterlacePass++;
-                             }
+                          switch(pGifDec->bInterlacePass)
+                          {
+                            case 0: pGifDec->wCurrentY = pGifDec->wImageY + 4;
+                                    break;
+                            case 1: pGifDec->wCurrentY = pGifDec->wImageY + 2;
+                                    break;
+                            case 2: pGifDec->wCurrentY = pGifDec->wImageY + 1;
+                                    break;
+                            case 3: pGifDec->wCurrentY = pGifDec->wImageY + 0;
+                                    break;
+                          }
+                          pGifDec->bInterlacePass++;
                 }
        }
 }
 
 /*******************************************************************************
-Function:       void GIF_vDisplayCode(GIFDECODER *pGifDec, WORD wCode)
+Function:       WORD GIF_wGetStringLength(GIFDECODER *pGifDec, WORD wCode)
 
 Precondition:   None
 
-Overview:       This function puts the stream of pixels corresponding to the
-                code. This uses recursion.
+Overview:       This function gets the number of pixels of the code's string.
+                Without the string table the code chain is traced.
 
 Input:          GIF decoder's data structure, code
 
-Output:         None
+Output:         Length of the string
 *******************************************************************************/
-static void GIF_vDisplayCode(GIFDECODER *pGifDec, WORD wCode)
+static WORD GIF_wGetStringLength(GIFDECODER *pGifDec, WORD wCode)
 {
-       WORD wPrevCode = GIF_wGetPrevCode(pGifDec, wCode);
-       if(wPrevCode != pGifDec->wInitialSymbols)
+    #if GIF_USE_STRING_TABLE == 1
+       return pGifDec->awStringLength[wCode];
+    #else
+       WORD wLength = 1;
+       while((wCode = GIF_wGetPrevCode(pGifDec, wCode)) != pGifDec->wInitialSymbols)
        {
-                GIF_vDisplayCode(pGifDec, wPrevCode);
+                wLength++;
        }
-       GIF_vPaintData(pGifDec, pGifDec->abSymbol[wCode]);
+       return wLength;
+    #endif
 }
 
 /*******************************************************************************
-Function:       BYTE GIF_bTraceFirstData(GIFDECODER *pGifDec, WORD wCode)
+Function:       BYTE GIF_bWriteString(GIFDECODER *pGifDec, WORD wCode)
 
 Precondition:   None
 
-Overview:       This function gets the first symbol of the code
+Overview:       This function puts the stream of pixels corresponding to the
+                code. As the code chain gives the pixels from the last one to
+                the first one, each piece of the string that fits into the
+                span and the row is filled in from its end, so no recursion
+                is needed. Only strings longer than the room left are traced
+                again for each piece.
 
 Input:          GIF decoder's data structure, code
 
 Output:         First symbol of the code
 *******************************************************************************/
-static BYTE GIF_bTraceFirstData(GIFDECODER *pGifDec, WORD wCode)
+static BYTE GIF_bWriteString(GIFDECODER *pGifDec, WORD wCode)
 {
-       while(GIF_wGetPrevCode(pGifDec, wCode) != pGifDec->wInitialSymbols)
+       WORD wLength = GIF_wGetStringLength(pGifDec, wCode);
+       WORD wRowEnd = pGifDec->wImageX + pGifDec->wImageWidth;
+       WORD wCount, wCounter, wChainCode;
+       BYTE *pbPixel;
+       BYTE bSymbol = 0, bFirstSymbol = 0;
+       BYTE blFirstPiece = 1;
+
+       while(wLength > 0)
        {
-                wCode = GIF_wGetPrevCode(pGifDec, wCode);
+                if(pGifDec->wSpanCount == 0)
+                {
+                         pGifDec->wSpanX = pGifDec->wCurrentX;
+                }
+                wCount = IMG_SPAN_BUFFER_SIZE - pGifDec->wSpanCount;
+                if(wCount > wRowEnd - pGifDec->wCurrentX)
+                {
+                         wCount = wRowEnd - pGifDec->wCurrentX;
+                }
+                if(wCount == 0) /* Empty image */
+                {
+                         break;
+                }
+                if(wCount > wLength)
+                {
+                         wCount = wLength;
+                }
+
+                /* The pixels after this piece are written in the next round */
+                wChainCode = wCode;
+                for(wCounter = wLength - wCount; wCounter > 0; wCounter--)
+                {
+                         wChainCode = GIF_wGetPrevCode(pGifDec, wChainCode);
+                }
+
+                pbPixel = &pGifDec->abSpan[pGifDec->wSpanCount + wCount];
+                for(wCounter = wCount; wCounter > 0; wCounter--)
+                {
+                         bSymbol = pGifDec->abSymbol[wChainCode];
+                         *--pbPixel = bSymbol;
+                         wChainCode = GIF_wGetPrevCode(pGifDec, wChainCode);
+                }
+                if(blFirstPiece == 1)
+                {
+                         bFirstSymbol = bSymbol;
+                         blFirstPiece = 0;
+                }
+
+                wLength -= wCount;
+                pGifDec->wSpanCount += wCount;
+                pGifDec->wCurrentX += wCount;
+                if(pGifDec->wSpanCount >= IMG_SPAN_BUFFER_SIZE)
+                {
+                         GIF_vFlushSpan(pGifDec);
+                }
+                if(pGifDec->wCurrentX >= wRowEnd)
+                {
+                         GIF_vNextRow(pGifDec);
+                }
        }
-       return pGifDec->abSymbol[wCode];
+       return bFirstSymbol;
+}
+
+/*******************************************************************************
+Function:       void GIF_vAddCode(GIFDECODER *pGifDec, WORD wPrefixCode, BYTE bSymbol)
+
+Precondition:   pGifDec->wMaxSymbol must be less than 4095
+
+Overview:       This function adds the string of the prefix code followed by
+                the symbol to the code table
+
+Input:          GIF decoder's data structure, prefix code, symbol
+
+Output:         None
+*******************************************************************************/
+static void GIF_vAddCode(GIFDECODER *pGifDec, WORD wPrefixCode, BYTE bSymbol)
+{
+       pGifDec->wMaxSymbol++;
+       GIF_vPutPrevCode(pGifDec, pGifDec->wMaxSymbol, wPrefixCode);
+       pGifDec->abSymbol[pGifDec->wMaxSymbol] = bSymbol;
+    #if GIF_USE_STRING_TABLE == 1
+       pGifDec->awStringLength[pGifDec->wMaxSymbol] = pGifDec->awStringLength[wPrefixCode] + 1;
+    #endif
 }
 
 /*******************************************************************************
@@ -626,7 +824,9 @@ Output:         Error code - '0' means no error
 static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
 {
         BYTE bBlockTerminator;
-        WORD wCode;
+        BYTE bBlockSize;
+        WORD wCode, wPrevCode = 0;
+        BYTE bFirstSymbol, bPrevFirstSymbol = 0;
         if(GIF_bReadNextImageDescriptor(pGifDec) != 0)
         {
             return(100);
@@ -648,9 +848,11 @@ static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
         {
                 IMG_vCheckAndAbort();
                 wCode = GIF_wGetNextSymbol(pGifDec);
-                if(wCode >= 4096)
+                if(wCode == 0xFFFF) /* Block terminator without an end code */
                 {
-                         return(100);
+                         IMG_FSEEK(pGifDec->pImageFile, -1, 1);
+                         pGifDec->bRemainingDataInBlock = 0;
+                         break;
                 }
                 if(wCode == pGifDec->wInitialSymbols) /* End code */
                 {
@@ -663,17 +865,11 @@ static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
                 }
                 if(wCode <= pGifDec->wMaxSymbol) /* Code exists */
                 {
-                         GIF_vDisplayCode(pGifDec, wCode);
+                         bFirstSymbol = GIF_bWriteString(pGifDec, wCode);
                          if(pGifDec->blFirstcodeFlag == 0 && pGifDec->wMaxSymbol < 4095)
                          {
-                                   pGifDec->wMaxSymbol++;
-                                   pGifDec->abSymbol[pGifDec->wMaxSymbol] = GIF_bTraceFirstData(pGifDec, wCode);
-                         }
-                         if(pGifDec->wMaxSymbol < 4095)
-                         {
-                                   GIF_vPutPrevCode(pGifDec, pGifDec->wMaxSymbol + 1, wCode);
+                                   GIF_vAddCode(pGifDec, wPrevCode, bFirstSymbol);
                          }
-                         pGifDec->blFirstcodeFlag = 0;
                 }
                 else if(wCode == pGifDec->wMaxSymbol + 1 && wCode <= 4095)
                 {
@@ -681,24 +877,24 @@ static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
                          {
                                    return(100);
                          }
-                         pGifDec->wMaxSymbol++;
-                         pGifDec->abSymbol[pGifDec->wMaxSymbol] = GIF_bTraceFirstData(pGifDec, GIF_wGetPrevCode(pGifDec, pGifDec->wMaxSymbol));
-                         GIF_vDisplayCode(pGifDec, wCode);
-                         if(pGifDec->wMaxSymbol < 4095)
-                         {
-                                   GIF_vPutPrevCode(pGifDec, pGifDec->wMaxSymbol + 1, wCode);
-                         }
+                         /* The code is the previous string followed by its own first symbol */
+                         GIF_vAddCode(pGifDec, wPrevCode, bPrevFirstSymbol);
+                         bFirstSymbol = GIF_bWriteString(pGifDec, wCode);
                 }
                 else
                 {
                          return(100);
                 }
+                pGifDec->blFirstcodeFlag = 0;
+                wPrevCode = wCode;
+                bPrevFirstSymbol = bFirstSymbol;
 
                 if((pGifDec->bMaxSymbolBits < 12) && (pGifDec->wMaxSymbol >= (0x01 << pGifDec->bMaxSymbolBits) - 1))
                 {
                          pGifDec->bMaxSymbolBits++;
                 }
         }
+        GIF_vFlushSpan(pGifDec); /* Output the last partial row */
         if(pGifDec->blLocalColorTableFlag == 1) /* Restore Global color table */
         {
                 if(pGifDec->lGlobalColorTablePos > 0)
@@ -709,18 +905,24 @@ static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
                          IMG_FSEEK(pGifDec->pImageFile, lFilePos, 0);
                 }
         }
+        /* Skip what is left of the image data up to the block terminator */
+        IMG_FSEEK(pGifDec->pImageFile, pGifDec->bRemainingDataInBlock, 1);
+        do
+        {
+                bBlockSize = 0;
+                IMG_FREAD(&bBlockSize, sizeof(BYTE), 1, pGifDec->pImageFile);
+                IMG_FSEEK(pGifDec->pImageFile, bBlockSize, 1);
+        }
+        while(bBlockSize != 0 && !IMG_FEOF(pGifDec->pImageFile));
+
+        bBlockTerminator = 0;
         IMG_FREAD(&bBlockTerminator, sizeof(BYTE), 1, pGifDec->pImageFile);
-        if(bBlockTerminator == 0)
+        if(bBlockTerminator == 0x3B || IMG_FEOF(pGifDec->pImageFile)) /* End of GIF stream */
         {
-                BYTE bTemp;
-                IMG_FREAD(&bTemp, sizeof(BYTE), 1, pGifDec->pImageFile);
-                if(bTemp == 0x3B) /* End of GIF stream */
-                {
-                         return 0x3B;
-                }
-                IMG_FSEEK(pGifDec->pImageFile, -1, 1);
+                return 0x3B;
         }
-        return bBlockTerminator;
+        IMG_FSEEK(pGifDec->pImageFile, -1, 1);
+        return 0;
 }
 
 /*******************************************************************************
@@ -751,5 +953,142 @@ BYTE GIF_bDecode(IMG_FILE *pFile)
         return GIF_bDecodeNextImage(&GifDec);
 }
 
+/*******************************************************************************
+Function:       void GIF_vFillArea(WORD wX, WORD wY, WORD wWidth, WORD wHeight, WORD wColor)
+
+Precondition:   IMG_vSetboundaries() has been called
+
+Overview:       This function fills an area of the image with one color
+
+Input:          Position and size of the area in image pixels, RGB565 color
+
+Output:         None
+*******************************************************************************/
+static void GIF_vFillArea(WORD wX, WORD wY, WORD wWidth, WORD wHeight, WORD wColor)
+{
+        WORD awColor[IMG_SPAN_BUFFER_SIZE];
+        WORD wRow, wColumn, wCount, wCounter;
+
+        for(wRow = wY; wRow < wY + wHeight; wRow++)
+        {
+                for(wColumn = wX; wColumn < wX + wWidth; wColumn += wCount)
+                {
+                         wCount = wX + wWidth - wColumn;
+                         if(wCount > IMG_SPAN_BUFFER_SIZE)
+                         {
+                                  wCount = IMG_SPAN_BUFFER_SIZE;
+                         }
+                         /* Refilled every time as IMG_vPutSpan changes the colors when downscaling */
+                         for(wCounter = 0; wCounter < wCount; wCounter++)
+                         {
+                                  awColor[wCounter] = wColor;
+                         }
+                         IMG_vPutSpan(wColumn, wRow, wCount, awColor);
+                }
+        }
+}
+
+/*******************************************************************************
+Function:       BYTE GIF_bAnimationStart(GIF_ANIMATION *pAnimation, IMG_FILE *pFile)
+
+Precondition:   None
+
+Overview:       This function reads the header of an animated GIF and sets up
+                the image boundaries. No frame is decoded.
+
+Input:          Animation state, Image file
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+BYTE GIF_bAnimationStart(GIF_ANIMATION *pAnimation, IMG_FILE *pFile)
+{
+        GIFDECODER GifDec;
+
+        GIF_vResetData(&GifDec);
+        GifDec.pImageFile = pFile;
+        GIF_bReadHeader(&GifDec);
+        if(GifDec.blGifMarkerFlag == 0)
+        {
+            return(100);
+        }
+        IMG_wImageWidth = GifDec.wScreenWidth;
+        IMG_wImageHeight = GifDec.wScreenHeight;
+        IMG_vSetboundaries();
+
+        pAnimation->pImageFile = pFile;
+        pAnimation->lFirstFramePos = IMG_FTELL(pFile);
+        pAnimation->lNextFramePos = pAnimation->lFirstFramePos;
+        pAnimation->wFrameX = 0;
+        pAnimation->wFrameY = 0;
+        pAnimation->wFrameWidth = 0;
+        pAnimation->wFrameHeight = 0;
+        pAnimation->bDisposalMethod = 0;
+        pAnimation->wBackgroundColor = 0;
+        if(GifDec.blGloabalColorTableFlag == 1)
+        {
+        #if GIF_USE_16_BITS_PER_PIXEL == 0
+            pAnimation->wBackgroundColor = RGB565CONVERT(GifDec.aPalette[GifDec.bBgColorIndex][0], GifDec.aPalette[GifDec.bBgColorIndex][1], GifDec.aPalette[GifDec.bBgColorIndex][2]);
+        #else
+            pAnimation->wBackgroundColor = GifDec.awPalette[GifDec.bBgColorIndex];
+        #endif
+        }
+        return(0);
+}
+
+/*******************************************************************************
+Function:       BYTE GIF_bDecodeNextFrame(GIF_ANIMATION *pAnimation, WORD *pwDelay)
+
+Precondition:   GIF_bAnimationStart() has been called
+
+Overview:       This function disposes the previous frame and decodes the next
+                one. Only the area of the frames is drawn. Disposal method 2
+                fills the frame area with the background color. Method 3
+                (restore to previous) is treated like method 1 as the pixels
+                can not be read back from the output. After the last frame
+                the animation starts over from the first one.
+
+Input:          Animation state, pointer to receive the delay in milliseconds
+                before the next frame should be shown
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+BYTE GIF_bDecodeNextFrame(GIF_ANIMATION *pAnimation, WORD *pwDelay)
+{
+        GIFDECODER GifDec;
+        BYTE bRetVal;
+
+        *pwDelay = 0;
+        if(pAnimation->bDisposalMethod == 2)
+        {
+            GIF_vFillArea(pAnimation->wFrameX, pAnimation->wFrameY, pAnimation->wFrameWidth, pAnimation->wFrameHeight, pAnimation->wBackgroundColor);
+        }
+        pAnimation->bDisposalMethod = 0;
+
+        /* The global color table is read again as the decoder does not keep it between frames */
+        GIF_vResetData(&GifDec);
+        GifDec.pImageFile = pAnimation->pImageFile;
+        IMG_FSEEK(pAnimation->pImageFile, 0, 0);
+        GIF_bReadHeader(&GifDec);
+        if(GifDec.blGifMarkerFlag == 0)
+        {
+            return(100);
+        }
+        IMG_FSEEK(pAnimation->pImageFile, pAnimation->lNextFramePos, 0);
+        bRetVal = GIF_bDecodeNextImage(&GifDec);
+        if(bRetVal != 0 && bRetVal != 0x3B)
+        {
+            return bRetVal;
+        }
+
+        pAnimation->wFrameX = GifDec.wImageX;
+        pAnimation->wFrameY = GifDec.wImageY;
+        pAnimation->wFrameWidth = GifDec.wImageWidth;
+        pAnimation->wFrameHeight = GifDec.wImageHeight;
+        pAnimation->bDisposalMethod = GifDec.bDisposalMethod;
+        pAnimation->lNextFramePos = (bRetVal == 0x3B)? pAnimation->lFirstFramePos: IMG_FTELL(pAnimation->pImageFile);
+        *pwDelay = (GifDec.wDelayTime > 6553)? 0xFFFF: GifDec.wDelayTime * 10;
+        return(0);
+}
+
 #endif
 #undef __GIFDECODER_C__
@@ -42,6 +42,9 @@ Pradeep Budagutta    03-Mar-2008    First release
    USB drive or from sd card, etc... */
 
 #include "Image Decoders\ImageDecoder.h"
+#ifdef IMG_SUPPORT_DECODED_IMAGE_CACHE
+#include <string.h>
+#endif
 
 /**************************/
 /**** GLOBAL VARIABLES ****/
@@ -53,11 +56,13 @@ WORD IMG_wHeight;
 WORD IMG_wImageWidth;
 WORD IMG_wImageHeight;
 BYTE IMG_bDownScalingFactor;
+BYTE IMG_bDecodeScale;
 BYTE IMG_bAlignCenter;
 BYTE IMG_blAbortImageDecoding;
 
 #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
 IMG_PIXEL_OUTPUT IMG_pPixelOutput;
+IMG_SPAN_OUTPUT IMG_pSpanOutput;
 IMG_PIXEL_XY_RGB_888 IMG_PixelXYColor;
 #endif
 
@@ -69,6 +74,36 @@ IMG_FILE_SYSTEM_API *IMG_pFileAPIs;
 IMG_LOOP_CALLBACK  IMG_pLoopCallbackFn;
 #endif
 
+#ifdef IMG_SUPPORT_DECODED_IMAGE_CACHE
+/* Header of a cache file, followed by the rows of RGB565 pixels */
+typedef struct _IMG_CACHE_HEADER
+{
+     BYTE abMarker[4];          /* "IMC1", written when all the pixels are in the file */
+     DWORD dwSourceSize;        /* Size and modification time of the image file */
+     WORD wSourceTime;
+     WORD wSourceDate;
+     WORD wWidth;               /* Area and flags the image was decoded for */
+     WORD wHeight;
+     WORD wFlags;
+     WORD wOffsetX;             /* Position of the pixels in the area */
+     WORD wOffsetY;
+     WORD wPixelWidth;          /* Size of the pixels */
+     WORD wPixelHeight;
+} IMG_CACHE_HEADER;
+
+static const BYTE IMG_abCacheMarker[4] = { 'I', 'M', 'C', '1' };
+
+static FSFILE *IMG_pCacheFile;                  /* Cache file being written, NULL if none */
+static IMG_CACHE_HEADER IMG_CacheHeader;
+static DWORD IMG_dwCachePixelsLeft;             /* Pixels not decoded yet */
+
+static void IMG_vCacheStart(void);
+static void IMG_vCacheSpan(WORD wX, WORD wY, WORD wCount, WORD *pwColor);
+#endif
+
+static WORD IMG_wScaleSpan(WORD *pwX, WORD *pwY, WORD wCount, WORD *pwColor, BYTE *pbRGB);
+static void IMG_vOutputSpan(WORD wX, WORD wY, WORD wCount, WORD *pwColor);
+
 /**************************/
 /*******************************************************************************
 Function:       void ImageDecoderInit(void)
@@ -92,6 +127,7 @@ void ImageDecoderInit(void)
 
    #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
      IMG_pPixelOutput = NULL;
+     IMG_pSpanOutput = NULL;
      IMG_PixelXYColor.X = 0;
      IMG_PixelXYColor.Y = 0;
      IMG_PixelXYColor.R = 0;
@@ -107,6 +143,11 @@ void ImageDecoderInit(void)
      IMG_pLoopCallbackFn = NULL;
    #endif
     IMG_blAbortImageDecoding = 0;
+    IMG_bDecodeScale = 1;
+
+   #ifdef IMG_SUPPORT_DECODED_IMAGE_CACHE
+     IMG_pCacheFile = NULL;
+   #endif
 }
 
 /*******************************************************************************
@@ -127,6 +168,24 @@ void ImageLoopCallbackRegister(IMG_LOOP_CALLBACK pLoopCallbackFn)
    #endif
 }
 
+/*******************************************************************************
+Function:       void ImageSpanOutputRegister(IMG_SPAN_OUTPUT pSpanOutput)
+
+Precondition:   None
+
+Overview:       This function registers the span output function
+
+Input:          Span output function pointer
+
+Output:         None
+*******************************************************************************/
+void ImageSpanOutputRegister(IMG_SPAN_OUTPUT pSpanOutput)
+{
+   #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+     IMG_pSpanOutput = pSpanOutput;
+   #endif
+}
+
 /*******************************************************************************
 Function:       BYTE ImageDecode(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat, WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight, WORD wFlags, IMG_FILE_SYSTEM_API *pFileAPIs, IMG_PIXEL_OUTPUT pPixelOutput)
 
@@ -155,6 +214,7 @@ BYTE ImageDecode(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat,
 
      IMG_bDownScalingFactor = (wFlags & IMG_DOWN_SCALE)? 1: 0;
      IMG_bAlignCenter = (wFlags & IMG_ALIGN_CENTER)? 1: 0;
+     IMG_bDecodeScale = 1;
 
    #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
      IMG_pPixelOutput = pPixelOutput;
@@ -184,6 +244,138 @@ BYTE ImageDecode(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat,
      return(bRetVal);
 }
 
+#ifdef IMG_SUPPORT_GIF
+/*******************************************************************************
+Function:       BYTE ImageAnimationStart(IMG_ANIMATION *pAnimation, IMG_FILE *pImageFile, WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight, WORD wFlags, IMG_FILE_SYSTEM_API *pFileAPIs, IMG_PIXEL_OUTPUT pPixelOutput)
+
+Precondition:   None
+
+Overview:       This function reads the header of an animated GIF and keeps
+                the resulting image position and scaling with the animation,
+                as other images may be decoded between its frames
+
+Input:          Animation, File pointer, Image position and boundaries, If center alignment and downscaling to fit into the display is required, File System API pointer and function to output the decoded pixels
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+BYTE ImageAnimationStart(IMG_ANIMATION *pAnimation, IMG_FILE *pImageFile,
+                         WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight,
+                         WORD wFlags, IMG_FILE_SYSTEM_API *pFileAPIs,
+                         IMG_PIXEL_OUTPUT pPixelOutput)
+{
+     BYTE bRetVal;
+
+     IMG_wStartX = wStartx;
+     IMG_wStartY = wStarty;
+     IMG_wWidth  = wWidth;
+     IMG_wHeight = wHeight;
+     IMG_wImageWidth = 0;
+     IMG_wImageHeight = 0;
+
+     IMG_bDownScalingFactor = (wFlags & IMG_DOWN_SCALE)? 1: 0;
+     IMG_bAlignCenter = (wFlags & IMG_ALIGN_CENTER)? 1: 0;
+     IMG_bDecodeScale = 1;
+
+   #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+     IMG_pPixelOutput = pPixelOutput;
+     pAnimation->pPixelOutput = pPixelOutput;
+   #endif
+
+   #ifndef IMG_USE_ONLY_MDD_FILE_SYSTEM_FOR_INPUT
+     IMG_pFileAPIs = pFileAPIs;
+     pAnimation->pFileAPIs = pFileAPIs;
+   #endif
+
+     bRetVal = GIF_bAnimationStart(&pAnimation->Gif, pImageFile);
+
+     pAnimation->wStartX = IMG_wStartX;
+     pAnimation->wStartY = IMG_wStartY;
+     pAnimation->wWidth = IMG_wWidth;
+     pAnimation->wHeight = IMG_wHeight;
+     pAnimation->wImageWidth = IMG_wImageWidth;
+     pAnimation->wImageHeight = IMG_wImageHeight;
+     pAnimation->bDownScalingFactor = IMG_bDownScalingFactor;
+     pAnimation->blFrameDue = 1;
+     pAnimation->dwNextFrameTime = 0;
+     return(bRetVal);
+}
+
+/*******************************************************************************
+Function:       BYTE ImageAnimationNextFrame(IMG_ANIMATION *pAnimation, WORD *pwDelay)
+
+Precondition:   ImageAnimationStart() has been called
+
+Overview:       This function restores the position and scaling of the
+                animation and draws its next frame
+
+Input:          Animation, pointer to receive the frame delay in milliseconds
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+BYTE ImageAnimationNextFrame(IMG_ANIMATION *pAnimation, WORD *pwDelay)
+{
+     IMG_wStartX = pAnimation->wStartX;
+     IMG_wStartY = pAnimation->wStartY;
+     IMG_wWidth  = pAnimation->wWidth;
+     IMG_wHeight = pAnimation->wHeight;
+     IMG_wImageWidth = pAnimation->wImageWidth;
+     IMG_wImageHeight = pAnimation->wImageHeight;
+     IMG_bDownScalingFactor = pAnimation->bDownScalingFactor;
+     IMG_bAlignCenter = 0;
+     IMG_bDecodeScale = 1;
+
+   #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+     IMG_pPixelOutput = pAnimation->pPixelOutput;
+   #endif
+
+   #ifndef IMG_USE_ONLY_MDD_FILE_SYSTEM_FOR_INPUT
+     IMG_pFileAPIs = pAnimation->pFileAPIs;
+   #endif
+
+     return GIF_bDecodeNextFrame(&pAnimation->Gif, pwDelay);
+}
+
+/*******************************************************************************
+Function:       BYTE ImageAnimationTask(IMG_ANIMATION *pAnimation, DWORD dwTime)
+
+Precondition:   ImageAnimationStart() has been called
+
+Overview:       This function draws the next frame of the animation when it
+                is due. The frames are scheduled from the time the previous
+                one was due so that the decoding time does not slow the
+                animation down, unless it has fallen behind by more than a
+                frame.
+
+Input:          Animation, current time in milliseconds
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+BYTE ImageAnimationTask(IMG_ANIMATION *pAnimation, DWORD dwTime)
+{
+     BYTE bRetVal;
+     WORD wDelay;
+
+     if(pAnimation->blFrameDue == 0 && (LONG)(dwTime - pAnimation->dwNextFrameTime) < 0)
+     {
+         return(0);
+     }
+
+     bRetVal = ImageAnimationNextFrame(pAnimation, &wDelay);
+     if(wDelay < 20) /* Like web browsers, very short delays are taken as 100ms */
+     {
+         wDelay = 100;
+     }
+
+     if(pAnimation->blFrameDue == 1 || (LONG)(dwTime - pAnimation->dwNextFrameTime) >= wDelay)
+     {
+         pAnimation->dwNextFrameTime = dwTime;
+     }
+     pAnimation->dwNextFrameTime += wDelay;
+     pAnimation->blFrameDue = 0;
+     return(bRetVal);
+}
+#endif
+
 /*******************************************************************************
 Function:       BYTE IMG_vSetboundaries(void)
 
@@ -232,6 +424,429 @@ void IMG_vSetboundaries(void)
              IMG_wStartY += (IMG_wHeight - (IMG_wImageHeight / bDownScalingFactor)) / 2;
          }
      }
+
+   #ifdef IMG_SUPPORT_DECODED_IMAGE_CACHE
+     if(IMG_pCacheFile != NULL)
+     {
+         IMG_vCacheStart();
+     }
+   #endif
 }
 
+/*******************************************************************************
+Function:       WORD IMG_wScaleSpan(WORD *pwX, WORD *pwY, WORD wCount, WORD *pwColor, BYTE *pbRGB)
+
+Precondition:   IMG_vSetboundaries() has been called
+
+Overview:       This function clips a horizontal run of decoded pixels to the
+                image and applies the downscaling factor. The pixels which
+                are kept are moved to the start of pwColor (RGB565) or of
+                pbRGB (R, G, B bytes), whichever is not NULL.
+
+Input:          Column and row of the first pixel (changed to the position in
+                the scaled image), number of pixels, RGB565 pixels or RGB888
+                pixels
+
+Output:         Number of pixels to output - '0' means none
+*******************************************************************************/
+static WORD IMG_wScaleSpan(WORD *pwX, WORD *pwY, WORD wCount, WORD *pwColor, BYTE *pbRGB)
+{
+     BYTE bScale = IMG_bDecodeScale;
+     WORD wX = *pwX, wY = *pwY;
+     WORD wDecodedWidth = (IMG_wImageWidth + bScale - 1) / bScale;
+     WORD wDecodedHeight = (IMG_wImageHeight + bScale - 1) / bScale;
+
+     if(wX >= wDecodedWidth || wY >= wDecodedHeight)
+     {
+         return 0;
+     }
+     if(wCount > wDecodedWidth - wX)
+     {
+         wCount = wDecodedWidth - wX;
+     }
+
+     if(IMG_bDownScalingFactor > 1)
+     {
+         BYTE bFactor = IMG_bDownScalingFactor;
+         DWORD dwPos;
+         WORD wFirst, wOut, wIndex;
+
+         /* Keep the row only if it covers an image row that is a multiple of
+            the scaling factor */
+         dwPos = (((DWORD)wY * bScale + bFactor - 1) / bFactor) * bFactor;
+         if(dwPos >= (DWORD)wY * bScale + bScale || dwPos >= IMG_wImageHeight)
+         {
+             return 0;
+         }
+         *pwY = (WORD)(dwPos / bFactor);
+
+         /* Keep only the columns that cover an image column which is a
+            multiple of the scaling factor */
+         dwPos = (((DWORD)wX * bScale + bFactor - 1) / bFactor) * bFactor;
+         wFirst = (WORD)(dwPos / bFactor);
+         for(wOut = 0; dwPos < IMG_wImageWidth; dwPos += bFactor, wOut++)
+         {
+             wIndex = (WORD)(dwPos / bScale) - wX;
+             if(wIndex >= wCount)
+             {
+                 break;
+             }
+             if(pwColor != NULL)
+             {
+                 pwColor[wOut] = pwColor[wIndex];
+             }
+             else
+             {
+                 pbRGB[wOut * 3] = pbRGB[wIndex * 3];
+                 pbRGB[wOut * 3 + 1] = pbRGB[wIndex * 3 + 1];
+                 pbRGB[wOut * 3 + 2] = pbRGB[wIndex * 3 + 2];
+             }
+         }
+
+         *pwX = wFirst;
+         wCount = wOut;
+     }
+     return wCount;
+}
+
+/*******************************************************************************
+Function:       void IMG_vPutSpan(WORD wX, WORD wY, WORD wCount, WORD *pwColor)
+
+Precondition:   IMG_vSetboundaries() has been called
+
+Overview:       This function outputs a horizontal run of decoded pixels. It
+                clips the run to the image, applies the downscaling factor and
+                the image position, and passes the result to PutPixelRow() of
+                the graphics driver, to the span output function, or pixel by
+                pixel to the pixel output. THIS IS NOT FOR THE USER.
+
+Input:          Column and row of the first pixel, number of pixels,
+                RGB565 pixels. When the decoder works at a reduced
+                resolution (IMG_bDecodeScale > 1) the column and row are
+                in units of IMG_bDecodeScale image pixels.
+
+Output:         None
+
+Note:           The contents of pwColor are changed when downscaling
+*******************************************************************************/
+void IMG_vPutSpan(WORD wX, WORD wY, WORD wCount, WORD *pwColor)
+{
+     wCount = IMG_wScaleSpan(&wX, &wY, wCount, pwColor, NULL);
+     if(wCount == 0)
+     {
+         return;
+     }
+
+   #ifdef IMG_SUPPORT_DECODED_IMAGE_CACHE
+     if(IMG_pCacheFile != NULL)
+     {
+         IMG_vCacheSpan(wX, wY, wCount, pwColor);
+     }
+   #endif
+
+     IMG_vOutputSpan(wX, wY, wCount, pwColor);
+}
+
+#ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+/*******************************************************************************
+Function:       void IMG_vPutSpanRGB(WORD wX, WORD wY, WORD wCount, BYTE *pbRGB)
+
+Precondition:   IMG_vSetboundaries() has been called, IMG_bUseRGBOutput()
+
+Overview:       This function is IMG_vPutSpan() for the decoders' 8-bit color
+                components. It passes the pixels to the pixel output without
+                reducing them to RGB565, only the cache file gets RGB565
+                pixels. THIS IS NOT FOR THE USER.
+
+Input:          Column and row of the first pixel (as for IMG_vPutSpan()),
+                number of pixels, R, G and B byte of each pixel
+
+Output:         None
+
+Note:           The contents of pbRGB are changed when downscaling
+*******************************************************************************/
+void IMG_vPutSpanRGB(WORD wX, WORD wY, WORD wCount, BYTE *pbRGB)
+{
+     WORD wCounter;
+
+     wCount = IMG_wScaleSpan(&wX, &wY, wCount, NULL, pbRGB);
+
+   #ifdef IMG_SUPPORT_DECODED_IMAGE_CACHE
+     if(IMG_pCacheFile != NULL)
+     {
+         WORD awColor[IMG_SPAN_BUFFER_SIZE];
+         WORD wDone, wPart;
+
+         for(wDone = 0; wDone < wCount; wDone += wPart)
+         {
+             wPart = wCount - wDone;
+             if(wPart > IMG_SPAN_BUFFER_SIZE)
+             {
+                 wPart = IMG_SPAN_BUFFER_SIZE;
+             }
+             for(wCounter = 0; wCounter < wPart; wCounter++)
+             {
+                 BYTE *pbPixel = &pbRGB[(wDone + wCounter) * 3];
+                 awColor[wCounter] = RGB565CONVERT(pbPixel[0], pbPixel[1], pbPixel[2]);
+             }
+             IMG_vCacheSpan(wX + wDone, wY, wPart, awColor);
+         }
+     }
+   #endif
+
+     IMG_PixelXYColor.Y = wY + IMG_wStartY;
+     for(wCounter = 0; wCounter < wCount; wCounter++, pbRGB += 3)
+     {
+         IMG_PixelXYColor.R = pbRGB[0];
+         IMG_PixelXYColor.G = pbRGB[1];
+         IMG_PixelXYColor.B = pbRGB[2];
+         IMG_PixelXYColor.X = wX + IMG_wStartX + wCounter;
+         IMG_pPixelOutput(&IMG_PixelXYColor);
+     }
+}
+#endif
+
+/*******************************************************************************
+Function:       void IMG_vOutputSpan(WORD wX, WORD wY, WORD wCount, WORD *pwColor)
+
+Precondition:   None
+
+Overview:       This function outputs a horizontal run of pixels at the image
+                position through the graphics driver, the span output function
+                or the pixel output function
+
+Input:          Column and row of the first pixel in the scaled image, number
+                of pixels, RGB565 pixels
+
+Output:         None
+*******************************************************************************/
+static void IMG_vOutputSpan(WORD wX, WORD wY, WORD wCount, WORD *pwColor)
+{
+   #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+     WORD wCounter;
+   #endif
+
+     wX += IMG_wStartX;
+     wY += IMG_wStartY;
+
+   #ifdef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+     PutPixelRow(wX, wY, pwColor, wCount);
+   #else
+     if(IMG_pSpanOutput != NULL)
+     {
+         IMG_pSpanOutput(wX, wY, wCount, pwColor);
+     }
+     else if(IMG_pPixelOutput != NULL)
+     {
+         IMG_PixelXYColor.Y = wY;
+         for(wCounter = 0; wCounter < wCount; wCounter++)
+         {
+             WORD wColor = pwColor[wCounter];
+             IMG_PixelXYColor.R = (BYTE)((wColor >> 8) & 0xF8) | (BYTE)(wColor >> 13);
+             IMG_PixelXYColor.G = (BYTE)((wColor >> 3) & 0xFC) | (BYTE)((wColor >> 9) & 0x03);
+             IMG_PixelXYColor.B = (BYTE)(wColor << 3) | (BYTE)((wColor >> 2) & 0x07);
+             IMG_PixelXYColor.X = wX + wCounter;
+             IMG_pPixelOutput(&IMG_PixelXYColor);
+         }
+     }
+   #endif
+}
+
+#ifdef IMG_SUPPORT_DECODED_IMAGE_CACHE
+/*******************************************************************************
+Function:       void IMG_vCacheStart(void)
+
+Precondition:   IMG_pCacheFile is open for writing, the boundaries are set
+
+Overview:       This function writes the header of the cache file and fills
+                the pixels with zeros so that the decoded spans can be written
+                to their place in any order. The marker is left out until all
+                the pixels have been written.
+
+Input:          None
+
+Output:         None
+*******************************************************************************/
+static void IMG_vCacheStart(void)
+{
+     WORD awZero[IMG_SPAN_BUFFER_SIZE];
+     BYTE bFactor = (IMG_bDownScalingFactor <= 1)? 1: IMG_bDownScalingFactor;
+     DWORD dwCount;
+     WORD wCount;
+
+     IMG_CacheHeader.wOffsetX = IMG_wStartX - IMG_CacheHeader.wOffsetX;
+     IMG_CacheHeader.wOffsetY = IMG_wStartY - IMG_CacheHeader.wOffsetY;
+     IMG_CacheHeader.wPixelWidth = (IMG_wImageWidth + bFactor - 1) / bFactor;
+     IMG_CacheHeader.wPixelHeight = (IMG_wImageHeight + bFactor - 1) / bFactor;
+     IMG_dwCachePixelsLeft = (DWORD)IMG_CacheHeader.wPixelWidth * IMG_CacheHeader.wPixelHeight;
+
+     FSfwrite(&IMG_CacheHeader, sizeof(IMG_CACHE_HEADER), 1, IMG_pCacheFile);
+     for(wCount = 0; wCount < IMG_SPAN_BUFFER_SIZE; wCount++)
+     {
+         awZero[wCount] = 0;
+     }
+     for(dwCount = IMG_dwCachePixelsLeft; dwCount > 0; dwCount -= wCount)
+     {
+         wCount = (dwCount > IMG_SPAN_BUFFER_SIZE)? IMG_SPAN_BUFFER_SIZE: (WORD)dwCount;
+         if(FSfwrite(awZero, sizeof(WORD), wCount, IMG_pCacheFile) != wCount)
+         {
+             IMG_dwCachePixelsLeft = 0xFFFFFFFF; /* The volume is full, the image is not cached */
+             break;
+         }
+     }
+}
+
+/*******************************************************************************
+Function:       void IMG_vCacheSpan(WORD wX, WORD wY, WORD wCount, WORD *pwColor)
+
+Precondition:   IMG_vCacheStart() has been called
+
+Overview:       This function writes a run of decoded pixels to its place in
+                the cache file
+
+Input:          Column and row of the first pixel in the scaled image, number
+                of pixels, RGB565 pixels
+
+Output:         None
+*******************************************************************************/
+static void IMG_vCacheSpan(WORD wX, WORD wY, WORD wCount, WORD *pwColor)
+{
+     if(wX >= IMG_CacheHeader.wPixelWidth || wY >= IMG_CacheHeader.wPixelHeight || IMG_dwCachePixelsLeft == 0xFFFFFFFF)
+     {
+         return;
+     }
+     if(wCount > IMG_CacheHeader.wPixelWidth - wX)
+     {
+         wCount = IMG_CacheHeader.wPixelWidth - wX;
+     }
+     if(FSfseek(IMG_pCacheFile, sizeof(IMG_CACHE_HEADER) + ((DWORD)wY * IMG_CacheHeader.wPixelWidth + wX) * sizeof(WORD), 0) != 0 ||
+        FSfwrite(pwColor, sizeof(WORD), wCount, IMG_pCacheFile) != wCount)
+     {
+         IMG_dwCachePixelsLeft = 0xFFFFFFFF; /* The cache file is incomplete, it is not committed */
+         return;
+     }
+     IMG_dwCachePixelsLeft -= (wCount < IMG_dwCachePixelsLeft)? wCount: IMG_dwCachePixelsLeft;
+}
+
+/*******************************************************************************
+Function:       BYTE IMG_bDrawCache(FSFILE *pCacheFile, IMG_CACHE_HEADER *pHeader)
+
+Precondition:   The position of the area is set in IMG_wStartX and IMG_wStartY,
+                the cache file points to the first pixel
+
+Overview:       This function copies the pixels of a cache file to the output
+
+Input:          Cache file, its header
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+static BYTE IMG_bDrawCache(FSFILE *pCacheFile, IMG_CACHE_HEADER *pHeader)
+{
+     WORD awColor[IMG_SPAN_BUFFER_SIZE];
+     WORD wX, wY, wCount;
+
+     IMG_wStartX += pHeader->wOffsetX;
+     IMG_wStartY += pHeader->wOffsetY;
+     for(wY = 0; wY < pHeader->wPixelHeight; wY++)
+     {
+         IMG_vCheckAndAbort();
+         for(wX = 0; wX < pHeader->wPixelWidth; wX += wCount)
+         {
+             wCount = pHeader->wPixelWidth - wX;
+             if(wCount > IMG_SPAN_BUFFER_SIZE)
+             {
+                 wCount = IMG_SPAN_BUFFER_SIZE;
+             }
+             if(FSfread(awColor, sizeof(WORD), wCount, pCacheFile) != wCount)
+             {
+                 return(100);
+             }
+             IMG_vOutputSpan(wX, wY, wCount, awColor);
+         }
+         IMG_vLoopCallback();
+     }
+     return(0);
+}
+
+/*******************************************************************************
+Function:       BYTE ImageDecodeCached(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat, WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight, WORD wFlags, IMG_PIXEL_OUTPUT pPixelOutput, const char *pCacheFileName)
+
+Precondition:   None
+
+Overview:       This function draws the image from its cache file when the
+                file is valid for the image, area and flags. Otherwise the
+                image is decoded and the cache file is written on the way.
+
+Input:          File pointer, Kind of image, Image position and boundaries, Flags, Function to output the decoded pixels, Name of the cache file
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+BYTE ImageDecodeCached(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat,
+                       WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight,
+                       WORD wFlags, IMG_PIXEL_OUTPUT pPixelOutput,
+                       const char *pCacheFileName)
+{
+     IMG_CACHE_HEADER CacheHeader;
+     FSFILE *pCacheFile;
+     BYTE bRetVal;
+
+     pCacheFile = FSfopen(pCacheFileName, READ);
+     if(pCacheFile != NULL)
+     {
+         if(FSfread(&CacheHeader, sizeof(IMG_CACHE_HEADER), 1, pCacheFile) == 1 &&
+            memcmp(CacheHeader.abMarker, IMG_abCacheMarker, 4) == 0 &&
+            CacheHeader.dwSourceSize == pImageFile->size &&
+            CacheHeader.wSourceTime == pImageFile->time &&
+            CacheHeader.wSourceDate == pImageFile->date &&
+            CacheHeader.wWidth == wWidth && CacheHeader.wHeight == wHeight &&
+            CacheHeader.wFlags == wFlags)
+         {
+             IMG_wStartX = wStartx;
+             IMG_wStartY = wStarty;
+           #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+             IMG_pPixelOutput = pPixelOutput;
+           #endif
+             bRetVal = IMG_bDrawCache(pCacheFile, &CacheHeader);
+             FSfclose(pCacheFile);
+             return(bRetVal);
+         }
+         FSfclose(pCacheFile);
+     }
+
+     /* The offsets hold the area position until IMG_vCacheStart() knows where the image is in it */
+     memset(IMG_CacheHeader.abMarker, 0, 4);
+     IMG_CacheHeader.dwSourceSize = pImageFile->size;
+     IMG_CacheHeader.wSourceTime = pImageFile->time;
+     IMG_CacheHeader.wSourceDate = pImageFile->date;
+     IMG_CacheHeader.wWidth = wWidth;
+     IMG_CacheHeader.wHeight = wHeight;
+     IMG_CacheHeader.wFlags = wFlags;
+     IMG_CacheHeader.wOffsetX = wStartx;
+     IMG_CacheHeader.wOffsetY = wStarty;
+     IMG_dwCachePixelsLeft = 0xFFFFFFFF;
+
+     IMG_pCacheFile = FSfopen(pCacheFileName, WRITEPLUS);
+     bRetVal = ImageDecode(pImageFile, eImgFormat, wStartx, wStarty, wWidth, wHeight, wFlags, NULL, pPixelOutput);
+     if(IMG_pCacheFile != NULL)
+     {
+         pCacheFile = IMG_pCacheFile;
+         IMG_pCacheFile = NULL;
+         /* GIF images end with their trailer 0x3B */
+         if((bRetVal == 0 || (eImgFormat == IMG_GIF && bRetVal == 0x3B)) && IMG_dwCachePixelsLeft == 0)
+         {
+             memcpy(IMG_CacheHeader.abMarker, IMG_abCacheMarker, 4);
+             FSfseek(pCacheFile, 0, 0);
+             FSfwrite(&IMG_CacheHeader, sizeof(IMG_CACHE_HEADER), 1, pCacheFile);
+             FSfclose(pCacheFile);
+         }
+         else
+         {
+             FSfclose(pCacheFile);
+             FSremove(pCacheFileName);
+         }
+     }
+     return(bRetVal);
+}
+#endif
+
 #undef __IMAGEDECODER_C__
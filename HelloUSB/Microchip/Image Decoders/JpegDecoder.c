@@ -40,6 +40,10 @@ Pradeep Budagutta    03-Mar-2008    First release
 
 #ifdef IMG_SUPPORT_JPEG
 
+#ifdef JPEG_SUPPORT_PROGRESSIVE
+#include <stdlib.h>
+#endif
+
 #define JPEG_SAMPLE_1x1 0
 #define JPEG_SAMPLE_1x2 1
 #define JPEG_SAMPLE_2x1 2
@@ -48,7 +52,15 @@ Pradeep Budagutta    03-Mar-2008    First release
 /*****************************/
 /**** FUNCTION PROTOTYPES ****/
 /*****************************/
+#if JPEG_USE_FAST_IDCT == 0
 void jpeg_idct_islow (SHORT *inbuf, WORD *quantptr);
+#else
+void jpeg_idct_ifast (SHORT *inbuf, WORD *quantptr, BYTE lastcoef);
+void jpeg_idct_ifast_scale_quant (WORD *quantptr);
+#endif
+void jpeg_idct_4x4 (SHORT *inbuf, WORD *quantptr);
+void jpeg_idct_2x2 (SHORT *inbuf, WORD *quantptr);
+void jpeg_idct_1x1 (SHORT *inbuf, WORD *quantptr);
 
 /*************************/
 /**** DATA STRUCTURES ****/
@@ -64,6 +76,7 @@ typedef struct _JPEGDECODER
         /*------- The x/y densities and thumbnail data are ignored --------*/
 
         /*********** From SOF0 ***********/
+        BYTE blProgressive;                     /* Progressive image (SOF2) */
         BYTE bDataBits;                         /* Data precision, can be 8(, 12 or 16) */
         WORD wWidth;                            /* Width in pixels */
         WORD wHeight;                           /* Height in pixels */
@@ -89,16 +102,28 @@ typedef struct _JPEGDECODER
         /*********** For Huffman-Decoding ***********/
         WORD awHuffAcSymStart[MAX_HUFF_TABLES][16]; /* Starting symbol for each length */
         WORD awHuffDcSymStart[MAX_HUFF_TABLES][16]; /* Starting symbol for each length */
+#if JPEG_HUFF_LOOKUP_BITS > 0
+        WORD awHuffAcLookup[MAX_HUFF_TABLES][1 << JPEG_HUFF_LOOKUP_BITS]; /* (Length << 8) | symbol of the short codes */
+        WORD awHuffDcLookup[MAX_HUFF_TABLES][1 << JPEG_HUFF_LOOKUP_BITS]; /* (Length << 8) | symbol of the short codes */
+#endif
 
         /*********** From SOS ***********/
         BYTE abChannelHuffAcTableMap[MAX_CHANNELS];
         BYTE abChannelHuffDcTableMap[MAX_CHANNELS];
-
+        BYTE bScanChannels;                     /* Number of channels in the scan */
+        BYTE abScanChannel[MAX_CHANNELS];       /* Channels in the scan */
+        BYTE bSpectralStart;                    /* First coefficient (zigzag order) in the scan */
+        BYTE bSpectralEnd;                      /* Last coefficient (zigzag order) in the scan */
+        BYTE bApproxHigh;                       /* Bit position of the previous scan, 0 for the first scan */
+        BYTE bApproxLow;                        /* Bit position of this scan */
+
+        BYTE blEndOfImage;                      /* EOI marker found */
         BYTE bError;
 
         /*********** Work memory ***********/
-        WORD wWorkBits;
+        DWORD dwWorkBits;                     /* Bit buffer, the next bit is the msb */
         BYTE bBitsAvailable;
+        BYTE blMarkerFound;                   /* A marker stops the bit buffer, zeros are fed afterwards */
         BYTE bBlocksInOnePass;
         SHORT asOneBlock[MAX_BLOCKS][64];     /* Temporary storage for a 8x8 block */
         WORD  wBlockNumber;
@@ -108,14 +133,23 @@ typedef struct _JPEGDECODER
         BYTE *pbCurrentHuffSymLenTable;
         BYTE *pbCurrentHuffSymbolTable;
         WORD *pwCurrentHuffSymStartTable;
+#if JPEG_HUFF_LOOKUP_BITS > 0
+        WORD *pwCurrentHuffLookupTable;
+#endif
         WORD *pwCurrentQuantTable;
         BYTE abDataBuffer[MAX_DATA_BUF_LEN];
         WORD wBufferLen;
         WORD wBufferIndex;
-        BYTE bFirstBit;
 
         WORD wPrevX;
         WORD wPrevY;
+        BYTE bScaleShift;                     /* Blocks are decoded to (8>>bScaleShift)x(8>>bScaleShift) pixels */
+        WORD wVisibleWidth;                   /* Image pixels which fall on the screen */
+        WORD wVisibleHeight;
+#ifdef JPEG_SUPPORT_PROGRESSIVE
+        WORD wEobRun;                         /* Number of blocks left in the current end of band run */
+        SHORT *psCoefficients;                /* 64 coefficients for each block of each MCU */
+#endif
 } JPEGDECODER;
 
 /**************************/
@@ -133,6 +167,101 @@ static const BYTE abZigzag[64] =
   53, 60, 61, 54, 47, 55, 62, 63
 };
 
+/* Chrominance contributions to the color components, indexed by the
+   chrominance sample + 128. The green contributions have 7 fractional bits,
+   the rounding constant is included in asCbToG */
+static const SHORT asCrToR[256] =
+{
+  -179, -178, -177, -175, -174, -172, -171, -170, -168, -167, -165, -164, -163, -161, -160, -158,
+  -157, -156, -154, -153, -151, -150, -149, -147, -146, -144, -143, -142, -140, -139, -137, -136,
+  -135, -133, -132, -130, -129, -128, -126, -125, -123, -122, -121, -119, -118, -116, -115, -114,
+  -112, -111, -109, -108, -107, -105, -104, -102, -101, -100,  -98,  -97,  -95,  -94,  -93,  -91,
+   -90,  -88,  -87,  -86,  -84,  -83,  -81,  -80,  -79,  -77,  -76,  -74,  -73,  -72,  -70,  -69,
+   -67,  -66,  -64,  -63,  -62,  -60,  -59,  -57,  -56,  -55,  -53,  -52,  -50,  -49,  -48,  -46,
+   -45,  -43,  -42,  -41,  -39,  -38,  -36,  -35,  -34,  -32,  -31,  -29,  -28,  -27,  -25,  -24,
+   -22,  -21,  -20,  -18,  -17,  -15,  -14,  -13,  -11,  -10,   -8,   -7,   -6,   -4,   -3,   -1,
+     0,    1,    3,    4,    6,    7,    8,   10,   11,   13,   14,   15,   17,   18,   20,   21,
+    22,   24,   25,   27,   28,   29,   31,   32,   34,   35,   36,   38,   39,   41,   42,   43,
+    45,   46,   48,   49,   50,   52,   53,   55,   56,   57,   59,   60,   62,   63,   64,   66,
+    67,   69,   70,   72,   73,   74,   76,   77,   79,   80,   81,   83,   84,   86,   87,   88,
+    90,   91,   93,   94,   95,   97,   98,  100,  101,  102,  104,  105,  107,  108,  109,  111,
+   112,  114,  115,  116,  118,  119,  121,  122,  123,  125,  126,  128,  129,  130,  132,  133,
+   135,  136,  137,  139,  140,  142,  143,  144,  146,  147,  149,  150,  151,  153,  154,  156,
+   157,  158,  160,  161,  163,  164,  165,  167,  168,  170,  171,  172,  174,  175,  177,  178
+};
+
+static const SHORT asCbToB[256] =
+{
+  -227, -225, -223, -221, -220, -218, -216, -214, -213, -211, -209, -207, -206, -204, -202, -200,
+  -198, -197, -195, -193, -191, -190, -188, -186, -184, -183, -181, -179, -177, -175, -174, -172,
+  -170, -168, -167, -165, -163, -161, -159, -158, -156, -154, -152, -151, -149, -147, -145, -144,
+  -142, -140, -138, -136, -135, -133, -131, -129, -128, -126, -124, -122, -120, -119, -117, -115,
+  -113, -112, -110, -108, -106, -105, -103, -101,  -99,  -97,  -96,  -94,  -92,  -90,  -89,  -87,
+   -85,  -83,  -82,  -80,  -78,  -76,  -74,  -73,  -71,  -69,  -67,  -66,  -64,  -62,  -60,  -58,
+   -57,  -55,  -53,  -51,  -50,  -48,  -46,  -44,  -43,  -41,  -39,  -37,  -35,  -34,  -32,  -30,
+   -28,  -27,  -25,  -23,  -21,  -19,  -18,  -16,  -14,  -12,  -11,   -9,   -7,   -5,   -4,   -2,
+     0,    2,    4,    5,    7,    9,   11,   12,   14,   16,   18,   19,   21,   23,   25,   27,
+    28,   30,   32,   34,   35,   37,   39,   41,   43,   44,   46,   48,   50,   51,   53,   55,
+    57,   58,   60,   62,   64,   66,   67,   69,   71,   73,   74,   76,   78,   80,   82,   83,
+    85,   87,   89,   90,   92,   94,   96,   97,   99,  101,  103,  105,  106,  108,  110,  112,
+   113,  115,  117,  119,  120,  122,  124,  126,  128,  129,  131,  133,  135,  136,  138,  140,
+   142,  144,  145,  147,  149,  151,  152,  154,  156,  158,  159,  161,  163,  165,  167,  168,
+   170,  172,  174,  175,  177,  179,  181,  183,  184,  186,  188,  190,  191,  193,  195,  197,
+   198,  200,  202,  204,  206,  207,  209,  211,  213,  214,  216,  218,  220,  222,  223,  225
+};
+
+static const SHORT asCbToG[256] =
+{
+    5702,   5658,   5614,   5570,   5526,   5482,   5438,   5394,   5350,   5306,   5262,   5218,
+    5174,   5130,   5086,   5042,   4998,   4953,   4909,   4865,   4821,   4777,   4733,   4689,
+    4645,   4601,   4557,   4513,   4469,   4425,   4381,   4337,   4293,   4249,   4205,   4161,
+    4117,   4072,   4028,   3984,   3940,   3896,   3852,   3808,   3764,   3720,   3676,   3632,
+    3588,   3544,   3500,   3456,   3412,   3368,   3324,   3280,   3236,   3192,   3147,   3103,
+    3059,   3015,   2971,   2927,   2883,   2839,   2795,   2751,   2707,   2663,   2619,   2575,
+    2531,   2487,   2443,   2399,   2355,   2311,   2266,   2222,   2178,   2134,   2090,   2046,
+    2002,   1958,   1914,   1870,   1826,   1782,   1738,   1694,   1650,   1606,   1562,   1518,
+    1474,   1430,   1385,   1341,   1297,   1253,   1209,   1165,   1121,   1077,   1033,    989,
+     945,    901,    857,    813,    769,    725,    681,    637,    593,    549,    504,    460,
+     416,    372,    328,    284,    240,    196,    152,    108,     64,     20,    -24,    -68,
+    -112,   -156,   -200,   -244,   -288,   -332,   -376,   -421,   -465,   -509,   -553,   -597,
+    -641,   -685,   -729,   -773,   -817,   -861,   -905,   -949,   -993,  -1037,  -1081,  -1125,
+   -1169,  -1213,  -1257,  -1302,  -1346,  -1390,  -1434,  -1478,  -1522,  -1566,  -1610,  -1654,
+   -1698,  -1742,  -1786,  -1830,  -1874,  -1918,  -1962,  -2006,  -2050,  -2094,  -2138,  -2183,
+   -2227,  -2271,  -2315,  -2359,  -2403,  -2447,  -2491,  -2535,  -2579,  -2623,  -2667,  -2711,
+   -2755,  -2799,  -2843,  -2887,  -2931,  -2975,  -3019,  -3064,  -3108,  -3152,  -3196,  -3240,
+   -3284,  -3328,  -3372,  -3416,  -3460,  -3504,  -3548,  -3592,  -3636,  -3680,  -3724,  -3768,
+   -3812,  -3856,  -3900,  -3944,  -3989,  -4033,  -4077,  -4121,  -4165,  -4209,  -4253,  -4297,
+   -4341,  -4385,  -4429,  -4473,  -4517,  -4561,  -4605,  -4649,  -4693,  -4737,  -4781,  -4825,
+   -4870,  -4914,  -4958,  -5002,  -5046,  -5090,  -5134,  -5178,  -5222,  -5266,  -5310,  -5354,
+   -5398,  -5442,  -5486,  -5530
+};
+
+static const SHORT asCrToG[256] =
+{
+   11700,  11609,  11518,  11426,  11335,  11243,  11152,  11061,  10969,  10878,  10786,  10695,
+   10603,  10512,  10421,  10329,  10238,  10146,  10055,   9964,   9872,   9781,   9689,   9598,
+    9507,   9415,   9324,   9232,   9141,   9050,   8958,   8867,   8775,   8684,   8592,   8501,
+    8410,   8318,   8227,   8135,   8044,   7953,   7861,   7770,   7678,   7587,   7496,   7404,
+    7313,   7221,   7130,   7039,   6947,   6856,   6764,   6673,   6581,   6490,   6399,   6307,
+    6216,   6124,   6033,   5942,   5850,   5759,   5667,   5576,   5485,   5393,   5302,   5210,
+    5119,   5028,   4936,   4845,   4753,   4662,   4570,   4479,   4388,   4296,   4205,   4113,
+    4022,   3931,   3839,   3748,   3656,   3565,   3474,   3382,   3291,   3199,   3108,   3017,
+    2925,   2834,   2742,   2651,   2559,   2468,   2377,   2285,   2194,   2102,   2011,   1920,
+    1828,   1737,   1645,   1554,   1463,   1371,   1280,   1188,   1097,   1006,    914,    823,
+     731,    640,    548,    457,    366,    274,    183,     91,      0,    -91,   -183,   -274,
+    -366,   -457,   -548,   -640,   -731,   -823,   -914,  -1006,  -1097,  -1188,  -1280,  -1371,
+   -1463,  -1554,  -1645,  -1737,  -1828,  -1920,  -2011,  -2102,  -2194,  -2285,  -2377,  -2468,
+   -2559,  -2651,  -2742,  -2834,  -2925,  -3017,  -3108,  -3199,  -3291,  -3382,  -3474,  -3565,
+   -3656,  -3748,  -3839,  -3931,  -4022,  -4113,  -4205,  -4296,  -4388,  -4479,  -4570,  -4662,
+   -4753,  -4845,  -4936,  -5028,  -5119,  -5210,  -5302,  -5393,  -5485,  -5576,  -5667,  -5759,
+   -5850,  -5942,  -6033,  -6124,  -6216,  -6307,  -6399,  -6490,  -6581,  -6673,  -6764,  -6856,
+   -6947,  -7039,  -7130,  -7221,  -7313,  -7404,  -7496,  -7587,  -7678,  -7770,  -7861,  -7953,
+   -8044,  -8135,  -8227,  -8318,  -8410,  -8501,  -8592,  -8684,  -8775,  -8867,  -8958,  -9050,
+   -9141,  -9232,  -9324,  -9415,  -9507,  -9598,  -9689,  -9781,  -9872,  -9964, -10055, -10146,
+  -10238, -10329, -10421, -10512, -10603, -10695, -10786, -10878, -10969, -11061, -11152, -11243,
+  -11335, -11426, -11518, -11609
+};
+
 /**************************/
 /******* FUNCTIONS  *******/
 /**************************/
@@ -296,9 +425,18 @@ static BYTE JPEG_bReadHeader(JPEGDECODER *pJpegDecoder)
              IMG_FREAD(&bsection, sizeof(bsection), 1, pJpegDecoder->pImageFile);
              switch(bsection)
              {
+               case EOI:  pJpegDecoder->blEndOfImage = TRUE;
+                          return 0;
+
+               case 0x00: /* Stuffed byte of the entropy coded data before a marker */
+                          break;
+
+               case 0xFF: /* Fill byte, the marker follows */
+                          IMG_FSEEK(pJpegDecoder->pImageFile, -1, 1);
+                          break;
+
                case SOI:
                case TEM:
-               case EOI:
                case RST0:
                case RST1:
                case RST2:
@@ -308,7 +446,16 @@ static BYTE JPEG_bReadHeader(JPEGDECODER *pJpegDecoder)
                case RST6:
                case RST7: break;
 
+#ifdef JPEG_SUPPORT_PROGRESSIVE
+               case SOF2: /* Start of progressive frame, the frame header is the same as SOF0 */
+                          pJpegDecoder->blProgressive = TRUE;
+#else
+               case SOF2: /* Progressive images are not supported */
+                          JPEG_SendError(100);
+                          break;
+#endif
                case SOF0: /* Start of frame */
+               case SOF1: /* Extended sequential frame, the same as SOF0 for 8-bit data */
                           wSegLen = JPEG_wReadWord(pJpegDecoder->pImageFile);
                           if(wSegLen <= 8)
                           {
@@ -421,6 +568,11 @@ static BYTE JPEG_bReadHeader(JPEGDECODER *pJpegDecoder)
                                      btemp = JPEG_bReadByte(pJpegDecoder->pImageFile);
                                      bHTableIndex = btemp & 0x0F;
                                      blIsAc = (btemp >> 4) & 0x01;
+                                     if(bHTableIndex >= MAX_HUFF_TABLES)
+                                     {
+                                               JPEG_SendError(100);
+                                               break;
+                                     }
                                      
                                      if(blIsAc == 0)
                                      {
@@ -463,9 +615,12 @@ static BYTE JPEG_bReadHeader(JPEGDECODER *pJpegDecoder)
                           }
 
                           btemp = JPEG_bReadByte(pJpegDecoder->pImageFile);
-                          wOffset = wSegLen - (3 + (btemp * 2));
+                          wOffset = wSegLen - (6 + (btemp * 2));
 
-                          if(pJpegDecoder->bChannels != btemp || wSegLen < 3 + (btemp * 2))
+                          /* A progressive scan can have a part of the channels */
+                          if(btemp == 0 || pJpegDecoder->bChannels < btemp ||
+                             (pJpegDecoder->blProgressive == FALSE && pJpegDecoder->bChannels != btemp) ||
+                             wSegLen < 6 + (btemp * 2))
                           {
                                      JPEG_SendError(100);
                                      break;
@@ -474,10 +629,12 @@ static BYTE JPEG_bReadHeader(JPEGDECODER *pJpegDecoder)
                           {
                                      BYTE bCounter, bChannelId = 0xFF;
                                      
-                                     for(bCounter = 0; bCounter < pJpegDecoder->bChannels; bCounter++)
+                                     pJpegDecoder->bScanChannels = btemp;
+                                     for(bCounter = 0; bCounter < pJpegDecoder->bScanChannels; bCounter++)
                                      {
                                                BYTE bindex;
 
+                                               bChannelId = 0xFF;
                                                btemp = JPEG_bReadByte(pJpegDecoder->pImageFile);
                                                for(bindex = 0; bindex < MAX_CHANNELS; bindex++)
                                                {
@@ -493,9 +650,29 @@ static BYTE JPEG_bReadHeader(JPEGDECODER *pJpegDecoder)
                                                           btemp = JPEG_bReadByte(pJpegDecoder->pImageFile);
                                                           pJpegDecoder->abChannelHuffAcTableMap[bChannelId] = btemp & 0x0F;
                                                           pJpegDecoder->abChannelHuffDcTableMap[bChannelId] = btemp >> 4;
+                                                          pJpegDecoder->abScanChannel[bCounter] = bChannelId;
+                                               }
+                                               if(bChannelId >= MAX_CHANNELS || (btemp & 0x0F) >= MAX_HUFF_TABLES || (btemp >> 4) >= MAX_HUFF_TABLES)
+                                               {
+                                                          JPEG_SendError(100);
                                                }
                                      }
+                                     pJpegDecoder->bSpectralStart = JPEG_bReadByte(pJpegDecoder->pImageFile);
+                                     pJpegDecoder->bSpectralEnd = JPEG_bReadByte(pJpegDecoder->pImageFile);
+                                     btemp = JPEG_bReadByte(pJpegDecoder->pImageFile);
+                                     pJpegDecoder->bApproxHigh = btemp >> 4;
+                                     pJpegDecoder->bApproxLow = btemp & 0x0F;
                                      IMG_FSEEK(pJpegDecoder->pImageFile, wOffset, 1);
+
+                                     /* A DC scan has no AC coefficients and an AC scan has only one channel */
+                                     if(pJpegDecoder->blProgressive == TRUE &&
+                                        (pJpegDecoder->bSpectralEnd > 63 || pJpegDecoder->bSpectralStart > pJpegDecoder->bSpectralEnd ||
+                                         (pJpegDecoder->bSpectralStart == 0 && pJpegDecoder->bSpectralEnd != 0) ||
+                                         (pJpegDecoder->bSpectralStart != 0 && pJpegDecoder->bScanChannels != 1) ||
+                                         pJpegDecoder->bApproxLow > 13))
+                                     {
+                                                JPEG_SendError(100);
+                                     }
                           }
                           blSOSOver = TRUE;
                           break;
@@ -510,9 +687,58 @@ static BYTE JPEG_bReadHeader(JPEGDECODER *pJpegDecoder)
                           IMG_FSEEK(pJpegDecoder->pImageFile, wSegLen - 2, 1);
              }
      }
+     pJpegDecoder->blEndOfImage = TRUE;
      return 0;
 }
 
+#if JPEG_HUFF_LOOKUP_BITS > 0
+/*******************************************************************************
+Function:       void JPEG_vGenerateLookupTable(BYTE *pbSymLen, BYTE *pbSymbol,
+                                               WORD *pwSymStart, WORD *pwLookup)
+
+Precondition:   The starting symbols of the table must be generated
+
+Overview:       This function fills the lookup table of one Huffman table.
+                The entry for every JPEG_HUFF_LOOKUP_BITS bit pattern that
+                begins with a code of that length or shorter holds the code
+                length in the upper byte and the symbol in the lower byte.
+                The other entries are 0 and need the bit by bit search.
+
+Input:          Symbol count per length, symbols, starting symbol per length,
+                lookup table
+
+Output:         None
+*******************************************************************************/
+static void JPEG_vGenerateLookupTable(BYTE *pbSymLen, BYTE *pbSymbol, WORD *pwSymStart, WORD *pwLookup)
+{
+     BYTE bLength, bCount;
+     WORD wIndex, wFill, wSymbolOffset = 0;
+
+     for(wIndex = 0; wIndex < (1 << JPEG_HUFF_LOOKUP_BITS); wIndex++)
+     {
+            pwLookup[wIndex] = 0;
+     }
+
+     for(bLength = 0; bLength < JPEG_HUFF_LOOKUP_BITS; bLength++)
+     {
+            for(bCount = 0; bCount < pbSymLen[bLength]; bCount++)
+            {
+                   if(pwSymStart[bLength] + bCount >= (2 << bLength)) /* Invalid table */
+                   {
+                          return;
+                   }
+                   /* All the patterns that start with this code */
+                   wIndex = (pwSymStart[bLength] + bCount) << (JPEG_HUFF_LOOKUP_BITS - 1 - bLength);
+                   for(wFill = 0; wFill < (1 << (JPEG_HUFF_LOOKUP_BITS - 1 - bLength)); wFill++)
+                   {
+                          pwLookup[wIndex + wFill] = ((WORD)(bLength + 1) << 8) | pbSymbol[wSymbolOffset + bCount];
+                   }
+            }
+            wSymbolOffset += pbSymLen[bLength];
+     }
+}
+#endif
+
 /*******************************************************************************
 Function:       BYTE JPEG_bGenerateHuffmanTables(JPEGDECODER *pJpegDecoder)
 
@@ -529,7 +755,7 @@ static BYTE JPEG_bGenerateHuffmanTables(JPEGDECODER *pJpegDecoder)
 {
      BYTE bLength, bTable;
 
-     for(bTable = 0; bTable < pJpegDecoder->bHuffTables / 2; bTable++)
+     for(bTable = 0; bTable < MAX_HUFF_TABLES; bTable++)
      {
             pJpegDecoder->awHuffAcSymStart[bTable][0] = 0;
             pJpegDecoder->awHuffDcSymStart[bTable][0] = 0;
@@ -539,67 +765,94 @@ static BYTE JPEG_bGenerateHuffmanTables(JPEGDECODER *pJpegDecoder)
                    pJpegDecoder->awHuffAcSymStart[bTable][bLength] = (pJpegDecoder->awHuffAcSymStart[bTable][bLength - 1] + pJpegDecoder->abHuffAcSymLen[bTable][bLength - 1]) << 1;
                    pJpegDecoder->awHuffDcSymStart[bTable][bLength] = (pJpegDecoder->awHuffDcSymStart[bTable][bLength - 1] + pJpegDecoder->abHuffDcSymLen[bTable][bLength - 1]) << 1;
             }
+
+     #if JPEG_HUFF_LOOKUP_BITS > 0
+            JPEG_vGenerateLookupTable(&pJpegDecoder->abHuffAcSymLen[bTable][0], &pJpegDecoder->abHuffAcSymbol[bTable][0],
+                                      &pJpegDecoder->awHuffAcSymStart[bTable][0], &pJpegDecoder->awHuffAcLookup[bTable][0]);
+            JPEG_vGenerateLookupTable(&pJpegDecoder->abHuffDcSymLen[bTable][0], &pJpegDecoder->abHuffDcSymbol[bTable][0],
+                                      &pJpegDecoder->awHuffDcSymStart[bTable][0], &pJpegDecoder->awHuffDcLookup[bTable][0]);
+     #endif
      }
      return 0;
 }
 
 /*******************************************************************************
-Function:       BYTE JPEG_bGet1Bit(JPEGDECODER *pJpegDecoder)
+Function:       void JPEG_vFillDataBuffer(JPEGDECODER *pJpegDecoder)
 
 Precondition:   None
 
-Overview:       This function returns 1 bit as the lsb of the returned byte.
-                It automatically fills the buffer if it becomes empty.
-                It also converts 0xFF00 into 0.
+Overview:       This function reads the next part of the entropy coded data
+                from the file. A 0xFF at the end of the buffer is left in the
+                file so that the byte following 0xFF is always in the buffer.
 
 Input:          JPEGDECODER
 
-Output:         One bit
+Output:         None
 *******************************************************************************/
-static BYTE JPEG_bGet1Bit(JPEGDECODER *pJpegDecoder)
+static void JPEG_vFillDataBuffer(JPEGDECODER *pJpegDecoder)
 {
-     BYTE bBit = 0;
-
-     if(pJpegDecoder->wBufferIndex >= pJpegDecoder->wBufferLen)
+     pJpegDecoder->wBufferLen = IMG_FREAD(&pJpegDecoder->abDataBuffer[0], sizeof(BYTE), MAX_DATA_BUF_LEN, pJpegDecoder->pImageFile);
+     while(pJpegDecoder->wBufferLen > 1 && pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferLen - 1] == 0xFF)
      {
-            pJpegDecoder->wBufferLen = IMG_FREAD(&pJpegDecoder->abDataBuffer[0], sizeof(BYTE), MAX_DATA_BUF_LEN, pJpegDecoder->pImageFile);
-            while(pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferLen - 1] == 0xFF)
-            {
-                   pJpegDecoder->wBufferLen--;
-                   IMG_FSEEK(pJpegDecoder->pImageFile, -1, 1);
-            }
-            pJpegDecoder->wBufferIndex = 0;
+            pJpegDecoder->wBufferLen--;
+            IMG_FSEEK(pJpegDecoder->pImageFile, -1, 1);
      }
+     pJpegDecoder->wBufferIndex = 0;
+}
+
+/*******************************************************************************
+Function:       void JPEG_vFillBitBuffer(JPEGDECODER *pJpegDecoder)
+
+Precondition:   None
 
-     while(pJpegDecoder->bBitsAvailable == 0) /* Be very careful to touch this part of code! You must know exactly what you are doing */
+Overview:       This function tops up the bit buffer a byte at a time until it
+                holds more than 24 bits. Stuffed bytes (0xFF00) are converted
+                into 0xFF. When a marker is found, it is left in the data and
+                zeros are fed instead until the marker is read.
+
+Input:          JPEGDECODER
+
+Output:         None
+*******************************************************************************/
+static void JPEG_vFillBitBuffer(JPEGDECODER *pJpegDecoder)
+{
+     while(pJpegDecoder->bBitsAvailable <= 24)
      {
-            pJpegDecoder->bBitsAvailable = 16;
-            pJpegDecoder->wWorkBits = pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferIndex++];
-            pJpegDecoder->wWorkBits = (pJpegDecoder->wWorkBits << 8) + pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferIndex++];
-            if(pJpegDecoder->wBufferIndex > pJpegDecoder->wBufferLen) /* wBufferIndex need not be even because of the below condition */
-            {
-                   pJpegDecoder->bBitsAvailable = 8;
-            }
-            else if((pJpegDecoder->wWorkBits & 0x00FF) == 0x00FF)
-            {
-                   pJpegDecoder->bBitsAvailable = 8;
-                   pJpegDecoder->wBufferIndex--;
-            }
-            else if(pJpegDecoder->wWorkBits >= 0xFF00)
+            BYTE bData = 0;
+
+            if(pJpegDecoder->blMarkerFound == 0)
             {
-                   if(pJpegDecoder->wWorkBits == 0xFF00)
+                   if(pJpegDecoder->wBufferIndex >= pJpegDecoder->wBufferLen)
                    {
-                         pJpegDecoder->bBitsAvailable = 8;
+                          JPEG_vFillDataBuffer(pJpegDecoder);
                    }
-            }
-     }
-
-     bBit = (pJpegDecoder->wWorkBits & 0x8000)? 0x01: 0;
 
-     pJpegDecoder->wWorkBits <<= 1;
-     pJpegDecoder->bBitsAvailable--;
+                   if(pJpegDecoder->wBufferIndex >= pJpegDecoder->wBufferLen) /* End of file */
+                   {
+                          pJpegDecoder->blMarkerFound = 1;
+                   }
+                   else
+                   {
+                          bData = pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferIndex++];
+                          if(bData == 0xFF)
+                          {
+                                 if(pJpegDecoder->wBufferIndex < pJpegDecoder->wBufferLen && pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferIndex] == 0x00)
+                                 {
+                                        pJpegDecoder->wBufferIndex++; /* Stuffed byte */
+                                 }
+                                 else
+                                 {
+                                        pJpegDecoder->wBufferIndex--; /* Marker, leave it for JPEG_wGetRestartWord() */
+                                        pJpegDecoder->blMarkerFound = 1;
+                                        bData = 0;
+                                 }
+                          }
+                   }
+            }
 
-     return bBit;
+            pJpegDecoder->dwWorkBits |= (DWORD)bData << (24 - pJpegDecoder->bBitsAvailable);
+            pJpegDecoder->bBitsAvailable += 8;
+     }
 }
 
 /*******************************************************************************
@@ -607,8 +860,8 @@ Function:       WORD JPEG_wGetBits(JPEGDECODER *pJpegDecoder, BYTE bLen)
 
 Precondition:   None
 
-Overview:       This function returns bLen number of bits as the lsb of the
-                returned word and it automatically fills the buffer
+Overview:       This function returns bLen (1 to 16) number of bits as the lsb
+                of the returned word and it automatically fills the buffer
                 if it becomes empty.
 
 Input:          JPEGDECODER, Number of bits
@@ -617,17 +870,17 @@ Output:         Requested number of bits
 *******************************************************************************/
 static WORD JPEG_wGetBits(JPEGDECODER *pJpegDecoder, BYTE bLen)
 {
-     WORD wVal = 0;
-
-     wVal = pJpegDecoder->bFirstBit = JPEG_bGet1Bit(pJpegDecoder);
-     bLen--;
+     WORD wVal;
 
-     while(bLen)
+     if(pJpegDecoder->bBitsAvailable < bLen)
      {
-            wVal = (wVal << 1) + JPEG_bGet1Bit(pJpegDecoder);
-            bLen--;
+            JPEG_vFillBitBuffer(pJpegDecoder);
      }
 
+     wVal = (WORD)(pJpegDecoder->dwWorkBits >> (32 - bLen));
+     pJpegDecoder->dwWorkBits <<= bLen;
+     pJpegDecoder->bBitsAvailable -= bLen;
+
      return wVal;   
 }
 
@@ -636,7 +889,9 @@ Function:       WORD JPEG_wGetRestartWord(JPEGDECODER *pJpegDecoder)
 
 Precondition:   File pointer must point to the restart word
 
-Overview:       Returns the restart word
+Overview:       Returns the restart word. The remaining bits of the previous
+                interval are dropped and the bit buffer starts again after
+                the marker.
 
 Input:          JPEGDECODER
 
@@ -644,15 +899,104 @@ Output:         Restart word
 *******************************************************************************/
 static WORD JPEG_wGetRestartWord(JPEGDECODER *pJpegDecoder)
 {
-     WORD wRestartWord;
-     while((pJpegDecoder->bBitsAvailable & 0x07) != 0) /* This is to clearoff wnwanted bits to go to fresh byte */
+     WORD wRestartWord = 0;
+     BYTE bCount;
+
+     pJpegDecoder->dwWorkBits = 0;
+     pJpegDecoder->bBitsAvailable = 0;
+     pJpegDecoder->blMarkerFound = 0;
+
+     for(bCount = 0; bCount < 2; bCount++)
      {
-            JPEG_bGet1Bit(pJpegDecoder);
+            if(pJpegDecoder->wBufferIndex >= pJpegDecoder->wBufferLen)
+            {
+                   JPEG_vFillDataBuffer(pJpegDecoder);
+                   if(pJpegDecoder->wBufferLen == 0)
+                   {
+                          break;
+                   }
+            }
+            wRestartWord = (wRestartWord << 8) | pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferIndex++];
+            if(wRestartWord == 0xFFFF) /* Fill bytes before the marker */
+            {
+                   wRestartWord = 0xFF;
+                   bCount--;
+            }
      }
-     wRestartWord = JPEG_wGetBits(pJpegDecoder, 16);
      return(wRestartWord);
 }
 
+/*******************************************************************************
+Function:       BYTE JPEG_bNextMarker(JPEGDECODER *pJpegDecoder, DWORD *pdwOffset)
+
+Precondition:   File pointer must point to the entropy coded data
+
+Overview:       Skips the entropy coded data without decoding it until the next
+                marker, which is also skipped. The bit buffer is not used.
+
+Input:          JPEGDECODER, pointer to store the file offset of the marker
+
+Output:         The marker, EOI at the end of the file
+*******************************************************************************/
+static BYTE JPEG_bNextMarker(JPEGDECODER *pJpegDecoder, DWORD *pdwOffset)
+{
+     BYTE bData;
+
+     while(1)
+     {
+            if(pJpegDecoder->wBufferIndex >= pJpegDecoder->wBufferLen)
+            {
+                   JPEG_vFillDataBuffer(pJpegDecoder);
+                   if(pJpegDecoder->wBufferLen == 0)
+                   {
+                          *pdwOffset = IMG_FTELL(pJpegDecoder->pImageFile);
+                          return EOI;
+                   }
+            }
+
+            bData = pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferIndex++];
+            if(bData == 0xFF && pJpegDecoder->wBufferIndex < pJpegDecoder->wBufferLen)
+            {
+                   bData = pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferIndex];
+                   if(bData != 0x00 && bData != 0xFF) /* Not a stuffed or a fill byte */
+                   {
+                          *pdwOffset = IMG_FTELL(pJpegDecoder->pImageFile) - (pJpegDecoder->wBufferLen - pJpegDecoder->wBufferIndex) - 1;
+                          pJpegDecoder->wBufferIndex++;
+                          return bData;
+                   }
+            }
+     }
+}
+
+/*******************************************************************************
+Function:       void JPEG_vRestartDecoding(JPEGDECODER *pJpegDecoder)
+
+Precondition:   None
+
+Overview:       Empties the bit buffer and resets the DC predictions as is done
+                after a restart marker
+
+Input:          JPEGDECODER
+
+Output:         None
+*******************************************************************************/
+static void JPEG_vRestartDecoding(JPEGDECODER *pJpegDecoder)
+{
+     BYTE bCounter;
+
+     pJpegDecoder->dwWorkBits = 0;
+     pJpegDecoder->bBitsAvailable = 0;
+     pJpegDecoder->blMarkerFound = 0;
+     for(bCounter = 0; bCounter < MAX_CHANNELS; bCounter++)
+     {
+            pJpegDecoder->asPrevDcValue[bCounter] = 0;
+     }
+     pJpegDecoder->wBlockNumber = 0;
+ #ifdef JPEG_SUPPORT_PROGRESSIVE
+     pJpegDecoder->wEobRun = 0;
+ #endif
+}
+
 /*******************************************************************************
 Function:       SHORT JPEG_sGetBitsValue(JPEGDECODER *pJpegDecoder, BYTE bLen)
 
@@ -671,10 +1015,9 @@ static SHORT JPEG_sGetBitsValue(JPEGDECODER *pJpegDecoder, BYTE bLen)
      if(bLen != 0)
      {  
             wVal = JPEG_wGetBits(pJpegDecoder, bLen);
-            if(pJpegDecoder->bFirstBit == 0)
+            if((wVal >> (bLen - 1)) == 0) /* Negative values start with 0 */
             {
-                   wVal = ~(wVal | (0xFFFF << bLen));
-                   return ((SHORT)wVal * -1);
+                   return (SHORT)wVal - (SHORT)((1 << bLen) - 1);
             }
      }
      return (SHORT)wVal;
@@ -694,14 +1037,32 @@ Output:         Huffman decoded data
 static BYTE JPEG_bGetNextHuffByte(JPEGDECODER *pJpegDecoder)
 {
      BYTE bBits, bSymbol = 0;
-     WORD wBitPattern = 0, wSymbolOffset = 0;
+     WORD wBitPattern, wSymbolOffset = 0;
 
+     if(pJpegDecoder->bBitsAvailable < 16)
+     {
+            JPEG_vFillBitBuffer(pJpegDecoder);
+     }
+
+ #if JPEG_HUFF_LOOKUP_BITS > 0
+     /* Short codes are found with one lookup */
+     wBitPattern = pJpegDecoder->pwCurrentHuffLookupTable[pJpegDecoder->dwWorkBits >> (32 - JPEG_HUFF_LOOKUP_BITS)];
+     if(wBitPattern != 0)
+     {
+            bBits = wBitPattern >> 8;
+            pJpegDecoder->dwWorkBits <<= bBits;
+            pJpegDecoder->bBitsAvailable -= bBits;
+            return (BYTE)wBitPattern;
+     }
+ #endif
+
+     /* Search the longer codes one length at a time */
      for(bBits = 0; bBits < 16; bBits++)
      {
             BYTE bSymbols;
             WORD wDiff;
 
-            wBitPattern = (wBitPattern << 1) + JPEG_bGet1Bit(pJpegDecoder);
+            wBitPattern = (WORD)(pJpegDecoder->dwWorkBits >> (31 - bBits));
             bSymbols = pJpegDecoder->pbCurrentHuffSymLenTable[bBits];
             if(bSymbols == 0)
             {
@@ -716,17 +1077,58 @@ static BYTE JPEG_bGetNextHuffByte(JPEGDECODER *pJpegDecoder)
             }
             wSymbolOffset += bSymbols;
      }
+
+     if(bBits == 16) /* Invalid code */
+     {
+            bBits = 15;
+     }
+     pJpegDecoder->dwWorkBits <<= bBits + 1;
+     pJpegDecoder->bBitsAvailable -= bBits + 1;
+
      return bSymbol;
 }
 
-#define range_limit(x) (x<0)?0:(x>0xFF)?0xFF:x
+/*******************************************************************************
+Function:       void JPEG_vInverseDct(JPEGDECODER *pJpegDecoder, BYTE bBlock, BYTE bLastCoef)
+
+Precondition:   The coefficients of the block and pwCurrentQuantTable must be set
+
+Overview:       Dequantizes the block and does the inverse DCT matching the
+                decoding scale
+
+Input:          JPEGDECODER, block number, zigzag index of the last non-zero
+                coefficient
+
+Output:         None
+*******************************************************************************/
+static void JPEG_vInverseDct(JPEGDECODER *pJpegDecoder, BYTE bBlock, BYTE bLastCoef)
+{
+     switch(pJpegDecoder->bScaleShift)
+     {
+         case 1:  jpeg_idct_4x4(&pJpegDecoder->asOneBlock[bBlock][0],pJpegDecoder->pwCurrentQuantTable);
+                  break;
+         case 2:  jpeg_idct_2x2(&pJpegDecoder->asOneBlock[bBlock][0],pJpegDecoder->pwCurrentQuantTable);
+                  break;
+         case 3:  jpeg_idct_1x1(&pJpegDecoder->asOneBlock[bBlock][0],pJpegDecoder->pwCurrentQuantTable);
+                  break;
+         default:
+ #if JPEG_USE_FAST_IDCT == 0
+                  jpeg_idct_islow(&pJpegDecoder->asOneBlock[bBlock][0],pJpegDecoder->pwCurrentQuantTable);
+ #else
+                  jpeg_idct_ifast(&pJpegDecoder->asOneBlock[bBlock][0],pJpegDecoder->pwCurrentQuantTable, bLastCoef);
+ #endif
+                  break;
+     }
+}
+
 /*******************************************************************************
 Function:       BYTE JPEG_bDecodeOneBlock(JPEGDECODER *pJpegDecoder)
 
 Precondition:   File pointer must point to a new block of data
 
 Overview:       Decodes the 8x8 pixel values of all the channels
-                (A multiple of 8x8 block if subsampling is used)
+                (A multiple of 8x8 block if subsampling is used). The inverse
+                DCT is skipped when the block is not on the screen
 
 Input:          JPEGDECODER
 
@@ -739,7 +1141,7 @@ static BYTE JPEG_bDecodeOneBlock(JPEGDECODER *pJpegDecoder)
      IMG_vLoopCallback();
      for(bBlock = 0; bBlock < pJpegDecoder->bBlocksInOnePass; bBlock++)
      {
-            BYTE bByteCount, bHuffbyte;
+            BYTE bByteCount, bHuffbyte, bLastCoef = 0;
 
             if((pJpegDecoder->wRestartInterval > 0) && (pJpegDecoder->wBlockNumber == pJpegDecoder->wRestartInterval * pJpegDecoder->bBlocksInOnePass))
             {
@@ -767,6 +1169,9 @@ static BYTE JPEG_bDecodeOneBlock(JPEGDECODER *pJpegDecoder)
             pJpegDecoder->pbCurrentHuffSymLenTable = &pJpegDecoder->abHuffDcSymLen[pJpegDecoder->abChannelHuffDcTableMap[pJpegDecoder->abChannelMap[bBlock]]][0];
             pJpegDecoder->pbCurrentHuffSymbolTable = &pJpegDecoder->abHuffDcSymbol[pJpegDecoder->abChannelHuffDcTableMap[pJpegDecoder->abChannelMap[bBlock]]][0];
             pJpegDecoder->pwCurrentHuffSymStartTable = &pJpegDecoder->awHuffDcSymStart[pJpegDecoder->abChannelHuffDcTableMap[pJpegDecoder->abChannelMap[bBlock]]][0];
+     #if JPEG_HUFF_LOOKUP_BITS > 0
+            pJpegDecoder->pwCurrentHuffLookupTable = &pJpegDecoder->awHuffDcLookup[pJpegDecoder->abChannelHuffDcTableMap[pJpegDecoder->abChannelMap[bBlock]]][0];
+     #endif
             bHuffbyte = JPEG_bGetNextHuffByte(pJpegDecoder);
             pJpegDecoder->asOneBlock[bBlock][0] = JPEG_sGetBitsValue(pJpegDecoder, bHuffbyte & 0x0F) + pJpegDecoder->asPrevDcValue[pJpegDecoder->abChannelMap[bBlock]];
             pJpegDecoder->asPrevDcValue[pJpegDecoder->abChannelMap[bBlock]] = pJpegDecoder->asOneBlock[bBlock][0];
@@ -776,6 +1181,9 @@ static BYTE JPEG_bDecodeOneBlock(JPEGDECODER *pJpegDecoder)
             pJpegDecoder->pbCurrentHuffSymLenTable = &pJpegDecoder->abHuffAcSymLen[pJpegDecoder->abChannelHuffAcTableMap[pJpegDecoder->abChannelMap[bBlock]]][0];
             pJpegDecoder->pbCurrentHuffSymbolTable = &pJpegDecoder->abHuffAcSymbol[pJpegDecoder->abChannelHuffAcTableMap[pJpegDecoder->abChannelMap[bBlock]]][0];
             pJpegDecoder->pwCurrentHuffSymStartTable = &pJpegDecoder->awHuffAcSymStart[pJpegDecoder->abChannelHuffAcTableMap[pJpegDecoder->abChannelMap[bBlock]]][0];
+     #if JPEG_HUFF_LOOKUP_BITS > 0
+            pJpegDecoder->pwCurrentHuffLookupTable = &pJpegDecoder->awHuffAcLookup[pJpegDecoder->abChannelHuffAcTableMap[pJpegDecoder->abChannelMap[bBlock]]][0];
+     #endif
             while(bByteCount < 64)
             {
                    bHuffbyte = JPEG_bGetNextHuffByte(pJpegDecoder);
@@ -788,10 +1196,14 @@ static BYTE JPEG_bDecodeOneBlock(JPEGDECODER *pJpegDecoder)
                    {
                           JPEG_SendError(100);
                    }
+                   bLastCoef = bByteCount;
                    pJpegDecoder->asOneBlock[bBlock][abZigzag[bByteCount++]] = JPEG_sGetBitsValue(pJpegDecoder, bHuffbyte & 0x0F);
             }
             pJpegDecoder->wBlockNumber++;
-            jpeg_idct_islow(&pJpegDecoder->asOneBlock[bBlock][0],pJpegDecoder->pwCurrentQuantTable);
+            if((pJpegDecoder->wPrevX << pJpegDecoder->bScaleShift) < pJpegDecoder->wVisibleWidth)
+            {
+                   JPEG_vInverseDct(pJpegDecoder, bBlock, bLastCoef);
+            }
      }
 
 //     SetVisualPage(1);
@@ -822,13 +1234,99 @@ static void JPEG_vInitDisplay(JPEGDECODER *pJpegDecoder)
  #endif
 }
 
+/*******************************************************************************
+Function:       void JPEG_vYCbCrToRGB565(SHORT *psY, SHORT *psCb, SHORT *psCr,
+                                         BYTE bCount, BYTE bXShift, WORD *pwRGB)
+
+Precondition:   The blocks must be decoded
+
+Overview:       Converts a run of YCbCr samples to RGB565. The chrominance
+                contributions are looked up once per chrominance sample, each
+                of them is used for (1 << bXShift) pixels. The per pixel loop
+                is plain 16-bit arithmetic with the clamps written as min/max
+                so that the compiler can vectorize it
+
+Input:          Luminance, Cb and Cr samples, number of pixels, horizontal
+                subsampling shift, RGB565 output buffer
+
+Output:         None
+*******************************************************************************/
+static void JPEG_vYCbCrToRGB565(SHORT *psY, SHORT *psCb, SHORT *psCr, BYTE bCount, BYTE bXShift, WORD *pwRGB)
+{
+     SHORT asR[8], asG[8], asB[8];
+     SHORT sY, sR, sG, sB;
+     WORD wCounter, wCb, wCr;
+
+     /* Chrominance contributions, repeated for subsampled pixels */
+     for(wCounter = 0; wCounter < bCount; wCounter++)
+     {
+            wCb = (WORD)(psCb[wCounter >> bXShift] + 128);
+            wCr = (WORD)(psCr[wCounter >> bXShift] + 128);
+            asR[wCounter] = asCrToR[wCr];
+            asG[wCounter] = (asCbToG[wCb] + asCrToG[wCr]) >> 7;
+            asB[wCounter] = asCbToB[wCb];
+     }
+
+     for(wCounter = 0; wCounter < bCount; wCounter++)
+     {
+            sY = psY[wCounter] + 128;
+            sR = sY + asR[wCounter];
+            sG = sY + asG[wCounter];
+            sB = sY + asB[wCounter];
+            sR = (sR < 0)? 0: (sR > 255)? 255: sR;
+            sG = (sG < 0)? 0: (sG > 255)? 255: sG;
+            sB = (sB < 0)? 0: (sB > 255)? 255: sB;
+            pwRGB[wCounter] = ((WORD)(sR & 0xF8) << 8) | ((WORD)(sG & 0xFC) << 3) | ((WORD)sB >> 3);
+     }
+}
+
+#ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+/*******************************************************************************
+Function:       void JPEG_vYCbCrToRGB888(SHORT *psY, SHORT *psCb, SHORT *psCr,
+                                         BYTE bCount, BYTE bXShift, BYTE *pbRGB)
+
+Precondition:   The blocks must be decoded
+
+Overview:       Converts a run of YCbCr samples to R, G and B bytes for the
+                pixel output, with the same arithmetic as
+                JPEG_vYCbCrToRGB565()
+
+Input:          Luminance, Cb and Cr samples, number of pixels, horizontal
+                subsampling shift, RGB888 output buffer
+
+Output:         None
+*******************************************************************************/
+static void JPEG_vYCbCrToRGB888(SHORT *psY, SHORT *psCb, SHORT *psCr, BYTE bCount, BYTE bXShift, BYTE *pbRGB)
+{
+     SHORT sY, sR, sG, sB;
+     WORD wCounter, wCb, wCr;
+
+     for(wCounter = 0; wCounter < bCount; wCounter++)
+     {
+            wCb = (WORD)(psCb[wCounter >> bXShift] + 128);
+            wCr = (WORD)(psCr[wCounter >> bXShift] + 128);
+            sY = psY[wCounter] + 128;
+            sR = sY + asCrToR[wCr];
+            sG = sY + ((asCbToG[wCb] + asCrToG[wCr]) >> 7);
+            sB = sY + asCbToB[wCb];
+            *pbRGB++ = (sR < 0)? 0: (sR > 255)? 255: (BYTE)sR;
+            *pbRGB++ = (sG < 0)? 0: (sG > 255)? 255: (BYTE)sG;
+            *pbRGB++ = (sB < 0)? 0: (sB > 255)? 255: (BYTE)sB;
+     }
+}
+#endif
+
 /*******************************************************************************
 Function:       BYTE JPEG_bPaintOneBlock(JPEGDECODER *pJpegDecoder)
 
 Precondition:   One block - 8x8 pixel data of all channels must be decoded
 
 Overview:       Displays one 8x8 on the screen
-                (A multiple of 8x8 block if subsampling is used)
+                (A multiple of 8x8 block if subsampling is used). Each pixel
+                row of the block is sent to the output as one span. When the
+                image is decoded at a reduced size, the blocks are 4x4, 2x2
+                or 1x1 pixels. A block which is not on the screen only
+                advances the position
 
 Input:          JPEGDECODER
 
@@ -847,148 +1345,489 @@ static BYTE JPEG_bPaintOneBlock(JPEGDECODER *pJpegDecoder)
 
  #else
 
-     WORD wX, wY;
+     WORD wY;
+     BYTE bXShift, bYShift, bMcuWidth, bMcuHeight, bBlockSize, bCbCr;
+     BYTE bBlockShift, bBlockMask;
+     SHORT *psCb, *psCr;
+     WORD awLine[16];
+   #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+     BYTE abLine[16 * 3];
+     BYTE blRGB = IMG_bUseRGBOutput();
+   #endif
+
      bCounter = 0;
-     BYTE r,g,b;
 
-     if(pJpegDecoder->bSubSampleType == JPEG_SAMPLE_1x1)
+     /* The MCU is one, two or four luminance blocks wide/high, the chrominance
+        blocks follow them and cover the whole MCU */
+     bXShift = (pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x1 || pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x2)? 1: 0;
+     bYShift = (pJpegDecoder->bSubSampleType == JPEG_SAMPLE_1x2 || pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x2)? 1: 0;
+     bBlockShift = 3 - pJpegDecoder->bScaleShift;
+     bBlockMask = (1 << bBlockShift) - 1;
+     bBlockSize = 1 << bBlockShift;
+     bMcuWidth = bBlockSize << bXShift;
+     bMcuHeight = bBlockSize << bYShift;
+     psCb = &pJpegDecoder->asOneBlock[1 << (bXShift + bYShift)][0];
+     psCr = psCb + 64;
+
+     /* Convert the MCU one row at a time and send each row as a span */
+     for(wY = 0; wY < bMcuHeight && (pJpegDecoder->wPrevX << pJpegDecoder->bScaleShift) < pJpegDecoder->wVisibleWidth; wY++)
      {
-            SHORT *psY = &pJpegDecoder->asOneBlock[0][0], *psCb = &pJpegDecoder->asOneBlock[1][0], *psCr = &pJpegDecoder->asOneBlock[2][0];
-
-            for(wY = 0; wY < 8; wY++)
+            /* One luminance block at a time, with the chrominance samples
+               which cover it */
+            for(bCounter = 0; bCounter < (1 << bXShift); bCounter++)
             {
-                    for(wX = 0; wX < 8; wX++)
+                    bCbCr = ((wY >> bYShift) << 3) + ((bCounter << bBlockShift) >> bXShift);
+                  #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+                    if(blRGB)
                     {
-                            LONG s1 = ((*psY) + 128)*128, s2 = (*psCb), s3 = (*psCr);
-                            r = range_limit((s1 + 180*s3)>>7);
-                            g = range_limit((s1 - 44*s2 - 91*s3)>>7);
-                            b = range_limit((s1 + 227*s2)>>7);
-                            IMG_vSetColor(r, g, b);
-                            IMG_vPutPixel(pJpegDecoder->wPrevX + wX, pJpegDecoder->wPrevY + wY);
-                            psY++; psCb++; psCr++;
-                    }  
-             }
-
-            pJpegDecoder->wPrevX += 8;
-
-            if(pJpegDecoder->wPrevX >= pJpegDecoder->wWidth)
+                            JPEG_vYCbCrToRGB888(&pJpegDecoder->asOneBlock[((wY >> bBlockShift) << bXShift) + bCounter][(wY & bBlockMask) << 3],
+                                                &psCb[bCbCr], &psCr[bCbCr], bBlockSize, bXShift,
+                                                &abLine[(bCounter << bBlockShift) * 3]);
+                            continue;
+                    }
+                  #endif
+                    JPEG_vYCbCrToRGB565(&pJpegDecoder->asOneBlock[((wY >> bBlockShift) << bXShift) + bCounter][(wY & bBlockMask) << 3],
+                                        &psCb[bCbCr], &psCr[bCbCr], bBlockSize, bXShift,
+                                        &awLine[bCounter << bBlockShift]);
+            }
+          #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+            if(blRGB)
             {
-                    pJpegDecoder->wPrevX = 0;
-                    pJpegDecoder->wPrevY += 8;
+                    IMG_vPutSpanRGB(pJpegDecoder->wPrevX, pJpegDecoder->wPrevY + wY, bMcuWidth, abLine);
+                    continue;
             }
-     }       
-     else if(pJpegDecoder->bSubSampleType == JPEG_SAMPLE_1x2)
+          #endif
+            IMG_vPutSpan(pJpegDecoder->wPrevX, pJpegDecoder->wPrevY + wY, bMcuWidth, awLine);
+     }
+
+     pJpegDecoder->wPrevX += bMcuWidth;
+
+     if((pJpegDecoder->wPrevX << pJpegDecoder->bScaleShift) >= pJpegDecoder->wWidth)
+     {
+            pJpegDecoder->wPrevX = 0;
+            pJpegDecoder->wPrevY += bMcuHeight;
+     }
+
+ #endif
+     return 0;
+}
+
+/*******************************************************************************
+Function:       BYTE JPEG_bSkipRestartInterval(JPEGDECODER *pJpegDecoder, WORD wMcusLeftInRow)
+
+Precondition:   The previous MCU must be painted
+
+Overview:       When a restart interval starts here and all its MCUs are to the
+                right of the screen, the entropy coded data is skipped until
+                the restart marker which ends the interval, without Huffman
+                decoding, and the position is advanced past the MCUs
+
+Input:          JPEGDECODER, number of MCUs left in this MCU row
+
+Output:         1 if the interval has been skipped
+*******************************************************************************/
+static BYTE JPEG_bSkipRestartInterval(JPEGDECODER *pJpegDecoder, WORD wMcusLeftInRow)
+{
+     WORD wCounter;
+     DWORD dwOffset;
+
+     if(pJpegDecoder->wRestartInterval == 0 || wMcusLeftInRow < pJpegDecoder->wRestartInterval ||
+        (pJpegDecoder->wPrevX << pJpegDecoder->bScaleShift) < pJpegDecoder->wVisibleWidth)
+     {
+            return 0;
+     }
+
+     if(pJpegDecoder->wBlockNumber == pJpegDecoder->wRestartInterval * pJpegDecoder->bBlocksInOnePass)
+     {
+            JPEG_bNextMarker(pJpegDecoder, &dwOffset); /* The marker before this interval */
+     }
+     else if(pJpegDecoder->wBlockNumber != 0) /* Not at the start of an interval */
+     {
+            return 0;
+     }
+     JPEG_bNextMarker(pJpegDecoder, &dwOffset); /* The marker after this interval */
+     JPEG_vRestartDecoding(pJpegDecoder);
+
+     for(wCounter = 0; wCounter < pJpegDecoder->wRestartInterval; wCounter++)
+     {
+            JPEG_bPaintOneBlock(pJpegDecoder);
+     }
+     return 1;
+}
+
+#ifdef JPEG_SUPPORT_PROGRESSIVE
+/*******************************************************************************
+Function:       void JPEG_vSelectHuffmanTable(JPEGDECODER *pJpegDecoder, BYTE bChannel, BYTE blAc)
+
+Precondition:   The Huffman tables must be generated
+
+Overview:       Selects the DC or AC Huffman table of the channel for decoding
+
+Input:          JPEGDECODER, channel, 1 for the AC table
+
+Output:         None
+*******************************************************************************/
+static void JPEG_vSelectHuffmanTable(JPEGDECODER *pJpegDecoder, BYTE bChannel, BYTE blAc)
+{
+     BYTE bTable;
+
+     if(blAc == 0)
+     {
+            bTable = pJpegDecoder->abChannelHuffDcTableMap[bChannel];
+            pJpegDecoder->pbCurrentHuffSymLenTable = &pJpegDecoder->abHuffDcSymLen[bTable][0];
+            pJpegDecoder->pbCurrentHuffSymbolTable = &pJpegDecoder->abHuffDcSymbol[bTable][0];
+            pJpegDecoder->pwCurrentHuffSymStartTable = &pJpegDecoder->awHuffDcSymStart[bTable][0];
+     #if JPEG_HUFF_LOOKUP_BITS > 0
+            pJpegDecoder->pwCurrentHuffLookupTable = &pJpegDecoder->awHuffDcLookup[bTable][0];
+     #endif
+     }
+     else
+     {
+            bTable = pJpegDecoder->abChannelHuffAcTableMap[bChannel];
+            pJpegDecoder->pbCurrentHuffSymLenTable = &pJpegDecoder->abHuffAcSymLen[bTable][0];
+            pJpegDecoder->pbCurrentHuffSymbolTable = &pJpegDecoder->abHuffAcSymbol[bTable][0];
+            pJpegDecoder->pwCurrentHuffSymStartTable = &pJpegDecoder->awHuffAcSymStart[bTable][0];
+     #if JPEG_HUFF_LOOKUP_BITS > 0
+            pJpegDecoder->pwCurrentHuffLookupTable = &pJpegDecoder->awHuffAcLookup[bTable][0];
+     #endif
+     }
+}
+
+/*******************************************************************************
+Function:       void JPEG_vRefineCoefficient(JPEGDECODER *pJpegDecoder, SHORT *psCoef)
+
+Precondition:   The coefficient must be non-zero
+
+Overview:       Reads the correction bit of a coefficient in a refinement scan
+                and increases its magnitude if the bit is set
+
+Input:          JPEGDECODER, coefficient
+
+Output:         None
+*******************************************************************************/
+static void JPEG_vRefineCoefficient(JPEGDECODER *pJpegDecoder, SHORT *psCoef)
+{
+     SHORT sBit = 1 << pJpegDecoder->bApproxLow;
+
+     if(JPEG_wGetBits(pJpegDecoder, 1) != 0 && (*psCoef & sBit) == 0)
      {
-            SHORT *psY, *psCb = &pJpegDecoder->asOneBlock[2][0], *psCr = &pJpegDecoder->asOneBlock[3][0];
-            BYTE bBlock, bOffsetY[2] = {0,8};
+            *psCoef += (*psCoef >= 0)? sBit: -sBit;
+     }
+}
+
+/*******************************************************************************
+Function:       void JPEG_vDecodeProgressiveBlock(JPEGDECODER *pJpegDecoder,
+                                                  SHORT *psBlock, BYTE bChannel)
+
+Precondition:   File pointer must point to the data of the block in this scan
 
-            for(bBlock = 0; bBlock < 2; bBlock++)
+Overview:       Decodes the part of the coefficients of one block which is
+                sent in the current scan: the DC coefficient or a band of AC
+                coefficients, either the first bits or one refinement bit
+
+Input:          JPEGDECODER, coefficients of the block, channel of the block
+
+Output:         None
+*******************************************************************************/
+static void JPEG_vDecodeProgressiveBlock(JPEGDECODER *pJpegDecoder, SHORT *psBlock, BYTE bChannel)
+{
+     BYTE bCoef, bHuffbyte, bRun, bSize;
+     SHORT sValue;
+
+     if(pJpegDecoder->bSpectralStart == 0) /* DC scan */
+     {
+            if(pJpegDecoder->bApproxHigh == 0)
             {
-                    psY = &pJpegDecoder->asOneBlock[bBlock][0];
-                    psCb = &pJpegDecoder->asOneBlock[2][bBlock*32];
-                    psCr = &pJpegDecoder->asOneBlock[3][bBlock*32];
-                    for(wY = 0; wY < 8; wY++)
-                    {
-                            for(wX = 0; wX < 8; wX++)
-                            {
-                                     LONG s1 = ((*psY) + 128)*128;
-                                     LONG s2 = psCb[(wY>>1)*8+wX];
-                                     LONG s3 = psCr[(wY>>1)*8+wX];
-                                     r = range_limit((s1 + 180*s3)>>7);
-                                     g = range_limit((s1 - 44*s2 - 91*s3)>>7);
-                                     b = range_limit((s1 + 227*s2)>>7);
-                                     IMG_vSetColor(r, g, b);
-                                     IMG_vPutPixel(pJpegDecoder->wPrevX + wX,
-                                              pJpegDecoder->wPrevY + bOffsetY[bBlock] + wY);
-                                     psY++;
-                            }
-                    }
+                   JPEG_vSelectHuffmanTable(pJpegDecoder, bChannel, 0);
+                   bHuffbyte = JPEG_bGetNextHuffByte(pJpegDecoder);
+                   pJpegDecoder->asPrevDcValue[bChannel] += JPEG_sGetBitsValue(pJpegDecoder, bHuffbyte & 0x0F);
+                   psBlock[0] = pJpegDecoder->asPrevDcValue[bChannel] * (1 << pJpegDecoder->bApproxLow);
+            }
+            else if(JPEG_wGetBits(pJpegDecoder, 1) != 0)
+            {
+                   psBlock[0] |= 1 << pJpegDecoder->bApproxLow;
             }
+            return;
+     }
 
-            pJpegDecoder->wPrevX += 8;
+     JPEG_vSelectHuffmanTable(pJpegDecoder, bChannel, 1);
+     bCoef = pJpegDecoder->bSpectralStart;
 
-            if(pJpegDecoder->wPrevX >= pJpegDecoder->wWidth)
+     if(pJpegDecoder->bApproxHigh == 0) /* First AC scan */
+     {
+            if(pJpegDecoder->wEobRun > 0)
+            {
+                   pJpegDecoder->wEobRun--;
+                   return;
+            }
+            for(; bCoef <= pJpegDecoder->bSpectralEnd; bCoef++)
             {
-                    pJpegDecoder->wPrevX = 0;
-                    pJpegDecoder->wPrevY += 16;
+                   bHuffbyte = JPEG_bGetNextHuffByte(pJpegDecoder);
+                   bRun = bHuffbyte >> 4;
+                   bSize = bHuffbyte & 0x0F;
+                   if(bSize != 0)
+                   {
+                          bCoef += bRun;
+                          if(bCoef > pJpegDecoder->bSpectralEnd)
+                          {
+                                 break;
+                          }
+                          psBlock[abZigzag[bCoef]] = JPEG_sGetBitsValue(pJpegDecoder, bSize) * (1 << pJpegDecoder->bApproxLow);
+                   }
+                   else if(bRun == 15) /* 16 zeros */
+                   {
+                          bCoef += 15;
+                   }
+                   else /* End of band, for this and (2^bRun - 1 + extra bits) more blocks */
+                   {
+                          pJpegDecoder->wEobRun = (1 << bRun) - 1;
+                          if(bRun != 0)
+                          {
+                                 pJpegDecoder->wEobRun += JPEG_wGetBits(pJpegDecoder, bRun);
+                          }
+                          break;
+                   }
             }
-     }       
-     else if(pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x1)
+            return;
+     }
+
+     /* Refinement AC scan: new coefficients are +-1 at this bit position and
+        the coefficients which are already non-zero get a correction bit */
+     if(pJpegDecoder->wEobRun == 0)
      {
-            SHORT *psY, *psCb = &pJpegDecoder->asOneBlock[2][0], *psCr = &pJpegDecoder->asOneBlock[3][0];
-            BYTE bBlock, bOffsetX[2] = {0,8};
+            for(; bCoef <= pJpegDecoder->bSpectralEnd; bCoef++)
+            {
+                   bHuffbyte = JPEG_bGetNextHuffByte(pJpegDecoder);
+                   bRun = bHuffbyte >> 4;
+                   bSize = bHuffbyte & 0x0F;
+                   sValue = 0;
+                   if(bSize != 0)
+                   {
+                          sValue = (JPEG_wGetBits(pJpegDecoder, 1) != 0)? (1 << pJpegDecoder->bApproxLow): -(1 << pJpegDecoder->bApproxLow);
+                   }
+                   else if(bRun != 15)
+                   {
+                          pJpegDecoder->wEobRun = 1 << bRun;
+                          if(bRun != 0)
+                          {
+                                 pJpegDecoder->wEobRun += JPEG_wGetBits(pJpegDecoder, bRun);
+                          }
+                          break;
+                   }
 
-            for(bBlock = 0; bBlock < 2; bBlock++)
+                   /* Skip bRun zero coefficients, refining the non-zero ones */
+                   while(bCoef <= pJpegDecoder->bSpectralEnd)
+                   {
+                          if(psBlock[abZigzag[bCoef]] != 0)
+                          {
+                                 JPEG_vRefineCoefficient(pJpegDecoder, &psBlock[abZigzag[bCoef]]);
+                          }
+                          else
+                          {
+                                 if(bRun == 0)
+                                 {
+                                        break;
+                                 }
+                                 bRun--;
+                          }
+                          bCoef++;
+                   }
+                   if(sValue != 0 && bCoef <= pJpegDecoder->bSpectralEnd)
+                   {
+                          psBlock[abZigzag[bCoef]] = sValue;
+                   }
+            }
+     }
+
+     if(pJpegDecoder->wEobRun > 0)
+     {
+            for(; bCoef <= pJpegDecoder->bSpectralEnd; bCoef++)
             {
-                    psY = &pJpegDecoder->asOneBlock[bBlock][0];
-                    psCb = &pJpegDecoder->asOneBlock[2][bBlock*4];
-                    psCr = &pJpegDecoder->asOneBlock[3][bBlock*4];
-                    for(wY = 0; wY < 8; wY++)
-                    {
-                            for(wX = 0; wX < 8; wX++)
-                            {
-                                     LONG s1 = ((*psY) + 128)*128;
-                                     LONG s2 = psCb[(wY*8)+(wX>>1)];
-                                     LONG s3 = psCr[(wY*8)+(wX>>1)];
-                                     r = range_limit((s1 + 180*s3)>>7);
-                                     g = range_limit((s1 - 44*s2 - 91*s3)>>7);
-                                     b = range_limit((s1 + 227*s2)>>7);
-                                     IMG_vSetColor(r, g, b);
-                                     IMG_vPutPixel(pJpegDecoder->wPrevX + bOffsetX[bBlock] + wX,
-                                              pJpegDecoder->wPrevY + wY);
-                                     psY++;
-                            }
-                    }
+                   if(psBlock[abZigzag[bCoef]] != 0)
+                   {
+                          JPEG_vRefineCoefficient(pJpegDecoder, &psBlock[abZigzag[bCoef]]);
+                   }
             }
+            pJpegDecoder->wEobRun--;
+     }
+}
+
+/*******************************************************************************
+Function:       BYTE JPEG_bDecodeScan(JPEGDECODER *pJpegDecoder, WORD wMcusInRow, WORD wMcuRows)
+
+Precondition:   The scan header must be read and the Huffman tables generated
 
-            pJpegDecoder->wPrevX += 16;
+Overview:       Decodes one scan of a progressive image into the coefficient
+                buffer. A scan of one channel goes through the blocks of that
+                channel, a scan of more channels through the MCUs. Rows below
+                the screen are not decoded, and AC scans are not decoded at
+                1/8 size as only the DC coefficients are used. Afterwards the
+                file points to the marker following the scan.
 
-            if(pJpegDecoder->wPrevX >= pJpegDecoder->wWidth)
+Input:          JPEGDECODER, number of MCUs in a row, number of MCU rows
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+static BYTE JPEG_bDecodeScan(JPEGDECODER *pJpegDecoder, WORD wMcusInRow, WORD wMcuRows)
+{
+     WORD wX, wY, wBlocksInRow, wBlockRows, wCount = 0;
+     BYTE bChannel, bBlock, bFirstBlock, bH, bV, bHMax, bVMax;
+     BYTE bMcuHeight = (pJpegDecoder->bSubSampleType == JPEG_SAMPLE_1x2 || pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x2)? 16: 8;
+     SHORT *psMcu;
+     DWORD dwOffset;
+
+     JPEG_vRestartDecoding(pJpegDecoder);
+     pJpegDecoder->wBufferLen = 0;
+     pJpegDecoder->wBufferIndex = 0;
+
+     if(pJpegDecoder->bScaleShift < 3 || pJpegDecoder->bSpectralStart == 0)
+     {
+            if(pJpegDecoder->bScanChannels == 1)
+            {
+                   /* Block layout of the channel, a grayscale image always has 8x8 MCUs */
+                   bChannel = pJpegDecoder->abScanChannel[0];
+                   bH = bV = bHMax = bVMax = 1;
+                   if(pJpegDecoder->bChannels > 1)
+                   {
+                          bH = pJpegDecoder->abChannelHSampFactor[bChannel];
+                          bV = pJpegDecoder->abChannelVSampFactor[bChannel];
+                          bHMax = pJpegDecoder->abChannelHSampFactor[0];
+                          bVMax = pJpegDecoder->abChannelVSampFactor[0];
+                   }
+                   wBlocksInRow = (((DWORD)pJpegDecoder->wWidth * bH + bHMax - 1) / bHMax + 7) >> 3;
+                   wBlockRows = (((DWORD)pJpegDecoder->wHeight * bV + bVMax - 1) / bVMax + 7) >> 3;
+                   for(bFirstBlock = 0; pJpegDecoder->abChannelMap[bFirstBlock] != bChannel; bFirstBlock++);
+
+                   for(wY = 0; wY < wBlockRows && (DWORD)wY * 8 * bVMax / bV < pJpegDecoder->wVisibleHeight; wY++)
+                   {
+                          IMG_vCheckAndAbort();
+                          IMG_vLoopCallback();
+                          for(wX = 0; wX < wBlocksInRow; wX++)
+                          {
+                                 if(pJpegDecoder->wRestartInterval > 0 && wCount == pJpegDecoder->wRestartInterval)
+                                 {
+                                        JPEG_wGetRestartWord(pJpegDecoder);
+                                        JPEG_vRestartDecoding(pJpegDecoder);
+                                        wCount = 0;
+                                 }
+                                 psMcu = pJpegDecoder->psCoefficients + ((DWORD)(wY / bV) * wMcusInRow + wX / bH) * pJpegDecoder->bBlocksInOnePass * 64;
+                                 JPEG_vDecodeProgressiveBlock(pJpegDecoder, psMcu + (bFirstBlock + (wY % bV) * bH + (wX % bH)) * 64, bChannel);
+                                 wCount++;
+                          }
+                   }
+            }
+            else
             {
-                    pJpegDecoder->wPrevX = 0;
-                    pJpegDecoder->wPrevY += 8;
+                   psMcu = pJpegDecoder->psCoefficients;
+                   for(wY = 0; wY < wMcuRows && (DWORD)wY * bMcuHeight < pJpegDecoder->wVisibleHeight; wY++)
+                   {
+                          IMG_vCheckAndAbort();
+                          IMG_vLoopCallback();
+                          for(wX = 0; wX < wMcusInRow; wX++)
+                          {
+                                 if(pJpegDecoder->wRestartInterval > 0 && wCount == pJpegDecoder->wRestartInterval)
+                                 {
+                                        JPEG_wGetRestartWord(pJpegDecoder);
+                                        JPEG_vRestartDecoding(pJpegDecoder);
+                                        wCount = 0;
+                                 }
+                                 for(bBlock = 0; bBlock < pJpegDecoder->bBlocksInOnePass; bBlock++)
+                                 {
+                                        bChannel = pJpegDecoder->abChannelMap[bBlock];
+                                        if(bChannel == pJpegDecoder->abScanChannel[0] ||
+                                           (pJpegDecoder->bScanChannels > 1 && bChannel == pJpegDecoder->abScanChannel[1]) ||
+                                           (pJpegDecoder->bScanChannels > 2 && bChannel == pJpegDecoder->abScanChannel[2]))
+                                        {
+                                               JPEG_vDecodeProgressiveBlock(pJpegDecoder, psMcu + bBlock * 64, bChannel);
+                                        }
+                                 }
+                                 psMcu += pJpegDecoder->bBlocksInOnePass * 64;
+                                 wCount++;
+                          }
+                   }
             }
      }
-     else if(pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x2)
-     {
-            SHORT *psY, *psCb, *psCr;
-            BYTE bBlock, bOffsetX[4] = {0,8,0,8}, bOffsetY[4] = {0,0,8,8}, bCbCrOffset[4] = {0,4,32,36};
 
-            for(bBlock = 0; bBlock < 4; bBlock++)
+     /* Skip the rest of the scan up to the next marker, which is not a restart marker */
+     while(1)
+     {
+            bBlock = JPEG_bNextMarker(pJpegDecoder, &dwOffset);
+            if(bBlock < RST0 || bBlock > RST7)
             {
-                    psY = &pJpegDecoder->asOneBlock[bBlock][0];
-                    psCb = &pJpegDecoder->asOneBlock[4][bCbCrOffset[bBlock]];
-                    psCr = &pJpegDecoder->asOneBlock[5][bCbCrOffset[bBlock]];
-                    for(wY = 0; wY < 8; wY++)
-                    {
-                            for(wX = 0; wX < 8; wX++)
-                            {
-                                     LONG s1 = ((*psY) + 128)*128;
-                                     LONG s2 = psCb[(wY>>1)*8+(wX>>1)];
-                                     LONG s3 = psCr[(wY>>1)*8+(wX>>1)];
-                                     r = range_limit((s1 + 180*s3)>>7);
-                                     g = range_limit((s1 - 44*s2 - 91*s3)>>7);
-                                     b = range_limit((s1 + 227*s2)>>7);
-                                     IMG_vSetColor(r, g, b);
-                                     IMG_vPutPixel(pJpegDecoder->wPrevX + bOffsetX[bBlock] + wX,
-                                              pJpegDecoder->wPrevY + bOffsetY[bBlock] + wY);
-                                     psY++;
-                            }
-                    }
+                   break;
             }
+     }
+     IMG_FSEEK(pJpegDecoder->pImageFile, dwOffset, 0);
+     JPEG_vRestartDecoding(pJpegDecoder);
+     pJpegDecoder->wBufferLen = 0;
+     pJpegDecoder->wBufferIndex = 0;
+     return 0;
+}
+
+/*******************************************************************************
+Function:       BYTE JPEG_bDecodeProgressive(JPEGDECODER *pJpegDecoder, WORD wMcusInRow, WORD wMcuRows)
+
+Precondition:   The first scan header must be read and psCoefficients must
+                hold a cleared buffer for all the MCUs
 
-            pJpegDecoder->wPrevX += 16;
+Overview:       Decodes all the scans of a progressive image into the
+                coefficient buffer, reading the tables and the scan header in
+                between. Then the blocks are inverse transformed and painted
+                the same way as a sequential image.
+
+Input:          JPEGDECODER, number of MCUs in a row, number of MCU rows
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+static BYTE JPEG_bDecodeProgressive(JPEGDECODER *pJpegDecoder, WORD wMcusInRow, WORD wMcuRows)
+{
+     WORD wX, wY;
+     BYTE bBlock, bLastCoef, bRetVal;
+     BYTE bMcuHeight = (pJpegDecoder->bSubSampleType == JPEG_SAMPLE_1x2 || pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x2)? 16: 8;
+     SHORT *psMcu;
 
-            if(pJpegDecoder->wPrevX >= pJpegDecoder->wWidth)
+     while(pJpegDecoder->blEndOfImage == FALSE)
+     {
+            JPEG_bGenerateHuffmanTables(pJpegDecoder);
+            bRetVal = JPEG_bDecodeScan(pJpegDecoder, wMcusInRow, wMcuRows);
+            if(bRetVal != 0)
+            {
+                   return bRetVal;
+            }
+            if(JPEG_bReadHeader(pJpegDecoder) != 0)
             {
-                    pJpegDecoder->wPrevX = 0;
-                    pJpegDecoder->wPrevY += 16;
+                   return pJpegDecoder->bError;
             }
-     }       
+     }
 
- #endif
-     return 0;
+     psMcu = pJpegDecoder->psCoefficients;
+     for(wY = 0; wY < wMcuRows && (DWORD)wY * bMcuHeight < pJpegDecoder->wVisibleHeight; wY++)
+     {
+            for(wX = 0; wX < wMcusInRow; wX++)
+            {
+                   IMG_vCheckAndAbort();
+                   IMG_vLoopCallback();
+                   for(bBlock = 0; bBlock < pJpegDecoder->bBlocksInOnePass; bBlock++)
+                   {
+                          for(bLastCoef = 0; bLastCoef < 64; bLastCoef++)
+                          {
+                                 pJpegDecoder->asOneBlock[bBlock][bLastCoef] = psMcu[bLastCoef];
+                          }
+                          for(bLastCoef = 63; bLastCoef > 0 && psMcu[abZigzag[bLastCoef]] == 0; bLastCoef--);
+                          psMcu += 64;
+
+                          pJpegDecoder->pwCurrentQuantTable = &pJpegDecoder->awQuantTable[pJpegDecoder->abChannelQuantTableMap[pJpegDecoder->abChannelMap[bBlock]]][0];
+                          if((pJpegDecoder->wPrevX << pJpegDecoder->bScaleShift) < pJpegDecoder->wVisibleWidth)
+                          {
+                                 JPEG_vInverseDct(pJpegDecoder, bBlock, bLastCoef);
+                          }
+                   }
+                   JPEG_bPaintOneBlock(pJpegDecoder);
+            }
+     }
+     return pJpegDecoder->bError;
 }
+#endif
 
 /*******************************************************************************
 Function:       BYTE JPEG_bDecode(IMG_FILE *pfile)
@@ -1003,8 +1842,10 @@ Output:         Error code - '0' means no error
 *******************************************************************************/
 BYTE JPEG_bDecode(IMG_FILE *pfile)
 {
-     WORD whblocks, wvblocks, wHAdd = 0, wVAdd = 0;
+     WORD whblocks, wvblocks, wMcuWidth, wMcuHeight;
      WORD wi, wj;
+     BYTE bFactor;
+     DWORD dwVisible;
      JPEGDECODER JPEG_JpegDecoder;
 
      JPEG_vResetDecoder(&JPEG_JpegDecoder);
@@ -1018,45 +1859,85 @@ BYTE JPEG_bDecode(IMG_FILE *pfile)
      IMG_wImageHeight = JPEG_JpegDecoder.wHeight;
      IMG_vSetboundaries();
 
-     JPEG_bGenerateHuffmanTables(&JPEG_JpegDecoder);
-
-     whblocks = JPEG_JpegDecoder.wWidth >> 3;
-     wvblocks = JPEG_JpegDecoder.wHeight >> 3;
-
-     if(whblocks * 8 < JPEG_JpegDecoder.wWidth) /* Odd sizes */
-     {
-         wHAdd = 1;
-     }
-
-     if(wvblocks * 8 < JPEG_JpegDecoder.wHeight) /* Odd sizes */
+     /* When the image is downscaled, the IDCT directly produces a 1/2, 1/4
+        or 1/8 size image, the rest of the scaling is done by IMG_vPutSpan() */
+     if(IMG_bDownScalingFactor >= 8)
      {
-         wVAdd = 1;
+         JPEG_JpegDecoder.bScaleShift = 3;
      }
-
-     if(JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_1x2)
+     else if(IMG_bDownScalingFactor >= 4)
      {
-         wvblocks >>= 1;
+         JPEG_JpegDecoder.bScaleShift = 2;
      }
-     else if(JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_2x1)
+     else if(IMG_bDownScalingFactor >= 2)
      {
-         whblocks >>= 1;
+         JPEG_JpegDecoder.bScaleShift = 1;
      }
-     else if(JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_2x2)
+     IMG_bDecodeScale = 1 << JPEG_JpegDecoder.bScaleShift;
+
+     /* Only the part of the image which falls on the screen is decoded */
+     bFactor = (IMG_bDownScalingFactor > 1)? IMG_bDownScalingFactor: 1;
+     dwVisible = (IMG_wStartX < IMG_SCREEN_WIDTH)? (DWORD)(IMG_SCREEN_WIDTH - IMG_wStartX) * bFactor: 0;
+     JPEG_JpegDecoder.wVisibleWidth = (dwVisible < JPEG_JpegDecoder.wWidth)? (WORD)dwVisible: JPEG_JpegDecoder.wWidth;
+     dwVisible = (IMG_wStartY < IMG_SCREEN_HEIGHT)? (DWORD)(IMG_SCREEN_HEIGHT - IMG_wStartY) * bFactor: 0;
+     JPEG_JpegDecoder.wVisibleHeight = (dwVisible < JPEG_JpegDecoder.wHeight)? (WORD)dwVisible: JPEG_JpegDecoder.wHeight;
+
+     JPEG_bGenerateHuffmanTables(&JPEG_JpegDecoder);
+
+ #if JPEG_USE_FAST_IDCT != 0
+     if(JPEG_JpegDecoder.bScaleShift == 0)
      {
-         whblocks >>= 1;
-         wvblocks >>= 1;
+         for(wi = 0; wi < MAX_CHANNELS; wi++) /* The fast IDCT needs the AAN scale factors in the quantization tables */
+         {
+             jpeg_idct_ifast_scale_quant(&JPEG_JpegDecoder.awQuantTable[wi][0]);
+         }
      }
+ #endif
 
-     whblocks += wHAdd;
-     wvblocks += wVAdd;
+     /* Number of MCUs, an MCU is 8, 16 or 32 pixels wide/high */
+     wMcuWidth = (JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_2x1 || JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_2x2)? 16: 8;
+     wMcuHeight = (JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_1x2 || JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_2x2)? 16: 8;
+     whblocks = (JPEG_JpegDecoder.wWidth + wMcuWidth - 1) / wMcuWidth;
+     wvblocks = (JPEG_JpegDecoder.wHeight + wMcuHeight - 1) / wMcuHeight;
 
      JPEG_vInitDisplay(&JPEG_JpegDecoder);
 
-     for(wi = 0; wi < whblocks; wi++)
+ #ifdef JPEG_SUPPORT_PROGRESSIVE
+     if(JPEG_JpegDecoder.blProgressive == TRUE)
      {
-            for(wj = 0; wj < wvblocks; wj++)
+         BYTE bRetVal;
+         DWORD dwCounter, dwSize = (DWORD)whblocks * wvblocks * JPEG_JpegDecoder.bBlocksInOnePass * 64 * sizeof(SHORT);
+
+       #if JPEG_PROGRESSIVE_MAX_BUFFER > 0
+         if(dwSize > JPEG_PROGRESSIVE_MAX_BUFFER)
+         {
+             return JPEG_ERROR_PROGRESSIVE_BUFFER;
+         }
+       #endif
+         if(dwSize != (size_t)dwSize || (JPEG_JpegDecoder.psCoefficients = (SHORT*)malloc((size_t)dwSize)) == NULL)
+         {
+             return JPEG_ERROR_PROGRESSIVE_BUFFER;
+         }
+         for(dwCounter = 0; dwCounter < dwSize / sizeof(SHORT); dwCounter++)
+         {
+             JPEG_JpegDecoder.psCoefficients[dwCounter] = 0;
+         }
+         bRetVal = JPEG_bDecodeProgressive(&JPEG_JpegDecoder, whblocks, wvblocks);
+         free(JPEG_JpegDecoder.psCoefficients);
+         return bRetVal;
+     }
+ #endif
+
+     for(wj = 0; wj < wvblocks && (DWORD)wj * wMcuHeight < JPEG_JpegDecoder.wVisibleHeight; wj++)
+     {
+            for(wi = 0; wi < whblocks; wi++)
             {
                    IMG_vCheckAndAbort();
+                   if(JPEG_bSkipRestartInterval(&JPEG_JpegDecoder, whblocks - wi) != 0) /* Off the screen */
+                   {
+                          wi += JPEG_JpegDecoder.wRestartInterval - 1;
+                          continue;
+                   }
                    JPEG_bDecodeOneBlock(&JPEG_JpegDecoder); /* Fills a block after correcting the zigzag, dequantizing, IDCR and color conversion to RGB */
                    JPEG_bPaintOneBlock(&JPEG_JpegDecoder); /* Sends the block to the Graphics unit */
             }
@@ -0,0 +1,414 @@
+/*
+ * jidctfst.c
+ *
+ * Copyright (C) 1994-1998, Thomas G. Lane.
+ * This file is part of the Independent JPEG Group's software.
+ * For conditions of distribution and use, see the accompanying README file.
+ *
+ * This file contains a fast, not so accurate integer implementation of the
+ * inverse DCT (Discrete Cosine Transform).  In the IJG code, this routine
+ * must also perform dequantization of the input coefficients.
+ *
+ * A 2-D IDCT can be done by 1-D IDCT on each column followed by 1-D IDCT
+ * on each row (or vice versa, but it's more convenient to emit a row at
+ * a time).  Direct algorithms are also available, but they are much more
+ * complex and seem not to be any faster when reduced to code.
+ *
+ * This implementation is based on Arai, Agui, and Nakajima's algorithm for
+ * scaled DCT.  Their original paper (Trans. IEICE E-71(11):1095) is in
+ * Japanese, but the algorithm is described in the Pennebaker & Mitchell
+ * JPEG textbook (see REFERENCES section in file README).  The following code
+ * is based directly on figure 4-8 in P&M.
+ * While an 8-point DCT cannot be done in less than 11 multiplies, it is
+ * possible to arrange the computation so that many of the multiplies are
+ * simple scalings of the final outputs.  These multiplies can then be
+ * folded into the multiplications or divisions by the JPEG quantization
+ * table entries.  The AA&N method leaves only 5 multiplies and 29 adds
+ * to be done in the DCT itself.
+ * The primary disadvantage of this method is that with fixed-point math,
+ * accuracy is lost due to imprecise representation of the scaled
+ * quantization values.  The smaller the quantization table entry, the less
+ * precise the scaled value, so this implementation does worse with high-
+ * quality-setting files than with low-quality ones.
+ *
+ * The quantization table must be scaled with jpeg_idct_ifast_scale_quant()
+ * before it is used here.  Blocks holding only the DC coefficient, and
+ * blocks whose coefficients all lie in the upper left 4x4 corner, are
+ * taken through shorter paths that give the same result as the full one.
+ */
+
+#include "GenericTypeDefs.h"
+
+
+/*
+ * This module is specialized to the case DCTSIZE = 8.
+ */
+
+#define DCTSIZE		    8	/* The basic DCT block is 8x8 samples */
+#define DCTSIZE2	    64	/* DCTSIZE squared; # of elements in a block */
+#define DCTELEM LONG
+
+/*
+ * Scaling decisions are generally the same as in the LL&M algorithm;
+ * see jidctint.c for more details.  However, we choose to descale
+ * (right shift) multiplication products as soon as they are formed,
+ * rather than carrying additional fractional bits into subsequent additions.
+ * This compromises accuracy slightly, but it lets us save a few shifts.
+ * The IJG code carries only 2 fraction bits so that 16-bit arithmetic is
+ * adequate; here DCTELEM is 32 bits wide, so PASS1_BITS is 5 and the
+ * products are rounded.  This keeps the output within 1 of jpeg_idct_islow().
+ *
+ * The dequantized coefficients are not integers because the AA&N scaling
+ * factors have been incorporated.  We represent them scaled up by PASS1_BITS,
+ * so that the first and second IDCT rounds have the same input scaling.
+ * The IJG code keeps the multiplier table scaled by PASS1_BITS only, which
+ * turns the smallest scaled entries of high quality files (quantization
+ * value 1) into 0.  Here the table keeps QUANT_EXTRA_BITS more bits, which
+ * still fit in a WORD for 8 bit quantization tables, and the dequantized
+ * coefficient is shifted down by them.
+ */
+
+#define CONST_BITS  8
+#define PASS1_BITS  5
+
+#define AAN_SCALE_BITS    14	/* Scaling of the aanscales[] table */
+#define QUANT_EXTRA_BITS  2	/* Extra precision of the multiplier table */
+
+/* We use the fixed-point constants scaled by CONST_BITS bits. */
+
+#define FIX_1_082392200  ((LONG)  277)		/* FIX(1.082392200) */
+#define FIX_1_414213562  ((LONG)  362)		/* FIX(1.414213562) */
+#define FIX_1_847759065  ((LONG)  473)		/* FIX(1.847759065) */
+#define FIX_2_613125930  ((LONG)  669)		/* FIX(2.613125930) */
+
+
+/* Descale and correctly round an INT32 value that's scaled by N bits.
+ * We assume RIGHT_SHIFT rounds towards minus infinity, so adding
+ * the fudge factor is correct for either sign of X.
+ */
+
+#define DESCALE(x,n)  (((x) + ((LONG)0x01 << ((n)-1))) >> (n))
+
+/* Multiply a DCTELEM variable by an INT32 constant, and immediately
+ * descale to yield a DCTELEM result.  The product is rounded, as in the
+ * IJG code with USE_ACCURATE_ROUNDING.
+ */
+
+#define MULTIPLY(var,const)  ((DCTELEM) DESCALE((LONG)(var) * (const), CONST_BITS))
+
+/* The outputs are descaled without rounding; instead the rounding constant
+ * is added to the DC term of each row, which feeds all 8 outputs of the row.
+ */
+
+#define IDESCALE(x,n)  ((LONG)(x) >> (n))
+#define ROUNDING       ((DCTELEM)1 << (PASS1_BITS+2))
+#define range_limit(x) ((x)<-128)?-128:((x)>127)?127:(x)
+
+
+/* Dequantize a coefficient by multiplying it by the multiplier-table
+ * entry; produce a DCTELEM result.
+ */
+
+#define DEQUANTIZE(coef,quantval)  DESCALE((DCTELEM)(coef) * (quantval), QUANT_EXTRA_BITS)
+
+
+/* For AA&N IDCT method, multipliers are equal to quantization
+ * coefficients scaled by scalefactor[row]*scalefactor[col], where
+ *   scalefactor[0] = 1
+ *   scalefactor[k] = cos(k*PI/16) * sqrt(2)    for k=1..7
+ * For integer operation, the multiplier table is to be scaled by
+ * PASS1_BITS + QUANT_EXTRA_BITS.
+ */
+
+static const WORD aanscales[DCTSIZE2] = {
+  /* precomputed values scaled up by 14 bits */
+  16384, 22725, 21407, 19266, 16384, 12873,  8867,  4520,
+  22725, 31521, 29692, 26722, 22725, 17855, 12299,  6270,
+  21407, 29692, 27969, 25172, 21407, 16819, 11585,  5906,
+  19266, 26722, 25172, 22654, 19266, 15137, 10426,  5315,
+  16384, 22725, 21407, 19266, 16384, 12873,  8867,  4520,
+  12873, 17855, 16819, 15137, 12873, 10114,  6967,  3552,
+   8867, 12299, 11585, 10426,  8867,  6967,  4799,  2446,
+   4520,  6270,  5906,  5315,  4520,  3552,  2446,  1247
+};
+
+
+/*
+ * Scale a quantization table (natural order) into the multiplier table
+ * used by jpeg_idct_ifast().  Entries that do not fit in 16 bits are
+ * saturated; they can only come from 16 bit quantization tables.
+ */
+
+void jpeg_idct_ifast_scale_quant (WORD *quantptr)
+{
+  BYTE ctr;
+  LONG scaled;
+
+  for (ctr = 0; ctr < DCTSIZE2; ctr++) {
+    scaled = DESCALE((LONG) quantptr[ctr] * aanscales[ctr], AAN_SCALE_BITS-PASS1_BITS-QUANT_EXTRA_BITS);
+    quantptr[ctr] = (scaled > 0xFFFF) ? 0xFFFF : (WORD) scaled;
+  }
+}
+
+
+/*
+ * Perform dequantization and inverse DCT on one block of coefficients.
+ * lastcoef is the zigzag index of the last coefficient that may be
+ * non-zero.  The output replaces the input, level shifted to -128..127.
+ */
+
+void jpeg_idct_ifast (SHORT *inbuf, WORD *quantptr, BYTE lastcoef)
+{
+  DCTELEM tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
+  DCTELEM tmp10, tmp11, tmp12, tmp13;
+  DCTELEM z5, z10, z11, z12, z13;
+  SHORT *inptr = inbuf, *outptr;
+  DCTELEM *wsptr;
+  LONG dcval;
+  BYTE ctr;
+  DCTELEM workspace[DCTSIZE2];	/* buffers data between passes */
+
+  /* DC only: the output is flat. */
+
+  if (lastcoef == 0) {
+    dcval = IDESCALE(DEQUANTIZE(inptr[0], quantptr[0]) + ROUNDING, PASS1_BITS+3);
+    dcval = range_limit(dcval);
+    for (ctr = 0; ctr < DCTSIZE2; ctr++)
+      inbuf[ctr] = (SHORT) dcval;
+    return;
+  }
+
+  /* Zigzag positions 0..9 all lie in the upper left 4x4 corner, so the
+   * lower half of each column and the right half of each row are zero.
+   * Only the left 4 columns are transformed and the row pass reads only
+   * the left 4 entries of the work array.
+   */
+
+  if (lastcoef <= 9) {
+    wsptr = workspace;
+    for (ctr = 4; ctr > 0; ctr--) {
+      /* Even part */
+      tmp10 = DEQUANTIZE(inptr[DCTSIZE*0], quantptr[DCTSIZE*0]);
+      tmp13 = DEQUANTIZE(inptr[DCTSIZE*2], quantptr[DCTSIZE*2]);
+
+      tmp12 = MULTIPLY(tmp13, FIX_1_414213562) - tmp13;
+
+      tmp0 = tmp10 + tmp13;
+      tmp3 = tmp10 - tmp13;
+      tmp1 = tmp10 + tmp12;
+      tmp2 = tmp10 - tmp12;
+
+      /* Odd part */
+      tmp4 = DEQUANTIZE(inptr[DCTSIZE*1], quantptr[DCTSIZE*1]);
+      tmp5 = DEQUANTIZE(inptr[DCTSIZE*3], quantptr[DCTSIZE*3]);
+
+      tmp7 = tmp4 + tmp5;
+      tmp11 = MULTIPLY(tmp4 - tmp5, FIX_1_414213562);
+      z5 = MULTIPLY(tmp4 - tmp5, FIX_1_847759065);
+      tmp10 = MULTIPLY(tmp4, FIX_1_082392200) - z5;
+      tmp12 = MULTIPLY(-tmp5, - FIX_2_613125930) + z5;
+
+      tmp6 = tmp12 - tmp7;
+      tmp5 = tmp11 - tmp6;
+      tmp4 = tmp10 + tmp5;
+
+      wsptr[DCTSIZE*0] = tmp0 + tmp7;
+      wsptr[DCTSIZE*7] = tmp0 - tmp7;
+      wsptr[DCTSIZE*1] = tmp1 + tmp6;
+      wsptr[DCTSIZE*6] = tmp1 - tmp6;
+      wsptr[DCTSIZE*2] = tmp2 + tmp5;
+      wsptr[DCTSIZE*5] = tmp2 - tmp5;
+      wsptr[DCTSIZE*4] = tmp3 + tmp4;
+      wsptr[DCTSIZE*3] = tmp3 - tmp4;
+
+      inptr++;
+      quantptr++;
+      wsptr++;
+    }
+
+    wsptr = workspace;
+    outptr = &inbuf[0];
+    for (ctr = 0; ctr < DCTSIZE; ctr++) {
+      /* Even part */
+      tmp10 = wsptr[0] + ROUNDING;
+      tmp13 = wsptr[2];
+
+      tmp12 = MULTIPLY(tmp13, FIX_1_414213562) - tmp13;
+
+      tmp0 = tmp10 + tmp13;
+      tmp3 = tmp10 - tmp13;
+      tmp1 = tmp10 + tmp12;
+      tmp2 = tmp10 - tmp12;
+
+      /* Odd part */
+      tmp4 = wsptr[1];
+      tmp5 = wsptr[3];
+
+      tmp7 = tmp4 + tmp5;
+      tmp11 = MULTIPLY(tmp4 - tmp5, FIX_1_414213562);
+      z5 = MULTIPLY(tmp4 - tmp5, FIX_1_847759065);
+      tmp10 = MULTIPLY(tmp4, FIX_1_082392200) - z5;
+      tmp12 = MULTIPLY(-tmp5, - FIX_2_613125930) + z5;
+
+      tmp6 = tmp12 - tmp7;
+      tmp5 = tmp11 - tmp6;
+      tmp4 = tmp10 + tmp5;
+
+      dcval = IDESCALE(tmp0 + tmp7, PASS1_BITS+3); outptr[0] = (SHORT)range_limit(dcval);
+      dcval = IDESCALE(tmp0 - tmp7, PASS1_BITS+3); outptr[7] = (SHORT)range_limit(dcval);
+      dcval = IDESCALE(tmp1 + tmp6, PASS1_BITS+3); outptr[1] = (SHORT)range_limit(dcval);
+      dcval = IDESCALE(tmp1 - tmp6, PASS1_BITS+3); outptr[6] = (SHORT)range_limit(dcval);
+      dcval = IDESCALE(tmp2 + tmp5, PASS1_BITS+3); outptr[2] = (SHORT)range_limit(dcval);
+      dcval = IDESCALE(tmp2 - tmp5, PASS1_BITS+3); outptr[5] = (SHORT)range_limit(dcval);
+      dcval = IDESCALE(tmp3 + tmp4, PASS1_BITS+3); outptr[4] = (SHORT)range_limit(dcval);
+      dcval = IDESCALE(tmp3 - tmp4, PASS1_BITS+3); outptr[3] = (SHORT)range_limit(dcval);
+
+      outptr += DCTSIZE;
+      wsptr += DCTSIZE;
+    }
+    return;
+  }
+
+  /* Pass 1: process columns from input, store into work array. */
+
+  wsptr = workspace;
+  for (ctr = DCTSIZE; ctr > 0; ctr--) {
+    /* Due to quantization, we will usually find that many of the input
+     * coefficients are zero, especially the AC terms.  We can exploit this
+     * by short-circuiting the IDCT calculation for any column in which all
+     * the AC terms are zero.  In that case each output is equal to the
+     * DC coefficient (with scale factor as needed).
+     * With typical images and quantization tables, half or more of the
+     * column DCT calculations can be simplified this way.
+     */
+
+    if (inptr[DCTSIZE*1] == 0 && inptr[DCTSIZE*2] == 0 &&
+	inptr[DCTSIZE*3] == 0 && inptr[DCTSIZE*4] == 0 &&
+	inptr[DCTSIZE*5] == 0 && inptr[DCTSIZE*6] == 0 &&
+	inptr[DCTSIZE*7] == 0) {
+      /* AC terms all zero */
+      dcval = DEQUANTIZE(inptr[DCTSIZE*0], quantptr[DCTSIZE*0]);
+
+      wsptr[DCTSIZE*0] = dcval;
+      wsptr[DCTSIZE*1] = dcval;
+      wsptr[DCTSIZE*2] = dcval;
+      wsptr[DCTSIZE*3] = dcval;
+      wsptr[DCTSIZE*4] = dcval;
+      wsptr[DCTSIZE*5] = dcval;
+      wsptr[DCTSIZE*6] = dcval;
+      wsptr[DCTSIZE*7] = dcval;
+
+      inptr++;			/* advance pointers to next column */
+      quantptr++;
+      wsptr++;
+      continue;
+    }
+
+    /* Even part */
+
+    tmp0 = DEQUANTIZE(inptr[DCTSIZE*0], quantptr[DCTSIZE*0]);
+    tmp1 = DEQUANTIZE(inptr[DCTSIZE*2], quantptr[DCTSIZE*2]);
+    tmp2 = DEQUANTIZE(inptr[DCTSIZE*4], quantptr[DCTSIZE*4]);
+    tmp3 = DEQUANTIZE(inptr[DCTSIZE*6], quantptr[DCTSIZE*6]);
+
+    tmp10 = tmp0 + tmp2;	/* phase 3 */
+    tmp11 = tmp0 - tmp2;
+
+    tmp13 = tmp1 + tmp3;	/* phases 5-3 */
+    tmp12 = MULTIPLY(tmp1 - tmp3, FIX_1_414213562) - tmp13; /* 2*c4 */
+
+    tmp0 = tmp10 + tmp13;	/* phase 2 */
+    tmp3 = tmp10 - tmp13;
+    tmp1 = tmp11 + tmp12;
+    tmp2 = tmp11 - tmp12;
+
+    /* Odd part */
+
+    tmp4 = DEQUANTIZE(inptr[DCTSIZE*1], quantptr[DCTSIZE*1]);
+    tmp5 = DEQUANTIZE(inptr[DCTSIZE*3], quantptr[DCTSIZE*3]);
+    tmp6 = DEQUANTIZE(inptr[DCTSIZE*5], quantptr[DCTSIZE*5]);
+    tmp7 = DEQUANTIZE(inptr[DCTSIZE*7], quantptr[DCTSIZE*7]);
+
+    z13 = tmp6 + tmp5;		/* phase 6 */
+    z10 = tmp6 - tmp5;
+    z11 = tmp4 + tmp7;
+    z12 = tmp4 - tmp7;
+
+    tmp7 = z11 + z13;		/* phase 5 */
+    tmp11 = MULTIPLY(z11 - z13, FIX_1_414213562); /* 2*c4 */
+
+    z5 = MULTIPLY(z10 + z12, FIX_1_847759065); /* 2*c2 */
+    tmp10 = MULTIPLY(z12, FIX_1_082392200) - z5; /* 2*(c2-c6) */
+    tmp12 = MULTIPLY(z10, - FIX_2_613125930) + z5; /* -2*(c2+c6) */
+
+    tmp6 = tmp12 - tmp7;	/* phase 2 */
+    tmp5 = tmp11 - tmp6;
+    tmp4 = tmp10 + tmp5;
+
+    wsptr[DCTSIZE*0] = tmp0 + tmp7;
+    wsptr[DCTSIZE*7] = tmp0 - tmp7;
+    wsptr[DCTSIZE*1] = tmp1 + tmp6;
+    wsptr[DCTSIZE*6] = tmp1 - tmp6;
+    wsptr[DCTSIZE*2] = tmp2 + tmp5;
+    wsptr[DCTSIZE*5] = tmp2 - tmp5;
+    wsptr[DCTSIZE*4] = tmp3 + tmp4;
+    wsptr[DCTSIZE*3] = tmp3 - tmp4;
+
+    inptr++;			/* advance pointers to next column */
+    quantptr++;
+    wsptr++;
+  }
+
+  /* Pass 2: process rows from work array, store into output array. */
+  /* Note that we must descale the results by a factor of 8 == 2**3, */
+  /* and also undo the PASS1_BITS scaling. */
+
+  wsptr = workspace;
+  outptr = &inbuf[0];
+  for (ctr = 0; ctr < DCTSIZE; ctr++) {
+    /* Even part */
+
+    tmp10 = wsptr[0] + ROUNDING + wsptr[4];
+    tmp11 = wsptr[0] + ROUNDING - wsptr[4];
+
+    tmp13 = wsptr[2] + wsptr[6];
+    tmp12 = MULTIPLY(wsptr[2] - wsptr[6], FIX_1_414213562) - tmp13;
+
+    tmp0 = tmp10 + tmp13;
+    tmp3 = tmp10 - tmp13;
+    tmp1 = tmp11 + tmp12;
+    tmp2 = tmp11 - tmp12;
+
+    /* Odd part */
+
+    z13 = wsptr[5] + wsptr[3];
+    z10 = wsptr[5] - wsptr[3];
+    z11 = wsptr[1] + wsptr[7];
+    z12 = wsptr[1] - wsptr[7];
+
+    tmp7 = z11 + z13;		/* phase 5 */
+    tmp11 = MULTIPLY(z11 - z13, FIX_1_414213562); /* 2*c4 */
+
+    z5 = MULTIPLY(z10 + z12, FIX_1_847759065); /* 2*c2 */
+    tmp10 = MULTIPLY(z12, FIX_1_082392200) - z5; /* 2*(c2-c6) */
+    tmp12 = MULTIPLY(z10, - FIX_2_613125930) + z5; /* -2*(c2+c6) */
+
+    tmp6 = tmp12 - tmp7;	/* phase 2 */
+    tmp5 = tmp11 - tmp6;
+    tmp4 = tmp10 + tmp5;
+
+    /* Final output stage: scale down by a factor of 8 and range-limit */
+
+    dcval = IDESCALE(tmp0 + tmp7, PASS1_BITS+3); outptr[0] = (SHORT)range_limit(dcval);
+    dcval = IDESCALE(tmp0 - tmp7, PASS1_BITS+3); outptr[7] = (SHORT)range_limit(dcval);
+    dcval = IDESCALE(tmp1 + tmp6, PASS1_BITS+3); outptr[1] = (SHORT)range_limit(dcval);
+    dcval = IDESCALE(tmp1 - tmp6, PASS1_BITS+3); outptr[6] = (SHORT)range_limit(dcval);
+    dcval = IDESCALE(tmp2 + tmp5, PASS1_BITS+3); outptr[2] = (SHORT)range_limit(dcval);
+    dcval = IDESCALE(tmp2 - tmp5, PASS1_BITS+3); outptr[5] = (SHORT)range_limit(dcval);
+    dcval = IDESCALE(tmp3 + tmp4, PASS1_BITS+3); outptr[4] = (SHORT)range_limit(dcval);
+    dcval = IDESCALE(tmp3 - tmp4, PASS1_BITS+3); outptr[3] = (SHORT)range_limit(dcval);
+
+    outptr += DCTSIZE;		/* advance pointer to next row */
+    wsptr += DCTSIZE;		/* advance pointer to next row */
+  }
+}
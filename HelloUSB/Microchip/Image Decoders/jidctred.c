@@ -0,0 +1,283 @@
+/*
+ * jidctred.c
+ *
+ * Copyright (C) 1994-1998, Thomas G. Lane.
+ * This file is part of the Independent JPEG Group's software.
+ * For conditions of distribution and use, see the accompanying README file.
+ *
+ * This file contains inverse-DCT routines that produce reduced-size output:
+ * either 4x4, 2x2, or 1x1 pixels from an 8x8 DCT block.
+ *
+ * The implementation is based on the Loeffler, Ligtenberg and Moschytz (LL&M)
+ * algorithm used in jidctint.c.  We simply replace each 8-to-8 1-D IDCT step
+ * with an 8-to-4 step that produces the four averages of two adjacent outputs
+ * (or an 8-to-2 step producing two averages of four outputs, for 2x2 output).
+ * These steps were derived by computing the corresponding values at the end
+ * of the normal LL&M code, then simplifying as much as possible.
+ *
+ * 1x1 is trivial: just take the DC coefficient divided by 8.
+ *
+ * See jidctint.c for additional comments.
+ *
+ * The routines take the unscaled quantization table (natural order) and
+ * write their output over the input block, level shifted to -128..127.
+ * The rows of the output keep the stride of 8, so the 4x4 output uses
+ * entries 0..3, 8..11, 16..19 and 24..27 of the block.
+ */
+
+#include "GenericTypeDefs.h"
+
+
+/*
+ * This module is specialized to the case DCTSIZE = 8.
+ */
+
+#define DCTSIZE		    8	/* The basic DCT block is 8x8 samples */
+#define DCTSIZE2	    64	/* DCTSIZE squared; # of elements in a block */
+
+/* Scaling is the same as in jidctint.c. */
+
+#define CONST_BITS  13
+#define PASS1_BITS  2
+
+#define FIX_0_211164243  ((LONG)  1730)	/* FIX(0.211164243) */
+#define FIX_0_509795579  ((LONG)  4176)	/* FIX(0.509795579) */
+#define FIX_0_601344887  ((LONG)  4926)	/* FIX(0.601344887) */
+#define FIX_0_720959822  ((LONG)  5906)	/* FIX(0.720959822) */
+#define FIX_0_765366865  ((LONG)  6270)	/* FIX(0.765366865) */
+#define FIX_0_850430095  ((LONG)  6967)	/* FIX(0.850430095) */
+#define FIX_0_899976223  ((LONG)  7373)	/* FIX(0.899976223) */
+#define FIX_1_061594337  ((LONG)  8697)	/* FIX(1.061594337) */
+#define FIX_1_272758580  ((LONG)  10426)	/* FIX(1.272758580) */
+#define FIX_1_451774981  ((LONG)  11893)	/* FIX(1.451774981) */
+#define FIX_1_847759065  ((LONG)  15137)	/* FIX(1.847759065) */
+#define FIX_2_172734803  ((LONG)  17799)	/* FIX(2.172734803) */
+#define FIX_2_562915447  ((LONG)  20995)	/* FIX(2.562915447) */
+#define FIX_3_624509785  ((LONG)  29692)	/* FIX(3.624509785) */
+
+
+#define DESCALE(x,n)  (((x) + ((LONG)0x01 << ((n)-1))) >> (n))
+#define MULTIPLY(var,constant)  ((LONG)(var) * (constant))
+#define range_limit(x) ((x)<-128)?-128:((x)>127)?127:(x)
+
+
+#define DEQUANTIZE(coef,quantval)  ((LONG)(coef) * (quantval))
+
+
+/*
+ * Perform dequantization and inverse DCT on one block of coefficients,
+ * producing a reduced-size 4x4 output block.
+ */
+
+void jpeg_idct_4x4 (SHORT *inbuf, WORD *quantptr)
+{
+  LONG tmp0, tmp2, tmp10, tmp12;
+  LONG z1, z2, z3, z4;
+  SHORT *inptr = inbuf, *outptr;
+  LONG *wsptr;
+  LONG dcval;
+  BYTE ctr;
+  LONG workspace[DCTSIZE*4];	/* buffers data between passes */
+
+  /* Pass 1: process columns from input, store into work array. */
+
+  wsptr = workspace;
+  for (ctr = DCTSIZE; ctr > 0; inptr++, quantptr++, wsptr++, ctr--) {
+    /* Don't bother to process column 4, because second pass won't use it */
+    if (ctr == DCTSIZE-4)
+      continue;
+    if (inptr[DCTSIZE*1] == 0 && inptr[DCTSIZE*2] == 0 &&
+	inptr[DCTSIZE*3] == 0 && inptr[DCTSIZE*5] == 0 &&
+	inptr[DCTSIZE*6] == 0 && inptr[DCTSIZE*7] == 0) {
+      /* AC terms all zero; we need not examine term 4 for 4x4 output */
+      dcval = DEQUANTIZE(inptr[DCTSIZE*0], quantptr[DCTSIZE*0]) << PASS1_BITS;
+
+      wsptr[DCTSIZE*0] = dcval;
+      wsptr[DCTSIZE*1] = dcval;
+      wsptr[DCTSIZE*2] = dcval;
+      wsptr[DCTSIZE*3] = dcval;
+
+      continue;
+    }
+
+    /* Even part */
+
+    tmp0 = DEQUANTIZE(inptr[DCTSIZE*0], quantptr[DCTSIZE*0]);
+    tmp0 <<= (CONST_BITS+1);
+
+    z2 = DEQUANTIZE(inptr[DCTSIZE*2], quantptr[DCTSIZE*2]);
+    z3 = DEQUANTIZE(inptr[DCTSIZE*6], quantptr[DCTSIZE*6]);
+
+    tmp2 = MULTIPLY(z2, FIX_1_847759065) + MULTIPLY(z3, - FIX_0_765366865);
+
+    tmp10 = tmp0 + tmp2;
+    tmp12 = tmp0 - tmp2;
+
+    /* Odd part */
+
+    z1 = DEQUANTIZE(inptr[DCTSIZE*7], quantptr[DCTSIZE*7]);
+    z2 = DEQUANTIZE(inptr[DCTSIZE*5], quantptr[DCTSIZE*5]);
+    z3 = DEQUANTIZE(inptr[DCTSIZE*3], quantptr[DCTSIZE*3]);
+    z4 = DEQUANTIZE(inptr[DCTSIZE*1], quantptr[DCTSIZE*1]);
+
+    tmp0 = MULTIPLY(z1, - FIX_0_211164243) /* sqrt(2) * (c3-c1) */
+	 + MULTIPLY(z2, FIX_1_451774981) /* sqrt(2) * (c3+c7) */
+	 + MULTIPLY(z3, - FIX_2_172734803) /* sqrt(2) * (-c1-c5) */
+	 + MULTIPLY(z4, FIX_1_061594337); /* sqrt(2) * (c5+c7) */
+
+    tmp2 = MULTIPLY(z1, - FIX_0_509795579) /* sqrt(2) * (c7-c5) */
+	 + MULTIPLY(z2, - FIX_0_601344887) /* sqrt(2) * (c5-c1) */
+	 + MULTIPLY(z3, FIX_0_899976223) /* sqrt(2) * (c3-c7) */
+	 + MULTIPLY(z4, FIX_2_562915447); /* sqrt(2) * (c1+c3) */
+
+    /* Final output stage */
+
+    wsptr[DCTSIZE*0] = DESCALE(tmp10 + tmp2, CONST_BITS-PASS1_BITS+1);
+    wsptr[DCTSIZE*3] = DESCALE(tmp10 - tmp2, CONST_BITS-PASS1_BITS+1);
+    wsptr[DCTSIZE*1] = DESCALE(tmp12 + tmp0, CONST_BITS-PASS1_BITS+1);
+    wsptr[DCTSIZE*2] = DESCALE(tmp12 - tmp0, CONST_BITS-PASS1_BITS+1);
+  }
+
+  /* Pass 2: process 4 rows from work array, store into output array. */
+
+  wsptr = workspace;
+  outptr = &inbuf[0];
+  for (ctr = 0; ctr < 4; ctr++) {
+    /* Even part */
+
+    tmp0 = wsptr[0] << (CONST_BITS+1);
+
+    tmp2 = MULTIPLY(wsptr[2], FIX_1_847759065)
+	 + MULTIPLY(wsptr[6], - FIX_0_765366865);
+
+    tmp10 = tmp0 + tmp2;
+    tmp12 = tmp0 - tmp2;
+
+    /* Odd part */
+
+    z1 = wsptr[7];
+    z2 = wsptr[5];
+    z3 = wsptr[3];
+    z4 = wsptr[1];
+
+    tmp0 = MULTIPLY(z1, - FIX_0_211164243) /* sqrt(2) * (c3-c1) */
+	 + MULTIPLY(z2, FIX_1_451774981) /* sqrt(2) * (c3+c7) */
+	 + MULTIPLY(z3, - FIX_2_172734803) /* sqrt(2) * (-c1-c5) */
+	 + MULTIPLY(z4, FIX_1_061594337); /* sqrt(2) * (c5+c7) */
+
+    tmp2 = MULTIPLY(z1, - FIX_0_509795579) /* sqrt(2) * (c7-c5) */
+	 + MULTIPLY(z2, - FIX_0_601344887) /* sqrt(2) * (c5-c1) */
+	 + MULTIPLY(z3, FIX_0_899976223) /* sqrt(2) * (c3-c7) */
+	 + MULTIPLY(z4, FIX_2_562915447); /* sqrt(2) * (c1+c3) */
+
+    /* Final output stage */
+
+    dcval = DESCALE(tmp10 + tmp2, CONST_BITS+PASS1_BITS+3+1); outptr[0] = (SHORT)range_limit(dcval);
+    dcval = DESCALE(tmp10 - tmp2, CONST_BITS+PASS1_BITS+3+1); outptr[3] = (SHORT)range_limit(dcval);
+    dcval = DESCALE(tmp12 + tmp0, CONST_BITS+PASS1_BITS+3+1); outptr[1] = (SHORT)range_limit(dcval);
+    dcval = DESCALE(tmp12 - tmp0, CONST_BITS+PASS1_BITS+3+1); outptr[2] = (SHORT)range_limit(dcval);
+
+    outptr += DCTSIZE;		/* advance pointer to next row */
+    wsptr += DCTSIZE;		/* advance pointer to next row */
+  }
+}
+
+
+/*
+ * Perform dequantization and inverse DCT on one block of coefficients,
+ * producing a reduced-size 2x2 output block.
+ */
+
+void jpeg_idct_2x2 (SHORT *inbuf, WORD *quantptr)
+{
+  LONG tmp0, tmp10, z1;
+  SHORT *inptr = inbuf, *outptr;
+  LONG *wsptr;
+  LONG dcval;
+  BYTE ctr;
+  LONG workspace[DCTSIZE*2];	/* buffers data between passes */
+
+  /* Pass 1: process columns from input, store into work array. */
+
+  wsptr = workspace;
+  for (ctr = DCTSIZE; ctr > 0; inptr++, quantptr++, wsptr++, ctr--) {
+    /* Don't bother to process columns 2,4,6 */
+    if (ctr == DCTSIZE-2 || ctr == DCTSIZE-4 || ctr == DCTSIZE-6)
+      continue;
+    if (inptr[DCTSIZE*1] == 0 && inptr[DCTSIZE*3] == 0 &&
+	inptr[DCTSIZE*5] == 0 && inptr[DCTSIZE*7] == 0) {
+      /* AC terms all zero; we need not examine terms 2,4,6 for 2x2 output */
+      dcval = DEQUANTIZE(inptr[DCTSIZE*0], quantptr[DCTSIZE*0]) << PASS1_BITS;
+
+      wsptr[DCTSIZE*0] = dcval;
+      wsptr[DCTSIZE*1] = dcval;
+
+      continue;
+    }
+
+    /* Even part */
+
+    z1 = DEQUANTIZE(inptr[DCTSIZE*0], quantptr[DCTSIZE*0]);
+    tmp10 = z1 << (CONST_BITS+2);
+
+    /* Odd part */
+
+    z1 = DEQUANTIZE(inptr[DCTSIZE*7], quantptr[DCTSIZE*7]);
+    tmp0 = MULTIPLY(z1, - FIX_0_720959822); /* sqrt(2) * (c7-c5+c3-c1) */
+    z1 = DEQUANTIZE(inptr[DCTSIZE*5], quantptr[DCTSIZE*5]);
+    tmp0 += MULTIPLY(z1, FIX_0_850430095); /* sqrt(2) * (-c1+c3+c5+c7) */
+    z1 = DEQUANTIZE(inptr[DCTSIZE*3], quantptr[DCTSIZE*3]);
+    tmp0 += MULTIPLY(z1, - FIX_1_272758580); /* sqrt(2) * (-c1+c3-c5-c7) */
+    z1 = DEQUANTIZE(inptr[DCTSIZE*1], quantptr[DCTSIZE*1]);
+    tmp0 += MULTIPLY(z1, FIX_3_624509785); /* sqrt(2) * (c1+c3+c5+c7) */
+
+    /* Final output stage */
+
+    wsptr[DCTSIZE*0] = DESCALE(tmp10 + tmp0, CONST_BITS-PASS1_BITS+2);
+    wsptr[DCTSIZE*1] = DESCALE(tmp10 - tmp0, CONST_BITS-PASS1_BITS+2);
+  }
+
+  /* Pass 2: process 2 rows from work array, store into output array. */
+
+  wsptr = workspace;
+  outptr = &inbuf[0];
+  for (ctr = 0; ctr < 2; ctr++) {
+    /* Even part */
+
+    tmp10 = wsptr[0] << (CONST_BITS+2);
+
+    /* Odd part */
+
+    tmp0 = MULTIPLY(wsptr[7], - FIX_0_720959822) /* sqrt(2) * (c7-c5+c3-c1) */
+	 + MULTIPLY(wsptr[5], FIX_0_850430095) /* sqrt(2) * (-c1+c3+c5+c7) */
+	 + MULTIPLY(wsptr[3], - FIX_1_272758580) /* sqrt(2) * (-c1+c3-c5-c7) */
+	 + MULTIPLY(wsptr[1], FIX_3_624509785); /* sqrt(2) * (c1+c3+c5+c7) */
+
+    /* Final output stage */
+
+    dcval = DESCALE(tmp10 + tmp0, CONST_BITS+PASS1_BITS+3+2); outptr[0] = (SHORT)range_limit(dcval);
+    dcval = DESCALE(tmp10 - tmp0, CONST_BITS+PASS1_BITS+3+2); outptr[1] = (SHORT)range_limit(dcval);
+
+    outptr += DCTSIZE;		/* advance pointer to next row */
+    wsptr += DCTSIZE;		/* advance pointer to next row */
+  }
+}
+
+
+/*
+ * Perform dequantization and inverse DCT on one block of coefficients,
+ * producing a reduced-size 1x1 output block.
+ */
+
+void jpeg_idct_1x1 (SHORT *inbuf, WORD *quantptr)
+{
+  LONG dcval;
+
+  /* We hardly need an inverse DCT routine for this: just take the
+   * average pixel value, which is one-eighth of the DC coefficient.
+   */
+  dcval = DEQUANTIZE(inbuf[0], quantptr[0]);
+  dcval = DESCALE(dcval, 3);
+
+  inbuf[0] = (SHORT)range_limit(dcval);
+}
@@ -98,6 +98,7 @@ Value Range - The scale for the value axis.
 									// bar chart labels for variables are numeric. If this bit is not set, it indicates
 									// that the bar chart labels for variables are alphabets.
 
+#define CH_DRAW_STREAM	0x1000		// Bit to indicate only the samples set by ChStreamSample() must be redrawn.
 #define CH_DRAW_DATA   	0x2000  	// Bit to indicate data portion of the chart must be redrawn.
 #define CH_DRAW        	0x4000  	// Bit to indicate chart must be redrawn.
 #define CH_HIDE        	0x8000  	// Bit to indicate chart must be removed from screen.
@@ -163,6 +164,28 @@ typedef struct {
 //	XCHAR 		   *pCatLabel;		// Pointer to the array of category labels used for the samples axis.
 //									// If this is NULL labels are numeric (i.e. 1, 2, 3, ...etc).
 
+/*********************************************************************
+* Overview: Defines the layout of the last drawn bar chart and the 
+*			samples waiting to be drawn in the streaming mode 
+*			(CH_DRAW_STREAM state). The layout is saved only for 
+*			vertical bar charts drawn without 3-D effect and without 
+*			values shown.
+*
+*********************************************************************/
+typedef struct {
+	SHORT			xStart;			// Position of the value axis.
+	SHORT			yStart;			// Position of the sample axis.
+	WORD			splDelta;		// Space used by one sample. Zero if the layout is not saved.
+	WORD			valDelta;		// Space between the value grids.
+	WORD			smplStart;		// Start point of the drawn sample range.
+	WORD			smplEnd;		// End point of the drawn sample range.
+	WORD			valMax;			// Maximum value of the drawn value range.
+	WORD			valMin;			// Minimum value of the drawn value range.
+	SHORT			seriesCount;	// Number of data series drawn.
+	WORD			first;			// First sample waiting to be drawn.
+	WORD			count;			// Number of samples waiting to be drawn.
+} CHARTSTREAM;
+
 /*********************************************************************
 * Overview: Defines the parameters required for a chart Object.
 *
@@ -171,6 +194,7 @@ typedef struct {
 	OBJ_HEADER      hdr;			// Generic header for all Objects (see OBJ_HEADER).   
 	CHARTPARAM		prm;			// Structure for the parameters of the chart.
 	DATASERIES	   	*pChData;		// Pointer to the first chart data series in the link list of data series.	
+	CHARTSTREAM		stream;			// Layout and new samples used in the streaming mode (see CHARTSTREAM).
 
 } CHART;
 
@@ -597,6 +621,48 @@ void ChSetPercentRange(CHART *pCh, WORD min, WORD max);
 ********************************************************************/
 void ChSetSampleRange(CHART *pCh, WORD start, WORD end); 
 
+/*********************************************************************
+* Function: ChStreamSample(CHART *pCh, WORD sample)
+*
+* Overview: This function marks a sample of the bar chart as new. 
+*			When the chart is drawn with the CH_DRAW_STREAM state
+*			set only the bars of the new samples are redrawn, the 
+*			frame, grids, labels and legend are kept. 
+*
+*			In the streaming mode the sample range is used as a ring
+*			buffer: the application writes the new values of the 
+*			shown data series at the next sample position (after 
+*			smplEnd it continues at smplStart), calls this function 
+*			with the position and sets the CH_DRAW_STREAM state.
+*			All samples marked since the last drawing are drawn.
+*
+*			The chart is drawn completely instead if it was not drawn 
+*			before as a vertical bar chart without 3-D effect and values
+*			shown, or if the sample range, value range or number of 
+*			shown data series changed since it was drawn.
+*
+* PreCondition: none
+*
+* Input: pCh - Pointer to the chart object.
+*        sample - Position of the new sample, smplStart <= sample <= smplEnd.
+*
+* Output: none.
+*
+* Example:
+*   <PRE> 
+*		// add a new reading to the chart
+*		pSeries->pData[pos-1] = reading;
+*		ChStreamSample(pChart, pos);
+*		SetState(pChart, CH_DRAW_STREAM);
+*		if (++pos > ChGetSampleEnd(pChart))
+*			pos = ChGetSampleStart(pChart);
+*	</PRE> 
+*
+* Side Effects: none.
+*
+********************************************************************/
+void ChStreamSample(CHART *pCh, WORD sample); 
+
 /*********************************************************************
 * Function: ChGetSampleRange(pCh)
 *
@@ -0,0 +1,600 @@
+/*****************************************************************************
+ *  Module for Microchip Graphics Library
+ *  In-memory RGB565 frame buffer display driver
+ *****************************************************************************
+ * FileName:        Framebuffer.h
+ * Dependencies:    GraphicsConfig.h
+ * Processor:       PIC32, host PC
+ * Compiler:       	MPLAB C32, GCC
+ * Linker:          MPLAB LINK32, GNU ld
+ * Company:         Microchip Technology Incorporated
+ *
+ * Software License Agreement
+ *
+ * Copyright  2008 Microchip Technology Inc.  All rights reserved.
+ * Microchip licenses to you the right to use, modify, copy and distribute
+ * Software only when embedded on a Microchip microcontroller or digital
+ * signal controller, which is integrated into your product or third party
+ * product (pursuant to the sublicense terms in the accompanying license
+ * agreement).  
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED AS IS WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+ *****************************************************************************/
+#ifndef _FRAMEBUFFER_H
+#define _FRAMEBUFFER_H
+
+#include "GraphicsConfig.h"
+#include "GenericTypeDefs.h"
+
+/*********************************************************************
+* Overview: Additional functions implemented in the driver. These
+*           definitions exclude the PutPixel()-based functions in the
+*           primitives layer (Primitive.c file) from compilation.
+*********************************************************************/
+
+// Define this to implement Font related functions in the driver.
+//#define USE_DRV_FONT
+
+// Define this to implement Line function in the driver.
+//#define USE_DRV_LINE
+
+// Define this to implement Circle function in the driver.
+//#define USE_DRV_CIRCLE
+
+// Define this to implement FillCircle function in the driver.
+//#define USE_DRV_FILLCIRCLE
+
+// Define FRAMEBUFFER_GENERIC_PRIMITIVES in GraphicsConfig.h to leave
+// Bar, ClearDevice, PutImage and PutPixelRow to the primitives layer, as
+// for a driver without them. With the value 2 HLine is left out too and
+// everything is drawn with PutPixel. It lets the driver calls of other
+// display drivers be measured with the statistics counters.
+#ifndef FRAMEBUFFER_GENERIC_PRIMITIVES
+
+// Define this to implement Bar function in the driver.
+#define USE_DRV_BAR
+
+// Define this to implement ClearDevice function in the driver.
+#define USE_DRV_CLEARDEVICE
+
+// Define this to implement PutImage function in the driver.
+#define USE_DRV_PUTIMAGE
+
+// Define this to implement PutPixelRow function in the driver.
+#define USE_DRV_PUTPIXELROW
+
+#endif
+
+#if !defined(FRAMEBUFFER_GENERIC_PRIMITIVES) || (FRAMEBUFFER_GENERIC_PRIMITIVES < 2)
+// Define this to implement HLine function in the driver.
+#define USE_DRV_HLINE
+#endif
+
+/*********************************************************************
+* Overview: Horizontal and vertical screen size. The defaults can be
+*           overridden in GraphicsConfig.h to match the display that
+*           is being simulated.
+*********************************************************************/
+#ifndef SCREEN_HOR_SIZE
+#define SCREEN_HOR_SIZE    320
+#endif
+#ifndef SCREEN_VER_SIZE
+#define SCREEN_VER_SIZE    240
+#endif
+
+/*********************************************************************
+* Overview: Clipping region control codes to be used with SetClip(...)
+*           function.
+*********************************************************************/
+#define CLIP_DISABLE       0 	// Disables clipping.
+#define CLIP_ENABLE        1	// Enables clipping.
+
+/*********************************************************************
+* Overview: Some basic colors definitions.
+*********************************************************************/
+#define BLACK              (WORD)0x0000
+#define BRIGHTBLUE         (WORD)0x001f
+#define BRIGHTGREEN        (WORD)0x07e0
+#define BRIGHTCYAN         (WORD)0x07ff
+#define BRIGHTRED          (WORD)0xf800
+#define BRIGHTMAGENTA      (WORD)0xf81f
+#define BRIGHTYELLOW       (WORD)0xffe0
+#define BLUE               (WORD)0x0010
+#define GREEN              (WORD)0x0400
+#define CYAN               (WORD)0x0410
+#define RED                (WORD)0x8000
+#define MAGENTA            (WORD)0x8010
+#define BROWN              (WORD)0xfc00
+#define LIGHTGRAY          (WORD)0x8410
+#define DARKGRAY           (WORD)0x4208
+#define LIGHTBLUE          (WORD)0x841f
+#define LIGHTGREEN         (WORD)0x87f0
+#define LIGHTCYAN          (WORD)0x87ff
+#define LIGHTRED           (WORD)0xfc10
+#define LIGHTMAGENTA       (WORD)0xfc1f
+#define YELLOW             (WORD)0xfff0
+#define WHITE              (WORD)0xffff
+
+#define GRAY0       	   (WORD)0xe71c
+#define GRAY1         	   (WORD)0xc618
+#define GRAY2              (WORD)0xa514
+#define GRAY3              (WORD)0x8410
+#define GRAY4              (WORD)0x630c
+#define GRAY5              (WORD)0x4208
+#define GRAY6	           (WORD)0x2104
+
+// Color
+extern WORD _color;
+
+/*********************************************************************
+* Overview: Clipping region control and border settings.
+*
+*********************************************************************/
+// Clipping region enable control
+extern SHORT _clipRgn;
+
+// Left clipping region border
+extern SHORT _clipLeft;
+// Top clipping region border
+extern SHORT _clipTop;
+// Right clipping region border
+extern SHORT _clipRight;
+// Bottom clipping region border
+extern SHORT _clipBottom;
+
+/*********************************************************************
+* Overview: Frame buffer memory. Pixels are stored row by row in
+*           5:6:5 RGB format, _frameBuffer[y][x] is the pixel at x,y.
+*
+*********************************************************************/
+extern WORD _frameBuffer[SCREEN_VER_SIZE][SCREEN_HOR_SIZE];
+
+#ifdef USE_DOUBLE_BUFFERING
+/*********************************************************************
+* Overview: Back buffer memory. Define USE_DOUBLE_BUFFERING in 
+*           GraphicsConfig.h to draw into the back buffer instead of 
+*           the frame buffer. Drawn areas must be passed to 
+*           InvalidateRectangle() and are copied to the frame buffer 
+*           by UpdateDisplayNow(), so partially drawn screens are 
+*           never shown. GOLDraw() does it for the objects. This is 
+*           the only driver that supports double buffering.
+*
+*********************************************************************/
+extern WORD _backBuffer[SCREEN_VER_SIZE][SCREEN_HOR_SIZE];
+
+// Number of invalidated areas kept, if more areas are invalidated 
+// the whole screen is copied.
+#ifndef FRAMEBUFFER_INVALID_RECS
+#define FRAMEBUFFER_INVALID_RECS    8
+#endif
+#endif
+
+#ifdef USE_FRAMEBUFFER_STATISTICS
+/*********************************************************************
+* Overview: Driver call and pixel counters. Define
+*           USE_FRAMEBUFFER_STATISTICS in GraphicsConfig.h to enable
+*           them. Reset the counters before a screen is drawn and read
+*           them afterwards to get the driver load of one frame.
+*
+*********************************************************************/
+typedef struct {
+    DWORD putPixel;         // Number of PutPixel() calls
+    DWORD getPixel;         // Number of GetPixel() calls
+    DWORD putPixelRow;      // Number of PutPixelRow() calls
+    DWORD bar;              // Number of Bar() calls
+    DWORD hLine;            // Number of HLine() calls
+    DWORD clearDevice;      // Number of ClearDevice() calls
+    DWORD putImage;         // Number of PutImage() calls
+    DWORD pixels;           // Number of pixels written (after clipping)
+    DWORD update;           // Number of UpdateDisplayNow() calls
+    DWORD updated;          // Number of pixels copied to the frame buffer
+} FRAMEBUFFER_STATS;
+#endif
+
+/*********************************************************************
+* Function:  void ResetDevice()
+*
+* Overview: Clears the frame buffer to black.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void ResetDevice(void);
+
+/*********************************************************************
+* Macros:  GetMaxX()
+*
+* Overview: Returns maximum horizontal coordinate.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: Maximum horizontal coordinate.
+*
+* Side Effects: none
+*
+********************************************************************/
+#define GetMaxX() (SCREEN_HOR_SIZE-1)
+
+/*********************************************************************
+* Macros:  GetMaxY()
+*
+* Overview: Returns maximum vertical coordinate.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: Maximum vertical coordinate.
+*
+* Side Effects: none
+*
+********************************************************************/
+#define GetMaxY() (SCREEN_VER_SIZE-1)
+
+/*********************************************************************
+* Macros:  SetColor(color)
+*
+* Overview: Sets current drawing color.
+*
+* PreCondition: none
+*
+* Input: color - Color coded in 5:6:5 RGB format.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#define SetColor(color) _color = color
+
+/*********************************************************************
+* Macros:  GetColor()
+*
+* Overview: Returns current drawing color.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: Color coded in 5:6:5 RGB format.
+*
+* Side Effects: none
+*
+********************************************************************/
+#define GetColor() _color
+
+/*********************************************************************
+* Macros:  SetActivePage(page)
+*
+* Overview: Sets active graphic page.
+*
+* PreCondition: none
+*
+* Input: page - Graphic page number.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#define SetActivePage(page)
+
+/*********************************************************************
+* Macros: SetVisualPage(page)
+*
+* Overview: Sets graphic page to display.
+*
+* PreCondition: none
+*
+* Input: page - Graphic page number
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#define SetVisualPage(page)
+
+/*********************************************************************
+* Function: void PutPixel(SHORT x, SHORT y)
+*
+* Overview: Puts pixel with the given x,y coordinate position.
+*
+* PreCondition: none
+*
+* Input: x - x position of the pixel.
+*		 y - y position of the pixel.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void PutPixel(SHORT x, SHORT y);
+
+/*********************************************************************
+* Function: WORD GetPixel(SHORT x, SHORT y)
+*
+* Overview: Returns pixel color at the given x,y coordinate position.
+*
+* PreCondition: none
+*
+* Input: x - x position of the pixel.
+*		 y - y position of the pixel.
+*
+* Output: pixel color, 0 if the position is outside of the screen
+*
+* Side Effects: none
+*
+********************************************************************/
+WORD GetPixel(SHORT x, SHORT y);
+
+/*********************************************************************
+* Macros: SetClipRgn(left, top, right, bottom)
+*
+* Overview: Sets clipping region.
+*
+* PreCondition: none
+*
+* Input: left - Defines the left clipping region border.
+*		 top - Defines the top clipping region border.
+*		 right - Defines the right clipping region border.
+*	     bottom - Defines the bottom clipping region border.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#define SetClipRgn(left,top,right,bottom) _clipLeft=left; _clipTop=top; _clipRight=right; _clipBottom=bottom;
+
+/*********************************************************************
+* Macros: GetClipLeft()
+*
+* Overview: Returns left clipping border.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: Left clipping border.
+*
+* Side Effects: none
+*
+********************************************************************/
+#define GetClipLeft() _clipLeft
+
+/*********************************************************************
+* Macros: GetClipRight()
+*
+* Overview: Returns right clipping border.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: Right clipping border.
+*
+* Side Effects: none
+*
+********************************************************************/
+#define GetClipRight() _clipRight
+
+/*********************************************************************
+* Macros: GetClipTop()
+*
+* Overview: Returns top clipping border.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: Top clipping border.
+*
+* Side Effects: none
+*
+********************************************************************/
+#define GetClipTop() _clipTop
+
+/*********************************************************************
+* Macros: GetClipBottom()
+*
+* Overview: Returns bottom clipping border.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: Bottom clipping border.
+*
+* Side Effects: none
+*
+********************************************************************/
+#define GetClipBottom() _clipBottom
+
+/*********************************************************************
+* Macros: SetClip(control)
+*
+* Overview: Enables/disables clipping.
+*
+* PreCondition: none
+*
+* Input: control - Enables or disables the clipping.
+*			- 0: Disable clipping
+*			- 1: Enable clipping
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#define SetClip(control) _clipRgn=control;
+
+/*********************************************************************
+* Macros: IsDeviceBusy()
+*
+* Overview: Returns non-zero if LCD controller is busy
+*           (previous drawing operation is not completed).
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: Busy status.
+*
+* Side Effects: none
+*
+********************************************************************/
+#define IsDeviceBusy()  0
+
+/*********************************************************************
+* Macros: SetPalette(colorNum, color)
+*
+* Overview:  Sets palette register.
+*
+* PreCondition: none
+*
+* Input: colorNum - Register number.
+*        color - Color.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#define SetPalette(colorNum, color)
+
+/*********************************************************************
+* Macros:  DelayMs(time)
+*
+* Overview: Delays execution on time specified in milliseconds.
+*           There is no display hardware to wait for, so the
+*           frame buffer driver does not delay.
+*
+* PreCondition: none
+*
+* Input: time - Delay in milliseconds.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#define DelayMs(time)
+
+#ifdef USE_DOUBLE_BUFFERING
+/*********************************************************************
+* Function: void InvalidateRectangle(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* Overview: Marks the back buffer area to be copied to the frame 
+*           buffer by the next UpdateDisplayNow() call.
+*
+* PreCondition: none
+*
+* Input: left - Defines the left most border of the area.
+*		 top - Defines the top most border of the area.
+*		 right - Defines the right most border of the area.
+*		 bottom - Defines the bottom most border of the area.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void InvalidateRectangle(SHORT left, SHORT top, SHORT right, SHORT bottom);
+
+/*********************************************************************
+* Function: void UpdateDisplayNow(void)
+*
+* Overview: Copies the invalidated back buffer areas to the frame 
+*           buffer row by row and clears the list of the areas.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void UpdateDisplayNow(void);
+#endif
+
+#ifdef USE_FRAMEBUFFER_STATISTICS
+/*********************************************************************
+* Function: void FramebufferGetStats(FRAMEBUFFER_STATS* pStats)
+*
+* Overview: Copies the driver call and pixel counters.
+*
+* PreCondition: none
+*
+* Input: pStats - Pointer to the structure receiving the counters.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void FramebufferGetStats(FRAMEBUFFER_STATS* pStats);
+
+/*********************************************************************
+* Function: void FramebufferResetStats(void)
+*
+* Overview: Clears the driver call and pixel counters.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void FramebufferResetStats(void);
+#endif
+
+#ifdef USE_FRAMEBUFFER_DUMP
+/*********************************************************************
+* Function: BOOL FramebufferDumpPPM(const char* fileName)
+*
+* Overview: Writes the frame buffer contents to a binary PPM (P6)
+*           file, with each color component expanded to 8 bits.
+*           Define USE_FRAMEBUFFER_DUMP in GraphicsConfig.h to use
+*           this function; it needs the C standard I/O library.
+*
+* PreCondition: none
+*
+* Input: fileName - Name of the file to create.
+*
+* Output: TRUE if the file was written, FALSE otherwise.
+*
+* Side Effects: none
+*
+********************************************************************/
+BOOL FramebufferDumpPPM(const char* fileName);
+#endif
+
+#endif // _FRAMEBUFFER_H
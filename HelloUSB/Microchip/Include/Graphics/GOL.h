@@ -270,6 +270,17 @@ extern OBJ_HEADER  *_pObjectFocused;
 #define GOL_EMBOSS_SIZE                 3
 #endif
 
+/*********************************************************************
+* Overview: Number of dirty rectangles kept by the damage region 
+*			manager (USE_DIRTY_RECTS option). When the list is full 
+*			a new rectangle is merged with the entry that grows the 
+*			least, so a small list only costs some overdraw.
+*
+*********************************************************************/
+#ifndef GOL_DIRTY_RECS
+#define GOL_DIRTY_RECS                  4
+#endif
+
 /*********************************************************************
 * Overview: The following are the style scheme default settings.
 *
@@ -1124,6 +1135,16 @@ BOOL  GOLDeleteObjectByID(WORD ID);
 *			GOLDrawCallback() function is called by GOLDraw() 
 *			when drawing of objects in the active list is completed.
 *
+*			If USE_DOUBLE_BUFFERING is defined in GraphicsConfig.h 
+*			the display driver draws into a back buffer. The area of 
+*			each drawn object is passed to InvalidateRectangle() and 
+*			UpdateDisplayNow() is called when the whole list is drawn, 
+*			so objects in the middle of drawing are never shown. 
+*			Only the frame buffer driver (Framebuffer.h) supports 
+*			double buffering. None of the display controller 
+*			drivers supports it. Their headers stop the build 
+*			with an error when USE_DOUBLE_BUFFERING is defined.
+*
 * PreCondition: none
 *
 * Input: none
@@ -1193,6 +1214,90 @@ WORD GOLDraw();
 ********************************************************************/
 void  GOLRedrawRec(SHORT left, SHORT top, SHORT right, SHORT bottom);
 
+#ifdef USE_DIRTY_RECTS
+/*********************************************************************
+* Function: void GOLAddDirtyRec(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* Overview: This function adds a rectangular area of the screen to 
+*			the damage region. Overlapping and touching rectangles 
+*			are merged. On the next GOLDraw() pass every visible 
+*			object of the active list intersecting the damage region 
+*			is redrawn with clipping set to the damaged part of the 
+*			object, so only the damaged pixels are written. Objects 
+*			already marked to be redrawn are drawn as usual (a partial 
+*			update intersecting the damage is turned into a full redraw). 
+*			The damage region is cleared when the pass is completed. 
+*
+*			Unlike GOLRedrawRec() the objects states are not changed. 
+*			Use this function when an area has to be repainted, 
+*			for example after an object was removed from the list or 
+*			a pop-up drawn over the objects was closed. Define 
+*			USE_DIRTY_RECTS in GraphicsConfig.h to use it.
+*
+* PreCondition: none
+*
+* Input: left - Defines the left most border of the rectangle area.
+*		 top - Defines the top most border of the rectangle area.
+*		 right - Defines the right most border of the rectangle area.
+*		 bottom - Defines the bottom most border of the rectangle area.
+*
+* Output: none
+*
+* Example:
+*	<PRE> 
+*	// remove the pop-up window and repaint what was under it
+*	GOLDeleteObject((OBJ_HEADER*)pPopUp);
+*	GOLAddDirtyRec(pPopUp->hdr.left, pPopUp->hdr.top, 
+*				   pPopUp->hdr.right, pPopUp->hdr.bottom);
+*	</PRE>	
+*
+* Side Effects: none
+*
+********************************************************************/
+void  GOLAddDirtyRec(SHORT left, SHORT top, SHORT right, SHORT bottom);
+#endif
+
+/*********************************************************************
+* Function: void GOLSetClipRgn(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* Overview: This function enables clipping to the given rectangle. 
+*			Objects must use it instead of SetClip() and SetClipRgn() 
+*			in their drawing functions. When the object is being 
+*			redrawn for the damage region (USE_DIRTY_RECTS option) 
+*			the clipping region is limited to the damaged area.
+*
+* PreCondition: none
+*
+* Input: left - Defines the left clipping region border.
+*		 top - Defines the top clipping region border.
+*		 right - Defines the right clipping region border.
+*		 bottom - Defines the bottom clipping region border.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void  GOLSetClipRgn(SHORT left, SHORT top, SHORT right, SHORT bottom);
+
+/*********************************************************************
+* Function: void GOLResetClip(void)
+*
+* Overview: This function removes the clipping set by GOLSetClipRgn(). 
+*			Clipping is disabled or, if the object is being redrawn 
+*			for the damage region, set back to the damaged area.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void  GOLResetClip(void);
+
 /*********************************************************************
 * Macros: GOLRedraw(pObj)
 *
@@ -1217,10 +1322,8 @@ void  GOLRedrawRec(SHORT left, SHORT top, SHORT right, SHORT bottom);
 *		pCurrentObj = GOLGetList();
 *		while(pCurrentObj != NULL){
 *			if (
-*				((pCurrentObj->left >= left) && (pCurrentObj->left <= right)) ||
-*				((pCurrentObj->right >= left) && (pCurrentObj->right <= right))||
-*				((pCurrentObj->top >= top) && (pCurrentObj->top <= bottom)) ||
-*				((pCurrentObj->bottom >= top) && (pCurrentObj->bottom <= bottom))){
+*				(pCurrentObj->left <= right) && (pCurrentObj->right >= left) &&
+*				(pCurrentObj->top <= bottom) && (pCurrentObj->bottom >= top)){
 *					GOLRedraw(pCurrentObj);
 *			}
 *			pCurrentObj = pCurrentObj->pNxtObj;           
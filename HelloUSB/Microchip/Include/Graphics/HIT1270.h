@@ -62,6 +62,11 @@
 #define SCREEN_HOR_SIZE    320
 #define SCREEN_VER_SIZE    234
 
+// The driver writes to the display memory directly and has no back buffer
+#ifdef USE_DOUBLE_BUFFERING
+#error Double buffering is not supported by this driver.
+#endif
+
 // Memory pitch for line
 #define LINE_MEM_PITCH     320
 // Video buffer offset
@@ -92,12 +92,18 @@
 // Define this to implement Bar function in the driver.
 #define USE_DRV_BAR
 
+// Define this to implement HLine function in the driver.
+#define USE_DRV_HLINE
+
 // Define this to implement ClearDevice function in the driver.
 #define USE_DRV_CLEARDEVICE
 
 // Define this to implement PutImage function in the driver.
 #define USE_DRV_PUTIMAGE
 
+// Define this to implement PutPixelRow function in the driver.
+#define USE_DRV_PUTPIXELROW
+
 /*********************************************************************
 * Overview: Horizontal and vertical screen size.
 *********************************************************************/
@@ -117,6 +123,11 @@
 
 #endif
 
+// The driver writes to the display memory directly and has no back buffer
+#ifdef USE_DOUBLE_BUFFERING
+#error Double buffering is not supported by this driver.
+#endif
+
 /*********************************************************************
 * Overview: Clipping region control codes to be used with SetClip(...)
 *           function. 
@@ -83,6 +83,34 @@ extern BYTE _lineThickness;
 #define SIN45  46341  // sin(45) * 2^16)
 #define ONEP25 81920  // 1.25 * 2^16
 
+/*********************************************************************
+* Overview: Fixed-point trigonometry. Angles are given in degrees,
+*			sine and cosine values are scaled by 2^15 (SINE_SCALE). 
+*			The values are read from a table of the first quadrant 
+*			sine values with 1 degree steps (_sineTable[], scaled 
+*			by 2^16).
+*
+*********************************************************************/
+#define SINE_SCALE_SHIFT	15								// Shift of the fixed-point sine and cosine values.
+#define SINE_SCALE			(1<<SINE_SCALE_SHIFT)			// Scale of the fixed-point sine and cosine values.
+
+extern const WORD _sineTable[91];
+
+/*********************************************************************
+* Overview: State of the midpoint (Bresenham) circle walk shared by
+*			the circle primitives. The walk starts at x = radius, y = 0 
+*			and moves y by one pixel on each CircleWalkStep() call, x
+*			is decremented when the midpoint decision requires it. 
+*			One octant of the circle is done when y passes yLimit.
+*
+*********************************************************************/
+typedef struct {
+	SHORT	x;			// x position on the circle.
+	SHORT	y;			// y position on the circle.
+	SHORT	err;		// Midpoint decision variable.
+	SHORT	yLimit;		// Last y position of the octant (radius*sin(45)).
+} CIRCLE_WALK;
+
 // Current cursor coordinates
 extern SHORT _cursorX;
 extern SHORT _cursorY;
@@ -118,7 +146,8 @@ typedef struct {
   DWORD       address;      // bitmap or font image address
 } EXTDATA;
 
-#ifdef __PIC32MX__
+#if defined(__PIC32MX__) || !defined(__C30__)
+// Flash data is addressed as constant data (PIC32 and host builds)
 #define FLASH_BYTE  const BYTE 
 #define FLASH_WORD  const WORD
 #else
@@ -138,6 +167,21 @@ SHORT  height;				// Image height
 SHORT  width;				// Image width
 } BITMAP_HEADER;
 
+/*********************************************************************
+* Overview: Bitmap compression settings. COMP_NONE images store the 
+*			pixels of each line packed to whole bytes. COMP_RLE 
+*			images are 4 or 8 bits per pixel images with the lines 
+*			encoded as in the BMP file RLE4 and RLE8 formats, the 
+*			first line is the top line of the image. Each line ends 
+*			with the 0,0 escape and the image ends with the 0,1 
+*			escape, delta escapes are not supported. Pixels missing 
+*			in a line are drawn with the first pallete color. Define 
+*			USE_COMP_RLE in GraphicsConfig.h to draw COMP_RLE images.
+*
+*********************************************************************/
+#define COMP_NONE                   0	// Image is not compressed
+#define COMP_RLE                    1	// Image lines are RLE encoded
+
 /*********************************************************************
 * Overview: Structure for bitmap stored in FLASH memory.
 *
@@ -192,6 +236,47 @@ typedef struct {
 ********************************************************************/
 #define EXTERNAL_FONT_BUFFER_SIZE    200
 
+/*********************************************************************
+* Overview: Glyph cache settings. Define USE_GLYPH_CACHE in 
+*			GraphicsConfig.h to keep the recently used glyphs as 
+*			lists of horizontal pixel runs in RAM. Cached glyphs are 
+*			drawn with one span fill per run and external fonts are 
+*			read only when a glyph is not in the cache. 
+*			GLYPH_CACHE_SIZE is the number of glyphs kept, 
+*			GLYPH_CACHE_RUNS is the maximum number of runs in a 
+*			glyph (each run takes 3 bytes). Glyphs with more runs 
+*			are not cached.
+*
+********************************************************************/
+#ifndef GLYPH_CACHE_SIZE
+#define GLYPH_CACHE_SIZE             16
+#endif
+#ifndef GLYPH_CACHE_RUNS
+#define GLYPH_CACHE_RUNS             48
+#endif
+
+/*********************************************************************
+* Overview: Text width settings. Define USE_FONT_WIDTH_TABLE in 
+*			GraphicsConfig.h to copy the character widths of a font 
+*			to a RAM table when the font is set with SetFont(). 
+*			GetTextWidth() then adds the widths from the table and 
+*			does not read the font image. FONT_WIDTH_TABLE_SIZE is 
+*			the table size in bytes, fonts with more characters do 
+*			not use the table. 
+*			Define USE_TEXT_WIDTH_CACHE to keep the last widths 
+*			returned by GetTextWidth() for fonts without the table. 
+*			Entries are found by the string pointer, font, length 
+*			and a checksum of the characters. TEXT_WIDTH_CACHE_SIZE 
+*			is the number of entries.
+*
+********************************************************************/
+#ifndef FONT_WIDTH_TABLE_SIZE
+#define FONT_WIDTH_TABLE_SIZE        224
+#endif
+#ifndef TEXT_WIDTH_CACHE_SIZE
+#define TEXT_WIDTH_CACHE_SIZE        8
+#endif
+
 
 // Pointer to the current font image
 extern void*   _font;
@@ -384,6 +469,27 @@ WORD Arc(SHORT xL, SHORT yT, SHORT xR, SHORT yB, SHORT r1, SHORT r2, BYTE octant
 ********************************************************************/
  void OutChar(XCHAR ch);
 
+#ifdef USE_GLYPH_CACHE
+/*********************************************************************
+* Function: void ClearGlyphCache(void)
+*
+* Overview: This function removes all glyphs from the glyph cache. 
+*			Glyphs are cached by the font pointer and character code, 
+*			it must be called if a font image is changed or a font 
+*			structure is reused for another font.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+ void ClearGlyphCache(void);
+#endif
+
 /*********************************************************************
 * Function: WORD OutText(XCHAR* textString)
 *
@@ -503,6 +609,28 @@ SHORT GetTextHeight(void* font);
 ********************************************************************/
 SHORT GetTextWidth(XCHAR* textString, void* font);
 
+#if defined(USE_FONT_WIDTH_TABLE) || defined(USE_TEXT_WIDTH_CACHE)
+/*********************************************************************
+* Function: void ClearTextWidthCache(void)
+*
+* Overview: This function discards the font width table and the 
+*			cached string widths. The width table is reloaded by 
+*			the next SetFont() call. It must be called if a font 
+*			image or a string used with GetTextWidth() is changed 
+*			in place.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void ClearTextWidthCache(void);
+#endif
+
 /*********************************************************************
 * Function: void SetFont(void* font)
 *
@@ -689,6 +817,109 @@ WORD FillBevel(SHORT x1, SHORT y1, SHORT x2, SHORT y2, SHORT rad);
 #define FillCircle(x1, y1, rad) FillBevel(x1, y1, x1, y1, rad)
 #endif // end of USE_DRV_FILLCIRCLE
 
+/*********************************************************************
+* Function: void CircleWalkInit(CIRCLE_WALK* pWalk, SHORT rad)
+*
+* Overview: Starts the midpoint circle walk for the given radius.
+*
+* Input: pWalk - Pointer to the circle walk state.
+*        rad - Radius of the circle.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void CircleWalkInit(CIRCLE_WALK* pWalk, SHORT rad);
+
+/*********************************************************************
+* Function: void CircleWalkStep(CIRCLE_WALK* pWalk)
+*
+* Overview: Moves the midpoint circle walk to the next y position.
+*
+* Input: pWalk - Pointer to the circle walk state.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void CircleWalkStep(CIRCLE_WALK* pWalk);
+
+/*********************************************************************
+* Function: SHORT GetSine(SHORT angle)
+*
+* Overview: Returns the sine of the angle scaled by SINE_SCALE.
+*
+* Input: angle - Angle in degrees, any value.
+*
+* Output: sin(angle)*SINE_SCALE, limited to SINE_SCALE-1.
+*
+* Side Effects: none
+*
+********************************************************************/
+SHORT GetSine(SHORT angle);
+
+/*********************************************************************
+* Macro: GetCosine(angle)
+*
+* Overview: Returns the cosine of the angle scaled by SINE_SCALE.
+*
+* Input: angle - Angle in degrees, any value.
+*
+* Output: cos(angle)*SINE_SCALE, limited to SINE_SCALE-1.
+*
+* Side Effects: none
+*
+********************************************************************/
+#define GetCosine(angle)	GetSine((angle)+90)
+
+/*********************************************************************
+* Function: void GetCirclePoint(SHORT radius, SHORT angle, SHORT* x, SHORT* y)
+*
+* Overview: Calculates the position of the point on the circle at 
+*			the given angle relative to the circle center. The angle 
+*			is measured clockwise on the screen starting from the 
+*			positive x axis (90 degrees points down).
+*
+* Input: radius - Radius of the circle.
+*		 angle - Angle in degrees, any value.
+*		 x - Pointer to the x position result.
+*		 y - Pointer to the y position result.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void GetCirclePoint(SHORT radius, SHORT angle, SHORT* x, SHORT* y);
+
+/*********************************************************************
+* Function: void FillSector(SHORT cx, SHORT cy, SHORT radius, SHORT angleFrom, SHORT angleTo)
+*
+* Overview: Draws a filled sector of the circle with the current 
+*			color. The angles are measured clockwise on the screen 
+*			starting from the positive x axis (see GetCirclePoint()). 
+*			The rows of the circle are scanned with the midpoint 
+*			circle walk and each row is filled with horizontal 
+*			spans clipped to the sector, no pixels are read back.
+*			The filled area of a full circle is the same as of 
+*			FillCircle().
+*
+* Input: cx - Center x position.
+*		 cy - Center y position.
+*		 radius - Radius of the circle.
+*		 angleFrom - Start angle of the sector in degrees (0-360).
+*		 angleTo - End angle of the sector in degrees, 
+*				   angleFrom <= angleTo <= angleFrom+360.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void FillSector(SHORT cx, SHORT cy, SHORT radius, SHORT angleFrom, SHORT angleTo);
+
 /*********************************************************************
 * Macro: Rectangle(left, top, right, bottom)
 *
@@ -746,6 +977,49 @@ void DrawPoly(SHORT numPoints, SHORT* polyPoints);
 ********************************************************************/
 void Bar(SHORT left, SHORT top, SHORT right, SHORT bottom);
 
+/*********************************************************************
+* Function: void HLine(SHORT x1, SHORT x2, SHORT y)
+*
+* Overview: This function draws a horizontal span of pixels from
+*			x1 to x2 (inclusive) on row y with the current color.
+*			Drivers that define USE_DRV_HLINE set the display
+*			address once for the whole span; otherwise the span is
+*			drawn with PutPixel(). Bar(), ClearDevice(), Line() and
+*			the filled shapes are built on this function.
+*			Clipping is supported.
+*
+* Input: x1 - x position of one end of the span.
+*		 x2 - x position of the other end of the span.
+*		 y - y position of the span.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void HLine(SHORT x1, SHORT x2, SHORT y);
+
+/*********************************************************************
+* Function: void PutPixelRow(SHORT x, SHORT y, WORD* pixels, WORD count)
+*
+* Overview: This function puts a horizontal row of pixels starting at
+*			x,y. Each pixel has its own color, so the row can be
+*			written to the display in one pass instead of one
+*			SetColor()/PutPixel() pair per pixel. The current color
+*			is not changed. Clipping is supported.
+*
+* Input: x - x position of the first pixel.
+*		 y - y position of the row.
+*        pixels - pointer to the pixel colors.
+*        count - number of pixels.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void PutPixelRow(SHORT x, SHORT y, WORD* pixels, WORD count);
+
 /*********************************************************************
 * Function: void ClearDevice(void)
 *
@@ -816,6 +1090,42 @@ SHORT GetImageWidth(void* bitmap);
 ********************************************************************/
 SHORT GetImageHeight(void* bitmap);
 
+/*********************************************************************
+* Function: BYTE GetImageCompression(void* bitmap)
+*
+* Overview: This function returns the image compression setting.
+*
+* Input: bitmap - Pointer to the bitmap.
+*
+* Output: Returns COMP_NONE or COMP_RLE.
+* 
+* Side Effects: none
+*
+********************************************************************/
+BYTE GetImageCompression(void* bitmap);
+
+#ifdef USE_COMP_RLE
+/*********************************************************************
+* Function: void PutImageRLE(SHORT left, SHORT top, void* bitmap, BYTE stretch)
+*
+* Overview: This function outputs a COMP_RLE image starting from 
+*			left,top coordinates. The image is decoded line by line 
+*			and each line is written with PutPixelRow(). PutImage() 
+*			calls this function for COMP_RLE images.
+*
+* Input: left - x coordinate position of the left top corner.
+*		 top - y coordinate position of the left top corner.
+*        bitmap - pointer to the bitmap.
+*        stretch - The image stretch factor.
+*
+* Output: none
+* 
+* Side Effects: none
+*
+********************************************************************/
+void PutImageRLE(SHORT left, SHORT top, void* bitmap, BYTE stretch);
+#endif
+
 /*********************************************************************
 * Function: WORD ExternalMemoryCallback(EXTDATA* memory, LONG offset, WORD nCount, void* buffer)
 *
@@ -54,7 +54,6 @@
 
 #ifdef USE_KEYBOARD
     #define RDIA_QUADRANT_POSITIONS 6
-    extern SHORT                    _cosine[RDIA_QUADRANT_POSITIONS];
     SHORT RdiaCosine( SHORT v );
     SHORT RdiaSine( SHORT v );
 #endif
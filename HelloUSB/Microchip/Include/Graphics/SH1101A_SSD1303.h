@@ -101,6 +101,12 @@
 // Defines the vertical screen size. Dependent on the display glass used.
 #define SCREEN_VER_SIZE    64
 #endif
+
+// The driver writes to the display memory directly and has no back buffer
+#ifdef USE_DOUBLE_BUFFERING
+#error Double buffering is not supported by this driver.
+#endif
+
 /*********************************************************************
 * Overview: Clipping region control codes to be used with SetClip(...)
 *           function. 
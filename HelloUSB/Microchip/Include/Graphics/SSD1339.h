@@ -61,6 +61,11 @@
 #define SCREEN_HOR_SIZE    128
 #define SCREEN_VER_SIZE    128
 
+// The driver writes to the display memory directly and has no back buffer
+#ifdef USE_DOUBLE_BUFFERING
+#error Double buffering is not supported by this driver.
+#endif
+
 // Definitions for reset pin
 #define RST_TRIS_BIT       TRISCbits.TRISC1
 #define RST_LAT_BIT        LATCbits.LATC1
@@ -79,6 +79,9 @@
 // Define this to implement Bar function in the driver.
 #define USE_DRV_BAR
 
+// Define this to implement HLine function in the driver.
+#define USE_DRV_HLINE
+
 // Define this to implement ClearDevice function in the driver.
 #define USE_DRV_CLEARDEVICE
 
@@ -136,6 +139,11 @@
 #error The display orientation selected is not supported. It can be only 0,90,180 or 270.
 #endif
 
+// 256K bytes display buffer holds one 16 BPP page only (2 pages need 2*240*320*2 bytes)
+#ifdef USE_DOUBLE_BUFFERING
+#error Double buffering is not supported, display buffer is too small for the second page.
+#endif
+
 /*********************************************************************
 * Overview: Clipping region control codes to be used with SetClip(...)
 *           function. 
@@ -85,6 +85,11 @@
 // Defines the vertical screen size. Dependent on the display glass used.
 #define SCREEN_VER_SIZE    128
 
+// The driver writes to the display memory directly and has no back buffer
+#ifdef USE_DOUBLE_BUFFERING
+#error Double buffering is not supported by this driver.
+#endif
+
 // Norm commands
 
 #define EXTIN       0x30
@@ -37,6 +37,15 @@ Author                 Date           Comments
 Pradeep Budagutta    03-Mar-2008    First release
 *******************************************************************************/
 
+/* Size of the buffer in bytes that bitmap rows are read into, must be a multiple of 6 */
+#ifndef IMG_BMP_ROW_BUFFER_SIZE
+  #define IMG_BMP_ROW_BUFFER_SIZE  960
+#endif
+
+#if (IMG_BMP_ROW_BUFFER_SIZE % 6) != 0
+  #error "IMG_BMP_ROW_BUFFER_SIZE must be a multiple of 6 so that 16-bit and 24-bit pixels are not split between reads"
+#endif
+
 /* Function prototype */
 /* This function must be called after setting proper values in the global variables of ImageDecoder.c */
 BYTE BMP_bDecode(IMG_FILE *pFile);
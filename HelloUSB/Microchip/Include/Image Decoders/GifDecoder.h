@@ -37,7 +37,21 @@ Pradeep Budagutta    14-Mar-2008    First release
 *******************************************************************************/
 
 /* User configuration */
-#define GIF_CRUSH_PREV_SYMBOL_PTR_TABLE     1 /* If 1, this saves 2KB of RAM but requires more time to decode */
+#ifndef GIF_CRUSH_PREV_SYMBOL_PTR_TABLE
+  #ifdef __PIC32MX__
+    #define GIF_CRUSH_PREV_SYMBOL_PTR_TABLE     0 /* If 1, this saves 2KB of RAM but requires more time to decode */
+  #else
+    #define GIF_CRUSH_PREV_SYMBOL_PTR_TABLE     1
+  #endif
+#endif
+
+#ifndef GIF_USE_STRING_TABLE
+  #ifdef __PIC32MX__
+    #define GIF_USE_STRING_TABLE                1 /* If 1, the length of every code's string is kept so that it is written in one pass, this needs 8KB more RAM */
+  #else
+    #define GIF_USE_STRING_TABLE                0
+  #endif
+#endif
 
 #ifdef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
     #define GIF_USE_16_BITS_PER_PIXEL           1 /* If this is 1, then 16 bits/pixel is used and hence requires 256 Bytes less RAM */
@@ -47,8 +61,24 @@ Pradeep Budagutta    14-Mar-2008    First release
 
 /* User configuration */
 
+/* State of an animated GIF which is kept between its frames */
+typedef struct _GIF_ANIMATION
+{
+        IMG_FILE *pImageFile;
+        LONG lFirstFramePos;        /* File position of the first frame, to loop the animation */
+        LONG lNextFramePos;         /* File position of the frame to be decoded next */
+        WORD wFrameX;               /* Area of the last frame, to be disposed before the next one */
+        WORD wFrameY;
+        WORD wFrameWidth;
+        WORD wFrameHeight;
+        WORD wBackgroundColor;      /* RGB565 */
+        BYTE bDisposalMethod;       /* Disposal method of the last frame */
+} GIF_ANIMATION;
+
 /* Function prototype */
-/* This function must be called after setting proper values in the global variables of ImageDecoder.c */
+/* These functions must be called after setting proper values in the global variables of ImageDecoder.c */
 BYTE GIF_bDecode(IMG_FILE *pFile);
+BYTE GIF_bAnimationStart(GIF_ANIMATION *pAnimation, IMG_FILE *pFile);
+BYTE GIF_bDecodeNextFrame(GIF_ANIMATION *pAnimation, WORD *pwDelay);
 
 #endif
@@ -95,10 +95,27 @@ typedef struct _IMG_PIXEL_XY_RGB_888
 
 /*********************************************************************
 * Overview: IMG_PixelOutput is a callback function which receives the
-*           color information of the output pixel
+*           color information of the output pixel. The decoders pass
+*           the full 8-bit R, G and B values to it when no span output
+*           is registered. Pixels drawn from a decoded image cache file,
+*           the background restored between GIF animation frames and
+*           GIF images decoded with GIF_USE_16_BITS_PER_PIXEL are RGB565
+*           values expanded to 8 bits.
 *********************************************************************/
 typedef void (*IMG_PIXEL_OUTPUT)(IMG_PIXEL_XY_RGB_888 *pPix);
 
+/*********************************************************************
+* Overview: IMG_SpanOutput is a callback function which receives a
+*           horizontal run of wCount output pixels starting at
+*           (wX, wY), in RGB565 format
+*********************************************************************/
+typedef void (*IMG_SPAN_OUTPUT)(WORD wX, WORD wY, WORD wCount, WORD *pwColor);
+
+/* Maximum number of pixels a decoder collects before outputting a span */
+#ifndef IMG_SPAN_BUFFER_SIZE
+  #define IMG_SPAN_BUFFER_SIZE     64
+#endif
+
 /*********************************************************************
 * Overview: IMG_LoopCallback is a callback function which is called
 *           in every loop of the decoding cycle so that user
@@ -116,10 +133,12 @@ typedef void (*IMG_LOOP_CALLBACK)(void);
   extern WORD IMG_wImageWidth;
   extern WORD IMG_wImageHeight;
   extern BYTE IMG_bDownScalingFactor;
+  extern BYTE IMG_bDecodeScale;
   extern BYTE IMG_bAlignCenter;
  
  #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
   extern IMG_PIXEL_OUTPUT IMG_pPixelOutput;
+  extern IMG_SPAN_OUTPUT IMG_pSpanOutput;
   extern IMG_PIXEL_XY_RGB_888 IMG_PixelXYColor;
  #endif
 
@@ -144,6 +163,10 @@ typedef void (*IMG_LOOP_CALLBACK)(void);
 
 #else
 
+ #ifdef IMG_SUPPORT_DECODED_IMAGE_CACHE
+  #error "IMG_SUPPORT_DECODED_IMAGE_CACHE needs IMG_USE_ONLY_MDD_FILE_SYSTEM_FOR_INPUT"
+ #endif
+
  #define IMG_FILE         void
  #define IMG_FREAD        IMG_pFileAPIs->pFread
  #define IMG_FSEEK        IMG_pFileAPIs->pFseek
@@ -205,6 +228,30 @@ typedef void (*IMG_LOOP_CALLBACK)(void);
 
 #ifdef IMG_SUPPORT_GIF
  #include "GifDecoder.h"
+
+/*********************************************************************
+* Overview: IMG_ANIMATION holds an animated GIF which is being played
+*           and where it is displayed
+*********************************************************************/
+typedef struct _IMG_ANIMATION
+{
+     GIF_ANIMATION Gif;
+     WORD wStartX;
+     WORD wStartY;
+     WORD wWidth;
+     WORD wHeight;
+     WORD wImageWidth;
+     WORD wImageHeight;
+     BYTE bDownScalingFactor;
+     BYTE blFrameDue;                  /* The next frame is shown without waiting */
+     DWORD dwNextFrameTime;            /* Millisecond tick at which the next frame is due */
+   #ifndef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+     IMG_PIXEL_OUTPUT pPixelOutput;
+   #endif
+   #ifndef IMG_USE_ONLY_MDD_FILE_SYSTEM_FOR_INPUT
+     IMG_FILE_SYSTEM_API *pFileAPIs;
+   #endif
+} IMG_ANIMATION;
 #endif
 
 /* Function prototypes */
@@ -269,6 +316,43 @@ void ImageDecoderInit(void);
 ********************************************************************/
 void ImageLoopCallbackRegister(IMG_LOOP_CALLBACK pFn);
 
+/*********************************************************************
+* Function: void ImageSpanOutputRegister(IMG_SPAN_OUTPUT pSpanOutput)
+*
+* Overview: This function registers a function which receives the
+*           decoded image as horizontal spans of RGB565 pixels. When
+*           it is registered, decoders that output spans use it
+*           instead of the pixel output function passed to
+*           ImageDecode.
+*
+* Input: pSpanOutput -> Span output function pointer, NULL to output
+*                       pixel by pixel
+*
+* Output: None
+*
+* Example:
+*   <PRE> 
+*   void SpanOutput(WORD wX, WORD wY, WORD wCount, WORD *pwColor)
+*   {
+*       <- copy wCount pixels to the frame buffer ->
+*   }
+*
+*	void main(void)
+*	{
+*		ImageDecoderInit();
+*       ImageSpanOutputRegister(SpanOutput);
+*       ...
+*	}
+*	</PRE> 
+*
+* Side Effects: None
+*
+* Note: Not available when IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+*       is defined
+*
+********************************************************************/
+void ImageSpanOutputRegister(IMG_SPAN_OUTPUT pSpanOutput);
+
 /*********************************************************************
 * Function: BYTE ImageDecode(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat, WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight, WORD wFlags, IMG_FILE_SYSTEM_API *pFileAPIs, IMG_PIXEL_OUTPUT pPixelOutput)
 *
@@ -286,7 +370,8 @@ void ImageLoopCallbackRegister(IMG_LOOP_CALLBACK pFn);
 *                         specified by wStartx, wStarty, wWidth and wHeight
 *                 -> If bit 1 is set, the image would be downscaled if required to fit
 *                         into the area specified by wStartx, wStarty, wWidth
-*                         and wHeight
+*                         and wHeight. JPEG images are then decoded at
+*                         1/2, 1/4 or 1/8 size, which is much faster
 *        pFileAPIs     -> The pointer to a structure which has function pointers
 *                         to the File System APIs
 *        pPixelOutput  -> The function to output (x, y) coordinates and the color
@@ -359,6 +444,48 @@ BYTE ImageDecode(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat,
 #define ImageFullScreenDecode(pImageFile, eImgFormat, pFileAPIs, pPixelOutput) \
         ImageDecode(pImageFile, eImgFormat, 0, 0, IMG_SCREEN_WIDTH, IMG_SCREEN_HEIGHT, (IMG_ALIGN_CENTER | IMG_DOWN_SCALE), pFileAPIs, pPixelOutput)
 
+#ifdef IMG_SUPPORT_DECODED_IMAGE_CACHE
+/*********************************************************************
+* Function: BYTE ImageDecodeCached(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat, WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight, WORD wFlags, IMG_PIXEL_OUTPUT pPixelOutput, const char *pCacheFileName)
+*
+* Overview: This function displays the image like ImageDecode and
+*           keeps the decoded RGB565 pixels in a cache file. When
+*           the cache file was made from the same image file (same
+*           size and modification time) with the same area and
+*           flags, the pixels are copied from it without decoding.
+*           The image is cached only when all its pixels were
+*           decoded, so images which are partly off the screen or
+*           have transparent pixels are decoded every time. The
+*           first decode is slower as the pixels are also written
+*           to the cache file.
+*
+* Input: pCacheFileName -> Name of the cache file, one per image
+*        Other inputs are the same as for ImageDecode
+*
+* Output: Error code -> 0 means no error
+*
+* Example:
+*   <PRE> 
+*	void ShowLogo(void)
+*	{
+*		IMG_FILE pImageFile;
+*       pImageFile = IMG_FOPEN("Logo.jpg", "r");
+*       ImageDecodeCached(pImageFile, IMG_JPEG, 0, 0, 320, 240, 0, NULL, "Logo.raw");
+*       IMG_FCLOSE(pImageFile);
+*	}
+*	</PRE> 
+*
+* Side Effects: None
+*
+* Note: Needs IMG_USE_ONLY_MDD_FILE_SYSTEM_FOR_INPUT and ALLOW_WRITES
+*
+********************************************************************/
+BYTE ImageDecodeCached(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat,
+                       WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight,
+                       WORD wFlags, IMG_PIXEL_OUTPUT pPixelOutput,
+                       const char *pCacheFileName);
+#endif
+
 /*********************************************************************
 * Function: void ImageAbort(void)
 *
@@ -403,8 +530,93 @@ BYTE ImageDecode(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat,
 ********************************************************************/
 #define ImageAbort() IMG_blAbortImageDecoding = 1;
 
+#ifdef IMG_SUPPORT_GIF
+/*********************************************************************
+* Function: BYTE ImageAnimationStart(IMG_ANIMATION *pAnimation, IMG_FILE *pImageFile, WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight, WORD wFlags, IMG_FILE_SYSTEM_API *pFileAPIs, IMG_PIXEL_OUTPUT pPixelOutput)
+*
+* Overview: This function prepares an animated GIF to be played. The
+*           frames are then shown by ImageAnimationTask or
+*           ImageAnimationNextFrame. The file must stay open while
+*           the animation is played.
+*
+* Input: pAnimation -> The animation to be set up
+*        Other inputs are the same as for ImageDecode
+*
+* Output: Error code -> 0 means no error
+*
+* Example:
+*   <PRE> 
+*	void main(void)
+*	{
+*		IMG_ANIMATION Animation;
+*		IMG_FILE pImageFile;
+*       ImageDecoderInit();
+*       pImageFile = IMG_FOPEN("Busy.gif", "r");
+*       ImageAnimationStart(&Animation, pImageFile, 10, 10, 32, 32, 0, NULL, NULL);
+*       while(1)
+*       {
+*           ImageAnimationTask(&Animation, MSTimerGetTime());
+*           <- Other tasks ->
+*       }
+*	}
+*	</PRE> 
+*
+* Side Effects: None
+*
+********************************************************************/
+BYTE ImageAnimationStart(IMG_ANIMATION *pAnimation, IMG_FILE *pImageFile,
+                         WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight,
+                         WORD wFlags, IMG_FILE_SYSTEM_API *pFileAPIs,
+                         IMG_PIXEL_OUTPUT pPixelOutput);
+
+/*********************************************************************
+* Function: BYTE ImageAnimationNextFrame(IMG_ANIMATION *pAnimation, WORD *pwDelay)
+*
+* Overview: This function disposes the frame on the screen as its
+*           disposal method requires and draws the next frame. Only
+*           the area of the frames is redrawn. After the last frame
+*           the animation starts over.
+*
+* Input: pAnimation -> The animation
+*        pwDelay    -> Receives the time in milliseconds the frame
+*                      should be shown
+*
+* Output: Error code -> 0 means no error
+*
+* Side Effects: None
+*
+********************************************************************/
+BYTE ImageAnimationNextFrame(IMG_ANIMATION *pAnimation, WORD *pwDelay);
+
+/*********************************************************************
+* Function: BYTE ImageAnimationTask(IMG_ANIMATION *pAnimation, DWORD dwTime)
+*
+* Overview: This function draws the next frame when the delay of the
+*           current one has passed. The first call draws the first
+*           frame. It is called regularly with a millisecond tick
+*           such as MSTimerGetTime().
+*
+* Input: pAnimation -> The animation
+*        dwTime     -> Current time in milliseconds
+*
+* Output: Error code -> 0 means no error
+*
+* Side Effects: None
+*
+********************************************************************/
+BYTE ImageAnimationTask(IMG_ANIMATION *pAnimation, DWORD dwTime);
+#endif
+
 /********* This is not for the user *********/
 /* This is used by the individual decoders */
 void IMG_vSetboundaries(void);
+void IMG_vPutSpan(WORD wX, WORD wY, WORD wCount, WORD *pwColor);
+#ifdef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+  #define IMG_bUseRGBOutput()      0
+#else
+  /* The decoders output 8-bit components when only the pixel output is set */
+  #define IMG_bUseRGBOutput()      (IMG_pSpanOutput == NULL && IMG_pPixelOutput != NULL)
+  void IMG_vPutSpanRGB(WORD wX, WORD wY, WORD wCount, BYTE *pbRGB);
+#endif
 /********* This is not for the user *********/
 #endif
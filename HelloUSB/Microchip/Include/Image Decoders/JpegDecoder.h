@@ -44,6 +44,24 @@ Pradeep Budagutta    03-Mar-2008    First release
 #define MAX_HUFF_TABLES   2 /* Each causes 2 tables -> One for AC and another for DC - DONT REDUCE THIS */
 #define MAX_DATA_BUF_LEN  128 /* Increase if you have more data memory */
 
+#ifndef JPEG_HUFF_LOOKUP_BITS
+#define JPEG_HUFF_LOOKUP_BITS 9 /* Huffman codes up to this length are decoded with one table lookup, each of the 4 tables needs 2^n words - 0 disables the tables */
+#endif
+
+#if JPEG_HUFF_LOOKUP_BITS > 12
+#error "JPEG_HUFF_LOOKUP_BITS must not be greater than 12"
+#endif
+
+#ifndef JPEG_USE_FAST_IDCT
+#define JPEG_USE_FAST_IDCT 1 /* 1 uses the fast AAN IDCT of jidctfst.c which also shortcuts sparse blocks, 0 uses the slow but accurate IDCT of jidctint.c */
+#endif
+
+#ifndef JPEG_PROGRESSIVE_MAX_BUFFER
+#define JPEG_PROGRESSIVE_MAX_BUFFER 0 /* Largest coefficient buffer in bytes that a progressive image may malloc(), 0 for no limit other than the heap */
+#endif
+
+#define JPEG_ERROR_PROGRESSIVE_BUFFER 101 /* Error code of a progressive image whose coefficient buffer is larger than JPEG_PROGRESSIVE_MAX_BUFFER or could not be allocated */
+
 /* Error list */
 enum Errors
 {
@@ -54,6 +72,8 @@ enum Errors
 enum Markers
 {
      SOF0 = 0xC0,
+     SOF1 = 0xC1,
+     SOF2 = 0xC2,
      DHT  = 0xC4,
      SOI  = 0xD8,
      EOI  = 0xD9,
@@ -116,6 +116,8 @@ BYTE MDD_CFPMP_WriteProtectState (void);
 BYTE MDD_CFPMP_CFread( BYTE add);
 void MDD_CFPMP_CFwrite( BYTE add, BYTE d);
 void MDD_CFPMP_CFwait(void);
+void MDD_CFPMP_CFreadBurst( BYTE * buffer, WORD count);
+void MDD_CFPMP_CFwriteBurst( BYTE * buffer, WORD count);
 
 BYTE MDD_CFPMP_SectorRead( DWORD lda, BYTE * buf);
 BYTE MDD_CFPMP_SectorWrite( DWORD lda, BYTE * buf, BYTE allowWriteToZero);
@@ -287,6 +287,67 @@ typedef struct
 } SearchRec;
 
 
+
+#ifdef FS_MEDIA_STATISTICS
+
+    #ifndef FS_STATS_GET_TICKS
+        #if defined (__C32__)
+            // Summary: Timer used to measure media access latency
+            // Description: The FS_STATS_GET_TICKS macro must return a free-running DWORD tick count.  It defaults to the
+            //              PIC32 core timer; on other architectures it must be defined in FSconfig.h (for example, as a
+            //              read of a free-running hardware timer).
+            #define FS_STATS_GET_TICKS()    ReadCoreTimer()
+        #else
+            #error Please define FS_STATS_GET_TICKS in FSconfig.h to use FS_MEDIA_STATISTICS
+        #endif
+    #endif
+
+    #ifndef FS_STATS_LATENCY_BUCKETS
+        // Summary: Number of buckets in each latency histogram
+        // Description: Bucket 0 counts accesses that took 0 (scaled) ticks, bucket n counts accesses that took
+        //              2^(n-1) to 2^n - 1 (scaled) ticks.  The last bucket also collects all longer accesses.
+        #define FS_STATS_LATENCY_BUCKETS    16
+    #endif
+
+    #ifndef FS_STATS_LATENCY_SHIFT
+        // Summary: Right shift applied to tick counts before they are placed in a latency bucket
+        // Description: Use this value to match the histogram resolution to the rate of the FS_STATS_GET_TICKS timer.
+        #define FS_STATS_LATENCY_SHIFT      0
+    #endif
+
+// Summary: Indicates which region of the volume a media access targets
+// Description: The FS_MEDIA_KIND enumeration is used to index the read and write counters in the FS_MEDIA_STATS
+//              structure.  'FS_MEDIA_FAT' counts accesses to the file allocation tables, 'FS_MEDIA_DIR' counts accesses to
+//              directory entries (including the root directory and newly erased directory clusters), 'FS_MEDIA_DATA' counts
+//              accesses to file data, and 'FS_MEDIA_BOOT' counts accesses to the master boot record and boot sector.
+typedef enum
+{
+    FS_MEDIA_FAT = 0,
+    FS_MEDIA_DIR,
+    FS_MEDIA_DATA,
+    FS_MEDIA_BOOT,
+    FS_MEDIA_KINDS
+} FS_MEDIA_KIND;
+
+// Summary: Media access counters and latency histograms
+// Description: The FS_MEDIA_STATS structure is filled in by the FSgetMediaStats function.  It contains the number of
+//              MDD_SectorRead and MDD_SectorWrite calls made by the library, split by FS_MEDIA_KIND, and histograms of
+//              the time each call took, in FS_STATS_GET_TICKS ticks.
+typedef struct
+{
+    DWORD   reads[FS_MEDIA_KINDS];                      // Number of sector reads of each kind
+    DWORD   writes[FS_MEDIA_KINDS];                     // Number of sector writes of each kind
+    DWORD   readErrors;                                 // Number of sector reads that failed
+    DWORD   writeErrors;                                // Number of sector writes that failed
+    DWORD   readLatency[FS_STATS_LATENCY_BUCKETS];      // Histogram of sector read durations
+    DWORD   writeLatency[FS_STATS_LATENCY_BUCKETS];     // Histogram of sector write durations
+    DWORD   maxReadTicks;                               // Longest sector read, in ticks
+    DWORD   maxWriteTicks;                              // Longest sector write, in ticks
+} FS_MEDIA_STATS;
+
+#endif
+
+
 /***************************************************************************
 * Prototypes                                                               *
 ***************************************************************************/
@@ -893,6 +954,69 @@ int FSremove (const char * fileName);
 
 size_t FSfwrite(const void *ptr, size_t size, size_t n, FSFILE *stream);
 
+
+/*********************************************************************************
+  Function:
+    int FSflush (void)
+  Summary:
+    Write all buffered information to the device
+  Conditions:
+    FSInit performed
+  Input:
+    None
+  Return Values:
+    0 -   All buffered information was written
+    EOF - A write to the device failed
+  Side Effects:
+    The FSerrno variable will be changed.
+  Description:
+    The FSflush function writes the global data buffer, the cached FAT
+    sector and, if FS_LAZY_DIR_UPDATE is defined in FSconfig.h, the staged
+    directory sector to the device.  With FS_LAZY_DIR_UPDATE, FSfclose only
+    stages the updated directory entry of a file; entries that share a
+    directory sector are written together, and their last-modified
+    timestamps are set when they are written.  Call FSflush at durability
+    points (for example, before the media may be removed or power lost).
+    If MDD_FlushCache is defined (for example, as MDD_IntFlash_FlushCache
+    when INTERNAL_FLASH_WRITE_CACHE is used), FSflush also calls it.
+  Remarks:
+    The directory entries of files that are still open are updated when
+    those files are closed.
+  *********************************************************************************/
+
+int FSflush (void);
+
+
+/*********************************************************************************
+  Function:
+    int FSfallocate (FSFILE * stream, DWORD bytes)
+  Summary:
+    Reserve contiguous clusters for a file
+  Conditions:
+    File opened in a write mode
+  Input:
+    stream -  Pointer to the file
+    bytes -   The number of bytes, counted from the beginning of the file,
+              that the file's cluster chain must be able to hold
+  Return Values:
+    0 -   The clusters were reserved (or the file already had enough)
+    EOF - The clusters could not be reserved
+  Side Effects:
+    The FSerrno variable will be changed.
+  Description:
+    The FSfallocate function reserves a single run of consecutive clusters
+    for the part of the requested size that the file's cluster chain can't
+    already hold, and links it to the end of the chain in one pass over the
+    FAT.  The file size is not changed.  Subsequent calls of FSfwrite inside
+    the reserved region don't search or modify the FAT, so their latency
+    only depends on the data sector writes.
+  Remarks:
+    Clusters that are reserved but never written remain part of the file's
+    cluster chain until the file is deleted or overwritten.
+  *********************************************************************************/
+
+int FSfallocate (FSFILE * stream, DWORD bytes);
+
 #endif
 
 #ifdef ALLOW_DIRS
@@ -1258,6 +1382,19 @@ int FindNext (SearchRec * rec);
                                               device.
     FSfeof       -
                  - CE_GOOD                   No Error
+    FSflush      -
+                 - CE_GOOD                   No Error
+                 - CE_WRITE_ERROR            The data buffer, FAT sector or staged directory
+                                              sector could not be written to the device.
+    FSfallocate  -
+                 - CE_GOOD                   No Error
+                 - CE_READONLY               The file was opened in a read-only mode.
+                 - CE_WRITE_PROTECTED        The device write-protect check function indicated
+                                              that the device has been write-protected.
+                 - CE_INVALID_CLUSTER        The file has no valid first cluster.
+                 - CE_DISK_FULL              No run of consecutive empty clusters large enough
+                                              for the request could be found.
+                 - CE_WRITE_ERROR            The FAT could not be updated.
     FSformat     -
                  - CE_GOOD                   No Error 
                  - CE_INIT_ERROR             The device could not be initialized. 
@@ -1353,6 +1490,59 @@ int FindNext (SearchRec * rec);
 int FSerror (void);
 
 
+#ifdef FS_MEDIA_STATISTICS
+
+/**************************************************************************
+  Function:
+    void FSgetMediaStats (FS_MEDIA_STATS * stats)
+  Summary:
+    Read the media access statistics
+  Conditions:
+    FS_MEDIA_STATISTICS is defined in FSconfig.h
+  Input:
+    stats -  The structure to copy the statistics into
+  Return:
+    None
+  Side Effects:
+    None
+  Description:
+    Copies the sector read/write counters and latency histograms that
+    have been accumulated since startup or since the last call of
+    FSresetMediaStats.  FSInit does not clear the counters.  To measure
+    the media traffic caused by a single operation (such as FSfwrite,
+    FSfclose or FSmkdir), call FSresetMediaStats before the operation
+    and FSgetMediaStats after it.
+  Remarks:
+    None
+  **************************************************************************/
+
+void FSgetMediaStats (FS_MEDIA_STATS * stats);
+
+
+/**************************************************************************
+  Function:
+    void FSresetMediaStats (void)
+  Summary:
+    Clear the media access statistics
+  Conditions:
+    FS_MEDIA_STATISTICS is defined in FSconfig.h
+  Input:
+    None
+  Return:
+    None
+  Side Effects:
+    None
+  Description:
+    Zeroes all of the media access counters and latency histograms.
+  Remarks:
+    None
+  **************************************************************************/
+
+void FSresetMediaStats (void);
+
+#endif
+
+
 /*********************************************************************************
   Function:
     int FSCreateMBR (unsigned long firstSector, unsigned long numSectors)
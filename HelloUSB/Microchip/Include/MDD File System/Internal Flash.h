@@ -78,6 +78,7 @@ BYTE MDD_IntFlash_SectorWrite(DWORD sector_addr, BYTE* buffer, BYTE allowWriteTo
 WORD MDD_IntFlash_ReadSectorSize(void);
 DWORD MDD_IntFlash_ReadCapacity(void);
 BYTE MDD_IntFlash_WriteProtectState(void);
+BYTE MDD_IntFlash_FlushCache(void);
 
 #if !defined(MDD_INTERNAL_FLASH_MAX_NUM_FILES_IN_ROOT)
     #define MDD_INTERNAL_FLASH_MAX_NUM_FILES_IN_ROOT 16
@@ -97,6 +98,32 @@ BYTE MDD_IntFlash_WriteProtectState(void);
             MDD_INTERNAL_FLASH_OVERHEAD_SECTORS + \
             MDD_INTERNAL_FLASH_DRIVE_CAPACITY)
 
+// Wear leveling: the drive image is stored in MDD_INTERNAL_FLASH_LOGICAL_BLOCKS
+//  erase blocks, and MDD_INTERNAL_FLASH_SPARE_BLOCKS spare blocks and two journal
+//  blocks are reserved by the driver.  The application reserves the drive image
+//  (MDD_INTERNAL_FLASH_TOTAL_DISK_SIZE sectors) as without wear leveling, but
+//  MASTER_BOOT_RECORD_ADDRESS must be aligned to ERASE_BLOCK_SIZE.
+//  MDD_INTERNAL_FLASH_TOTAL_FLASH_SIZE is the program memory used by both.
+#if !defined(MDD_INTERNAL_FLASH_SPARE_BLOCKS)
+    #define MDD_INTERNAL_FLASH_SPARE_BLOCKS 2
+#endif
+#define MDD_INTERNAL_FLASH_SECTORS_PER_BLOCK (ERASE_BLOCK_SIZE / MEDIA_SECTOR_SIZE)
+#define MDD_INTERNAL_FLASH_LOGICAL_BLOCKS (\
+            (MDD_INTERNAL_FLASH_TOTAL_DISK_SIZE + MDD_INTERNAL_FLASH_SECTORS_PER_BLOCK - 1) / \
+            MDD_INTERNAL_FLASH_SECTORS_PER_BLOCK)
+#define MDD_INTERNAL_FLASH_PHYSICAL_BLOCKS (\
+            MDD_INTERNAL_FLASH_LOGICAL_BLOCKS + \
+            MDD_INTERNAL_FLASH_SPARE_BLOCKS)
+#if defined(INTERNAL_FLASH_WEAR_LEVELING)
+    #define MDD_INTERNAL_FLASH_TOTAL_FLASH_SIZE ((MDD_INTERNAL_FLASH_PHYSICAL_BLOCKS + 2) * ERASE_BLOCK_SIZE)
+#else
+    #define MDD_INTERNAL_FLASH_TOTAL_FLASH_SIZE (MDD_INTERNAL_FLASH_TOTAL_DISK_SIZE * MEDIA_SECTOR_SIZE)
+#endif
+
+#if defined(INTERNAL_FLASH_WEAR_LEVELING) && (MDD_INTERNAL_FLASH_SPARE_BLOCKS < 1)
+    #error "Wear leveling needs at least one spare erase block.  Please adjust MDD_INTERNAL_FLASH_SPARE_BLOCKS."
+#endif
+
 #if (MDD_INTERNAL_FLASH_TOTAL_DISK_SIZE>=64)
     #if defined(__C30__)
         #error "PSV only allows 32KB of memory.  The drive options selected result in more than 32KB of data.  Please reduce MDD internal flash memory usage."
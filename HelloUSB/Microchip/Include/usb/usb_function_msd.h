@@ -233,6 +233,10 @@
 #define ASC_WRITE_PROTECTED 0x27
 #define ASCQ_WRITE_PROTECTED 0x00
 
+// with sense key Medium error
+#define ASC_WRITE_ERROR 0x0c
+#define ASCQ_WRITE_ERROR 0x00
+
 /** S T R U C T U R E S ******************************************************/
 /********************** ******************************************************/
  
@@ -451,6 +455,12 @@ typedef union __attribute__((packed)){
     location in the structure. Incorrect alignment will cause the USB stack
     to call the incorrect function for a given command.
     
+    The FlushCache member is optional and may be left out of the
+    initializer. Media that hold written sectors in RAM must provide it
+    (for example, &amp;MDD_IntFlash_FlushCache when INTERNAL_FLASH_WRITE_CACHE
+    is used); it is called at the end of every WRITE(10) command, before
+    the status is returned to the host.
+    
     See the MDD File System Library for additional information about the
     available physical media, their requirements, and how to use their
     associated functions.                                                  
@@ -478,6 +488,9 @@ typedef struct
     //Function pointer to the SectorWrite() function of the physical media 
     //  being used.
     BYTE  (*SectorWrite)(DWORD sector_addr, BYTE* buffer, BYTE allowWriteToZero);
+    //Function pointer to the FlushCache() function of the physical media 
+    //  being used, or NULL if the media does not cache written sectors.
+    BYTE  (*FlushCache)();
 } LUN_FUNCTIONS;
 
 /** Section: Externs *********************************************************/
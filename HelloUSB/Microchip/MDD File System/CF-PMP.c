@@ -233,6 +233,70 @@ void MDD_CFPMP_CFwrite( BYTE add, BYTE d)
 } // CFwrite
 
 
+/******************************************************************************
+ * Function:        void MDD_CFPMP_CFreadBurst(BYTE * buffer, WORD count)
+ *
+ * PreCondition:    The CF data register is selected in PMADDR, the card
+ *                  has reported DRQ and a dummy read has started the
+ *                  first PMP read cycle
+ *
+ * Input:           buffer  - Buffer where data will be stored
+ *                  count   - Number of bytes to read
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Streams count bytes from the CF data register.
+ *
+ * Note:            The card keeps its ready line asserted until the
+ *                  sector buffer has been transferred, so only the PMP busy
+ *                  flag is polled between bytes.
+ *****************************************************************************/
+
+void MDD_CFPMP_CFreadBurst( BYTE * buffer, WORD count)
+{
+   BYTE * end = buffer + count;
+
+   while (buffer < end)
+   {
+      while(PMMODEbits.BUSY);
+      *buffer++ = PMDIN1;
+   }
+} // CFreadBurst
+
+
+/******************************************************************************
+ * Function:        void MDD_CFPMP_CFwriteBurst(BYTE * buffer, WORD count)
+ *
+ * PreCondition:    The CF data register is selected in PMADDR and the
+ *                  card has reported DRQ
+ *
+ * Input:           buffer  - Buffer where data will be read from
+ *                  count   - Number of bytes to write
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Streams count bytes to the CF data register.
+ *
+ * Note:            As in MDD_CFPMP_CFreadBurst, only the PMP busy flag is
+ *                  polled between bytes.
+ *****************************************************************************/
+
+void MDD_CFPMP_CFwriteBurst( BYTE * buffer, WORD count)
+{
+   BYTE * end = buffer + count;
+
+   while (buffer < end)
+   {
+      while(PMMODEbits.BUSY);
+      PMDIN1 = *buffer++;
+   }
+} // CFwriteBurst
+
+
 
 
 /******************************************************************************
@@ -259,7 +323,6 @@ void MDD_CFPMP_CFwrite( BYTE add, BYTE d)
 BYTE MDD_CFPMP_SectorRead(DWORD sector_addr, BYTE * buffer)
 {
    BYTE test;
-   WORD i = 0;
 
    PMADDRbits.CS1 = 1;
 
@@ -287,11 +350,7 @@ BYTE MDD_CFPMP_SectorRead(DWORD sector_addr, BYTE * buffer)
    
    MDD_CFPMP_CFread (0);
 
-   while (i < 512)
-   {
-      MDD_CFPMP_CFwait();
-      buffer[i++] = PMDIN1;
-   }
+   MDD_CFPMP_CFreadBurst (buffer, MEDIA_SECTOR_SIZE);
 
     PMADDRbits.CS1 = 0;        // CF deselected when done
 
@@ -322,8 +381,6 @@ BYTE MDD_CFPMP_SectorRead(DWORD sector_addr, BYTE * buffer)
 
 BYTE MDD_CFPMP_SectorWrite( DWORD sector_addr, BYTE * buffer, BYTE allowWriteToZero)
 {
-   WORD i;
-
    if (sector_addr == 0 && allowWriteToZero == FALSE)
       return FALSE;
 
@@ -349,12 +406,8 @@ BYTE MDD_CFPMP_SectorWrite( DWORD sector_addr, BYTE * buffer, BYTE allowWriteToZ
 
    PMADDR = R_DATA | (PMADDR & 0xC000);
 
-    for ( i=0; i<512; i++)
-    {
-      MDD_CFPMP_CFwait();
-       PMDIN1 = RAMread( buffer, 0);  // write data
-       buffer++;
-    }
+    MDD_CFPMP_CFwriteBurst (buffer, MEDIA_SECTOR_SIZE);
+
     PMADDRbits.CS1 = 0;        // CF deselected when done
 
    return TRUE;       
@@ -63,6 +63,9 @@
    #ifdef ALLOW_FSFPRINTF
       #error Write functions must be enabled to use the FSfprintf function
    #endif
+   #ifdef FS_LAZY_DIR_UPDATE
+      #error Write functions must be enabled to use lazy directory entry updates
+   #endif
 #endif
 
 #ifdef USEREALTIMECLOCK
@@ -133,11 +136,31 @@ FSFILE  gFileTemp;                  // Global variable used for file operations.
     BYTE __attribute__ ((aligned(4)))   gFATBuffer[MEDIA_SECTOR_SIZE];      // The global FAT sector buffer
 #endif
 
+#ifdef FS_LAZY_DIR_UPDATE
+    #ifdef __18CXX
+        #pragma udata dirCacheBuffer
+        BYTE gDirCacheBuffer[MEDIA_SECTOR_SIZE];                                // Staged copy of the directory sector with pending entry updates
+    #else
+        BYTE __attribute__ ((aligned(4)))   gDirCacheBuffer[MEDIA_SECTOR_SIZE]; // Staged copy of the directory sector with pending entry updates
+    #endif
+#endif
+
 
 #pragma udata
 
 DISK gDiskData;         // Global structure containing device information.
 
+#ifdef FS_MEDIA_STATISTICS
+FS_MEDIA_STATS gMediaStats;     // Global structure containing media access counters and latency histograms
+#endif
+
+#ifdef FS_LAZY_DIR_UPDATE
+DWORD   gDirCacheSector = 0xFFFFFFFF;       // Global variable indicating which directory sector is staged in gDirCacheBuffer
+BYTE    gDirCacheDirty = FALSE;             // Global variable indicating that gDirCacheBuffer must be written to the device
+WORD    gDirCacheStampMask = 0;             // Global bit mask of the staged entries whose timestamps must be updated on commit
+DWORD   gLastDirSectorRead = 0xFFFFFFFF;    // Global variable indicating which directory sector was loaded last by Cache_File_Entry
+#endif
+
 
 /************************************************************************/
 /*                        Structures and defines                        */
@@ -226,6 +249,19 @@ DIRENTRY LoadDirAttrib(FILEOBJ fo, WORD *fHandle);
 // Function pointer that points to a physical layer's MDD_xxxxx_WriteProtectState function
 extern BYTE MDD_WriteProtectState(void);
 
+#ifdef FS_MEDIA_STATISTICS
+    BYTE FSstatSectorRead (BYTE kind, DWORD sector, BYTE * buffer);
+    BYTE FSstatSectorWrite (BYTE kind, DWORD sector, BYTE * buffer, BYTE allowWriteToZero);
+
+    // Route every media access through the statistics wrappers
+    #define FS_SECTOR_READ(kind, sector, buffer)        FSstatSectorRead (kind, sector, buffer)
+    #define FS_SECTOR_WRITE(kind, sector, buffer, zero) FSstatSectorWrite (kind, sector, buffer, zero)
+#else
+    // Without statistics the access kind is discarded and the physical layer is called directly
+    #define FS_SECTOR_READ(kind, sector, buffer)        MDD_SectorRead (sector, buffer)
+    #define FS_SECTOR_WRITE(kind, sector, buffer, zero) MDD_SectorWrite (sector, buffer, zero)
+#endif
+
 void FileObjectCopy(FILEOBJ foDest,FILEOBJ foSource);
 BYTE ValidateChars (char * FileName, BYTE mode);
 BYTE FormatFileName( const char* fileName, char* fN2, BYTE mode);
@@ -237,8 +273,14 @@ CETYPE FILEopen (FILEOBJ fo, WORD *fHandle, char type);
 #ifdef ALLOW_WRITES
     BYTE Write_File_Entry( FILEOBJ fo, WORD * curEntry);
     BYTE flushData (void);
+#ifdef FS_LAZY_DIR_UPDATE
+    BYTE DirCacheRead (DISK * dsk, DWORD sector);
+    BYTE DirCacheStage (DISK * dsk, WORD entry);
+    BYTE DirCacheCommit (void);
+#endif
     CETYPE FILEerase( FILEOBJ fo, WORD *fHandle, BYTE EraseClusters);
     BYTE FILEallocate_new_cluster( FILEOBJ fo, BYTE mode);
+    DWORD FATfindEmptyRun (DISK * dsk, DWORD start, DWORD count);
     BYTE FAT_erase_cluster_chain (DWORD cluster, DISK * dsk);
     DWORD FATfindEmptyCluster(FILEOBJ fo);
     BYTE FindEmptyEntries(FILEOBJ fo, WORD *fHandle);
@@ -326,6 +368,12 @@ int FSInit(void)
 
     gBufferZeroed = FALSE;
 
+#ifdef FS_LAZY_DIR_UPDATE
+    gDirCacheSector = 0xFFFFFFFF;
+    gDirCacheDirty = FALSE;
+    gDirCacheStampMask = 0;
+#endif
+
     MDD_InitIO();
 
     if(DISKmount(&gDiskData) == CE_GOOD)
@@ -645,7 +693,7 @@ CETYPE FILEopen (FILEOBJ fo, WORD *fHandle, char type)
                 if (gLastDataSectorRead != l)
                 {
                     gBufferZeroed = FALSE;
-                    if ( !MDD_SectorRead( l, dsk->buffer))
+                    if ( !FS_SECTOR_READ (FS_MEDIA_DATA, l, dsk->buffer))
                         error = CE_BAD_SECTOR_READ;
                     gLastDataSectorRead = l;
                 }
@@ -737,8 +785,8 @@ BYTE FILEget_next_cluster(FILEOBJ fo, DWORD n)
             error = CE_BAD_SECTOR_READ;
         else
         {
-            // check if cluster value is valid
-            if ( c >= disk->maxcls)
+            // check if cluster value is valid (clusters run from 2 to maxcls+1)
+            if ( c >= disk->maxcls + 2)
             {
                 error = CE_INVALID_CLUSTER;
             }
@@ -852,7 +900,7 @@ BYTE LoadMBR(DISK *dsk)
     BootSec BSec;
 
     // Get the partition table from the MBR
-    if ( MDD_SectorRead( FO_MBR, dsk->buffer) != TRUE)
+    if ( FS_SECTOR_READ (FS_MEDIA_BOOT, FO_MBR, dsk->buffer) != TRUE)
     {
         error = CE_BAD_SECTOR_READ;
         FSerrno = CE_BAD_SECTOR_READ;
@@ -997,7 +1045,7 @@ BYTE LoadBootSector(DISK *dsk)
     WORD        ReservedSectorCount;
 
     // Get the Boot sector
-    if ( MDD_SectorRead( dsk->firsts, dsk->buffer) != TRUE)
+    if ( FS_SECTOR_READ (FS_MEDIA_BOOT, dsk->firsts, dsk->buffer) != TRUE)
     {
         FSerrno = CE_BAD_SECTOR_READ;
         error = CE_BAD_SECTOR_READ;
@@ -1300,7 +1348,7 @@ int FSCreateMBR (unsigned long firstSector, unsigned long numSectors)
     Partition->Signature0 = 0x55;
     Partition->Signature1 = 0xAA;
 
-    if (MDD_SectorWrite (0x00, gDataBuffer, TRUE) != TRUE)
+    if (FS_SECTOR_WRITE (FS_MEDIA_BOOT, 0x00, gDataBuffer, TRUE) != TRUE)
         return EOF;
     else
         return 0;
@@ -1364,6 +1412,13 @@ int FSformat (char mode, long int serialNumber, char * volumeID)
 
     disk->buffer = gDataBuffer;
 
+#ifdef FS_LAZY_DIR_UPDATE
+    // Any staged directory sector belongs to the volume being destroyed
+    gDirCacheSector = 0xFFFFFFFF;
+    gDirCacheDirty = FALSE;
+    gDirCacheStampMask = 0;
+#endif
+
     MDD_InitIO();
 
     if (MDD_MediaInitialize() != TRUE)
@@ -1372,7 +1427,7 @@ int FSformat (char mode, long int serialNumber, char * volumeID)
         return EOF;
     }
 
-    if (MDD_SectorRead (0x00, gDataBuffer) == FALSE)
+    if (FS_SECTOR_READ (FS_MEDIA_BOOT, 0x00, gDataBuffer) == FALSE)
     {
         FSerrno = CE_BADCACHEREAD;
         return EOF;
@@ -1438,7 +1493,7 @@ int FSformat (char mode, long int serialNumber, char * volumeID)
                 // Format to FAT12 only if there are too few sectors to format
                 // as FAT16
                 masterBootRecord->Partition0.PTE_FSDesc = 0x01;
-                if (MDD_SectorWrite (0x00, gDataBuffer, TRUE) == FALSE)
+                if (FS_SECTOR_WRITE (FS_MEDIA_BOOT, 0x00, gDataBuffer, TRUE) == FALSE)
                 {
                     FSerrno = CE_WRITE_ERROR;
                     return EOF;
@@ -1469,7 +1524,7 @@ int FSformat (char mode, long int serialNumber, char * volumeID)
                 disk->type = FAT16;
                 // Format to FAT16
                 masterBootRecord->Partition0.PTE_FSDesc = 0x06;
-                if (MDD_SectorWrite (0x00, gDataBuffer, TRUE) == FALSE)
+                if (FS_SECTOR_WRITE (FS_MEDIA_BOOT, 0x00, gDataBuffer, TRUE) == FALSE)
                 {
                     FSerrno = CE_WRITE_ERROR;
                     return EOF;
@@ -1598,7 +1653,7 @@ int FSformat (char mode, long int serialNumber, char * volumeID)
 
             disk->root = disk->fat + (disk->fatcopy * disk->fatsize);
             
-            if (MDD_SectorWrite (disk->firsts, gDataBuffer, FALSE) == FALSE)
+            if (FS_SECTOR_WRITE (FS_MEDIA_BOOT, disk->firsts, gDataBuffer, FALSE) == FALSE)
             {
                 FSerrno = CE_WRITE_ERROR;
                 return EOF;
@@ -1627,7 +1682,7 @@ int FSformat (char mode, long int serialNumber, char * volumeID)
 
     for (j = disk->fatcopy - 1; j != 0xFFFF; j--)
     {
-        if (MDD_SectorWrite (disk->fat + (j * disk->fatsize), gDataBuffer, FALSE) == FALSE)
+        if (FS_SECTOR_WRITE (FS_MEDIA_FAT, disk->fat + (j * disk->fatsize), gDataBuffer, FALSE) == FALSE)
             return EOF;
     }
 
@@ -1637,7 +1692,7 @@ int FSformat (char mode, long int serialNumber, char * volumeID)
     {
         for (j = disk->fatcopy - 1; j != 0xFFFF; j--)
         {
-            if (MDD_SectorWrite (Index + (j * disk->fatsize), gDataBuffer, FALSE) == FALSE)
+            if (FS_SECTOR_WRITE (FS_MEDIA_FAT, Index + (j * disk->fatsize), gDataBuffer, FALSE) == FALSE)
                 return EOF;
         }
     }
@@ -1647,7 +1702,7 @@ int FSformat (char mode, long int serialNumber, char * volumeID)
 
     for (Index = 1; Index < RootDirSectors; Index++)
     {
-        if (MDD_SectorWrite (disk->root + Index, gDataBuffer, FALSE) == FALSE)
+        if (FS_SECTOR_WRITE (FS_MEDIA_DIR, disk->root + Index, gDataBuffer, FALSE) == FALSE)
             return EOF;
     }
 
@@ -1669,12 +1724,12 @@ int FSformat (char mode, long int serialNumber, char * volumeID)
         gDataBuffer[19] = 0x11;
         gDataBuffer[23] = 0x11;
 
-        if (MDD_SectorWrite (disk->root, gDataBuffer, FALSE) == FALSE)
+        if (FS_SECTOR_WRITE (FS_MEDIA_DIR, disk->root, gDataBuffer, FALSE) == FALSE)
             return EOF;
     }
     else
     {
-        if (MDD_SectorWrite (disk->root, gDataBuffer, FALSE) == FALSE)
+        if (FS_SECTOR_WRITE (FS_MEDIA_DIR, disk->root, gDataBuffer, FALSE) == FALSE)
             return EOF;
     }
 
@@ -1748,11 +1803,20 @@ BYTE Write_File_Entry( FILEOBJ fo, WORD * curEntry)
 
     // Now write it
     // "Offset" ensures writing of data belonging to a file entry only. Hence it doesn't change other file entries.
-    if ( !MDD_SectorWrite( sector + offset2, dsk->buffer, FALSE)) 
+    if ( !FS_SECTOR_WRITE (FS_MEDIA_DIR, sector + offset2, dsk->buffer, FALSE)) 
         status = FALSE;
     else
         status = TRUE;
 
+#ifdef FS_LAZY_DIR_UPDATE
+    // Keep the staged copy coherent; only the deferred timestamps still differ from the media
+    if (status && ((sector + offset2) == gDirCacheSector))
+    {
+        memcpy (gDirCacheBuffer, dsk->buffer, MEDIA_SECTOR_SIZE);
+        gDirCacheDirty = (gDirCacheStampMask != 0);
+    }
+#endif
+
     return(status);
 } // Write_File_Entry
 #endif
@@ -1778,6 +1842,9 @@ BYTE Write_File_Entry( FILEOBJ fo, WORD * curEntry)
     starting with the cluster pointed to by 'cluster' and
     mark all of the FAT entries as empty until the end of
     the chain has been reached or an error occurs. 
+    If FS_LAZY_DIR_UPDATE is defined, a staged directory
+    sector that lies in one of the freed clusters is
+    dropped without being written.
   Remarks:
     None                                                   
   **********************************************************/
@@ -1840,6 +1907,17 @@ BYTE FAT_erase_cluster_chain (DWORD cluster, DISK * dsk)
                     if(WriteFAT(dsk, cluster, CLUSTER_EMPTY, FALSE) == ClusterFailValue)
                         status = Fail;
 
+#ifdef FS_LAZY_DIR_UPDATE
+                    // A staged directory sector in a freed cluster must not be written back
+                    // over the data of the file that gets the cluster next; drop it
+                    if ((gDirCacheSector - Cluster2Sector(dsk, cluster)) < dsk->SecPerClus)
+                    {
+                        gDirCacheSector = 0xFFFFFFFF;
+                        gDirCacheDirty = FALSE;
+                        gDirCacheStampMask = 0;
+                    }
+#endif
+
                     // now update what the current cluster is
                     cluster = c;
                 }
@@ -1980,7 +2058,11 @@ DIRENTRY Cache_File_Entry( FILEOBJ fo, WORD * curEntry, BYTE ForceRead)
                 gBufferOwner = NULL;
                 gBufferZeroed = FALSE;
 
-                if ( MDD_SectorRead( sector + offset2, dsk->buffer) != TRUE) // if FALSE: sector could not be read.
+#ifdef FS_LAZY_DIR_UPDATE
+                if ( DirCacheRead (dsk, sector + offset2) != TRUE) // if FALSE: sector could not be read.
+#else
+                if ( FS_SECTOR_READ (FS_MEDIA_DIR, sector + offset2, dsk->buffer) != TRUE) // if FALSE: sector could not be read.
+#endif
                 {
                     dir = ((DIRENTRY)NULL);
                 }
@@ -2697,7 +2779,7 @@ DWORD FATfindEmptyCluster(FILEOBJ fo)
 
         c++;    // check next cluster in FAT
         // check if reached last cluster in FAT, re-start from top
-        if (value == EndClusterLimit || c >= disk->maxcls)
+        if (value == EndClusterLimit || c >= disk->maxcls + 2)
             c = 2;
 
         // check if full circle done, disk full
@@ -2736,6 +2818,10 @@ DWORD FATfindEmptyCluster(FILEOBJ fo)
     then be written to the device.  Finally, the memory
     used for the specified file object will be freed from
     the dynamic heap or the array of FSFILE objects.
+    If FS_LAZY_DIR_UPDATE is defined, the updated entry is
+    only staged in the directory cache; it is written, with
+    its timestamp, by FSflush or when an entry in a different
+    directory sector is staged.
   Remarks:
     A function to flush data to the device without closing the
     file can be created by removing the portion of this
@@ -2780,6 +2866,7 @@ int FSfclose(FSFILE   *fo)
             return error;
         }
 
+#ifndef FS_LAZY_DIR_UPDATE
       // update the time
 #ifdef INCREMENTTIMESTAMP
         IncrementTimeStamp(dir);
@@ -2790,12 +2877,23 @@ int FSfclose(FSFILE   *fo)
         CacheTime();
         dir->DIR_WrtTime = gTimeWrtTime;
         dir->DIR_WrtDate = gTimeWrtDate;
+#endif
 #endif
 
         dir->DIR_FileSize = fo->size;
 
         dir->DIR_Attr = fo->attributes;
 
+#ifdef FS_LAZY_DIR_UPDATE
+        // Stage the entry; it will be written with its timestamp by DirCacheCommit
+        if(DirCacheStage(fo->dsk, fHandle) == CE_GOOD)
+            error = 0;
+        else
+        {
+            FSerrno = CE_WRITE_ERROR;
+            error = EOF;
+        }
+#else
         // just write the last entry in
         if(Write_File_Entry(fo,&fHandle))
             error = 0;
@@ -2804,6 +2902,7 @@ int FSfclose(FSFILE   *fo)
             FSerrno = CE_WRITE_ERROR;
             error = EOF;
         }
+#endif
 
         // it's now closed
         fo->flags.write = FALSE;
@@ -4009,6 +4108,189 @@ int FSerror (void)
 }
 
 
+#ifdef FS_MEDIA_STATISTICS
+
+/**************************************************************
+  Function:
+    static BYTE FSstatLatencyBucket (DWORD ticks)
+  Summary:
+    Select a latency histogram bucket
+  Conditions:
+    This function should not be called by the user.
+  Input:
+    ticks -  The duration of a media access in timer ticks
+  Return:
+    The index of the histogram bucket for this duration
+  Side Effects:
+    None
+  Description:
+    The duration is scaled down by FS_STATS_LATENCY_SHIFT.  Bucket
+    0 counts accesses that completed in 0 scaled ticks; bucket n
+    counts accesses that took from 2^(n-1) to 2^n - 1 scaled
+    ticks.  The last bucket also collects everything longer.
+  Remarks:
+    None
+  **************************************************************/
+
+static BYTE FSstatLatencyBucket (DWORD ticks)
+{
+    BYTE bucket = 0;
+
+    ticks >>= FS_STATS_LATENCY_SHIFT;
+
+    while ((ticks != 0) && (bucket < (FS_STATS_LATENCY_BUCKETS - 1)))
+    {
+        ticks >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+
+/**************************************************************
+  Function:
+    BYTE FSstatSectorRead (BYTE kind, DWORD sector, BYTE * buffer)
+  Summary:
+    Read a sector and record the access in the media statistics
+  Conditions:
+    This function should not be called by the user.
+  Input:
+    kind -    The region being accessed (FS_MEDIA_FAT, FS_MEDIA_DIR,
+              FS_MEDIA_DATA or FS_MEDIA_BOOT)
+    sector -  The sector to read
+    buffer -  The buffer to read the sector into
+  Return Values:
+    TRUE -  The sector was read
+    FALSE - The sector could not be read
+  Side Effects:
+    The gMediaStats structure will be updated.
+  Description:
+    Wraps the physical layer's MDD_SectorRead function, counting
+    the call by kind and timing it with FS_STATS_GET_TICKS.
+  Remarks:
+    None
+  **************************************************************/
+
+BYTE FSstatSectorRead (BYTE kind, DWORD sector, BYTE * buffer)
+{
+    DWORD start, ticks;
+    BYTE result;
+
+    start = FS_STATS_GET_TICKS();
+    result = MDD_SectorRead (sector, buffer);
+    ticks = FS_STATS_GET_TICKS() - start;
+
+    gMediaStats.reads[kind]++;
+    if (result != TRUE)
+        gMediaStats.readErrors++;
+    gMediaStats.readLatency[FSstatLatencyBucket (ticks)]++;
+    if (ticks > gMediaStats.maxReadTicks)
+        gMediaStats.maxReadTicks = ticks;
+
+    return result;
+}
+
+
+/**************************************************************
+  Function:
+    BYTE FSstatSectorWrite (BYTE kind, DWORD sector, BYTE * buffer, BYTE allowWriteToZero)
+  Summary:
+    Write a sector and record the access in the media statistics
+  Conditions:
+    This function should not be called by the user.
+  Input:
+    kind -              The region being accessed (FS_MEDIA_FAT,
+                        FS_MEDIA_DIR, FS_MEDIA_DATA or FS_MEDIA_BOOT)
+    sector -            The sector to write
+    buffer -            The data to write
+    allowWriteToZero -  Passed through to MDD_SectorWrite
+  Return Values:
+    TRUE -  The sector was written
+    FALSE - The sector could not be written
+  Side Effects:
+    The gMediaStats structure will be updated.
+  Description:
+    Wraps the physical layer's MDD_SectorWrite function, counting
+    the call by kind and timing it with FS_STATS_GET_TICKS.
+  Remarks:
+    None
+  **************************************************************/
+
+BYTE FSstatSectorWrite (BYTE kind, DWORD sector, BYTE * buffer, BYTE allowWriteToZero)
+{
+    DWORD start, ticks;
+    BYTE result;
+
+    start = FS_STATS_GET_TICKS();
+    result = MDD_SectorWrite (sector, buffer, allowWriteToZero);
+    ticks = FS_STATS_GET_TICKS() - start;
+
+    gMediaStats.writes[kind]++;
+    if (result != TRUE)
+        gMediaStats.writeErrors++;
+    gMediaStats.writeLatency[FSstatLatencyBucket (ticks)]++;
+    if (ticks > gMediaStats.maxWriteTicks)
+        gMediaStats.maxWriteTicks = ticks;
+
+    return result;
+}
+
+
+/**************************************************************
+  Function:
+    void FSgetMediaStats (FS_MEDIA_STATS * stats)
+  Summary:
+    Read the media access statistics
+  Conditions:
+    FS_MEDIA_STATISTICS is defined in FSconfig.h
+  Input:
+    stats -  The structure to copy the statistics into
+  Return:
+    None
+  Side Effects:
+    None
+  Description:
+    Copies the sector read/write counters and latency histograms
+    accumulated since startup or the last FSresetMediaStats call.
+    FSInit does not clear the counters.
+  Remarks:
+    None
+  **************************************************************/
+
+void FSgetMediaStats (FS_MEDIA_STATS * stats)
+{
+    memcpy (stats, &gMediaStats, sizeof (FS_MEDIA_STATS));
+}
+
+
+/**************************************************************
+  Function:
+    void FSresetMediaStats (void)
+  Summary:
+    Clear the media access statistics
+  Conditions:
+    FS_MEDIA_STATISTICS is defined in FSconfig.h
+  Input:
+    None
+  Return:
+    None
+  Side Effects:
+    The gMediaStats structure will be cleared.
+  Description:
+    Zeroes all counters and histogram buckets.
+  Remarks:
+    None
+  **************************************************************/
+
+void FSresetMediaStats (void)
+{
+    memset (&gMediaStats, 0x00, sizeof (FS_MEDIA_STATS));
+}
+
+#endif
+
+
 /**************************************************************
   Function:
     void FileObjectCopy(FILEOBJ foDest,FILEOBJ foSource)
@@ -4173,7 +4455,7 @@ BYTE EraseCluster(DISK *disk, DWORD cluster)
     // Now clear them out
     for(index = 0; index < disk->SecPerClus && error == CE_GOOD; index++)
     {
-        if (MDD_SectorWrite( SectorAddress++, disk->buffer, FALSE) != TRUE)
+        if (FS_SECTOR_WRITE (FS_MEDIA_DIR, SectorAddress++, disk->buffer, FALSE) != TRUE)
             error = CE_WRITE_ERROR;
     }
 
@@ -4459,6 +4741,7 @@ size_t FSfwrite(const void *ptr, size_t size, size_t n, FSFILE *stream)
     WORD        pos;
     DWORD       l;                     // absolute lba of sector to load
     DWORD       seek, filesize;
+    DWORD       cls;
     WORD        writeCount = 0;
 
     // see if the file was opened in a write mode
@@ -4514,7 +4797,7 @@ size_t FSfwrite(const void *ptr, size_t size, size_t n, FSFILE *stream)
         }
 
         gBufferZeroed = FALSE;
-        if(!MDD_SectorRead( l, dsk->buffer) )
+        if(!FS_SECTOR_READ (FS_MEDIA_DATA, l, dsk->buffer) )
         {
             FSerrno = CE_BADCACHEREAD;
             error = CE_BAD_SECTOR_READ;
@@ -4545,6 +4828,11 @@ size_t FSfwrite(const void *ptr, size_t size, size_t n, FSFILE *stream)
             // reset position
             pos = 0;
 
+            // A sector past the end of the file holds no file data, so
+            // there is no need to read it before overwriting it
+            if(stream->flags.FileWriteEOF)
+                needRead = FALSE;
+
             // point to the next sector
             stream->sec++;
 
@@ -4555,8 +4843,16 @@ size_t FSfwrite(const void *ptr, size_t size, size_t n, FSFILE *stream)
 
                 if(stream->flags.FileWriteEOF)
                 {
-                    error = FILEallocate_new_cluster(stream, 0);    // add new cluster to the file
-                    needRead = FALSE;
+                    // Use the next cluster in the chain if one has already been
+                    // reserved (by FSfallocate); otherwise add a new one
+                    cls = ReadFAT(dsk, stream->ccls);
+                    if ((cls >= 2) && (cls < dsk->maxcls + 2))
+                    {
+                        stream->ccls = cls;
+                        error = CE_GOOD;
+                    }
+                    else
+                        error = FILEallocate_new_cluster(stream, 0);    // add new cluster to the file
                 }
                 else
                     error = FILEget_next_cluster( stream, 1);
@@ -4578,7 +4874,7 @@ size_t FSfwrite(const void *ptr, size_t size, size_t n, FSFILE *stream)
                 // Whatever is in the buffer will work fine
                 if (needRead)
                 {
-                    if( !MDD_SectorRead( l, dsk->buffer) )
+                    if( !FS_SECTOR_READ (FS_MEDIA_DATA, l, dsk->buffer) )
                     {
                         FSerrno = CE_BADCACHEREAD;
                         error = CE_BAD_SECTOR_READ;
@@ -4624,6 +4920,219 @@ size_t FSfwrite(const void *ptr, size_t size, size_t n, FSFILE *stream)
 #endif
 
 
+/*********************************************************************************
+  Function:
+    DWORD FATfindEmptyRun (DISK * dsk, DWORD start, DWORD count)
+  Summary:
+    Find a run of consecutive empty clusters
+  Conditions:
+    This function should not be called by the user.
+  Input:
+    dsk -    The disk structure
+    start -  The cluster to begin the search at
+    count -  The number of consecutive empty clusters required
+  Return Values:
+    DWORD - The first cluster of the run
+    0 -     No run of the requested length could be found
+  Side Effects:
+    None
+  Description:
+    This function scans the FAT from the 'start' cluster to the end of the
+    data region, then from cluster 2 back to 'start', looking for 'count'
+    consecutive clusters that are all empty.  A run may not wrap around the
+    end of the FAT.
+  Remarks:
+    None
+  *********************************************************************************/
+
+#ifdef ALLOW_WRITES
+DWORD FATfindEmptyRun (DISK * dsk, DWORD start, DWORD count)
+{
+    DWORD   c, runStart, runLength, value, ClusterFailValue;
+    BYTE    wrapped = FALSE;
+
+#ifdef SUPPORT_FAT32 // If FAT32 supported.
+    if (dsk->type == FAT32)
+        ClusterFailValue = CLUSTER_FAIL_FAT32;
+    else
+#endif
+        ClusterFailValue = CLUSTER_FAIL_FAT16;
+
+    if ((start < 2) || (start >= dsk->maxcls + 2))
+        start = 2;
+
+    c = start;
+    runStart = c;
+    runLength = 0;
+
+    while (runLength < count)
+    {
+        if (c >= dsk->maxcls + 2)
+        {
+            // A run can't continue across the end of the FAT
+            if (wrapped)
+                return 0;
+            wrapped = TRUE;
+            c = 2;
+            runStart = c;
+            runLength = 0;
+            continue;
+        }
+
+        if (wrapped && (c >= start + count))
+            return 0;
+
+        if ((value = ReadFAT (dsk, c)) == ClusterFailValue)
+            return 0;
+
+        c++;
+        if (value == CLUSTER_EMPTY)
+        {
+            runLength++;
+        }
+        else
+        {
+            runStart = c;
+            runLength = 0;
+        }
+    }
+
+    return runStart;
+}
+
+
+/*********************************************************************************
+  Function:
+    int FSfallocate (FSFILE * stream, DWORD bytes)
+  Summary:
+    Reserve contiguous clusters for a file
+  Conditions:
+    File opened in a write mode
+  Input:
+    stream -  Pointer to the file
+    bytes -   The number of bytes, counted from the beginning of the file,
+              that the file's cluster chain must be able to hold
+  Return Values:
+    0 -   The clusters were reserved (or the file already had enough)
+    EOF - The clusters could not be reserved
+  Side Effects:
+    The FSerrno variable will be changed.
+  Description:
+    The FSfallocate function counts the clusters already linked to the
+    file, then searches the FAT for a single run of consecutive empty
+    clusters large enough to hold the rest of the requested size.  The run
+    is linked into a chain and appended to the file in one pass over the
+    FAT, and the cached FAT sector is written to the device.  The file size
+    is not changed.  Later calls of FSfwrite that stay inside the reserved
+    clusters only read and write data sectors; they never search or modify
+    the FAT.
+  Remarks:
+    Clusters that are reserved but never written remain part of the file's
+    cluster chain until the file is deleted or overwritten.
+  *********************************************************************************/
+
+int FSfallocate (FSFILE * stream, DWORD bytes)
+{
+    DISK *  dsk;
+    DWORD   clusterSize, needed, have, c, last, next, run, LastClusterValue;
+
+    FSerrno = CE_GOOD;
+
+    if (!(stream->flags.write))
+    {
+        FSerrno = CE_READONLY;
+        return EOF;
+    }
+
+    if (MDD_WriteProtectState())
+    {
+        FSerrno = CE_WRITE_PROTECTED;
+        return EOF;
+    }
+
+    dsk = stream->dsk;
+
+    /* Settings based on FAT type */
+    switch (dsk->type)
+    {
+#ifdef SUPPORT_FAT32 // If FAT32 supported.
+        case FAT32:
+            LastClusterValue = LAST_CLUSTER_FAT32;
+            break;
+#endif
+        case FAT12:
+            LastClusterValue = LAST_CLUSTER_FAT12;
+            break;
+        case FAT16:
+        default:
+            LastClusterValue = LAST_CLUSTER_FAT16;
+            break;
+    }
+
+    clusterSize = (DWORD)dsk->SecPerClus * MEDIA_SECTOR_SIZE;
+    needed = (bytes + clusterSize - 1) / clusterSize;
+
+    // Count the clusters that are already linked to the file
+    last = stream->cluster;
+    if ((last < 2) || (last >= dsk->maxcls + 2))
+    {
+        FSerrno = CE_INVALID_CLUSTER;
+        return EOF;
+    }
+
+    have = 1;
+    while (((next = ReadFAT (dsk, last)) >= 2) && (next < dsk->maxcls + 2))
+    {
+        last = next;
+        have++;
+    }
+
+    if (have >= needed)
+        return 0;
+
+    needed -= have;
+
+    // Prefer the clusters that directly follow the end of the file
+    run = FATfindEmptyRun (dsk, last + 1, needed);
+    if (run == 0)
+    {
+        FSerrno = CE_DISK_FULL;
+        return EOF;
+    }
+
+    // Build the new chain first, so an interrupted call only leaks clusters
+    for (c = run; c < run + needed - 1; c++)
+    {
+        if (WriteFAT (dsk, c, c + 1, FALSE) != 0)
+        {
+            FSerrno = CE_WRITE_ERROR;
+            return EOF;
+        }
+    }
+    if (WriteFAT (dsk, c, LastClusterValue, FALSE) != 0)
+    {
+        FSerrno = CE_WRITE_ERROR;
+        return EOF;
+    }
+
+    // Then append it to the file
+    if (WriteFAT (dsk, last, run, FALSE) != 0)
+    {
+        FSerrno = CE_WRITE_ERROR;
+        return EOF;
+    }
+
+    if (WriteFAT (dsk, 0, 0, TRUE) != 0)
+    {
+        FSerrno = CE_WRITE_ERROR;
+        return EOF;
+    }
+
+    return 0;
+}
+#endif
+
+
 /**********************************************************
   Function:
     BYTE flushData (void)
@@ -4663,7 +5172,7 @@ BYTE flushData (void)
     l = Cluster2Sector(dsk,stream->ccls);
     l += (WORD)stream->sec;      // add the sector number to it
 
-    if(!MDD_SectorWrite( l, dsk->buffer, FALSE))
+    if(!FS_SECTOR_WRITE (FS_MEDIA_DATA, l, dsk->buffer, FALSE))
     {
         return CE_WRITE_ERROR;
     }
@@ -4674,6 +5183,225 @@ BYTE flushData (void)
 }
 #endif
 
+
+/*********************************************************************************
+  Function:
+    int FSflush (void)
+  Summary:
+    Write all buffered information to the device
+  Conditions:
+    FSInit performed
+  Input:
+    None
+  Return Values:
+    0 -   All buffered information was written
+    EOF - A write to the device failed
+  Side Effects:
+    The FSerrno variable will be changed.
+  Description:
+    The FSflush function writes the global data buffer, the cached FAT
+    sector and, if FS_LAZY_DIR_UPDATE is defined, the staged directory
+    sector to the device.  If the physical layer buffers writes and
+    MDD_FlushCache is mapped to its flush function, that buffer is written
+    too.  When it returns successfully, every file that has been closed is
+    fully recorded on the device.
+  Remarks:
+    The directory entries of files that are still open are updated when
+    those files are closed.
+  *********************************************************************************/
+
+#ifdef ALLOW_WRITES
+int FSflush (void)
+{
+    FSerrno = CE_GOOD;
+
+    if (gNeedDataWrite)
+        if (flushData())
+        {
+            FSerrno = CE_WRITE_ERROR;
+            return EOF;
+        }
+
+    if (gNeedFATWrite)
+        if (WriteFAT (&gDiskData, 0, 0, TRUE))
+        {
+            FSerrno = CE_WRITE_ERROR;
+            return EOF;
+        }
+
+#ifdef FS_LAZY_DIR_UPDATE
+    if (DirCacheCommit() != CE_GOOD)
+    {
+        FSerrno = CE_WRITE_ERROR;
+        return EOF;
+    }
+#endif
+
+#ifdef MDD_FlushCache
+    if (MDD_FlushCache() == FALSE)
+    {
+        FSerrno = CE_WRITE_ERROR;
+        return EOF;
+    }
+#endif
+
+    return 0;
+}
+#endif
+
+
+#ifdef FS_LAZY_DIR_UPDATE
+
+/*********************************************************************************
+  Function:
+    BYTE DirCacheRead (DISK * dsk, DWORD sector)
+  Summary:
+    Load a directory sector into the data buffer
+  Conditions:
+    This function should not be called by the user.
+  Input:
+    dsk -     The disk structure
+    sector -  The directory sector to load
+  Return Values:
+    TRUE -  The sector was loaded
+    FALSE - The sector could not be read
+  Side Effects:
+    None
+  Description:
+    If the requested sector is the one staged in gDirCacheBuffer, the staged
+    copy is used, since it may be newer than the media; otherwise the sector
+    is read from the device.
+  Remarks:
+    None
+  *********************************************************************************/
+
+BYTE DirCacheRead (DISK * dsk, DWORD sector)
+{
+    if (sector == gDirCacheSector)
+    {
+        memcpy (dsk->buffer, gDirCacheBuffer, MEDIA_SECTOR_SIZE);
+    }
+    else if (FS_SECTOR_READ (FS_MEDIA_DIR, sector, dsk->buffer) != TRUE)
+    {
+        gLastDirSectorRead = 0xFFFFFFFF;
+        return FALSE;
+    }
+
+    gLastDirSectorRead = sector;
+    return TRUE;
+}
+
+
+/*********************************************************************************
+  Function:
+    BYTE DirCacheStage (DISK * dsk, WORD entry)
+  Summary:
+    Stage a modified directory entry for a later write
+  Conditions:
+    This function should not be called by the user.  The sector containing
+    the entry must have been loaded into the data buffer by Cache_File_Entry.
+  Input:
+    dsk -    The disk structure
+    entry -  The offset of the modified entry in its directory
+  Return Values:
+    CE_GOOD -        The entry was staged
+    CE_WRITE_ERROR - A previously staged sector could not be written
+  Side Effects:
+    None
+  Description:
+    Copies the directory sector in the data buffer into gDirCacheBuffer and
+    marks the entry's timestamp as pending.  If a different sector was
+    staged, it is committed to the device first, so updates to entries that
+    share a sector are written together.
+  Remarks:
+    None
+  *********************************************************************************/
+
+BYTE DirCacheStage (DISK * dsk, WORD entry)
+{
+    if (gDirCacheSector != gLastDirSectorRead)
+    {
+        if (DirCacheCommit() != CE_GOOD)
+            return CE_WRITE_ERROR;
+
+        gDirCacheSector = gLastDirSectorRead;
+    }
+
+    memcpy (gDirCacheBuffer, dsk->buffer, MEDIA_SECTOR_SIZE);
+    gDirCacheStampMask |= (WORD)1 << (entry % DIRENTRIES_PER_SECTOR);
+    gDirCacheDirty = TRUE;
+
+    return CE_GOOD;
+}
+
+
+/*********************************************************************************
+  Function:
+    BYTE DirCacheCommit (void)
+  Summary:
+    Write the staged directory sector to the device
+  Conditions:
+    This function should not be called by the user.
+  Input:
+    None
+  Return Values:
+    CE_GOOD -        The staged sector was written (or nothing was staged)
+    CE_WRITE_ERROR - The staged sector could not be written
+  Side Effects:
+    None
+  Description:
+    Applies the last-modified timestamp to every staged entry that has not
+    been deleted since, using the clocking mode selected in FSconfig.h (the
+    real-time clock is read only once per commit), and writes the sector to
+    the device.
+  Remarks:
+    None
+  *********************************************************************************/
+
+BYTE DirCacheCommit (void)
+{
+#if defined(INCREMENTTIMESTAMP) || defined(USERDEFINEDCLOCK) || defined(USEREALTIMECLOCK)
+    DIRENTRY dir;
+    BYTE index;
+#endif
+
+    if (gDirCacheDirty == FALSE)
+        return CE_GOOD;
+
+#if defined(INCREMENTTIMESTAMP) || defined(USERDEFINEDCLOCK) || defined(USEREALTIMECLOCK)
+#ifdef USEREALTIMECLOCK
+    if (gDirCacheStampMask)
+        CacheTime();
+#endif
+
+    for (index = 0; index < DIRENTRIES_PER_SECTOR; index++)
+    {
+        dir = (DIRENTRY)gDirCacheBuffer + index;
+
+        // Entries deleted after they were staged keep their old timestamp
+        if ((gDirCacheStampMask & ((WORD)1 << index)) && (dir->DIR_Name[0] != DIR_DEL))
+        {
+#ifdef INCREMENTTIMESTAMP
+            IncrementTimeStamp(dir);
+#else
+            dir->DIR_WrtTime = gTimeWrtTime;
+            dir->DIR_WrtDate = gTimeWrtDate;
+#endif
+        }
+    }
+#endif
+    gDirCacheStampMask = 0;
+
+    if (!FS_SECTOR_WRITE (FS_MEDIA_DIR, gDirCacheSector, gDirCacheBuffer, FALSE))
+        return CE_WRITE_ERROR;
+
+    gDirCacheDirty = FALSE;
+
+    return CE_GOOD;
+}
+
+#endif
+
 /****************************************************
   Function:
     int FSfeof( FSFILE * stream )
@@ -4773,7 +5501,7 @@ size_t FSfread (void *ptr, size_t size, size_t n, FSFILE *stream)
         sec_sel += (WORD)stream->sec;      // add the sector number to it
 
         gBufferZeroed = FALSE;
-        if( !MDD_SectorRead( sec_sel, dsk->buffer) )
+        if( !FS_SECTOR_READ (FS_MEDIA_DATA, sec_sel, dsk->buffer) )
         {
             FSerrno = CE_BAD_SECTOR_READ;
             error = CE_BAD_SECTOR_READ;
@@ -4817,7 +5545,7 @@ size_t FSfread (void *ptr, size_t size, size_t n, FSFILE *stream)
 
             gBufferOwner = stream;
             gBufferZeroed = FALSE;
-            if( !MDD_SectorRead( sec_sel, dsk->buffer) )
+            if( !FS_SECTOR_READ (FS_MEDIA_DATA, sec_sel, dsk->buffer) )
             {
                 FSerrno = CE_BAD_SECTOR_READ;
                 error = CE_BAD_SECTOR_READ;
@@ -5229,7 +5957,7 @@ int FSfseek(FSFILE *stream, long offset, int whence)
 
         gBufferOwner = NULL;
         gBufferZeroed = FALSE;
-        if( !MDD_SectorRead(temp, dsk->buffer) )
+        if( !FS_SECTOR_READ (FS_MEDIA_DATA, temp, dsk->buffer) )
         {
             FSerrno = CE_BADCACHEREAD;
             return (-1);   // Bad read
@@ -5496,7 +6224,7 @@ DWORD ReadFAT (DISK *dsk, DWORD ccls)
                         if(WriteFAT (dsk, 0, 0, TRUE))
                             return ClusterFailValue;
 #endif
-                    if (!MDD_SectorRead (l+1, gFATBuffer))
+                    if (!FS_SECTOR_READ (FS_MEDIA_FAT, l+1, gFATBuffer))
                     {
                         gLastFATSectorRead = 0xFFFF;
                         return ClusterFailValue;
@@ -5528,7 +6256,7 @@ DWORD ReadFAT (DISK *dsk, DWORD ccls)
                     return ClusterFailValue;
             }
 #endif
-            if (!MDD_SectorRead (l, gFATBuffer))
+            if (!FS_SECTOR_READ (FS_MEDIA_FAT, l, gFATBuffer))
             {
                 gLastFATSectorRead = 0xFFFF;  // Note: It is Sector not Cluster.
                 return ClusterFailValue;
@@ -5636,7 +6364,7 @@ DWORD WriteFAT (DISK *dsk, DWORD ccls, DWORD value, BYTE forceWrite)
     if (forceWrite)
     {
         for (i = 0, li = gLastFATSectorRead; i < dsk->fatcopy; i++, li += dsk->fatsize)
-            if (!MDD_SectorWrite (gLastFATSectorRead, gFATBuffer, FALSE))
+            if (!FS_SECTOR_WRITE (FS_MEDIA_FAT, gLastFATSectorRead, gFATBuffer, FALSE))
                 return ClusterFailValue;
 
         gNeedFATWrite = FALSE;
@@ -5673,14 +6401,14 @@ DWORD WriteFAT (DISK *dsk, DWORD ccls, DWORD value, BYTE forceWrite)
         if (gNeedFATWrite)
         {
             for (i = 0, li = gLastFATSectorRead; i < dsk->fatcopy; i++, li += dsk->fatsize)
-                if (!MDD_SectorWrite (gLastFATSectorRead, gFATBuffer, FALSE))
+                if (!FS_SECTOR_WRITE (FS_MEDIA_FAT, gLastFATSectorRead, gFATBuffer, FALSE))
                     return ClusterFailValue;
 
             gNeedFATWrite = FALSE;
         }
 
         // Load the new sector
-        if (!MDD_SectorRead (l, gFATBuffer))
+        if (!FS_SECTOR_READ (FS_MEDIA_FAT, l, gFATBuffer))
         {
             gLastFATSectorRead = 0xFFFF;
             return ClusterFailValue;
@@ -5729,7 +6457,7 @@ DWORD WriteFAT (DISK *dsk, DWORD ccls, DWORD value, BYTE forceWrite)
                 if (WriteFAT (dsk, 0,0,TRUE))
                     return ClusterFailValue;
                 // Load the next sector
-                if (!MDD_SectorRead (l +1, gFATBuffer))
+                if (!FS_SECTOR_READ (FS_MEDIA_FAT, l +1, gFATBuffer))
                 {
                     gLastFATSectorRead = 0xFFFF;
                     return ClusterFailValue;
@@ -7310,7 +8038,7 @@ BYTE writeDotEntries (DISK * disk, DWORD dotAddress, DWORD dotdotAddress)
 
     sector = Cluster2Sector (disk, dotAddress);
 
-    if (MDD_SectorWrite(sector, disk->buffer, FALSE) == FALSE)
+    if (FS_SECTOR_WRITE (FS_MEDIA_DIR, sector, disk->buffer, FALSE) == FALSE)
     {
         FSerrno = CE_WRITE_ERROR;
         return FALSE;
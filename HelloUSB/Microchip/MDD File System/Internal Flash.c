@@ -43,6 +43,22 @@
 #include "HardwareProfile.h"
 #include "FSConfig.h"
 
+#if defined(INTERNAL_FLASH_WRITE_CACHE) || defined(INTERNAL_FLASH_WEAR_LEVELING)
+    #define INTERNAL_FLASH_TRANSLATION_LAYER
+
+    #if !defined(__C32__)
+        #error "INTERNAL_FLASH_WRITE_CACHE and INTERNAL_FLASH_WEAR_LEVELING are only supported on PIC32."
+    #endif
+
+    #if (ERASE_BLOCK_SIZE < MEDIA_SECTOR_SIZE)
+        #error "The internal flash translation layer requires ERASE_BLOCK_SIZE to be at least MEDIA_SECTOR_SIZE."
+    #endif
+
+    #if defined(INTERNAL_FLASH_WRITE_PROTECT)
+        #error "INTERNAL_FLASH_WRITE_PROTECT cannot be combined with INTERNAL_FLASH_WRITE_CACHE or INTERNAL_FLASH_WEAR_LEVELING."
+    #endif
+#endif
+
 /*************************************************************************/
 /*  Note:  This file is included as a template of a C file for           */
 /*         a new physical layer. It is designed to go with               */
@@ -70,6 +86,15 @@ BYTE LoadBootSector(DISK *dsk);
 extern void Delayms(BYTE milliseconds);
 BYTE MediaInitialize(void);
 
+#if defined(INTERNAL_FLASH_TRANSLATION_LAYER)
+    static BYTE IntFlashReadSector (DWORD sector_addr, BYTE* buffer);
+    static BYTE IntFlashWriteSector (DWORD sector_addr, BYTE* buffer);
+    static BYTE IntFlashFlushBlock (void);
+    #if defined(INTERNAL_FLASH_WEAR_LEVELING)
+        static BYTE IntFlashLoadBlockMap (void);
+    #endif
+#endif
+
 /******************************************************************************
  * Function:        BYTE MediaDetect(void)
  *
@@ -170,7 +195,11 @@ BYTE MDD_IntFlash_InitIO (void)
  *****************************************************************************/
 BYTE MDD_IntFlash_MediaInitialize(void)
 {
+    #if defined(INTERNAL_FLASH_WEAR_LEVELING)
+        return IntFlashLoadBlockMap();
+    #else
 	return TRUE;
+    #endif
 }//end MediaInitialize
 
 
@@ -200,6 +229,9 @@ BYTE MDD_IntFlash_MediaInitialize(void)
  *****************************************************************************/
 BYTE MDD_IntFlash_SectorRead(DWORD sector_addr, BYTE* buffer)
 {
+    #if defined(INTERNAL_FLASH_TRANSLATION_LAYER)
+        return IntFlashReadSector (sector_addr, buffer);
+    #else
     #if defined(__C30__)
         WORD PSVPageSave;
 
@@ -220,6 +252,7 @@ BYTE MDD_IntFlash_SectorRead(DWORD sector_addr, BYTE* buffer)
     #endif
 
 	return TRUE;
+    #endif
 }//end SectorRead
 
 /******************************************************************************
@@ -267,7 +300,9 @@ ROM BYTE *FileAddress = 0;
 
 BYTE MDD_IntFlash_SectorWrite(DWORD sector_addr, BYTE* buffer, BYTE allowWriteToZero)
 {
-    #if !defined(INTERNAL_FLASH_WRITE_PROTECT)
+    #if defined(INTERNAL_FLASH_TRANSLATION_LAYER)
+        return IntFlashWriteSector (sector_addr, buffer);
+    #elif !defined(INTERNAL_FLASH_WRITE_PROTECT)
         ROM BYTE* dest;
         BOOL foundDifference;
         WORD blockCounter;
@@ -452,6 +487,514 @@ void EraseBlock(ROM BYTE* dest)
 }
 #endif
 
+#if defined(INTERNAL_FLASH_TRANSLATION_LAYER)
+
+// Logical erase blocks are numbered from the erase block that contains the
+// master boot record.  The drive image may start part way into that block
+// when only the write cache is enabled; wear leveling requires it to be aligned.
+#define INTERNAL_FLASH_BLOCK_BASE       ((PTR_SIZE)(MASTER_BOOT_RECORD_ADDRESS) & ~(ERASE_BLOCK_SIZE - 1))
+#define INTERNAL_FLASH_BLOCK_OFFSET     ((PTR_SIZE)(MASTER_BOOT_RECORD_ADDRESS) & (ERASE_BLOCK_SIZE - 1))
+#define INTERNAL_FLASH_NO_BLOCK         0xFFFFFFFF
+
+static DWORD cachedBlock = INTERNAL_FLASH_NO_BLOCK;     // Logical block held in file_buffer
+static BOOL cachedBlockDirty = FALSE;                   // file_buffer differs from flash
+
+#if defined(INTERNAL_FLASH_WEAR_LEVELING)
+
+#define INTERNAL_FLASH_JOURNAL_WORDS    (ERASE_BLOCK_SIZE / 4)
+#define INTERNAL_FLASH_JOURNAL_RECORD(l,p)  (0x80000000ul | ((DWORD)(l) << 16) | (DWORD)(p))
+
+// A drive image that ends part way into its last erase block shares that block
+// with other program memory, so the block is always programmed in place.
+#define INTERNAL_FLASH_PARTIAL_LAST_BLOCK   ((MDD_INTERNAL_FLASH_TOTAL_DISK_SIZE % MDD_INTERNAL_FLASH_SECTORS_PER_BLOCK) != 0)
+
+// The spare blocks and the two journal blocks are reserved by the driver, so the
+// application only reserves the drive image.  The area is reached through a
+// volatile pointer; the compiler must not assume that it still holds its
+// initializer once it has been programmed.
+static ROM BYTE spareArea[(MDD_INTERNAL_FLASH_SPARE_BLOCKS + 2) * ERASE_BLOCK_SIZE] __attribute__ ((aligned (ERASE_BLOCK_SIZE))) = {0};
+static ROM BYTE* volatile spareBlocks = spareArea;
+
+// blockMap[logical] holds the physical erase block (relative to the drive base)
+// that currently stores the logical block.
+static WORD blockMap[MDD_INTERNAL_FLASH_LOGICAL_BLOCKS];
+static WORD lastAllocatedBlock;
+static BOOL blockMapLoaded = FALSE;
+static ROM DWORD* journal = NULL;                       // Active journal block
+static WORD journalIndex;                               // Next free word in the active journal
+static DWORD journalSequence;
+
+#define INTERNAL_FLASH_JOURNAL(n)       ((ROM DWORD*)(spareBlocks + (MDD_INTERNAL_FLASH_SPARE_BLOCKS + (n)) * ERASE_BLOCK_SIZE))
+
+#endif
+
+
+/******************************************************************************
+ * Function:        ROM BYTE* IntFlashPhysicalAddress(DWORD block)
+ *
+ * PreCondition:    None
+ *
+ * Input:           block - Physical erase block number
+ *
+ * Output:          Address of the erase block
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Physical blocks below MDD_INTERNAL_FLASH_LOGICAL_BLOCKS
+ *                  are part of the drive image; the spare blocks follow
+ *                  in the area reserved by the driver.
+ *
+ * Note:            None
+ *****************************************************************************/
+static ROM BYTE* IntFlashPhysicalAddress (DWORD block)
+{
+    #if defined(INTERNAL_FLASH_WEAR_LEVELING)
+        if (block >= MDD_INTERNAL_FLASH_LOGICAL_BLOCKS)
+            return spareBlocks + ((block - MDD_INTERNAL_FLASH_LOGICAL_BLOCKS) * ERASE_BLOCK_SIZE);
+    #endif
+
+    return (ROM BYTE*)(INTERNAL_FLASH_BLOCK_BASE + (block * ERASE_BLOCK_SIZE));
+}
+
+
+/******************************************************************************
+ * Function:        ROM BYTE* IntFlashBlockAddress(DWORD block)
+ *
+ * PreCondition:    The block map has been loaded (wear leveling only)
+ *
+ * Input:           block - Logical erase block number
+ *
+ * Output:          Address of the erase block that holds the logical block
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Translates a logical erase block into a flash address.
+ *
+ * Note:            None
+ *****************************************************************************/
+static ROM BYTE* IntFlashBlockAddress (DWORD block)
+{
+    #if defined(INTERNAL_FLASH_WEAR_LEVELING)
+        block = blockMap[block];
+    #endif
+
+    return IntFlashPhysicalAddress (block);
+}
+
+
+/******************************************************************************
+ * Function:        void IntFlashProgramBlock(ROM BYTE* dest)
+ *
+ * PreCondition:    file_buffer contains the data for the erase block
+ *
+ * Input:           dest - Start of the erase block to program
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Erases the block at dest and programs the contents of
+ *                  file_buffer into it.  Words that are still in the erased
+ *                  state are skipped.
+ *
+ * Note:            None
+ *****************************************************************************/
+static void IntFlashProgramBlock (ROM BYTE* dest)
+{
+    WORD i;
+    DWORD word;
+
+    EraseBlock (dest);
+
+    for (i = 0; i < ERASE_BLOCK_SIZE; i += 4)
+    {
+        word = *((DWORD*)&file_buffer[i]);
+        if (word != 0xFFFFFFFF)
+        {
+            NVMWriteWord ((DWORD*)KVA_TO_PA(FileAddress), word);
+        }
+        FileAddress += 4;
+    }
+}
+
+
+#if defined(INTERNAL_FLASH_WEAR_LEVELING)
+
+/******************************************************************************
+ * Function:        void IntFlashCompactJournal(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    The inactive journal block is erased and becomes active
+ *
+ * Overview:        Writes every remapped logical block into the inactive
+ *                  journal block.  The sequence number is written last, so
+ *                  the previous journal stays valid until the new one is
+ *                  complete.
+ *
+ * Note:            None
+ *****************************************************************************/
+static void IntFlashCompactJournal (void)
+{
+    ROM DWORD* next;
+    WORD i;
+    WORD index;
+
+    next = (journal == INTERNAL_FLASH_JOURNAL(0)) ? INTERNAL_FLASH_JOURNAL(1) : INTERNAL_FLASH_JOURNAL(0);
+
+    EraseBlock ((ROM BYTE*)next);
+
+    index = 1;
+    for (i = 0; i < MDD_INTERNAL_FLASH_LOGICAL_BLOCKS; i++)
+    {
+        if (blockMap[i] != i)
+        {
+            NVMWriteWord ((DWORD*)KVA_TO_PA(&next[index]), INTERNAL_FLASH_JOURNAL_RECORD(i, blockMap[i]));
+            index++;
+        }
+    }
+
+    journalSequence++;
+    if ((journalSequence == 0) || (journalSequence == 0xFFFFFFFF))
+        journalSequence = 1;
+
+    NVMWriteWord ((DWORD*)KVA_TO_PA(&next[0]), journalSequence);
+
+    journal = next;
+    journalIndex = index;
+}
+
+
+/******************************************************************************
+ * Function:        BYTE IntFlashLoadBlockMap(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          TRUE  - The block map was rebuilt
+ *                  FALSE - The drive image is not aligned to an erase block
+ *
+ * Side Effects:    Discards any cached block
+ *
+ * Overview:        Rebuilds the logical to physical block map by replaying
+ *                  the journal with the highest valid sequence number.
+ *                  Logical blocks without a journal record map to the
+ *                  physical block with the same number.  New records are
+ *                  appended at the first erased word of the journal.
+ *
+ * Note:            None
+ *****************************************************************************/
+static BYTE IntFlashLoadBlockMap (void)
+{
+    ROM DWORD* j0 = INTERNAL_FLASH_JOURNAL(0);
+    ROM DWORD* j1 = INTERNAL_FLASH_JOURNAL(1);
+    BOOL valid0, valid1;
+    DWORD record;
+    WORD logical, physical;
+    WORD i;
+
+    if (INTERNAL_FLASH_BLOCK_OFFSET != 0)
+        return FALSE;
+
+    for (i = 0; i < MDD_INTERNAL_FLASH_LOGICAL_BLOCKS; i++)
+        blockMap[i] = i;
+
+    lastAllocatedBlock = MDD_INTERNAL_FLASH_LOGICAL_BLOCKS - 1;
+    cachedBlock = INTERNAL_FLASH_NO_BLOCK;
+    cachedBlockDirty = FALSE;
+
+    valid0 = (j0[0] != 0) && (j0[0] != 0xFFFFFFFF);
+    valid1 = (j1[0] != 0) && (j1[0] != 0xFFFFFFFF);
+
+    journal = NULL;
+    journalSequence = 0;
+    journalIndex = INTERNAL_FLASH_JOURNAL_WORDS;
+
+    if (valid0 && (!valid1 || ((LONG)(j0[0] - j1[0]) > 0)))
+        journal = j0;
+    else if (valid1)
+        journal = j1;
+
+    if (journal != NULL)
+    {
+        journalSequence = journal[0];
+
+        for (journalIndex = 1; journalIndex < INTERNAL_FLASH_JOURNAL_WORDS; journalIndex++)
+        {
+            // An erased word ends the journal.  Records always have bit 31
+            // set; a word without it was not completely programmed.
+            record = journal[journalIndex];
+            if (record == 0xFFFFFFFF)
+                break;
+
+            logical = (WORD)((record >> 16) & 0x7FFF);
+            physical = (WORD)record;
+            if ((record & 0x80000000ul) && (logical < MDD_INTERNAL_FLASH_LOGICAL_BLOCKS) && (physical < MDD_INTERNAL_FLASH_PHYSICAL_BLOCKS))
+            {
+                blockMap[logical] = physical;
+                lastAllocatedBlock = physical;
+            }
+        }
+    }
+
+    blockMapLoaded = TRUE;
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * Function:        WORD IntFlashNextFreeBlock(void)
+ *
+ * PreCondition:    The block map has been loaded
+ *
+ * Input:           None
+ *
+ * Output:          Physical block that no logical block maps to
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Searches round-robin from the last allocated block so
+ *                  that erases are spread over all physical blocks.
+ *
+ * Note:            There are always MDD_INTERNAL_FLASH_SPARE_BLOCKS free blocks.
+ *****************************************************************************/
+static WORD IntFlashNextFreeBlock (void)
+{
+    WORD candidate = lastAllocatedBlock;
+    WORD i;
+
+    for (;;)
+    {
+        if (++candidate >= MDD_INTERNAL_FLASH_PHYSICAL_BLOCKS)
+            candidate = 0;
+
+        for (i = 0; i < MDD_INTERNAL_FLASH_LOGICAL_BLOCKS; i++)
+        {
+            if (blockMap[i] == candidate)
+                break;
+        }
+
+        if (i == MDD_INTERNAL_FLASH_LOGICAL_BLOCKS)
+            return candidate;
+    }
+}
+
+#endif
+
+
+/******************************************************************************
+ * Function:        BYTE IntFlashFlushBlock(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          TRUE  - The cached block is clean
+ *                  FALSE - The block could not be programmed
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Programs the cached erase block if it has been modified.
+ *                  With wear leveling the data is programmed into a free
+ *                  physical block and the remap is recorded in the journal
+ *                  afterwards, so a reset during the write leaves the old
+ *                  copy of the block in use.  A last block that the drive
+ *                  image only partly fills is programmed in place.
+ *
+ * Note:            None
+ *****************************************************************************/
+static BYTE IntFlashFlushBlock (void)
+{
+    ROM BYTE* dest;
+
+    if (cachedBlockDirty == FALSE)
+        return TRUE;
+
+    #if defined(INTERNAL_FLASH_WEAR_LEVELING)
+    if (INTERNAL_FLASH_PARTIAL_LAST_BLOCK && (cachedBlock == MDD_INTERNAL_FLASH_LOGICAL_BLOCKS - 1))
+    {
+        // The rest of the block is not part of the drive image; keep it in place
+        dest = IntFlashBlockAddress (cachedBlock);
+        IntFlashProgramBlock (dest);
+
+        if (memcmp ((void*)dest, (void*)file_buffer, ERASE_BLOCK_SIZE) != 0)
+            return FALSE;
+    }
+    else
+    {
+        WORD physical = IntFlashNextFreeBlock();
+
+        dest = IntFlashPhysicalAddress (physical);
+        IntFlashProgramBlock (dest);
+
+        if (memcmp ((void*)dest, (void*)file_buffer, ERASE_BLOCK_SIZE) != 0)
+            return FALSE;
+
+        blockMap[cachedBlock] = physical;
+        lastAllocatedBlock = physical;
+
+        if ((journal == NULL) || (journalIndex >= INTERNAL_FLASH_JOURNAL_WORDS))
+        {
+            IntFlashCompactJournal();
+        }
+        else
+        {
+            NVMWriteWord ((DWORD*)KVA_TO_PA(&journal[journalIndex]), INTERNAL_FLASH_JOURNAL_RECORD(cachedBlock, physical));
+            journalIndex++;
+        }
+    }
+    #else
+        dest = IntFlashBlockAddress (cachedBlock);
+        IntFlashProgramBlock (dest);
+
+        if (memcmp ((void*)dest, (void*)file_buffer, ERASE_BLOCK_SIZE) != 0)
+            return FALSE;
+    #endif
+
+    cachedBlockDirty = FALSE;
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * Function:        BYTE IntFlashReadSector(DWORD sector_addr, BYTE* buffer)
+ *
+ * PreCondition:    None
+ *
+ * Input:           sector_addr - Sector address
+ *                  buffer      - Buffer where data will be stored
+ *
+ * Output:          Returns TRUE if read successful, FALSE otherwise
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Reads a sector through the translation layer.  Sectors
+ *                  in the cached erase block are returned from RAM.
+ *
+ * Note:            None
+ *****************************************************************************/
+static BYTE IntFlashReadSector (DWORD sector_addr, BYTE* buffer)
+{
+    DWORD offset;
+    DWORD block;
+
+    #if defined(INTERNAL_FLASH_WEAR_LEVELING)
+        if ((blockMapLoaded == FALSE) && (IntFlashLoadBlockMap() == FALSE))
+            return FALSE;
+    #endif
+
+    offset = INTERNAL_FLASH_BLOCK_OFFSET + (sector_addr * MEDIA_SECTOR_SIZE);
+    block = offset / ERASE_BLOCK_SIZE;
+    offset &= (ERASE_BLOCK_SIZE - 1);
+
+    if (block == cachedBlock)
+        memcpy ((void*)buffer, (void*)&file_buffer[offset], MEDIA_SECTOR_SIZE);
+    else
+        memcpypgm2ram ((void*)buffer, (ROM void*)(IntFlashBlockAddress (block) + offset), MEDIA_SECTOR_SIZE);
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * Function:        BYTE IntFlashWriteSector(DWORD sector_addr, BYTE* buffer)
+ *
+ * PreCondition:    None
+ *
+ * Input:           sector_addr - Sector address
+ *                  buffer      - Buffer where data will be read
+ *
+ * Output:          Returns TRUE if write successful, FALSE otherwise
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Merges the sector into the cached erase block.  The block
+ *                  is only erased and programmed when a sector in another
+ *                  block is written or MDD_IntFlash_FlushCache is called, so
+ *                  consecutive writes to one erase block cost a single erase.
+ *                  Without INTERNAL_FLASH_WRITE_CACHE the block is programmed
+ *                  before returning.
+ *
+ * Note:            None
+ *****************************************************************************/
+static BYTE IntFlashWriteSector (DWORD sector_addr, BYTE* buffer)
+{
+    DWORD offset;
+    DWORD block;
+
+    #if defined(INTERNAL_FLASH_WEAR_LEVELING)
+        if ((blockMapLoaded == FALSE) && (IntFlashLoadBlockMap() == FALSE))
+            return FALSE;
+    #endif
+
+    offset = INTERNAL_FLASH_BLOCK_OFFSET + (sector_addr * MEDIA_SECTOR_SIZE);
+    block = offset / ERASE_BLOCK_SIZE;
+    offset &= (ERASE_BLOCK_SIZE - 1);
+
+    if (block != cachedBlock)
+    {
+        if (IntFlashFlushBlock() == FALSE)
+            return FALSE;
+
+        // A sector that already holds the data does not need to load the block
+        if (memcmp ((void*)(IntFlashBlockAddress (block) + offset), (void*)buffer, MEDIA_SECTOR_SIZE) == 0)
+            return TRUE;
+
+        memcpypgm2ram ((void*)file_buffer, (ROM void*)IntFlashBlockAddress (block), ERASE_BLOCK_SIZE);
+        cachedBlock = block;
+    }
+
+    if (memcmp ((void*)&file_buffer[offset], (void*)buffer, MEDIA_SECTOR_SIZE) != 0)
+    {
+        memcpy ((void*)&file_buffer[offset], (void*)buffer, MEDIA_SECTOR_SIZE);
+        cachedBlockDirty = TRUE;
+    }
+
+    #if defined(INTERNAL_FLASH_WRITE_CACHE)
+        return TRUE;
+    #else
+        return IntFlashFlushBlock();
+    #endif
+}
+
+#endif
+
+
+/******************************************************************************
+ * Function:        BYTE MDD_IntFlash_FlushCache(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Returns TRUE if all written sectors are in flash,
+ *                  FALSE otherwise
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Programs the erase block held by the write cache.  When
+ *                  INTERNAL_FLASH_WRITE_CACHE is enabled, call this before
+ *                  a reset or power down.  FSflush calls it through
+ *                  MDD_FlushCache, and the USB MSD device driver calls it
+ *                  after every WRITE(10) command when it is set as the
+ *                  FlushCache member of the LUN_FUNCTIONS entry.
+ *
+ * Note:            None
+ *****************************************************************************/
+BYTE MDD_IntFlash_FlushCache(void)
+{
+    #if defined(INTERNAL_FLASH_TRANSLATION_LAYER)
+        return IntFlashFlushBlock();
+    #else
+        return TRUE;
+    #endif
+}
+
 /******************************************************************************
  * Function:        BYTE WriteProtectState(void)
  *
@@ -0,0 +1,257 @@
+/*****************************************************************************
+ *  Frame buffer benchmark of typical GOL screens
+ *****************************************************************************
+ * FileName:        FramebufferBenchmark.c
+ * Dependencies:    Graphics.h, Framebuffer.c
+ * Processor:       host PC
+ * Compiler:        GCC
+ * Company:         Microchip Technology Incorporated
+ *
+ * Draws a few typical GOL screens with the frame buffer driver and prints
+ * for each of them the driver calls and pixels of one frame, taken from
+ * the USE_FRAMEBUFFER_STATISTICS counters, and the pixel rate of the host.
+ * The "widgets" screen is the one the driver call numbers of the HLine
+ * primitive were measured on. Build from the Microchip directory with the
+ * GraphicsConfig.h of this directory:
+ *
+ *   gcc -O2 -I"Tests/Graphics" -IInclude -I"Include/Graphics" -o FramebufferBenchmark
+ *       "Tests/Graphics/FramebufferBenchmark.c" Graphics/Drivers/Framebuffer.c
+ *       Graphics/Primitive.c Graphics/GOL.c Graphics/GOLFontDefault.c
+ *       Graphics/Button.c Graphics/Window.c Graphics/StaticText.c
+ *       Graphics/Slider.c Graphics/CheckBox.c Graphics/ProgressBar.c
+ *       Graphics/Meter.c Graphics/RoundDial.c Graphics/Picture.c
+ *       Graphics/EditBox.c Graphics/ListBox.c Graphics/Chart.c
+ *
+ * Add -DFRAMEBUFFER_GENERIC_PRIMITIVES=1 to draw bars, images and pixel
+ * rows with the primitives layer like a driver without them, or 2 to draw
+ * everything with PutPixel. The sources include "Graphics\...", on hosts
+ * that do not take '\' as a path separator these names must be made
+ * available on the include path (for example as links).
+ *
+ * Usage: FramebufferBenchmark [PPM file prefix]
+ * With a prefix every screen is also written to <prefix><screen>.ppm.
+ *****************************************************************************/
+#include "Graphics\Graphics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Number of times each screen is drawn for the timing
+#define BENCHMARK_FRAMES    1000
+
+// 8 bits per pixel test bitmap: compression, depth, height, width, palette, data
+#define IMAGE_WIDTH         64
+#define IMAGE_HEIGHT        50
+static BYTE         _image[6 + 256*2 + IMAGE_WIDTH*IMAGE_HEIGHT];
+static BITMAP_FLASH _bitmap;
+
+static WORD         _series[40];
+
+// Style scheme of all objects, chart of the current screen
+static GOL_SCHEME*  _pScheme;
+static CHART*       _pChart;
+
+/*********************************************************************
+* Function: void MakeImage(void)
+*
+* Overview: fills the test bitmap with a pattern
+*
+********************************************************************/
+void MakeImage(void){
+BYTE* pData = _image;
+WORD  counter;
+
+    pData[0] = 0;
+    pData[1] = 8;
+    ((WORD*)pData)[1] = IMAGE_HEIGHT;
+    ((WORD*)pData)[2] = IMAGE_WIDTH;
+    pData += 6;
+    for(counter=0; counter<256; counter++)
+        ((WORD*)pData)[counter] = (WORD)((counter*2654435761u)>>7);
+    pData += 256*2;
+    for(counter=0; counter<IMAGE_WIDTH*IMAGE_HEIGHT; counter++)
+        pData[counter] = (BYTE)(counter*131 + 2*7 + (counter>>5));
+    _bitmap.type = FLASH;
+    _bitmap.address = _image;
+}
+
+/*********************************************************************
+* Functions: screens
+*
+* Overview: create the objects of one screen
+*
+********************************************************************/
+// Buttons, slider, progress bar, check box, static text, meter, dial
+// and picture in a window
+void ScreenWidgets(void){
+GOL_SCHEME* pScheme = _pScheme;
+
+    WndCreate(1,0,0,GetMaxX(),GetMaxY(),WND_DRAW,NULL,(XCHAR*)"Window",pScheme);
+    BtnCreate(2,10,30,100,70,8,BTN_DRAW,NULL,(XCHAR*)"Button",pScheme);
+    BtnCreate(3,110,30,200,70,0,BTN_DRAW|BTN_PRESSED,NULL,(XCHAR*)"Pressed",pScheme);
+    SldCreate(4,10,80,200,100,SLD_DRAW,100,10,40,pScheme);
+    PbCreate(5,10,110,200,130,PB_DRAW,60,100,pScheme);
+    CbCreate(6,210,30,310,50,CB_DRAW|CB_CHECKED,(XCHAR*)"Check",pScheme);
+    StCreate(7,210,60,310,80,ST_DRAW|ST_FRAME,(XCHAR*)"Static",pScheme);
+    MtrCreate(8,200,85,319,239,MTR_DRAW,50,100,(XCHAR*)"Mtr",pScheme);
+    RdiaCreate(9,60,190,40,RDIA_DRAW,1,50,100,pScheme);
+    PictCreate(10,110,140,200,230,PICT_DRAW,1,&_bitmap,pScheme);
+}
+
+// Text entry form with an edit box and a list box
+void ScreenForm(void){
+GOL_SCHEME* pScheme = _pScheme;
+
+    WndCreate(1,0,0,GetMaxX(),GetMaxY(),WND_DRAW,NULL,(XCHAR*)"Form",pScheme);
+    StCreate(2,10,30,150,55,ST_DRAW|ST_FRAME,(XCHAR*)"Name",pScheme);
+    EbCreate(3,160,30,310,55,EB_DRAW,(XCHAR*)"Edit text",20,pScheme);
+    LbCreate(4,10,65,150,230,LB_DRAW,(XCHAR*)"One\nTwo\nThree\nFour\nFive",pScheme);
+    CbCreate(5,160,65,310,90,CB_DRAW|CB_CHECKED,(XCHAR*)"Option",pScheme);
+    BtnCreate(6,160,190,230,230,8,BTN_DRAW,NULL,(XCHAR*)"OK",pScheme);
+    BtnCreate(7,240,190,310,230,8,BTN_DRAW,NULL,(XCHAR*)"Cancel",pScheme);
+}
+
+// Full screen pie chart
+void ScreenPie(void){
+CHART* pChart;
+
+    pChart = _pChart = ChCreate(1,0,0,GetMaxX(),GetMaxY(),CH_DRAW|CH_PIE|CH_VALUE,NULL,NULL,_pScheme);
+    ChAddDataSeries(pChart,8,_series,(XCHAR*)"S1");
+    ChShowSeries(pChart,0);
+    pChart->prm.pTitle = (XCHAR*)"Title";
+    pChart->prm.pSmplLabel = (XCHAR*)"Smp";
+    pChart->prm.pValLabel = (XCHAR*)"Val";
+    ChSetSampleRange(pChart,1,8);
+    ChSetValueRange(pChart,0,60);
+}
+
+// Full screen bar chart
+void ScreenBar(void){
+CHART* pChart;
+
+    pChart = _pChart = ChCreate(1,0,0,GetMaxX(),GetMaxY(),CH_DRAW|CH_BAR|CH_VALUE,NULL,NULL,_pScheme);
+    ChAddDataSeries(pChart,12,_series,(XCHAR*)"S2");
+    ChShowSeries(pChart,0);
+    pChart->prm.pTitle = (XCHAR*)"Title";
+    pChart->prm.pSmplLabel = (XCHAR*)"Smp";
+    pChart->prm.pValLabel = (XCHAR*)"Val";
+    ChSetSampleRange(pChart,1,12);
+    ChSetValueRange(pChart,0,60);
+}
+
+typedef struct {
+    const char* name;
+    void        (*create)(void);
+} SCREEN;
+
+static const SCREEN _screens[] = {
+    {"widgets", ScreenWidgets},
+    {"form",    ScreenForm},
+    {"pie",     ScreenPie},
+    {"bar",     ScreenBar},
+};
+
+/*********************************************************************
+* Function: void FreeScreen(void)
+*
+* Overview: frees the objects of the current screen, GOLFree() does
+*           not free the data series of a chart
+*
+********************************************************************/
+void FreeScreen(void){
+    if(_pChart != NULL){
+        ChRemoveDataSeries(_pChart,0);
+        _pChart = NULL;
+    }
+    GOLFree();
+}
+
+/*********************************************************************
+* Function: clock_t DrawScreen(const SCREEN* pScreen)
+*
+* Output: processor time of the drawing
+*
+* Overview: clears the screen, creates the objects and draws them.
+*           The statistics and the time count only the drawing of
+*           the objects.
+*
+********************************************************************/
+clock_t DrawScreen(const SCREEN* pScreen){
+clock_t start;
+
+    FreeScreen();
+    SetColor(BLACK);
+    ClearDevice();
+    FramebufferResetStats();
+    pScreen->create();
+    start = clock();
+    while(!GOLDraw());
+    return clock() - start;
+}
+
+WORD GOLMsgCallback(WORD objMsg, OBJ_HEADER* pObj, GOL_MSG* pMsg){
+    return 1;
+}
+
+WORD GOLDrawCallback(void){
+    return 1;
+}
+
+int main(int argc, char** argv){
+const SCREEN*     pScreen;
+FRAMEBUFFER_STATS stats;
+DWORD             calls;
+clock_t           ticks;
+double            seconds;
+WORD              counter;
+char              fileName[256];
+
+    ResetDevice();
+    GOLInit();
+    _pScheme = GOLCreateScheme();
+    MakeImage();
+    for(counter=0; counter<sizeof(_series)/sizeof(_series[0]); counter++)
+        _series[counter] = (counter*37)%50 + 5;
+
+#if !defined(FRAMEBUFFER_GENERIC_PRIMITIVES)
+    printf("Frame buffer driver with Bar, HLine, ClearDevice, PutImage and PutPixelRow\n");
+#elif (FRAMEBUFFER_GENERIC_PRIMITIVES < 2)
+    printf("Frame buffer driver with HLine only (FRAMEBUFFER_GENERIC_PRIMITIVES=1)\n");
+#else
+    printf("Frame buffer driver with PutPixel only (FRAMEBUFFER_GENERIC_PRIMITIVES=2)\n");
+#endif
+    printf("%-8s %8s %8s %8s %6s %6s %6s %6s %6s %8s %9s %9s\n", "screen", "calls", "putPixel",
+           "getPixel", "row", "bar", "hLine", "clear", "image", "pixels", "ms/frame", "Mpixels/s");
+
+    for(pScreen=_screens; pScreen<_screens+sizeof(_screens)/sizeof(_screens[0]); pScreen++){
+
+        // Driver calls and pixels of one frame
+        DrawScreen(pScreen);
+        FramebufferGetStats(&stats);
+        calls = stats.putPixel + stats.getPixel + stats.putPixelRow + stats.bar +
+                stats.hLine + stats.clearDevice + stats.putImage;
+
+        if(argc > 1){
+            sprintf(fileName, "%.240s%s.ppm", argv[1], pScreen->name);
+            if(!FramebufferDumpPPM(fileName))
+                printf("cannot write %s\n", fileName);
+        }
+
+        // Time of a frame, the objects are created again for each one
+        ticks = 0;
+        for(counter=0; counter<BENCHMARK_FRAMES; counter++)
+            ticks += DrawScreen(pScreen);
+        seconds = (double)ticks / CLOCKS_PER_SEC / BENCHMARK_FRAMES;
+
+        printf("%-8s %8lu %8lu %8lu %6lu %6lu %6lu %6lu %6lu %8lu %9.3f %9.1f\n", pScreen->name,
+               (unsigned long)calls, (unsigned long)stats.putPixel, (unsigned long)stats.getPixel,
+               (unsigned long)stats.putPixelRow, (unsigned long)stats.bar, (unsigned long)stats.hLine,
+               (unsigned long)stats.clearDevice, (unsigned long)stats.putImage, (unsigned long)stats.pixels,
+               seconds*1e3, (seconds > 0)? stats.pixels/seconds/1e6: 0.0);
+    }
+
+    FreeScreen();
+    free(_pScheme);
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*****************************************************************************
+ * Graphics library configuration of the frame buffer benchmark
+ *****************************************************************************
+ * FileName:        GraphicsConfig.h
+ * Dependencies:    Framebuffer.h
+ * Processor:       host PC
+ * Compiler:        GCC
+ * Company:         Microchip Technology Incorporated
+ *****************************************************************************/
+
+#ifndef _GRAPHICSCONFIG_H
+#define _GRAPHICSCONFIG_H
+
+//////////////////// GRAPHICS OBJECTS LAYER ////////////////////
+#define USE_GOL
+#define USE_BUTTON
+#define USE_WINDOW
+#define USE_STATICTEXT
+#define USE_SLIDER
+#define USE_CHECKBOX
+#define USE_PROGRESSBAR
+#define USE_METER
+#define USE_ROUNDDIAL
+#define USE_PICTURE
+#define USE_EDITBOX
+#define USE_LISTBOX
+#define USE_CHART
+
+//////////////////// BITMAPS AND FONTS ////////////////////
+#define USE_BITMAP_FLASH
+#define USE_FONT_FLASH
+
+//////////////////// COLOR DEPTH ////////////////////
+#define COLOR_DEPTH 16
+
+//////////////////// DEFAULT SCHEME COLORS ////////////////////
+#define GRAPHICS_PICTAIL_VERSION 2
+
+//////////////////// FRAME BUFFER DRIVER ////////////////////
+// Counters and PPM dumps used by the benchmark. Build with
+// -DFRAMEBUFFER_GENERIC_PRIMITIVES=1 or 2 to measure drivers without
+// Bar/PutImage or without HLine.
+#define USE_FRAMEBUFFER_STATISTICS
+#define USE_FRAMEBUFFER_DUMP
+
+#include "Framebuffer.h"
+
+#endif // _GRAPHICSCONFIG_H
@@ -0,0 +1,177 @@
+/******************************************************************************
+
+* FileName:        IdctTest.c
+* Dependencies:    jidctfst.c, jidctint.c
+* Processor:       Host PC
+* Compiler:        Any C99 compiler
+* Company:         Microchip Technology, Inc.
+
+ * Software License Agreement
+ *
+ * Copyright  2008 Microchip Technology Inc.  All rights reserved.
+ * Microchip licenses to you the right to use, modify, copy and distribute
+ * Software only when embedded on a Microchip microcontroller or digital
+ * signal controller, which is integrated into your product or third party
+ * product (pursuant to the sublicense terms in the accompanying license
+ * agreement).
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED AS IS WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+
+Compares the fast inverse DCT (jpeg_idct_ifast, JPEG_USE_FAST_IDCT) with the
+accurate one (jpeg_idct_islow) on random, DC only and sparse coefficient
+blocks, and checks that the shorter paths for DC only and upper left 4x4
+blocks give the same result as the full one. Build and run on the host from
+the Microchip directory:
+
+    gcc -IInclude -o IdctTest "Tests/Image Decoders/IdctTest.c"
+        "Image Decoders/jidctfst.c" "Image Decoders/jidctint.c"
+    ./IdctTest
+
+The program prints the largest difference of each block kind and returns a
+non-zero exit code when a difference exceeds IDCT_MAX_DIFFERENCE.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "GenericTypeDefs.h"
+
+void jpeg_idct_islow (SHORT *inbuf, WORD *quantptr);
+void jpeg_idct_ifast (SHORT *inbuf, WORD *quantptr, BYTE lastcoef);
+void jpeg_idct_ifast_scale_quant (WORD *quantptr);
+
+#define IDCT_MAX_DIFFERENCE   1       /* Largest difference allowed per sample */
+#define IDCT_BLOCKS           100000  /* Blocks tested of each kind */
+
+#define IDCT_RANDOM           0       /* All 64 coefficients may be set */
+#define IDCT_DC_ONLY          1       /* Only the DC coefficient is set */
+#define IDCT_SPARSE           2       /* A few low frequency coefficients are set */
+
+static const BYTE abZigzag[64] =
+{
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+static const char *apszKind[3] = { "random", "DC only", "sparse" };
+
+static DWORD dwSeed = 1;
+
+/*******************************************************************************
+Function:       WORD wRandom(WORD wRange)
+
+Overview:       Returns a pseudo random number in 0..wRange-1, the same
+                sequence on every host
+
+Input:          Range
+
+Output:         Random number
+*******************************************************************************/
+static WORD wRandom(WORD wRange)
+{
+     dwSeed = dwSeed * 1103515245UL + 12345UL;
+     return (WORD)(((dwSeed >> 16) & 0x7FFF) % wRange);
+}
+
+/*******************************************************************************
+Function:       BYTE bMakeBlock(BYTE bKind, SHORT *psCoef, WORD *pwQuant)
+
+Overview:       Fills a quantization table and a block of coefficients of
+                the given kind. The coefficients are limited so that the
+                dequantized values stay in the range of baseline JPEG files.
+
+Input:          Kind of block, coefficient and quantization table buffers
+
+Output:         Zigzag index of the last coefficient that may be non-zero
+*******************************************************************************/
+static BYTE bMakeBlock(BYTE bKind, SHORT *psCoef, WORD *pwQuant)
+{
+     BYTE bQuality = (BYTE)wRandom(4);
+     BYTE bLast, bCounter;
+     WORD wAmplitude;
+
+     for(bCounter = 0; bCounter < 64; bCounter++)
+     {
+          /* Quality 100 tables hold ones, low quality tables large values */
+          pwQuant[bCounter] = (bQuality == 0)? 1 + wRandom(3):
+                              (bQuality == 1)? 2 + wRandom(20):
+                              (bQuality == 2)? 10 + wRandom(100): 50 + wRandom(206);
+     }
+
+     memset(psCoef, 0, 64 * sizeof(SHORT));
+     bLast = (bKind == IDCT_DC_ONLY)? 0: (bKind == IDCT_SPARSE)? (BYTE)wRandom(10): 63;
+     for(bCounter = 0; bCounter <= bLast; bCounter++)
+     {
+          if(bCounter == 0 || bKind == IDCT_RANDOM || wRandom(3) == 0)
+          {
+               wAmplitude = 1024 / (1 + bCounter) / pwQuant[abZigzag[bCounter]] + 1;
+               psCoef[abZigzag[bCounter]] = (SHORT)wRandom(2 * wAmplitude + 1) - (SHORT)wAmplitude;
+          }
+     }
+     return bLast;
+}
+
+int main(void)
+{
+     SHORT asExact[64], asFast[64], asFull[64];
+     WORD awQuant[64], awScaled[64];
+     BYTE bKind, bLast, bCounter;
+     WORD wMaxDiff, wDiff;
+     DWORD dwBlock, dwMismatch;
+     int iFailed = 0;
+
+     for(bKind = IDCT_RANDOM; bKind <= IDCT_SPARSE; bKind++)
+     {
+          wMaxDiff = 0;
+          dwMismatch = 0;
+          for(dwBlock = 0; dwBlock < IDCT_BLOCKS; dwBlock++)
+          {
+               bLast = bMakeBlock(bKind, asExact, awQuant);
+               memcpy(asFast, asExact, sizeof(asExact));
+               memcpy(asFull, asExact, sizeof(asExact));
+               memcpy(awScaled, awQuant, sizeof(awQuant));
+               jpeg_idct_ifast_scale_quant(awScaled);
+
+               jpeg_idct_islow(asExact, awQuant);
+               jpeg_idct_ifast(asFast, awScaled, bLast);
+               jpeg_idct_ifast(asFull, awScaled, 63);
+
+               for(bCounter = 0; bCounter < 64; bCounter++)
+               {
+                    wDiff = (WORD)((asFast[bCounter] > asExact[bCounter])? asFast[bCounter] - asExact[bCounter]: asExact[bCounter] - asFast[bCounter]);
+                    if(wDiff > wMaxDiff)
+                    {
+                         wMaxDiff = wDiff;
+                    }
+                    if(asFast[bCounter] != asFull[bCounter])
+                    {
+                         dwMismatch++;
+                    }
+               }
+          }
+
+          printf("%-8s blocks: max difference %u, short path mismatches %lu\n",
+                 apszKind[bKind], wMaxDiff, (unsigned long)dwMismatch);
+          if(wMaxDiff > IDCT_MAX_DIFFERENCE || dwMismatch != 0)
+          {
+               iFailed = 1;
+          }
+     }
+
+     printf(iFailed? "FAILED\n": "PASSED\n");
+     return iFailed;
+}
@@ -0,0 +1,15 @@
+/******************************************************************************
+ File system configuration of the internal flash journal test
+*******************************************************************************/
+
+#ifndef _FS_DEF_
+#define _FS_DEF_
+
+#include "HardwareProfile.h"
+
+#define FS_MAX_FILES_OPEN   4
+#define MEDIA_SECTOR_SIZE   512
+#define ALLOW_WRITES
+#define USERDEFINEDCLOCK
+
+#endif
@@ -0,0 +1,16 @@
+/******************************************************************************
+ Hardware profile of the internal flash journal test
+
+ The drive image is placed at a PIC32 program flash address; the test maps
+ memory at this address on the host.
+*******************************************************************************/
+
+#ifndef _HARDWAREPROFILE_H
+#define _HARDWAREPROFILE_H
+
+#define ERASE_BLOCK_SIZE                4096
+#define WRITE_BLOCK_SIZE                512
+#define MASTER_BOOT_RECORD_ADDRESS      ((BYTE*)0x1D010000)
+#define MDD_INTERNAL_FLASH_DRIVE_CAPACITY   60
+
+#endif
@@ -0,0 +1,280 @@
+/******************************************************************************
+
+* FileName:        IntFlashJournalTest.c
+* Dependencies:    Internal Flash.c
+* Processor:       Host PC (Linux)
+* Compiler:        GCC
+* Company:         Microchip Technology, Inc.
+
+ * Software License Agreement
+ *
+ * Copyright  2008 Microchip Technology Inc.  All rights reserved.
+ * Microchip licenses to you the right to use, modify, copy and distribute
+ * Software only when embedded on a Microchip microcontroller or digital
+ * signal controller, which is integrated into your product or third party
+ * product (pursuant to the sublicense terms in the accompanying license
+ * agreement).
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED AS IS WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+
+Tests the wear leveling journal of the internal flash driver on a host with
+flash emulated in RAM (see plib.h of this directory):
+
+- Random sector writes with a remount every 1000 writes must read back the
+  data last written, and must not touch the program memory that shares the
+  last erase block with the drive image.
+- After a remount, new journal records must be appended to the journal that
+  was found. A write that remaps one block then costs one erase, and the
+  journal block is only erased again when it is full.
+
+The driver needs the 32-bit DWORD of the PIC32, so the test is built as a
+32-bit program. Build and run from the Microchip directory, with and without
+-DINTERNAL_FLASH_WRITE_CACHE:
+
+    gcc -m32 -no-pie -D__C32__ -D__PIC32MX__ -DINTERNAL_FLASH_WEAR_LEVELING
+        -I"Tests/MDD File System" -IInclude -o IntFlashJournalTest
+        "Tests/MDD File System/IntFlashJournalTest.c"
+        "MDD File System/Internal Flash.c"
+    ./IntFlashJournalTest
+
+The driver includes "MDD File System\...", on hosts that do not take '\' as
+a path separator these names must be made available on the include path
+(for example as links). The driver keeps its spare and journal blocks in a
+constant array, so the test makes the read-only data of the program
+writable. The program returns a non-zero exit code when a check fails.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "GenericTypeDefs.h"
+#include "HardwareProfile.h"
+#include "FSconfig.h"
+#include "MDD File System\internal flash.h"
+
+BYTE MDD_IntFlash_MediaInitialize (void);
+BYTE MDD_IntFlash_SectorRead (DWORD sector_addr, BYTE* buffer);
+BYTE MDD_IntFlash_SectorWrite (DWORD sector_addr, BYTE* buffer, BYTE allowWriteToZero);
+BYTE MDD_IntFlash_FlushCache (void);
+
+#define TEST_SECTORS          MDD_INTERNAL_FLASH_TOTAL_DISK_SIZE
+#define TEST_FLASH_SIZE       (16 * ERASE_BLOCK_SIZE)   /* Mapped at MASTER_BOOT_RECORD_ADDRESS */
+#define TEST_RANDOM_WRITES    20000
+#define TEST_REMOUNTS         300
+
+/* Journal records and programmed words are 32 bits wide */
+typedef char DWORD_MUST_HAVE_32_BITS[(sizeof(DWORD) == 4)? 1: -1];
+
+DWORD dwWordsProgrammed;
+DWORD dwPagesErased;
+
+static BYTE abReference[TEST_SECTORS][MEDIA_SECTOR_SIZE];
+
+/*******************************************************************************
+Function:       BYTE bCodeByte(DWORD dwOffset)
+
+Overview:       Returns the pattern of the program memory after the drive image
+
+Input:          Offset from the start of the drive image
+
+Output:         Pattern byte
+*******************************************************************************/
+static BYTE bCodeByte(DWORD dwOffset)
+{
+     return (BYTE)(dwOffset * 31 + 7);
+}
+
+/*******************************************************************************
+Function:       BOOL fMakeFlashWritable(void)
+
+Overview:       Maps the emulated program flash and makes the read-only data
+                of the program, which holds the spare and journal blocks,
+                writable
+
+Input:          None
+
+Output:         TRUE if successful
+*******************************************************************************/
+static BOOL fMakeFlashWritable(void)
+{
+     char szLine[512], szExe[256], szPerm[8];
+     unsigned long ulStart, ulEnd;
+     ssize_t iLength;
+     BYTE *pbFlash;
+     DWORD dwOffset;
+     FILE *pMaps;
+
+     pbFlash = mmap((void*)MASTER_BOOT_RECORD_ADDRESS, TEST_FLASH_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+     if(pbFlash != (BYTE*)MASTER_BOOT_RECORD_ADDRESS)
+     {
+          return FALSE;
+     }
+     memset(pbFlash, 0xFF, TEST_FLASH_SIZE);
+     for(dwOffset = TEST_SECTORS * MEDIA_SECTOR_SIZE; dwOffset < TEST_FLASH_SIZE; dwOffset++)
+     {
+          pbFlash[dwOffset] = bCodeByte(dwOffset);
+     }
+
+     iLength = readlink("/proc/self/exe", szExe, sizeof(szExe) - 1);
+     pMaps = fopen("/proc/self/maps", "r");
+     if(iLength <= 0 || pMaps == NULL)
+     {
+          return FALSE;
+     }
+     szExe[iLength] = 0;
+     while(fgets(szLine, sizeof(szLine), pMaps) != NULL)
+     {
+          if(sscanf(szLine, "%lx-%lx %7s", &ulStart, &ulEnd, szPerm) == 3 &&
+             strcmp(szPerm, "r--p") == 0 && strstr(szLine, szExe) != NULL)
+          {
+               mprotect((void*)ulStart, ulEnd - ulStart, PROT_READ | PROT_WRITE);
+          }
+     }
+     fclose(pMaps);
+     return TRUE;
+}
+
+/*******************************************************************************
+Function:       BOOL fCheckDrive(void)
+
+Overview:       Compares all sectors with the data last written and the
+                program memory after the drive image with its pattern
+
+Input:          None
+
+Output:         TRUE if everything matches
+*******************************************************************************/
+static BOOL fCheckDrive(void)
+{
+     BYTE abSector[MEDIA_SECTOR_SIZE];
+     BYTE *pbFlash = (BYTE*)MASTER_BOOT_RECORD_ADDRESS;
+     DWORD dwSector, dwOffset;
+
+     for(dwSector = 0; dwSector < TEST_SECTORS; dwSector++)
+     {
+          if(!MDD_IntFlash_SectorRead(dwSector, abSector) ||
+             memcmp(abSector, abReference[dwSector], MEDIA_SECTOR_SIZE) != 0)
+          {
+               printf("sector %lu differs\n", (unsigned long)dwSector);
+               return FALSE;
+          }
+     }
+     for(dwOffset = TEST_SECTORS * MEDIA_SECTOR_SIZE; dwOffset < TEST_FLASH_SIZE; dwOffset++)
+     {
+          if(pbFlash[dwOffset] != bCodeByte(dwOffset))
+          {
+               printf("program memory changed at offset %lu\n", (unsigned long)dwOffset);
+               return FALSE;
+          }
+     }
+     return TRUE;
+}
+
+/*******************************************************************************
+Function:       BOOL fWriteSector(DWORD dwSector)
+
+Overview:       Writes random data to a sector and keeps a copy of it
+
+Input:          Sector
+
+Output:         TRUE if successful
+*******************************************************************************/
+static BOOL fWriteSector(DWORD dwSector)
+{
+     WORD wCounter;
+
+     for(wCounter = 0; wCounter < MEDIA_SECTOR_SIZE; wCounter++)
+     {
+          abReference[dwSector][wCounter] = (BYTE)rand();
+     }
+     return MDD_IntFlash_SectorWrite(dwSector, abReference[dwSector], TRUE);
+}
+
+int main(void)
+{
+     DWORD dwCounter, dwErases;
+     int iFailed = 0;
+
+     if(!fMakeFlashWritable())
+     {
+          printf("cannot map the emulated flash\n");
+          return 1;
+     }
+     memset(abReference, 0xFF, sizeof(abReference));
+     srand(1);
+
+     /* Random writes, remounted every 1000 writes */
+     if(!MDD_IntFlash_MediaInitialize())
+     {
+          printf("MediaInitialize failed\n");
+          return 1;
+     }
+     for(dwCounter = 0; dwCounter < TEST_RANDOM_WRITES && !iFailed; dwCounter++)
+     {
+          if(!fWriteSector((dwCounter % 5 == 0)? (DWORD)rand() % TEST_SECTORS: (dwCounter / 5 * 3 + dwCounter % 5) % TEST_SECTORS))
+          {
+               printf("write %lu failed\n", (unsigned long)dwCounter);
+               iFailed = 1;
+          }
+          if(dwCounter % 1000 == 999)
+          {
+               MDD_IntFlash_FlushCache();
+               MDD_IntFlash_MediaInitialize();
+          }
+     }
+     MDD_IntFlash_FlushCache();
+     MDD_IntFlash_MediaInitialize();
+     if(!iFailed && !fCheckDrive())
+     {
+          iFailed = 1;
+     }
+     printf("random writes: %lu erases, %lu words programmed\n",
+            (unsigned long)dwPagesErased, (unsigned long)dwWordsProgrammed);
+
+     /* Remount after every block write: each write appends one record to the
+        journal found by the remount and costs only the erase of the block.
+        The journal block is erased at most once when it fills up. */
+     dwPagesErased = 0;
+     for(dwCounter = 0; dwCounter < TEST_REMOUNTS && !iFailed; dwCounter++)
+     {
+          MDD_IntFlash_MediaInitialize();
+          /* The last block is partly program memory and is not remapped */
+          if(!fWriteSector((dwCounter % (MDD_INTERNAL_FLASH_LOGICAL_BLOCKS - 1)) * MDD_INTERNAL_FLASH_SECTORS_PER_BLOCK) ||
+             !MDD_IntFlash_FlushCache())
+          {
+               printf("remount write %lu failed\n", (unsigned long)dwCounter);
+               iFailed = 1;
+          }
+     }
+     dwErases = dwPagesErased;
+     MDD_IntFlash_MediaInitialize();
+     if(!iFailed && !fCheckDrive())
+     {
+          iFailed = 1;
+     }
+     printf("remount writes: %lu writes, %lu erases\n", (unsigned long)TEST_REMOUNTS, (unsigned long)dwErases);
+     if(dwErases > TEST_REMOUNTS + 1)
+     {
+          printf("the journal was not appended after a remount\n");
+          iFailed = 1;
+     }
+
+     printf(iFailed? "FAILED\n": "PASSED\n");
+     return iFailed;
+}
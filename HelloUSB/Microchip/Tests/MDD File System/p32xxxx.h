@@ -0,0 +1,4 @@
+/******************************************************************************
+ Host replacement of the PIC32 device header for the internal flash journal
+ test. The driver needs no special function registers on PIC32.
+*******************************************************************************/
@@ -0,0 +1,33 @@
+/******************************************************************************
+ Host replacement of the PIC32 peripheral library for the internal flash
+ journal test. Programming a word can only clear bits, erasing a page sets
+ all of its bits, like on the flash of the device.
+*******************************************************************************/
+
+#ifndef _PLIB_H
+#define _PLIB_H
+
+#include <string.h>
+#include "GenericTypeDefs.h"
+#include "HardwareProfile.h"
+
+extern DWORD dwWordsProgrammed;
+extern DWORD dwPagesErased;
+
+#define KVA_TO_PA(v)    ((DWORD)(v) & 0x1FFFFFFF)
+
+static inline unsigned int NVMWriteWord (void* address, DWORD data)
+{
+     *(DWORD*)address &= data;
+     dwWordsProgrammed++;
+     return 0;
+}
+
+static inline unsigned int NVMErasePage (void* address)
+{
+     memset (address, 0xFF, ERASE_BLOCK_SIZE);
+     dwPagesErased++;
+     return 0;
+}
+
+#endif
@@ -113,6 +113,7 @@
     #define LUNSectorWrite(bLBA,pDest,Write0)   LUN[LUN_INDEX].SectorWrite(bLBA, pDest, Write0)
     #define LUNWriteProtectState()              LUN[LUN_INDEX].WriteProtectState()
     #define LUNSectorRead(bLBA,pSrc)            LUN[LUN_INDEX].SectorRead(bLBA, pSrc)
+    #define LUNFlushCache()                     ((LUN[LUN_INDEX].FlushCache == NULL) ? TRUE : LUN[LUN_INDEX].FlushCache())
 #else
     #if defined(USE_INTERNAL_FLASH)
         #include "MDD File System\Internal Flash.h"
@@ -129,6 +130,11 @@
     #define LUNSectorWrite(bLBA,pDest,Write0)   MDD_SectorWrite(bLBA, pDest, Write0)
     #define LUNWriteProtectState()              MDD_WriteProtectState()
     #define LUNSectorRead(bLBA,pSrc)            MDD_SectorRead(bLBA, pSrc)
+    #if defined(MDD_FlushCache)
+        #define LUNFlushCache()                 MDD_FlushCache()
+    #else
+        #define LUNFlushCache()                 TRUE
+    #endif
 #endif
 
 /** V A R I A B L E S ************************************************/
@@ -909,6 +915,15 @@ BYTE MSDWriteHandler(void)
         case MSD_WRITE10_BLOCK:
             if(TransferLength.Val == 0)
             {
+                //Program any sectors the media still holds in RAM before the
+                //  status is sent, since the host then considers them written
+                if(LUNFlushCache() != TRUE)
+                {
+                    gblSenseData[LUN_INDEX].SenseKey=S_MEDIUM_ERROR;
+                    gblSenseData[LUN_INDEX].ASC=ASC_WRITE_ERROR;
+                    gblSenseData[LUN_INDEX].ASCQ=ASCQ_WRITE_ERROR;
+                    msd_csw.bCSWStatus=0x01;
+                }
                 MSDWriteState = MSD_WRITE10_WAIT;
                 break;
             }